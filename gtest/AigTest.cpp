@@ -0,0 +1,115 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include <gtest/gtest.h>
+#include <vector>
+#include "Netlist.hpp"
+#include "BitSim.hpp"
+#include "Aig.hpp"
+
+namespace{
+typedef BitSim<64> Sim;
+const Sim::Word AllPatterns=0xFFFFULL; // 4 PIs, 16 patterns
+
+/* x1 and x2 are the same and of a and b, y1 and y2 the same or over them,
+   z takes a branch of a
+*/
+void buildTwins(Netlist& n){
+  Netlist::GateId a=n.addGate("a",Netlist::In),b=n.addGate("b",Netlist::In);
+  Netlist::GateId c=n.addGate("c",Netlist::In),d=n.addGate("d",Netlist::In);
+  Netlist::GateId x1=n.addGate("x1",Netlist::And),x2=n.addGate("x2",Netlist::And);
+  n.addFanin(x1,a); n.addFanin(x1,b);
+  n.addFanin(x2,b); n.addFanin(x2,a);
+  Netlist::GateId y1=n.addGate("y1",Netlist::Or),y2=n.addGate("y2",Netlist::Or);
+  n.addFanin(y1,x1); n.addFanin(y1,c);
+  n.addFanin(y2,x2); n.addFanin(y2,c);
+  Netlist::GateId z=n.addGate("z",Netlist::Nand);
+  n.addFanin(z,a); n.addFanin(z,d);
+  Netlist::GateId o1=n.addGate("o1",Netlist::Out),o2=n.addGate("o2",Netlist::Out),o3=n.addGate("o3",Netlist::Out);
+  n.addFanin(o1,y1);
+  n.addFanin(o2,y2);
+  n.addFanin(o3,z);
+  n.levelize();
+}
+/* Every combination of the PIs, the value of each PO in turn */
+std::vector<Sim::Word> simulate(const Netlist& n){
+  Sim sim(n);
+  for(size_t i=0;i<n.getInputs().size();++i){
+    Sim::Word hi=0;
+    for(unsigned p=0;p<16;++p) if(0!=(p&(1u<<i))) hi|=1ULL<<p;
+    Sim::Word lo=~hi&AllPatterns;
+    sim.setInput(i,&hi,&lo);
+  }
+  sim.simulate();
+  std::vector<Sim::Word> po;
+  for(size_t i=0;i<n.getOutputs().size();++i){
+    po.push_back(sim.getHi(n.getOutputs()[i])[0]&AllPatterns);
+    EXPECT_EQ(AllPatterns,(sim.getHi(n.getOutputs()[i])[0]|sim.getLo(n.getOutputs()[i])[0])&AllPatterns) << "X on PO " << i;
+  }
+  return po;
+}
+}
+
+TEST(Aig,IdenticalSubFunctionsMerge){
+  Netlist n;
+  buildTwins(n);
+  Aig aig;
+  ASSERT_TRUE(aig.build(n));
+  EXPECT_EQ(aig.literal(n.findGate("x1")),aig.literal(n.findGate("x2")));
+  EXPECT_EQ(aig.literal(n.findGate("y1")),aig.literal(n.findGate("y2")));
+  EXPECT_EQ(3u,aig.numAnds());
+  Netlist hashed;
+  ASSERT_TRUE(aig.write(hashed));
+  EXPECT_LT(hashed.size(),n.size());
+  EXPECT_EQ(n.getOutputs().size(),hashed.getOutputs().size());
+  EXPECT_EQ(simulate(n),simulate(hashed));
+}
+TEST(Aig,HashNetlistKeepsTheSmallerNetlist){
+  Netlist n;
+  buildTwins(n);
+  std::vector<Sim::Word> before=simulate(n);
+  ASSERT_TRUE(Aig::hashNetlist(n,""));
+  EXPECT_EQ(10u,n.size()); // the twins gone
+  EXPECT_EQ(before,simulate(n));
+  // nothing to merge, the written netlist is no smaller
+  Netlist m;
+  Netlist::GateId a=m.addGate("a",Netlist::In),b=m.addGate("b",Netlist::In);
+  Netlist::GateId x=m.addGate("x",Netlist::Or),y=m.addGate("y",Netlist::And);
+  m.addFanin(x,a); m.addFanin(x,b);
+  m.addFanin(y,a); m.addFanin(y,b);
+  Netlist::GateId w=m.addGate("w",Netlist::And);
+  m.addFanin(w,x); m.addFanin(w,y);
+  Netlist::GateId o1=m.addGate("o1",Netlist::Out),o2=m.addGate("o2",Netlist::Out);
+  m.addFanin(o1,w);
+  m.addFanin(o2,x);
+  m.levelize();
+  size_t size=m.size();
+  ASSERT_TRUE(Aig::hashNetlist(m,""));
+  EXPECT_EQ(size,m.size());
+  EXPECT_TRUE(m.findGate("x")<m.size());
+}
+TEST(Aig,BranchFaultGoesOnTheInputOfItsAnd){
+  Netlist n;
+  buildTwins(n);
+  Aig aig;
+  ASSERT_TRUE(aig.build(n));
+  Netlist::GateId a=n.findGate("a"),z=n.findGate("z"),y1=n.findGate("y1"),x1=n.findGate("x1");
+  Aig::NodeFault stem=aig.mapFault(a,~0u,false);
+  EXPECT_EQ(Aig::node(aig.literal(a)),stem.node);
+  EXPECT_EQ(Aig::None,stem.input);
+  EXPECT_FALSE(stem.bBranch);
+  // the branch of a into z is the a input of the and of z, not the stem
+  Aig::NodeFault branch=aig.mapFault(z,0,false);
+  EXPECT_TRUE(branch.bBranch);
+  EXPECT_EQ(Aig::node(aig.literal(z)),branch.node);
+  EXPECT_EQ(aig.literal(a),branch.input);
+  EXPECT_FALSE(branch.stuckAt);
+  // an or takes the complement of its inputs, the stuck value stays that of the net
+  branch=aig.mapFault(y1,0,true);
+  EXPECT_EQ(Aig::node(aig.literal(y1)),branch.node);
+  EXPECT_EQ(aig.literal(x1)^1u,branch.input);
+  EXPECT_TRUE(branch.stuckAt);
+  EXPECT_NE(aig.mapFault(x1,0,false).node,aig.mapFault(z,0,false).node);
+}
@@ -0,0 +1,68 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+#include "Arena.hpp"
+
+TEST(Arena,AlignedAndReusedAfterReset){
+  Arena a(256);
+  char* c=a.allocateArray<char>(3);
+  ASSERT_TRUE(0!=c);
+  double* d=a.allocateArray<double>(4);
+  EXPECT_EQ(0u,reinterpret_cast<size_t>(d)%alignof(double));
+  EXPECT_LE(3+4*sizeof(double),a.used());
+  // larger than a chunk
+  unsigned* big=a.allocateArray<unsigned>(1000);
+  for(unsigned i=0;i<1000;++i) big[i]=i;
+  EXPECT_EQ(999u,big[999]);
+  size_t capacity=a.capacity();
+  EXPECT_LE(1000*sizeof(unsigned),capacity);
+  a.reset();
+  EXPECT_EQ(0u,a.used());
+  EXPECT_EQ(capacity,a.capacity()); // the chunks are kept
+  a.allocateArray<double>(4);
+  EXPECT_EQ(capacity,a.capacity());
+}
+TEST(Arena,FixedQueueIsFifoAndGrows){
+  Arena a;
+  FixedQueue<unsigned> q;
+  q.reserve(a,4);
+  EXPECT_TRUE(q.empty());
+  unsigned next=0,expected=0;
+  // wrap around the ring a few times, then grow past the reserve
+  for(int round=0;round<10;++round){
+    q.push_back(next++); q.push_back(next++); q.push_back(next++);
+    EXPECT_EQ(expected++,q.front()); q.pop_front();
+    EXPECT_EQ(expected++,q.front()); q.pop_front();
+  }
+  EXPECT_EQ(10u,q.size());
+  std::vector<unsigned> seen;
+  for(FixedQueue<unsigned>::iterator it=q.begin();it!=q.end();++it) seen.push_back(*it);
+  ASSERT_EQ(10u,seen.size());
+  for(unsigned i=0;i<10;++i) EXPECT_EQ(expected+i,seen[i]);
+  while(!q.empty()){ EXPECT_EQ(expected++,q.front()); q.pop_front(); }
+  EXPECT_EQ(next,expected);
+  a.reset();
+  q.reserve(a,2);
+  EXPECT_TRUE(q.empty());
+}
+TEST(Arena,FixedSetMatchesStdSet){
+  Arena a;
+  FixedSet<unsigned> s;
+  s.reserve(a,4);
+  std::set<unsigned> ref;
+  for(unsigned i=0;i<200;++i){
+    unsigned v=(i*37)%101; // repeats after 101
+    std::pair<FixedSet<unsigned>::iterator,bool> r=s.insert(v);
+    EXPECT_EQ(ref.insert(v).second,r.second) << v;
+    EXPECT_EQ(v,*r.first);
+  }
+  ASSERT_EQ(ref.size(),s.size());
+  EXPECT_TRUE(std::equal(ref.begin(),ref.end(),s.begin()));
+  s.clear();
+  EXPECT_TRUE(s.empty());
+}
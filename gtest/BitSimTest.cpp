@@ -0,0 +1,70 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include <gtest/gtest.h>
+#include <vector>
+#include "Netlist.hpp"
+#include "BitSim.hpp"
+
+namespace{
+typedef BitSim<256> Sim; // 3^4 = 81 patterns, every input combination of 4 fanins
+typedef Sim::Word Word;
+
+/* A gate of type fed by numIn PIs, the PIs first so the gate is last */
+Netlist::GateId buildGate(Netlist& n,Netlist::GateType type,unsigned numIn){
+  std::vector<Netlist::GateId> pis;
+  for(unsigned i=0;i<numIn;++i) pis.push_back(n.addGate("i"+std::to_string(i),Netlist::In));
+  Netlist::GateId g=n.addGate("g",type);
+  for(unsigned i=0;i<numIn;++i) n.addFanin(g,pis[i]);
+  n.levelize();
+  return g;
+}
+/* Pattern p sets PI i to ZERO, ONE, X by digit i of p in base 3 */
+void setInputs(const Netlist& n,std::vector<Word>& hi,std::vector<Word>& lo){
+  unsigned numPatterns=1;
+  for(size_t i=0;i<n.getInputs().size();++i) numPatterns*=3;
+  for(size_t i=0;i<n.getInputs().size();++i){
+    Netlist::GateId pi=n.getInputs()[i];
+    unsigned weight=1;
+    for(size_t k=0;k<i;++k) weight*=3;
+    for(unsigned p=0;p<numPatterns;++p){
+      unsigned digit=(p/weight)%3;
+      Word bit=1ULL<<(p%64);
+      if(1==digit) hi[pi*Sim::Words+p/64]|=bit;
+      if(0==digit) lo[pi*Sim::Words+p/64]|=bit;
+    }
+  }
+}
+void checkGroupKernel(Netlist::GateType type,unsigned numIn){
+  Netlist n;
+  Netlist::GateId g=buildGate(n,type,numIn);
+  Sim::GroupKernel kernel=Sim::groupKernel(type,numIn);
+  ASSERT_TRUE(0!=kernel) << "type " << type << " arity " << numIn;
+  std::vector<Word> hi(n.size()*Sim::Words,0ULL),lo(n.size()*Sim::Words,0ULL);
+  setInputs(n,hi,lo);
+  std::vector<Word> refHi(hi),refLo(lo);
+  kernel(n,&g,&g+1,&hi[0],&lo[0]);
+  Sim::evaluateGate(type,numIn,n.fanins(g),&refHi[0],&refLo[0],g);
+  for(unsigned w=0;w<Sim::Words;++w){
+    EXPECT_EQ(refHi[g*Sim::Words+w],hi[g*Sim::Words+w]) << "type " << type << " arity " << numIn << " word " << w;
+    EXPECT_EQ(refLo[g*Sim::Words+w],lo[g*Sim::Words+w]) << "type " << type << " arity " << numIn << " word " << w;
+  }
+}
+}
+
+TEST(BitSim,GroupKernelsMatchEvaluateGate){
+  const Netlist::GateType Types[4]={Netlist::And,Netlist::Nand,Netlist::Or,Netlist::Nor};
+  for(int t=0;t<4;++t){
+    for(unsigned numIn=1;numIn<=GateKernels::MaxArity;++numIn) checkGroupKernel(Types[t],numIn);
+  }
+  checkGroupKernel(Netlist::Buf,1);
+  checkGroupKernel(Netlist::Not,1);
+  checkGroupKernel(Netlist::Out,1);
+}
+TEST(BitSim,NoGroupKernelPastMaxArity){
+  EXPECT_TRUE(0==BitSim<64>::groupKernel(Netlist::Nand,GateKernels::MaxArity+1));
+  EXPECT_TRUE(0==BitSim<64>::groupKernel(Netlist::Not,2));
+  EXPECT_TRUE(0==BitSim<64>::groupKernel(Netlist::Lut,2));
+}
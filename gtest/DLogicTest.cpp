@@ -0,0 +1,42 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include <gtest/gtest.h>
+#include "DLogic.hpp"
+
+namespace{
+/* The good and faulty machine of ZERO, ONE, D, _D, X, 2 is X */
+const int Good[5]={0,1,1,0,2};
+const int Faulty[5]={0,1,0,1,2};
+
+int andOf(int a,int b){ return (0==a || 0==b) ? 0 : ((1==a && 1==b) ? 1 : 2); }
+int orOf(int a,int b){ return (1==a || 1==b) ? 1 : ((0==a && 0==b) ? 0 : 2); }
+/* A pair back to one of the five values, X if either machine is X */
+DLogic value(int good,int faulty){
+  if(2==good || 2==faulty) return DLogic::X;
+  if(good==faulty) return good ? DLogic::ONE : DLogic::ZERO;
+  return good ? DLogic::D : DLogic::_D;
+}
+}
+
+TEST(DLogic,AndTableIsEachMachineApart){
+  for(int a=0;a<5;++a){
+    for(int b=0;b<5;++b){
+      EXPECT_EQ(value(andOf(Good[a],Good[b]),andOf(Faulty[a],Faulty[b])),DLogic::DLogicAnd[a][b]) << a << " and " << b;
+    }
+  }
+}
+TEST(DLogic,OrTableIsEachMachineApart){
+  for(int a=0;a<5;++a){
+    for(int b=0;b<5;++b){
+      EXPECT_EQ(value(orOf(Good[a],Good[b]),orOf(Faulty[a],Faulty[b])),DLogic::DLogicOr[a][b]) << a << " or " << b;
+    }
+  }
+}
+TEST(DLogic,DAndDIsD){
+  EXPECT_EQ(DLogic::D,DLogic::D && DLogic::D);
+  EXPECT_EQ(DLogic::_D,DLogic::_D && DLogic::_D);
+  EXPECT_EQ(DLogic::ZERO,DLogic::D && DLogic::_D);
+}
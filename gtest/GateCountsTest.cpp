@@ -0,0 +1,38 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include <gtest/gtest.h>
+#include <vector>
+#include "GateCounts.hpp"
+#include "GateKernels.hpp"
+
+TEST(GateCounts,CountsGiveTheValueOfTheKernels){
+  const GateCounts::Func Funcs[4]={GateCounts::And,GateCounts::Nand,GateCounts::Or,GateCounts::Nor};
+  const Netlist::GateType Types[4]={Netlist::And,Netlist::Nand,Netlist::Or,Netlist::Nor};
+  for(unsigned numIn=1;numIn<=5;++numIn){
+    for(int t=0;t<4;++t){
+      GateCounts gates;
+      for(unsigned i=0;i<numIn;++i) gates.addInput(0,i+1,i); // gate 0, driven by 1 to numIn
+      gates.setFunc(0,Funcs[t]);
+      gates.clear(numIn+1);
+      std::vector<unsigned> index(numIn,0);
+      std::vector<DLogic> in(numIn);
+      bool bMore=true;
+      while(bMore){
+        for(unsigned i=0;i<numIn;++i){
+          in[i]=GateKernels::value(index[i]);
+          gates.change(0,DLogic::X,in[i]);
+        }
+        ASSERT_EQ(GateKernels::evaluate(Types[t],&in[0],numIn),gates.evaluate(0)) << "type " << Types[t] << " arity " << numIn;
+        for(unsigned i=0;i<numIn;++i) gates.change(0,in[i],DLogic::X);
+        bMore=false;
+        for(unsigned i=0;i<numIn && !bMore;++i){
+          if(++index[i]<5) bMore=true;
+          else index[i]=0;
+        }
+      }
+    }
+  }
+}
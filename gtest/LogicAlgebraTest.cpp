@@ -0,0 +1,157 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include <gtest/gtest.h>
+#include <vector>
+#include "LogicAlgebra.hpp"
+#include "GateKernels.hpp"
+#include "FaultSim.hpp"
+
+namespace{
+/* and or or of each machine apart, the value of the pair at the end */
+template<class V>
+unsigned reference(bool bAnd,const unsigned char* in,unsigned numIn){
+  unsigned good=V::good(in[0]),faulty=V::faulty(in[0]);
+  for(unsigned i=1;i<numIn;++i){
+    good=bAnd ? Component::andOf(good,V::good(in[i])) : Component::orOf(good,V::good(in[i]));
+    faulty=bAnd ? Component::andOf(faulty,V::faulty(in[i])) : Component::orOf(faulty,V::faulty(in[i]));
+  }
+  return V::value(good,faulty);
+}
+/* Every input combination of numIn values of V, in[0] fastest */
+template<class V>
+bool next(std::vector<unsigned char>& in){
+  for(size_t i=0;i<in.size();++i){
+    if(++in[i]<V::Size) return true;
+    in[i]=0;
+  }
+  return false;
+}
+template<class V>
+void checkEveryCombination(unsigned maxIn){
+  typedef LogicAlgebra<V> L;
+  const Netlist::GateType Types[4]={Netlist::And,Netlist::Nand,Netlist::Or,Netlist::Nor};
+  for(unsigned numIn=1;numIn<=maxIn;++numIn){
+    std::vector<unsigned char> in(numIn,0);
+    do{
+      for(int t=0;t<4;++t){
+        bool bAnd=(Netlist::And==Types[t] || Netlist::Nand==Types[t]);
+        unsigned expected=reference<V>(bAnd,&in[0],numIn);
+        if(Netlist::Nand==Types[t] || Netlist::Nor==Types[t]) expected=L::Not[expected];
+        ASSERT_EQ(expected,L::evaluate(Types[t],&in[0],numIn)) << "type " << Types[t] << " arity " << numIn;
+      }
+    }while(next<V>(in));
+  }
+}
+}
+
+TEST(LogicAlgebra,FiveValuedAndDoesNotDependOnPinOrder){
+  typedef LogicAlgebra<FiveValued> Five;
+  const unsigned char first[3]={FiveValued::D,FiveValued::DBar,FiveValued::X};
+  const unsigned char middle[3]={FiveValued::D,FiveValued::X,FiveValued::DBar};
+  EXPECT_EQ(static_cast<unsigned>(FiveValued::Zero),Five::evaluate(Netlist::And,first,3));
+  EXPECT_EQ(static_cast<unsigned>(FiveValued::Zero),Five::evaluate(Netlist::And,middle,3));
+  typedef Five::Kernel<Netlist::And,3> And3;
+  typedef Five::Kernel<Netlist::Nand,3> Nand3;
+  EXPECT_EQ(static_cast<unsigned>(FiveValued::Zero),And3::evaluate(middle));
+  EXPECT_EQ(static_cast<unsigned>(FiveValued::One),Nand3::evaluate(middle));
+  const unsigned char wide[6]={FiveValued::D,FiveValued::X,FiveValued::One,FiveValued::One,FiveValued::X,FiveValued::DBar};
+  EXPECT_EQ(static_cast<unsigned>(FiveValued::Zero),Five::evaluate(Netlist::And,wide,6));
+  const unsigned char orMiddle[3]={FiveValued::D,FiveValued::X,FiveValued::DBar};
+  EXPECT_EQ(static_cast<unsigned>(FiveValued::One),Five::evaluate(Netlist::Or,orMiddle,3));
+}
+TEST(LogicAlgebra,FiveValuedGatesAreEachMachineApart){
+  checkEveryCombination<FiveValued>(6);
+}
+TEST(LogicAlgebra,NineValuedGatesAreEachMachineApart){
+  checkEveryCombination<NineValued>(4);
+}
+TEST(LogicAlgebra,ThreeValuedGatesAreEachMachineApart){
+  checkEveryCombination<ThreeValued>(6);
+}
+TEST(LogicAlgebra,ThreeValuedIsTheGoodMachineOfFiveAndNine){
+  typedef LogicAlgebra<ThreeValued> Three;
+  typedef LogicAlgebra<FiveValued> Five;
+  typedef LogicAlgebra<NineValued> Nine;
+  for(unsigned a=0;a<ThreeValued::Size;++a){
+    EXPECT_EQ(FiveValued::value(Three::Not[a],Three::Not[a]),Five::Not[FiveValued::value(a,a)]);
+    for(unsigned b=0;b<ThreeValued::Size;++b){
+      unsigned and3=Three::And[a*ThreeValued::Size+b];
+      EXPECT_EQ(FiveValued::value(and3,and3),Five::And[FiveValued::value(a,a)*FiveValued::Size+FiveValued::value(b,b)]);
+      EXPECT_EQ(NineValued::value(and3,and3),Nine::And[NineValued::value(a,a)*NineValued::Size+NineValued::value(b,b)]);
+    }
+  }
+}
+namespace{
+/* s=buf(a), z=and(s,c), y=and(s,b), out=or(z,y) : a fault on a reaches
+   the or on both paths, so with c at X 9 values still see it
+*/
+template<class V>
+void faultsDetected(const std::vector<unsigned>& piValues,std::vector<bool>& detected){
+  Netlist n;
+  Netlist::GateId a=n.addGate("a",Netlist::In),b=n.addGate("b",Netlist::In),c=n.addGate("c",Netlist::In);
+  Netlist::GateId s=n.addGate("s",Netlist::Buf),z=n.addGate("z",Netlist::And),y=n.addGate("y",Netlist::And);
+  Netlist::GateId w=n.addGate("w",Netlist::Or),o=n.addGate("o",Netlist::Out);
+  n.addFanin(s,a);
+  n.addFanin(z,s); n.addFanin(z,c);
+  n.addFanin(y,s); n.addFanin(y,b);
+  n.addFanin(w,z); n.addFanin(w,y);
+  n.addFanin(o,w);
+  n.levelize();
+  FaultSim<V> sim(n);
+  for(size_t i=0;i<piValues.size();++i){
+    sim.setInput(i,(2==piValues[i]) ? LogicAlgebra<V>::unknown() : LogicAlgebra<V>::fromBool(1==piValues[i]));
+  }
+  sim.simulate();
+  std::vector<typename FaultSim<V>::Fault> faults;
+  FaultSim<V>::checkpointFaults(n,faults);
+  detected.clear();
+  for(size_t f=0;f<faults.size();++f) detected.push_back(sim.detects(faults[f]));
+}
+}
+TEST(FaultSim,ThreeValuedSeesWhatNineValuedSees){
+  std::vector<unsigned> pi(3,0); // 0, 1 or 2 for X, every combination
+  unsigned numDetected=0,numMoreThanFive=0;
+  for(unsigned p=0;p<27;++p){
+    pi[0]=p%3; pi[1]=(p/3)%3; pi[2]=p/9;
+    std::vector<bool> three,nine,five;
+    faultsDetected<ThreeValued>(pi,three);
+    faultsDetected<NineValued>(pi,nine);
+    faultsDetected<FiveValued>(pi,five);
+    EXPECT_EQ(nine,three) << "pattern " << p;
+    for(size_t f=0;f<five.size();++f){
+      if(five[f]) EXPECT_TRUE(three[f]) << "pattern " << p << " fault " << f;
+      if(three[f]) ++numDetected;
+      if(three[f] && !five[f]) ++numMoreThanFive;
+    }
+  }
+  EXPECT_GT(numDetected,0u);
+  EXPECT_GT(numMoreThanFive,0u); // an effect through X that 5 values lose
+}
+TEST(GateKernels,DLogicAndDoesNotDependOnPinOrder){
+  DLogic in[3]={DLogic::D,DLogic::X,DLogic::_D};
+  EXPECT_EQ(DLogic::ZERO,GateKernels::evaluate(Netlist::And,in,3));
+  EXPECT_EQ(DLogic::ONE,GateKernels::evaluate(Netlist::Nand,in,3));
+  EXPECT_EQ(DLogic::ONE,GateKernels::evaluate(Netlist::Or,in,3));
+  typedef GateKernels::Kernel<Netlist::Nor,3> Nor3;
+  EXPECT_EQ(DLogic::ZERO,Nor3::evaluate(in));
+  DLogic wide[5]={DLogic::D,DLogic::X,DLogic::ONE,DLogic::ONE,DLogic::_D};
+  EXPECT_EQ(DLogic::ZERO,GateKernels::evaluate(Netlist::And,wide,5));
+}
+TEST(GateKernels,DLogicGatesMatchTheFiveValuedAlgebra){
+  typedef LogicAlgebra<FiveValued> Five;
+  const Netlist::GateType Types[4]={Netlist::And,Netlist::Nand,Netlist::Or,Netlist::Nor};
+  for(unsigned numIn=1;numIn<=6;++numIn){
+    std::vector<unsigned char> in(numIn,0);
+    std::vector<DLogic> logic(numIn);
+    do{
+      for(unsigned i=0;i<numIn;++i) logic[i]=GateKernels::value(in[i]);
+      for(int t=0;t<4;++t){
+        ASSERT_EQ(GateKernels::value(Five::evaluate(Types[t],&in[0],numIn)),GateKernels::evaluate(Types[t],&logic[0],numIn))
+          << "type " << Types[t] << " arity " << numIn;
+      }
+    }while(next<FiveValued>(in));
+  }
+}
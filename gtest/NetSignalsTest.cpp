@@ -0,0 +1,86 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include <gtest/gtest.h>
+#include "NetSignals.hpp"
+
+namespace{
+/* Vertex 0 fans out to edges 0,1,2, vertex 1 to edge 3, vertex 2 to none */
+void build(NetSignals& s){
+  s.clear(3);
+  s.setFanout(0,3);
+  s.setFanout(1,1);
+  s.setFanout(2,0);
+}
+}
+
+TEST(NetSignals,BranchesReadTheStem){
+  NetSignals s;
+  EXPECT_FALSE(s.loaded());
+  build(s);
+  EXPECT_TRUE(s.loaded());
+  EXPECT_EQ(3u,s.size());
+  EXPECT_TRUE(s.hasX(0));
+  EXPECT_EQ(0u,s.drive(0,DLogic::ONE));
+  EXPECT_EQ(DLogic::ONE,s.net(0));
+  for(NetSignals::Edge e=0;e<3;++e) EXPECT_EQ(DLogic::ONE,s.branch(0,e));
+  EXPECT_FALSE(s.hasX(0));
+  // driving a net that has a value counts its branches, the value stays
+  EXPECT_EQ(3u,s.drive(0,DLogic::ZERO));
+  EXPECT_EQ(DLogic::ONE,s.net(0));
+  bool bIncompatible=true;
+  EXPECT_EQ(DLogic::ONE,s.evaluate(0,bIncompatible));
+  EXPECT_FALSE(bIncompatible);
+  EXPECT_EQ(0u,s.numBranchValues());
+  // clear keeps the fanouts of the same size
+  s.clear(3);
+  EXPECT_EQ(DLogic::X,s.net(0));
+  EXPECT_EQ(0u,s.drive(0,DLogic::ZERO));
+  EXPECT_EQ(DLogic::ZERO,s.branch(0,2));
+}
+TEST(NetSignals,BranchFaultKeepsItsValue){
+  NetSignals s;
+  build(s);
+  s.setBranch(0,1,DLogic::D);
+  EXPECT_EQ(1u,s.numBranchValues());
+  EXPECT_EQ(DLogic::D,s.branch(0,1));
+  EXPECT_EQ(DLogic::X,s.branch(0,0));
+  EXPECT_EQ(DLogic::X,s.branch(1,3)); // other vertices skip the branch values
+  bool bIncompatible=true;
+  EXPECT_EQ(DLogic::D,s.evaluate(0,bIncompatible)); // the one non X value
+  EXPECT_FALSE(bIncompatible);
+  EXPECT_TRUE(s.hasX(0));
+  // the stem and the X branches take the value, the fault is counted
+  EXPECT_EQ(1u,s.drive(0,DLogic::ONE));
+  EXPECT_EQ(DLogic::ONE,s.branch(0,0));
+  EXPECT_EQ(DLogic::D,s.branch(0,1));
+  EXPECT_EQ(DLogic::ONE,s.branch(0,2));
+  EXPECT_FALSE(s.hasX(0));
+  EXPECT_EQ(DLogic::X,s.evaluate(0,bIncompatible));
+  EXPECT_TRUE(bIncompatible);
+  // setBranch again replaces the value, no second entry
+  s.setBranch(0,1,DLogic::ONE);
+  EXPECT_EQ(1u,s.numBranchValues());
+  EXPECT_EQ(DLogic::ONE,s.evaluate(0,bIncompatible));
+  EXPECT_FALSE(bIncompatible);
+}
+TEST(NetSignals,EveryBranchOwnValue){
+  NetSignals s;
+  build(s);
+  // a vertex whose branches all have their own value ignores its stem
+  s.setBranch(1,3,DLogic::X);
+  s.setNet(1,DLogic::ZERO);
+  bool bIncompatible=true;
+  EXPECT_EQ(DLogic::X,s.evaluate(1,bIncompatible));
+  EXPECT_FALSE(bIncompatible);
+  EXPECT_TRUE(s.hasX(1));
+  EXPECT_EQ(0u,s.drive(1,DLogic::_D));
+  EXPECT_EQ(DLogic::_D,s.branch(1,3));
+  EXPECT_EQ(DLogic::ZERO,s.net(1));
+  EXPECT_EQ(DLogic::_D,s.evaluate(1,bIncompatible));
+  // no fanout, nothing to read
+  EXPECT_FALSE(s.hasX(2));
+  EXPECT_EQ(DLogic::X,s.evaluate(2,bIncompatible));
+}
@@ -0,0 +1,174 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Netlist.hpp"
+#include "BitSim.hpp"
+#include "MappedNetlist.hpp"
+
+namespace{
+typedef BitSim<256> Sim; // 8 PIs, every one of the 256 combinations
+typedef Sim::Word Word;
+const unsigned NumPI=8,NumGates=160,NumPO=12;
+
+/* A random netlist of primitives, the same for every call. Each gate takes
+   its fanins from the gates before it, so there is no loop, and the last
+   gates and a few in the middle drive the POs
+*/
+void buildRandom(Netlist& n){
+  const Netlist::GateType Types[6]={Netlist::And,Netlist::Nand,Netlist::Or,Netlist::Nor,Netlist::Not,Netlist::Buf};
+  unsigned seed=12345;
+  std::vector<Netlist::GateId> nets;
+  for(unsigned i=0;i<NumPI;++i) nets.push_back(n.addGate("i"+std::to_string(i),Netlist::In));
+  for(unsigned i=0;i<NumGates;++i){
+    seed=seed*1103515245u+12345u;
+    Netlist::GateType type=Types[(seed>>16)%6];
+    unsigned numIn=(Netlist::Not==type || Netlist::Buf==type) ? 1 : 2+(seed>>8)%3;
+    Netlist::GateId g=n.addGate("g"+std::to_string(i),type);
+    for(unsigned k=0;k<numIn;++k){
+      seed=seed*1103515245u+12345u;
+      n.addFanin(g,nets[(seed>>16)%nets.size()]);
+    }
+    nets.push_back(g);
+  }
+  for(unsigned i=0;i<NumPO;++i){
+    Netlist::GateId o=n.addGate("o"+std::to_string(i),Netlist::Out);
+    n.addFanin(o,nets[(i<NumPO/2) ? nets.size()-1-i : NumPI+i*NumGates/NumPO]);
+  }
+  ASSERT_TRUE(n.levelize());
+}
+/* Pattern p sets PI i to bit i of p */
+void setInputs(std::vector<Word>& hi,std::vector<Word>& lo){
+  hi.assign(NumPI*Sim::Words,0ULL);
+  lo.assign(NumPI*Sim::Words,0ULL);
+  for(unsigned i=0;i<NumPI;++i){
+    for(unsigned p=0;p<256;++p){
+      Word bit=1ULL<<(p%64);
+      if(0!=(p&(1u<<i))) hi[i*Sim::Words+p/64]|=bit;
+      else lo[i*Sim::Words+p/64]|=bit;
+    }
+  }
+}
+/* hi then lo planes of every PO, in PO order */
+template<class Simulator,class Net>
+std::vector<Word> simulate(Simulator& sim,const Net& n){
+  std::vector<Word> hi,lo;
+  setInputs(hi,lo);
+  for(unsigned i=0;i<NumPI;++i) sim.setInput(i,&hi[i*Sim::Words],&lo[i*Sim::Words]);
+  sim.simulate();
+  std::vector<Word> po;
+  for(size_t i=0;i<n.getOutputs().size();++i){
+    po.insert(po.end(),sim.getHi(n.getOutputs()[i]),sim.getHi(n.getOutputs()[i])+Sim::Words);
+    po.insert(po.end(),sim.getLo(n.getOutputs()[i]),sim.getLo(n.getOutputs()[i])+Sim::Words);
+  }
+  return po;
+}
+std::vector<Word> simulate(const Netlist& n){
+  Sim sim(n);
+  return simulate(sim,n);
+}
+}
+
+TEST(Netlist,ReorderKeepsThePOValues){
+  Netlist ref;
+  buildRandom(ref);
+  std::vector<Word> expected=simulate(ref);
+  for(int o=Netlist::FileOrder;o<Netlist::NumOrderings;++o){
+    Netlist n;
+    buildRandom(n);
+    n.reorder(static_cast<Netlist::Ordering>(o));
+    EXPECT_EQ(ref.size(),n.size()) << Netlist::orderingName(static_cast<Netlist::Ordering>(o));
+    EXPECT_EQ(ref.getDepth(),n.getDepth());
+    EXPECT_TRUE(expected==simulate(n)) << Netlist::orderingName(static_cast<Netlist::Ordering>(o));
+    for(Netlist::GateId g=0;g<n.size();++g){
+      Netlist::GateId old=n.getOriginalId(g);
+      ASSERT_LT(old,ref.size());
+      EXPECT_EQ(ref.getName(old),n.getName(g));
+      EXPECT_EQ(ref.getType(old),n.getType(g));
+      ASSERT_EQ(ref.numFanins(old),n.numFanins(g));
+      for(unsigned k=0;k<n.numFanins(g);++k) EXPECT_EQ(ref.fanins(old)[k],n.getOriginalId(n.fanins(g)[k]));
+      EXPECT_EQ(g,n.findGate(n.getName(g)));
+    }
+    for(size_t i=0;i<NumPI;++i) EXPECT_EQ(ref.getName(ref.getInputs()[i]),n.getName(n.getInputs()[i]));
+  }
+}
+TEST(Netlist,ConeOrderKeepsEachConeContiguous){
+  Netlist n;
+  buildRandom(n);
+  n.reorder(Netlist::ConeOrder);
+  // the cone of the first PO is ids 0 to the PO, of the second PO what it adds
+  for(size_t o=0;o<2;++o){
+    std::vector<bool> inCone(n.size(),false);
+    std::vector<Netlist::GateId> stack(1,n.getOutputs()[o]);
+    while(!stack.empty()){
+      Netlist::GateId g=stack.back();
+      stack.pop_back();
+      if(inCone[g]) continue;
+      inCone[g]=true;
+      for(unsigned k=0;k<n.numFanins(g);++k) stack.push_back(n.fanins(g)[k]);
+    }
+    Netlist::GateId first=(0==o) ? 0 : n.getOutputs()[0]+1;
+    for(Netlist::GateId g=first;g<=n.getOutputs()[o];++g) EXPECT_TRUE(inCone[g]) << "PO " << o << " " << n.getName(g);
+    for(Netlist::GateId g=n.getOutputs()[o]+1;g<n.size();++g) EXPECT_FALSE(inCone[g]) << "PO " << o << " " << n.getName(g);
+  }
+}
+TEST(MappedNetlist,WriteOpenSimulate){
+  Netlist n;
+  buildRandom(n);
+  n.reorder(Netlist::LevelOrder);
+  std::string path=::testing::TempDir()+"NetlistTest.nm";
+  ASSERT_TRUE(MappedNetlist::write(n,path,256)); // a few gates per block
+  MappedNetlist m;
+  ASSERT_TRUE(m.open(path));
+  EXPECT_EQ(n.size(),m.size());
+  EXPECT_EQ(n.getDepth(),m.getDepth());
+  EXPECT_LT(1u,m.numBlocks());
+  EXPECT_EQ(n.getInputs(),m.getInputs());
+  EXPECT_EQ(n.getOutputs(),m.getOutputs());
+  for(Netlist::GateId g=0;g<n.size();++g) EXPECT_EQ(n.getLevel(g),m.getLevel(g));
+  EXPECT_EQ(n.findGate("i3"),m.findGate("i3"));
+  EXPECT_EQ(n.findGate("o5"),m.findGate("o5"));
+  EXPECT_EQ(m.size(),m.findGate("g7")); // PIs and POs only
+  // every gate once, in level order, as the netlist has it
+  std::vector<Netlist::GateId> seen;
+  unsigned lastLevel=0;
+  m.forEachGate(0,[&](Netlist::GateId g,Netlist::GateType type,unsigned numIn,const Netlist::GateId* in){
+    EXPECT_EQ(n.getType(g),type);
+    EXPECT_TRUE(std::equal(in,in+numIn,n.fanins(g)));
+    EXPECT_LE(lastLevel,m.getLevel(g));
+    lastLevel=m.getLevel(g);
+    seen.push_back(g);
+    return true;
+  });
+  std::sort(seen.begin(),seen.end());
+  ASSERT_EQ(n.size(),seen.size());
+  for(Netlist::GateId g=0;g<n.size();++g) EXPECT_EQ(g,seen[g]);
+  MappedBitSim<256> sim(m);
+  ASSERT_TRUE(sim.good());
+  EXPECT_TRUE(simulate(n)==simulate(sim,m));
+  // the fault cone of a PI is what its fanouts reach
+  Netlist::GateId root=n.getInputs()[0];
+  std::vector<bool> reached(n.size(),false);
+  std::vector<Netlist::GateId> stack(1,root);
+  while(!stack.empty()){
+    Netlist::GateId g=stack.back();
+    stack.pop_back();
+    if(reached[g]) continue;
+    reached[g]=true;
+    for(unsigned k=0;k<n.numFanouts(g);++k) stack.push_back(n.fanouts(g)[k]);
+  }
+  std::vector<Netlist::GateId> cone;
+  m.faultCone(root,cone);
+  EXPECT_EQ(static_cast<size_t>(std::count(reached.begin(),reached.end(),true)),cone.size());
+  for(size_t i=0;i<cone.size();++i) EXPECT_TRUE(reached[cone[i]]) << cone[i];
+  cone.clear();
+  m.faultCone(m.findGate("none"),cone);
+  EXPECT_TRUE(cone.empty());
+  std::remove(path.c_str());
+}
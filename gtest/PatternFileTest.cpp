@@ -0,0 +1,103 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include "PatternFile.hpp"
+
+namespace{
+const size_t NumPI=70,NumPO=3; // more than one word per plane
+
+/* The five values, made on first use : the DLogic constants live in another
+   translation unit, so a table at namespace scope may copy them unset
+*/
+DLogic values(size_t i){
+  const DLogic Values[5]={DLogic::ZERO,DLogic::ONE,DLogic::D,DLogic::_D,DLogic::X};
+  return Values[i];
+}
+/* Value of signal s in pattern p, every one of the five values on every signal */
+DLogic value(size_t p,size_t s){
+  return values((p*7+s*3+p/5)%5);
+}
+std::vector<std::string> names(const char* prefix,size_t num){
+  std::vector<std::string> v;
+  for(size_t i=0;i<num;++i) v.push_back(prefix+std::to_string(i));
+  return v;
+}
+void writePatterns(const std::string& path,PatternFile::Format format,size_t numPatterns){
+  PatternWriter w(path,format,names("pi",NumPI),names("po",NumPO));
+  ASSERT_TRUE(w.good()) << path;
+  std::vector<DLogic> pi(NumPI),po(NumPO);
+  for(size_t p=0;p<numPatterns;++p){
+    for(size_t s=0;s<NumPI;++s) pi[s]=value(p,s);
+    for(size_t s=0;s<NumPO;++s) po[s]=value(p,NumPI+s);
+    w.addPattern(pi,po);
+  }
+  EXPECT_EQ(numPatterns,w.getCount());
+  w.close();
+}
+/* Reads the file back in blocks of width, every bit of every block checked,
+   the good value of D and _D is that of the good machine
+*/
+void checkRoundTrip(PatternFile::Format format,size_t width,size_t numPatterns){
+  std::string path=::testing::TempDir()+"PatternFileTest."+std::to_string(width)+".pat";
+  writePatterns(path,format,numPatterns);
+  PatternReader r(path,width);
+  ASSERT_TRUE(r.good());
+  EXPECT_EQ(format,r.getFormat());
+  EXPECT_EQ(names("pi",NumPI),r.getPINames());
+  EXPECT_EQ(names("po",NumPO),r.getPONames());
+  PatternBlock b;
+  size_t first=0,numBlocks=0;
+  while(r.nextBlock(b)){
+    ++numBlocks;
+    ASSERT_EQ((width+63)/64,b.getWords());
+    size_t count=b.getCount();
+    ASSERT_EQ(std::min(width,numPatterns-first),count) << "block " << numBlocks;
+    for(size_t s=0;s<NumPI+NumPO;++s){
+      for(size_t k=0;k<width;++k){
+        PatternBlock::Word bit=1ULL<<(k%64);
+        bool care=0!=(b.getCare(s)[k/64]&bit);
+        bool good=0!=(b.getGood(s)[k/64]&bit);
+        if(k>=count){
+          EXPECT_FALSE(care) << "past the count, signal " << s << " pattern " << first+k;
+          continue;
+        }
+        DLogic d=value(first+k,s);
+        EXPECT_EQ(DLogic::X!=d,care) << "signal " << s << " pattern " << first+k;
+        if(care) EXPECT_EQ(DLogic::ONE==d || DLogic::D==d,good) << "signal " << s << " pattern " << first+k;
+      }
+    }
+    first+=count;
+  }
+  EXPECT_EQ(numPatterns,first);
+  EXPECT_EQ((numPatterns+width-1)/width,numBlocks);
+  std::remove(path.c_str());
+}
+}
+
+TEST(PatternFile,TextRoundTrip){
+  const size_t Widths[3]={64,256,512};
+  for(int w=0;w<3;++w){
+    checkRoundTrip(PatternFile::Text,Widths[w],2*Widths[w]+37); // partial last block
+    checkRoundTrip(PatternFile::Text,Widths[w],3*Widths[w]);    // ends on a block boundary
+  }
+}
+TEST(PatternFile,BinaryRoundTrip){
+  const size_t Widths[3]={64,256,512};
+  for(int w=0;w<3;++w){
+    checkRoundTrip(PatternFile::Binary,Widths[w],2*Widths[w]+37);
+    checkRoundTrip(PatternFile::Binary,Widths[w],3*Widths[w]);
+  }
+}
+TEST(PatternFile,CharEncoding){
+  for(size_t i=0;i<5;++i) EXPECT_EQ(values(i),PatternFile::fromChar(PatternFile::toChar(values(i))));
+  EXPECT_EQ(PatternFile::Binary,PatternFile::formatFromString("bin"));
+  EXPECT_EQ(PatternFile::Binary,PatternFile::formatFromString("binary"));
+  EXPECT_EQ(PatternFile::Text,PatternFile::formatFromString("text"));
+  EXPECT_EQ(3*2*sizeof(unsigned long long),PatternFile::recordBytes(NumPI+NumPO));
+}
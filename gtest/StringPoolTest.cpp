@@ -0,0 +1,56 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "StringPool.hpp"
+
+TEST(StringPool,InternOnceFindAfter){
+  StringPool pool;
+  StringPool::Id a=pool.intern("a");
+  StringPool::Id b=pool.intern(std::string("net_b"));
+  EXPECT_NE(a,b);
+  EXPECT_EQ(a,pool.intern("a"));
+  EXPECT_EQ(b,pool.find("net_b"));
+  EXPECT_EQ(StringPool::NoId,pool.find("net_c"));
+  EXPECT_EQ(StringPool::NoId,pool.find("net_"));
+  EXPECT_STREQ("net_b",pool.c_str(b));
+  EXPECT_EQ(5u,pool.length(b));
+  EXPECT_EQ("a",pool.str(a));
+  // an embedded NUL is part of the string
+  StringPool::Id z=pool.intern("x\0y",3);
+  EXPECT_NE(pool.find("x"),z);
+  EXPECT_EQ(3u,pool.length(z));
+  EXPECT_EQ(std::string("x\0y",3),pool.str(z));
+  EXPECT_EQ(3u,pool.size());
+}
+TEST(StringPool,GrowsKeepingIds){
+  StringPool pool;
+  std::vector<StringPool::Id> ids;
+  for(int i=0;i<5000;++i) ids.push_back(pool.intern("n"+std::to_string(i)));
+  EXPECT_EQ(5000u,pool.size());
+  for(int i=0;i<5000;++i){
+    EXPECT_EQ(ids[i],pool.find("n"+std::to_string(i)));
+    EXPECT_EQ("n"+std::to_string(i),pool.str(ids[i]));
+  }
+  pool.intern("");
+  EXPECT_EQ(0u,pool.length(pool.find("")));
+}
+TEST(StringPool,IdIndexFindsTheFirstIndex){
+  StringPool pool;
+  std::vector<StringPool::Id> names;
+  IdIndex byName;
+  for(int i=0;i<1000;++i){
+    names.push_back(pool.intern("g"+std::to_string(i%700))); // 300 repeats
+    byName.insert(names,names.size()-1);
+  }
+  for(int i=0;i<700;++i) EXPECT_EQ(static_cast<unsigned>(i),byName.find(names,pool.find("g"+std::to_string(i))));
+  StringPool::Id absent=pool.intern("absent");
+  EXPECT_EQ(IdIndex::None,byName.find(names,absent));
+  byName.clear();
+  EXPECT_EQ(IdIndex::None,byName.find(names,names[0]));
+}
@@ -0,0 +1,168 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "TruthTable.hpp"
+
+namespace{
+typedef std::vector<TruthTable::Cube> Cover;
+
+bool contains(const TruthTable::Cube& c,unsigned minterm){
+  return (minterm&c.care)==c.value;
+}
+bool covered(const Cover& cover,unsigned minterm){
+  for(size_t k=0;k<cover.size();++k) if(contains(cover[k],minterm)) return true;
+  return false;
+}
+/* Value of the cover for inputs ZERO, ONE or X : a cube is true when every
+   literal is, as the bit-parallel simulators evaluate it
+*/
+bool coverTrue(const Cover& cover,const std::vector<DLogic>& in){
+  for(size_t k=0;k<cover.size();++k){
+    bool bTrue=true;
+    for(unsigned i=0;i<in.size() && bTrue;++i){
+      if(0==(cover[k].care&(1u<<i))) continue;
+      bTrue=(0!=(cover[k].value&(1u<<i))) ? (DLogic::ONE==in[i]) : (DLogic::ZERO==in[i]);
+    }
+    if(bTrue) return true;
+  }
+  return false;
+}
+void checkCovers(const std::string& func,unsigned numIn){
+  TruthTable t;
+  ASSERT_TRUE(TruthTable::fromFunc(func,numIn,t)) << func << " " << numIn;
+  // on cover exactly the minterms at 1, off cover exactly those at 0
+  for(unsigned m=0;m<(1u<<numIn);++m){
+    EXPECT_EQ(t.output(m),covered(t.onCover(),m)) << func << " " << numIn << " minterm " << m;
+    EXPECT_EQ(!t.output(m),covered(t.offCover(),m)) << func << " " << numIn << " minterm " << m;
+  }
+  // and the covers give the same three valued output as evaluate
+  const DLogic Values[3]={DLogic::ZERO,DLogic::ONE,DLogic::X};
+  std::vector<unsigned> index(numIn,0);
+  std::vector<DLogic> in(numIn);
+  bool bMore=true;
+  while(bMore){
+    for(unsigned i=0;i<numIn;++i) in[i]=Values[index[i]];
+    DLogic expected=t.evaluate(&in[0]);
+    bool bOn=coverTrue(t.onCover(),in),bOff=coverTrue(t.offCover(),in);
+    EXPECT_FALSE(bOn && bOff) << func << " " << numIn;
+    DLogic fromCovers=bOn ? DLogic::ONE : (bOff ? DLogic::ZERO : DLogic::X);
+    EXPECT_EQ(expected,fromCovers) << func << " " << numIn;
+    bMore=false;
+    for(unsigned i=0;i<numIn && !bMore;++i){
+      if(++index[i]<3) bMore=true;
+      else index[i]=0;
+    }
+  }
+}
+}
+
+TEST(TruthTable,CoversOfAndOrXorMux){
+  for(unsigned numIn=2;numIn<=4;++numIn){
+    checkCovers("and",numIn);
+    checkCovers("or",numIn);
+    checkCovers("xor",numIn);
+  }
+  checkCovers("mux",3);
+}
+TEST(TruthTable,CoversArePrime){
+  TruthTable t;
+  ASSERT_TRUE(TruthTable::fromFunc("and",3,t));
+  EXPECT_EQ(1u,t.onCover().size());  // a&b&c
+  EXPECT_EQ(3u,t.offCover().size()); // !a, !b, !c
+  ASSERT_TRUE(TruthTable::fromFunc("or",3,t));
+  EXPECT_EQ(3u,t.onCover().size());
+  EXPECT_EQ(1u,t.offCover().size());
+  ASSERT_TRUE(TruthTable::fromFunc("xor",3,t));
+  EXPECT_EQ(4u,t.onCover().size());  // minterms, xor has no larger implicant
+  EXPECT_EQ(4u,t.offCover().size());
+  ASSERT_TRUE(TruthTable::fromFunc("mux",3,t));
+  EXPECT_EQ(3u,t.onCover().size());  // with the consensus a&b, so mux(ONE,ONE,X) is ONE
+  EXPECT_EQ(3u,t.offCover().size());
+  DLogic in[3]={DLogic::ONE,DLogic::ONE,DLogic::X};
+  EXPECT_EQ(DLogic::ONE,t.evaluate(in));
+}
+TEST(TruthTable,ControllingAndEnablingValues){
+  TruthTable t;
+  const char* Funcs[4]={"and","nand","or","nor"};
+  for(int f=0;f<4;++f){
+    ASSERT_TRUE(TruthTable::fromFunc(Funcs[f],3,t));
+    DLogic controlling=(f<2) ? DLogic::ZERO : DLogic::ONE;
+    for(unsigned pin=0;pin<3;++pin){
+      EXPECT_EQ(controlling,t.controllingValue(pin)) << Funcs[f] << " pin " << pin;
+      EXPECT_EQ(!controlling,t.enablingValue(pin)) << Funcs[f] << " pin " << pin;
+    }
+  }
+  ASSERT_TRUE(TruthTable::fromFunc("xor",2,t));
+  EXPECT_EQ(DLogic::X,t.controllingValue(0));
+  EXPECT_EQ(DLogic::ONE,t.enablingValue(0)); // a tie
+  ASSERT_TRUE(TruthTable::fromFunc("aoi21",3,t));
+  EXPECT_EQ(DLogic::X,t.controllingValue(0));   // a=0 leaves !c
+  EXPECT_EQ(DLogic::ONE,t.enablingValue(0));    // a=1 leaves !(b|c)
+  EXPECT_EQ(DLogic::ONE,t.controllingValue(2)); // c=1 is 0 whatever a and b
+  EXPECT_EQ(DLogic::ZERO,t.enablingValue(2));
+  ASSERT_TRUE(TruthTable::fromFunc("mux",3,t));
+  EXPECT_EQ(DLogic::X,t.controllingValue(2));
+}
+TEST(TruthTable,AndOrGroupNames){
+  TruthTable t;
+  ASSERT_TRUE(TruthTable::fromFunc("aoi21",3,t));
+  for(unsigned m=0;m<8;++m) EXPECT_EQ(!(((m&1) && (m&2)) || (m&4)),t.output(m)) << "aoi21 " << m;
+  ASSERT_TRUE(TruthTable::fromFunc("oai22",4,t));
+  for(unsigned m=0;m<16;++m) EXPECT_EQ(!(((m&1) || (m&2)) && ((m&4) || (m&8))),t.output(m)) << "oai22 " << m;
+  ASSERT_TRUE(TruthTable::fromFunc("ao211",4,t));
+  for(unsigned m=0;m<16;++m) EXPECT_EQ(((m&1) && (m&2)) || 0!=(m&4) || 0!=(m&8),t.output(m)) << "ao211 " << m;
+  ASSERT_TRUE(TruthTable::fromFunc("oa12",3,t));
+  for(unsigned m=0;m<8;++m) EXPECT_EQ((m&1) && ((m&2) || (m&4)),t.output(m)) << "oa12 " << m;
+  EXPECT_TRUE(TruthTable::isCell("aoi222"));
+  EXPECT_TRUE(TruthTable::isCell("oa33"));
+  EXPECT_FALSE(TruthTable::isCell("aoi2"));  // one group
+  EXPECT_FALSE(TruthTable::isCell("aoi7"));
+  EXPECT_FALSE(TruthTable::isCell("aoi43")); // more than MaxInputs
+  EXPECT_FALSE(TruthTable::isCell("ao"));
+  EXPECT_FALSE(TruthTable::isCell("and"));   // the primitives are no cells
+  EXPECT_FALSE(TruthTable::fromFunc("aoi21",4,t)); // the groups add up to 3
+  EXPECT_FALSE(TruthTable::fromFunc("oai2x",3,t));
+}
+TEST(TruthTable,Majority){
+  TruthTable t;
+  for(unsigned numIn=1;numIn<=5;numIn+=2){
+    ASSERT_TRUE(TruthTable::fromFunc("maj",numIn,t)) << numIn;
+    for(unsigned m=0;m<(1u<<numIn);++m){
+      EXPECT_EQ(2*static_cast<unsigned>(__builtin_popcount(m))>numIn,t.output(m)) << "maj " << numIn << " minterm " << m;
+    }
+  }
+  EXPECT_FALSE(TruthTable::fromFunc("maj",2,t));
+  EXPECT_FALSE(TruthTable::fromFunc("maj",4,t));
+  checkCovers("maj",3);
+  checkCovers("maj",5);
+}
+TEST(TruthTable,LutFromHex){
+  TruthTable t;
+  ASSERT_TRUE(TruthTable::fromFunc("lut_8",2,t));
+  TruthTable and2;
+  ASSERT_TRUE(TruthTable::fromFunc("and",2,and2));
+  EXPECT_TRUE(and2==t);
+  ASSERT_TRUE(TruthTable::fromFunc("lut_6",2,t));
+  TruthTable xor2;
+  ASSERT_TRUE(TruthTable::fromFunc("xor",2,xor2));
+  EXPECT_TRUE(xor2==t);
+  ASSERT_TRUE(TruthTable::fromFunc("lut_E8",3,t)); // majority of 3, either case
+  for(unsigned m=0;m<8;++m) EXPECT_EQ(2*static_cast<unsigned>(__builtin_popcount(m))>3,t.output(m)) << m;
+  ASSERT_TRUE(TruthTable::fromFunc("lut_8000000000000001",6,t));
+  EXPECT_TRUE(t.output(0));
+  EXPECT_TRUE(t.output(63));
+  EXPECT_FALSE(t.output(1));
+  // more minterms than the inputs have
+  EXPECT_FALSE(TruthTable::fromFunc("lut_1f",2,t));
+  EXPECT_FALSE(TruthTable::fromFunc("lut_100",3,t));
+  EXPECT_TRUE(TruthTable::fromFunc("lut_ff",3,t));
+  EXPECT_TRUE(TruthTable::isCell("lut_ff"));
+  EXPECT_FALSE(TruthTable::isCell("lut_"));
+  EXPECT_FALSE(TruthTable::isCell("lut_fg"));
+  EXPECT_FALSE(TruthTable::isCell("lut_10000000000000000")); // 17 digits
+}
@@ -0,0 +1,440 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "Aig.hpp"
+#include "FaultSim.hpp"
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <assert.h>
+using namespace std;
+
+const Aig::Node Aig::None;
+
+Aig::Aig() : _pN(0), _used(0), _numAnds(0), _numOpaque(0){
+  _kind.push_back(static_cast<unsigned char>(Constant)); // node 0, literal 0 is false
+  _fanin0.push_back(0);
+  _fanin1.push_back(0);
+}
+Aig::Literal Aig::addInput(GateId original){
+  Node v=static_cast<Node>(_kind.size());
+  _kind.push_back(static_cast<unsigned char>(Input));
+  _fanin0.push_back(original);
+  _fanin1.push_back(0);
+  return makeLiteral(v,false);
+}
+Aig::Literal Aig::addAnd(Literal a,Literal b){
+  if(a>b) swap(a,b);
+  if(a==b) return a;
+  return lookup(a,b);
+}
+void Aig::rehash(){
+  vector<unsigned> table(_table.empty() ? 1024 : 2*_table.size(),None);
+  size_t mask=table.size()-1;
+  for(size_t i=0;i<_table.size();++i){
+    if(None==_table[i]) continue;
+    Node v=_table[i];
+    size_t slot=hash(_fanin0[v],_fanin1[v])&mask;
+    while(None!=table[slot]) slot=(slot+1)&mask;
+    table[slot]=v;
+  }
+  _table.swap(table);
+}
+Aig::Literal Aig::lookup(Literal a,Literal b){
+/* The and node of a and b, made if there is none */
+  if(2*(_used+1)>_table.size()) rehash();
+  size_t mask=_table.size()-1;
+  size_t slot=hash(a,b)&mask;
+  for(;None!=_table[slot];slot=(slot+1)&mask){
+    Node v=_table[slot];
+    if(_fanin0[v]==a && _fanin1[v]==b) return makeLiteral(v,false);
+  }
+  Node v=static_cast<Node>(_kind.size());
+  _kind.push_back(static_cast<unsigned char>(And));
+  _fanin0.push_back(a);
+  _fanin1.push_back(b);
+  _table[slot]=v;
+  ++_used;
+  ++_numAnds;
+  return makeLiteral(v,false);
+}
+Aig::Literal Aig::tree(vector<Literal>& in,size_t begin,size_t end){
+  if(1==end-begin) return in[begin];
+  size_t mid=begin+(end-begin)/2;
+  Literal left=tree(in,begin,mid);
+  return addAnd(left,tree(in,mid,end));
+}
+Aig::Literal Aig::fold(Netlist::GateType type,vector<Literal>& in){
+  bool bOr=(Netlist::Or==type || Netlist::Nor==type);
+  bool bInvert=(Netlist::Nand==type || Netlist::Or==type);
+  if(bOr) for(size_t i=0;i<in.size();++i) in[i]^=1u;
+  sort(in.begin(),in.end());
+  in.erase(unique(in.begin(),in.end()),in.end());
+  Literal l=tree(in,0,in.size());
+  return bInvert ? (l^1u) : l;
+}
+Aig::Literal Aig::cell(const TruthTable& t,const GateId* fanin){
+  const vector<TruthTable::Cube>& cover=t.onCover();
+  vector<Literal> terms,literals;
+  for(size_t k=0;k<cover.size();++k){
+    literals.clear();
+    for(unsigned i=0;i<t.numInputs();++i){
+      if(0==(cover[k].care&(1u<<i))) continue;
+      literals.push_back(_net[fanin[i]]^((0!=(cover[k].value&(1u<<i))) ? 0u : 1u));
+    }
+    sort(literals.begin(),literals.end());
+    terms.push_back(tree(literals,0,literals.size()));
+  }
+  return fold(Netlist::Or,terms);
+}
+bool Aig::build(const Netlist& n){
+  if(!n.isLevelized()) return false;
+  _pN=&n;
+  _net.assign(n.size(),0);
+  const vector<GateId>& order=n.getOrder();
+  vector<Literal> in;
+  for(size_t i=0;i<order.size();++i){
+    GateId g=order[i];
+    Netlist::GateType type=n.getType(g);
+    unsigned numIn=n.numFanins(g);
+    if(Netlist::In==type){
+      _net[g]=addInput(g);
+      continue;
+    }
+    bool bOpaque=(0==numIn || Netlist::Unknown==type);
+    if(Netlist::Lut==type){
+      const vector<TruthTable::Cube>& cover=n.getTable(g).onCover();
+      bOpaque=cover.empty(); // constant 0
+      for(size_t k=0;k<cover.size();++k) if(0==cover[k].care) bOpaque=true; // constant 1
+    }
+    if(bOpaque){
+      Node v=static_cast<Node>(_kind.size());
+      _kind.push_back(static_cast<unsigned char>(Opaque));
+      _fanin0.push_back(g);
+      _fanin1.push_back(0);
+      _net[g]=makeLiteral(v,false);
+      ++_numOpaque;
+      continue;
+    }
+    const GateId* fanin=n.fanins(g);
+    switch(type){
+    case Netlist::Lut :
+      _net[g]=cell(n.getTable(g),fanin);
+      break;
+    case Netlist::And : case Netlist::Nand : case Netlist::Or : case Netlist::Nor :
+      in.clear();
+      for(unsigned k=0;k<numIn;++k) in.push_back(_net[fanin[k]]);
+      _net[g]=fold(type,in);
+      break;
+    case Netlist::Not :
+      _net[g]=_net[fanin[0]]^1u;
+      break;
+    default : // Buf, Out, Noop take their first fanin
+      _net[g]=_net[fanin[0]];
+      break;
+    }
+  }
+  return true;
+}
+void Aig::names(Node v,vector<GateId>& gates) const{
+  gates.clear();
+  for(GateId g=0;g<_net.size();++g) if(node(_net[g])==v) gates.push_back(g);
+}
+void Aig::firstNets(vector<GateId>& positive,vector<GateId>& negative) const{
+/* First internal net on each node and on its complement, PIs and POs
+   keep their own gates
+*/
+  positive.assign(size(),None);
+  negative.assign(size(),None);
+  for(GateId g=0;g<_net.size();++g){
+    Netlist::GateType type=_pN->getType(g);
+    if(Netlist::In==type || Netlist::Out==type) continue;
+    vector<GateId>& first=isComplement(_net[g]) ? negative : positive;
+    if(None==first[node(_net[g])]) first[node(_net[g])]=g;
+  }
+  for(Node v=0;v<size();++v) if(Input==getKind(v)) positive[v]=_fanin0[v];
+}
+string Aig::literalName(Literal l,const vector<GateId>& positive,const vector<GateId>& negative) const{
+  Node v=node(l);
+  const vector<GateId>& first=isComplement(l) ? negative : positive;
+  if(None!=first[v]) return _pN->getName(first[v]);
+  if(isComplement(l)) return literalName(l^1u,positive,negative)+"_n";
+  if(None!=negative[v]) return _pN->getName(negative[v])+"_n";
+  ostringstream name;
+  name << "aig" << v;
+  return name.str();
+}
+void Aig::references(vector<unsigned>& refs,vector<unsigned char>& polarity) const{
+  refs.assign(size(),0);
+  polarity.assign(size(),0);
+  struct Ref{
+    static void to(Literal l,vector<unsigned>& refs,vector<unsigned char>& polarity){
+      ++refs[node(l)];
+      polarity[node(l)]|=isComplement(l) ? 2 : 1;
+    }
+  };
+  const vector<GateId>& outputs=_pN->getOutputs();
+  for(size_t i=0;i<outputs.size();++i) Ref::to(_net[outputs[i]],refs,polarity);
+  for(Node v=static_cast<Node>(size());v-->0;){
+    if(0==refs[v]) continue;
+    if(And==getKind(v)){
+      Ref::to(_fanin0[v],refs,polarity);
+      Ref::to(_fanin1[v],refs,polarity);
+    }else if(Opaque==getKind(v)){
+      GateId g=_fanin0[v];
+      for(unsigned k=0;k<_pN->numFanins(g);++k) Ref::to(_net[_pN->fanins(g)[k]],refs,polarity);
+    }
+  }
+}
+bool Aig::absorbed(Node v,const vector<unsigned>& refs,const vector<unsigned char>& polarity,
+                   const vector<GateId>& positive,const vector<GateId>& negative) const{
+/* An and used once, uncomplemented, and no net of the netlist : it is
+   part of the wide gate of its fanout
+*/
+  return And==getKind(v) && 1==refs[v] && 1==polarity[v] && None==positive[v] && None==negative[v];
+}
+Aig::Literal Aig::primary(Node v,const vector<unsigned char>& polarity,
+                          const vector<GateId>& positive,const vector<GateId>& negative) const{
+/* The polarity of the gate write makes of an and : that of the nets of the
+   netlist on it, else the one its fanouts use. A fanout that takes the
+   other polarity can flip its own form instead of adding a not gate.
+*/
+  if(And!=getKind(v)) return makeLiteral(v,false);
+  if(None!=positive[v] || None!=negative[v]) return makeLiteral(v,None==positive[v]);
+  return makeLiteral(v,0==(polarity[v]&1));
+}
+string Aig::gateName(Literal l,const vector<GateId>* gate,const Netlist& out) const{
+/* The gate of l in the written netlist, - if it has none, ! and the gate
+   of the other polarity if only that one is made
+*/
+  GateId g=gate[isComplement(l) ? 1 : 0][node(l)];
+  if(None!=g) return out.getName(g);
+  g=gate[isComplement(l) ? 0 : 1][node(l)];
+  return (None!=g) ? "!"+out.getName(g) : string("-");
+}
+bool Aig::write(Netlist& out) const{
+  vector<GateId> gate[2];
+  return write(out,gate);
+}
+bool Aig::write(Netlist& out,vector<GateId>* gate) const{
+/* Nodes are made after their fanins, so node order is a topological
+   order; a not gate is added when first needed, after its input. An and
+   takes in the nodes it absorbs, so a tree of the AIG comes back as the
+   wide gate it was built from, an or, nand or nor if that saves the not
+   gates : the form is the one with more of its inputs already made.
+*/
+  if(0==_pN) return false;
+  vector<GateId> positive,negative;
+  firstNets(positive,negative);
+  vector<unsigned> refs;
+  vector<unsigned char> polarity;
+  references(refs,polarity);
+  if(0!=refs[0]){
+    cout << "Error! The and-inverter graph has a constant node\n";
+    return false;
+  }
+  gate[0].assign(size(),None);
+  gate[1].assign(size(),None);
+  struct Gates{
+    static GateId of(const Aig& aig,Literal l,vector<GateId>* gate,Netlist& out,const vector<GateId>& positive,const vector<GateId>& negative){
+      GateId& g=gate[isComplement(l) ? 1 : 0][node(l)];
+      if(None==g){
+        GateId other=gate[isComplement(l) ? 0 : 1][node(l)];
+        assert(None!=other);
+        g=out.addGate(aig.literalName(l,positive,negative),Netlist::Not);
+        out.addFanin(g,other);
+      }
+      return g;
+    }
+  };
+  const vector<GateId>& inputs=_pN->getInputs();
+  for(size_t i=0;i<inputs.size();++i){
+    gate[0][node(_net[inputs[i]])]=out.addGate(_pN->getNameId(inputs[i]),Netlist::In);
+  }
+  vector<Literal> leaves,stack;
+  for(Node v=1;v<size();++v){
+    if(0==refs[v] || Input==getKind(v)) continue;
+    if(And==getKind(v)){
+      if(absorbed(v,refs,polarity,positive,negative)) continue;
+      leaves.clear();
+      stack.assign(1,_fanin1[v]);
+      stack.push_back(_fanin0[v]);
+      while(!stack.empty()){
+        Literal l=stack.back();
+        stack.pop_back();
+        if(!isComplement(l) && absorbed(node(l),refs,polarity,positive,negative)){
+          stack.push_back(_fanin1[node(l)]);
+          stack.push_back(_fanin0[node(l)]);
+        }else{
+          leaves.push_back(l);
+        }
+      }
+      size_t numAndNots=0,numNorNots=0; // not gates each form needs, its inputs made so far
+      for(size_t k=0;k<leaves.size();++k){
+        if(None==gate[isComplement(leaves[k]) ? 1 : 0][node(leaves[k])]) ++numAndNots;
+        if(None==gate[isComplement(leaves[k]) ? 0 : 1][node(leaves[k])]) ++numNorNots;
+      }
+      bool bNor=numNorNots<numAndNots; // the and of complements
+      Literal l=primary(v,polarity,positive,negative);
+      Netlist::GateType type=bNor ? (isComplement(l) ? Netlist::Or : Netlist::Nor) : (isComplement(l) ? Netlist::Nand : Netlist::And);
+      vector<GateId> fanins;
+      for(size_t k=0;k<leaves.size();++k){
+        fanins.push_back(Gates::of(*this,bNor ? (leaves[k]^1u) : leaves[k],gate,out,positive,negative));
+      }
+      GateId g=out.addGate(literalName(l,positive,negative),type);
+      for(size_t k=0;k<fanins.size();++k) out.addFanin(g,fanins[k]);
+      gate[isComplement(l) ? 1 : 0][v]=g;
+    }else{ // a copy of the gate, over the gates of its fanins
+      GateId original=_fanin0[v];
+      vector<GateId> fanins;
+      for(unsigned k=0;k<_pN->numFanins(original);++k){
+        fanins.push_back(Gates::of(*this,_net[_pN->fanins(original)[k]],gate,out,positive,negative));
+      }
+      string name=literalName(makeLiteral(v,false),positive,negative);
+      GateId g=0;
+      Netlist::GateType type=_pN->getType(original);
+      if(Netlist::Lut==type){ // a constant cell, its table again by name
+        const TruthTable& t=_pN->getTable(original);
+        ostringstream func;
+        func << "lut_" << hex << ((t.numInputs()<TruthTable::MaxInputs) ? (t.bits()&((1ULL<<(1u<<t.numInputs()))-1)) : t.bits());
+        g=out.addGate(name,func.str());
+      }else{
+        g=out.addGate(name,(Netlist::Out==type) ? Netlist::Unknown : type); // the PO comes after
+      }
+      for(size_t k=0;k<fanins.size();++k) out.addFanin(g,fanins[k]);
+      gate[0][v]=g;
+    }
+  }
+  const vector<GateId>& outputs=_pN->getOutputs();
+  for(size_t i=0;i<outputs.size();++i){
+    GateId driver=Gates::of(*this,_net[outputs[i]],gate,out,positive,negative);
+    GateId g=out.addGate(_pN->getNameId(outputs[i]),Netlist::Out);
+    out.addFanin(g,driver);
+  }
+  return out.levelize();
+}
+bool Aig::consumer(GateId gate,Node leaf,Node& v,Literal& input) const{
+/* Walks the ands of gate down to the nodes of its fanins and counts the
+   edges from leaf. Only with exactly one is the branch a single edge.
+*/
+  vector<Node> leaves,stack,seen;
+  for(unsigned k=0;k<_pN->numFanins(gate);++k) leaves.push_back(node(_net[_pN->fanins(gate)[k]]));
+  unsigned numUses=0;
+  stack.push_back(node(_net[gate]));
+  while(!stack.empty()){
+    Node u=stack.back();
+    stack.pop_back();
+    if(And!=getKind(u) || find(seen.begin(),seen.end(),u)!=seen.end()) continue;
+    seen.push_back(u);
+    Literal in[2]={_fanin0[u],_fanin1[u]};
+    for(int i=0;i<2;++i){
+      if(leaf==node(in[i])){
+        ++numUses;
+        v=u;
+        input=in[i];
+      }else if(find(leaves.begin(),leaves.end(),node(in[i]))==leaves.end()){
+        stack.push_back(node(in[i]));
+      }
+    }
+  }
+  return 1==numUses;
+}
+Aig::NodeFault Aig::mapFault(GateId gate,unsigned pin,bool stuckAt) const{
+  bool bBranch=(pin<_pN->numFanins(gate));
+  Literal l=_net[bBranch ? _pN->fanins(gate)[pin] : gate];
+  NodeFault f={node(l),None,stuckAt!=isComplement(l),bBranch};
+  if(bBranch && node(_net[gate])!=node(l) && !consumer(gate,node(l),f.node,f.input)){
+    f.node=node(_net[gate]); // the cell, or the opaque copy of the gate
+    f.input=l;
+  }
+  return f;
+}
+size_t Aig::numFaultSites() const{
+  vector<FaultSim<FiveValued>::Fault> faults;
+  FaultSim<FiveValued>::checkpointFaults(*_pN,faults);
+  set<pair<pair<Node,Literal>,bool> > sites;
+  for(size_t i=0;i<faults.size();++i){
+    NodeFault f=mapFault(faults[i].gate,faults[i].pin,faults[i].stuckAt);
+    sites.insert(make_pair(make_pair(f.node,f.input),f.stuckAt));
+  }
+  return sites.size();
+}
+void Aig::writeMap(ostream& os) const{
+/* net <name> <gate of the written netlist>
+   fault <gate>/<pin or out> sa<v> [<gate of the written netlist>/]<gate of the written netlist> sa<v> [branch]
+   A branch fault on an input of a node names the written gate that takes
+   the input before it; one taken to its stem is flagged branch.
+*/
+  if(0==_pN) return;
+  vector<GateId> positive,negative;
+  firstNets(positive,negative);
+  vector<unsigned> refs;
+  vector<unsigned char> polarity;
+  references(refs,polarity);
+  vector<Node> owner(size()); // the node whose written gate an absorbed and is part of
+  for(Node v=0;v<size();++v) owner[v]=v;
+  for(Node v=static_cast<Node>(size());v-->0;){
+    if(And!=getKind(v)) continue;
+    Literal in[2]={_fanin0[v],_fanin1[v]};
+    for(int i=0;i<2;++i){
+      if(!isComplement(in[i]) && absorbed(node(in[i]),refs,polarity,positive,negative)) owner[node(in[i])]=owner[v];
+    }
+  }
+  Netlist out;
+  vector<GateId> gate[2];
+  if(!write(out,gate)) return;
+  os << "# aig " << numAnds() << " and nodes, " << numOpaque() << " opaque, from " << _pN->size() << " gates\n";
+  for(GateId g=0;g<_net.size();++g){
+    if(Netlist::Out==_pN->getType(g)) continue; // the PO keeps its name
+    os << "net " << _pN->getName(g) << " " << gateName(_net[g],gate,out) << "\n";
+  }
+  vector<FaultSim<FiveValued>::Fault> faults;
+  FaultSim<FiveValued>::checkpointFaults(*_pN,faults);
+  for(size_t i=0;i<faults.size();++i){
+    const FaultSim<FiveValued>::Fault& fault=faults[i];
+    NodeFault f=mapFault(fault.gate,fault.pin,fault.stuckAt);
+    Literal l=_net[f.bBranch ? _pN->fanins(fault.gate)[fault.pin] : fault.gate];
+    if(None==gate[isComplement(l) ? 1 : 0][node(l)]) l^=1u; // the stuck value through the polarity of the gate
+    os << "fault " << _pN->getName(fault.gate) << "/";
+    if(fault.pin<_pN->numFanins(fault.gate)) os << fault.pin;
+    else os << "out";
+    os << " sa" << (fault.stuckAt ? 1 : 0) << " ";
+    if(None!=f.input){
+      Literal o=makeLiteral(owner[f.node],None==gate[0][owner[f.node]]);
+      os << gateName(o,gate,out) << "/";
+    }
+    os << gateName(l,gate,out)
+       << " sa" << ((f.stuckAt!=isComplement(l)) ? 1 : 0) << ((f.bBranch && None==f.input) ? " branch" : "") << "\n";
+  }
+}
+bool Aig::hashNetlist(Netlist& n,const string& mapPath){
+  Aig aig;
+  Netlist hashed;
+  if(!aig.build(n) || !aig.write(hashed)){
+    cout << "Error! Cannot make the and-inverter graph, keeping the netlist\n";
+    return false;
+  }
+  vector<FaultSim<FiveValued>::Fault> before,after;
+  FaultSim<FiveValued>::checkpointFaults(n,before);
+  FaultSim<FiveValued>::checkpointFaults(hashed,after);
+  cout << "And-inverter graph " << aig.numAnds() << " and nodes, " << aig.numOpaque() << " opaque\n"
+       << "\tGates :\t" << n.size() << " -> " << hashed.size() << "\n"
+       << "\tDepth :\t" << n.getDepth() << " -> " << hashed.getDepth() << "\n"
+       << "\tCheckpoint faults :\t" << before.size() << " on " << aig.numFaultSites() << " node faults, "
+       << after.size() << " in the graph\n";
+  if(hashed.size()>=n.size()){
+    cout << "Warning! The and-inverter graph does not shrink the netlist, keeping it\n";
+    return true;
+  }
+  if(!mapPath.empty()){
+    ofstream os(mapPath.c_str());
+    aig.writeMap(os);
+    if(!os) cout << "Error! Cannot write " << mapPath << "\n";
+  }
+  n=hashed;
+  return true;
+}
@@ -0,0 +1,141 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __Aig__
+#define __Aig__
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include "Netlist.hpp"
+
+// ------------------------------------------------------------
+// class Aig
+// ------------------------------------------------------------
+class Aig{
+/* And-Inverter Graph of a levelized Netlist, structurally hashed.
+
+   A literal is 2*node+complement. Every gate becomes two input ands and
+   inverted edges : nand is the complement of the and, or and nor go
+   through De Morgan, a cell is the or of the and of the literals of each
+   cube of its on cover, buf, out and noop are their input. A wide gate is
+   a balanced tree over its fanin literals sorted by node, so the same set
+   of inputs gives the same tree whatever the order of the fanins.
+
+   addAnd keeps one node per pair of fanin literals, so two gates, or two
+   parts of wider gates, of the same function of the same nets end on the
+   same node, and so do their fanouts, level by level. Only a&a is
+   simplified; a&!a is kept, not folded to 0, so a three valued simulation
+   of the AIG gives the X of the netlist. Gates the AIG cannot express,
+   unknown functions and gates without fanins other than PIs, stay opaque :
+   a node that stands for a copy of the gate over the literals of its
+   fanins.
+
+   The mapping back :
+      literal(g)       the literal of the net of gate g of the netlist
+      names(node)      the nets of the netlist on node, either polarity
+      mapFault(...)    a checkpoint fault of the netlist as a stuck-at
+                       fault on a node, the stuck value through the
+                       polarity of the net. A fault on a fanout branch
+                       goes on the input literal of the and of the gate
+                       that takes the branch, or of the gate's own node
+                       when several ands of a cell take it. A branch into
+                       a gate that leaves no node of its own, a buf or a
+                       not, becomes the fault of its stem; merged nets
+                       share their faults.
+
+   write builds a Netlist back from the AIG, with the PIs and POs of the
+   original in the same order and under the same names, so pattern files
+   still apply. Logic that reaches no PO is left out. A node gets a gate
+   if it is on a net of the netlist, has more than one fanout or is used
+   complemented; the other ands merge into their fanout, so an and tree
+   comes back as one wide and, nand, or or nor, whichever needs fewer not
+   gates on its inputs. A gate is named after the first internal net of
+   the netlist on it, else after the first on its complement and _n,
+   else aig<node>, and _n for the complement. writeMap
+   lists every net and every checkpoint fault of the netlist with the
+   gate of the written netlist that carries it, - for a net left out, !
+   before the gate for a net only there as its complement.
+
+   hashNetlist does all of it for the driver : the netlist is replaced by
+   the written one, with a summary, and the map written if a path is given.
+   The not gates write adds can outweigh the merged logic; a written
+   netlist no smaller than the original is dropped, with a warning, and
+   the original kept.
+
+   Usage :
+      Aig aig;
+      aig.build(netlist);
+      Netlist hashed;
+      aig.write(hashed);
+      Aig::Literal z=aig.literal(netlist.findGate("z"));
+   NB - compiler defaults of destructor, copy constructor, operator= sufficient.
+        The netlist given to build must outlive the Aig.
+ */
+public:
+  typedef unsigned Literal;
+  typedef unsigned Node;
+  typedef Netlist::GateId GateId;
+  static const Node None=~0u;
+  enum Kind{Constant,Input,And,Opaque};
+  struct NodeFault{
+    Node node;
+    Literal input; // the fanin of node a branch fault is on, None for the output of node
+    bool stuckAt;  // of node(input) for a branch, else of node
+    bool bBranch;
+  };
+
+  Aig();
+  bool build(const Netlist& n); // false if n is not levelized
+  bool write(Netlist& out) const;
+  void writeMap(std::ostream& os) const;
+
+  static Node node(Literal l){ return l>>1; }
+  static bool isComplement(Literal l){ return 0!=(l&1u); }
+  static Literal makeLiteral(Node v,bool bComplement){ return (v<<1)|(bComplement ? 1u : 0u); }
+
+  Literal addInput(GateId original);
+  Literal addAnd(Literal a,Literal b);
+  Literal addOr(Literal a,Literal b){ return addAnd(a^1u,b^1u)^1u; }
+
+  std::size_t size() const { return _kind.size(); }          // nodes, the constant included
+  std::size_t numAnds() const { return _numAnds; }
+  std::size_t numOpaque() const { return _numOpaque; }
+  Kind getKind(Node v) const { return static_cast<Kind>(_kind[v]); }
+  Literal fanin0(Node v) const { return _fanin0[v]; }
+  Literal fanin1(Node v) const { return _fanin1[v]; }
+  Literal literal(GateId g) const { return _net[g]; }
+  void names(Node v,std::vector<GateId>& gates) const;       // nets of the netlist on v
+  NodeFault mapFault(GateId gate,unsigned pin,bool stuckAt) const; // pin ~0u for the output, as FaultSim::Stem
+  std::size_t numFaultSites() const;                         // distinct node faults of the checkpoint faults
+  static bool hashNetlist(Netlist& n,const std::string& mapPath); // no map if mapPath is empty
+private:
+  void firstNets(std::vector<GateId>& positive,std::vector<GateId>& negative) const;
+  bool consumer(GateId gate,Node leaf,Node& v,Literal& input) const; // the one and of gate that takes leaf
+  std::string literalName(Literal l,const std::vector<GateId>& positive,const std::vector<GateId>& negative) const;
+  void references(std::vector<unsigned>& refs,std::vector<unsigned char>& polarity) const; // fanouts from the POs, bit 0 node, bit 1 complement
+  bool absorbed(Node v,const std::vector<unsigned>& refs,const std::vector<unsigned char>& polarity,
+                const std::vector<GateId>& positive,const std::vector<GateId>& negative) const;
+  Literal primary(Node v,const std::vector<unsigned char>& polarity,
+                  const std::vector<GateId>& positive,const std::vector<GateId>& negative) const; // the polarity write makes a gate of
+  bool write(Netlist& out,std::vector<GateId>* gate) const; // gate[0] and gate[1], the gates of each node and its complement
+  std::string gateName(Literal l,const std::vector<GateId>* gate,const Netlist& out) const;
+  Literal lookup(Literal a,Literal b);
+  void rehash();
+  Literal fold(Netlist::GateType type,std::vector<Literal>& in);
+  Literal tree(std::vector<Literal>& in,std::size_t begin,std::size_t end);
+  Literal cell(const TruthTable& t,const GateId* fanin);
+  static std::size_t hash(Literal a,Literal b){ return (static_cast<std::size_t>(a)*0x9E3779B1u)^(static_cast<std::size_t>(b)*0x85EBCA77u); }
+
+  const Netlist* _pN;
+  std::vector<unsigned char> _kind;
+  std::vector<Literal> _fanin0; // the gate for Input and Opaque
+  std::vector<Literal> _fanin1;
+  std::vector<Literal> _net;    // per gate of the netlist
+  std::vector<unsigned> _table; // strash, node indices, power of two slots, None is empty
+  std::size_t _used;
+  std::size_t _numAnds;
+  std::size_t _numOpaque;
+};
+#endif // __Aig__
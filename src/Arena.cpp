@@ -0,0 +1,47 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "Arena.hpp"
+#include <new>
+using namespace std;
+
+Arena::Arena(size_t chunkBytes) : _current(0), _next(0), _end(0), _chunkBytes(chunkBytes), _used(0) {
+}
+Arena::~Arena(){
+  for(size_t i=0;i<_chunks.size();++i) ::operator delete(_chunks[i].data);
+}
+void Arena::reset(){
+  _current=0;
+  _next=_chunks.empty() ? 0 : _chunks[0].data;
+  _end=_chunks.empty() ? 0 : _chunks[0].data+_chunks[0].size;
+  _used=0;
+}
+void* Arena::nextChunk(size_t bytes,size_t align){
+/* Moves on to the next kept chunk that can hold the request, or adds one.
+   Kept chunks too small for it are skipped for the rest of this fault.
+*/
+  size_t need=bytes+align;
+  size_t next=_chunks.empty() ? 0 : _current+1;
+  while(next<_chunks.size() && _chunks[next].size<need) ++next;
+  if(next>=_chunks.size()){
+    Chunk c;
+    c.size=(need>_chunkBytes) ? need : _chunkBytes;
+    c.data=static_cast<char*>(::operator new(c.size));
+    _chunks.push_back(c);
+    next=_chunks.size()-1;
+  }
+  _current=next;
+  _next=_chunks[next].data;
+  _end=_next+_chunks[next].size;
+  return allocate(bytes,align);
+}
+size_t Arena::capacity() const{
+  size_t bytes=0;
+  for(size_t i=0;i<_chunks.size();++i) bytes+=_chunks[i].size;
+  return bytes;
+}
+size_t Arena::used() const{
+  return _used;
+}
@@ -0,0 +1,195 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __Arena__
+#define __Arena__
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+// ------------------------------------------------------------
+// class Arena
+// ------------------------------------------------------------
+class Arena{
+/* Monotonic arena for the transient state of one ATPG worker.
+
+   allocate() bumps a pointer through a list of chunks and there is no
+   free. reset() rewinds to the first chunk and keeps every chunk, so once
+   the first fault has sized the arena the following faults allocate
+   nothing from the heap. A request larger than the chunk size gets a
+   chunk of its own, which is kept as well.
+
+   Usage :
+      Arena a;
+      a.reset();                         // between faults
+      T* p=a.allocateArray<T>(n);        // no destructors are run
+   NB - one worker only, not copyable. Memory is only good until reset()
+ */
+public:
+  explicit Arena(std::size_t chunkBytes=64*1024);
+  ~Arena();
+  void* allocate(std::size_t bytes,std::size_t align);
+  template<class T> T* allocateArray(std::size_t n){
+    return static_cast<T*>(allocate(n*sizeof(T),alignof(T)));
+  }
+  void reset();
+  std::size_t capacity() const; // bytes held in chunks
+  std::size_t used() const;     // bytes handed out since reset()
+private:
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+  struct Chunk{
+    char* data;
+    std::size_t size;
+  };
+  void* nextChunk(std::size_t bytes,std::size_t align);
+  std::vector<Chunk> _chunks;
+  std::size_t _current; // index of the chunk being filled
+  char* _next;
+  char* _end;
+  std::size_t _chunkBytes;
+  std::size_t _used;
+};
+inline void* Arena::allocate(std::size_t bytes,std::size_t align){
+  std::size_t misalign=reinterpret_cast<std::size_t>(_next)&(align-1);
+  char* p=_next+((0==misalign) ? 0 : align-misalign);
+  if(0!=_next && p+bytes<=_end){
+    _next=p+bytes;
+    _used+=bytes;
+    return p;
+  }
+  return nextChunk(bytes,align);
+}
+
+// ------------------------------------------------------------
+// class FixedQueue
+// ------------------------------------------------------------
+template<class T>
+class FixedQueue{
+/* FIFO in a ring buffer taken from an Arena, the pooled replacement of
+   std::deque for the D-frontier and the propagation container.
+
+   reserve(arena,n) hands it n slots, enough for the worst case the caller
+   can bound ( the D-frontier never holds a vertex twice, so num_vertices
+   ). If a push finds the ring full it moves to a ring twice the size,
+   from the same arena. Iterators run from front to back, so std::find
+   works as on the deque. T must be a plain value, no destructor is run.
+
+   Usage :
+      FixedQueue<Vertex> q;
+      q.reserve(arena,num_vertices(g));   // after every arena.reset()
+      q.push_back(v); ... q.front(); q.pop_front();
+ */
+public:
+  class iterator{
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef T& reference;
+    iterator(const FixedQueue* q,std::size_t i) : _q(q), _i(i) {}
+    T& operator*() const { return _q->_data[(_q->_head+_i)&_q->_mask]; }
+    T* operator->() const { return &**this; }
+    iterator& operator++(){ ++_i; return *this; }
+    iterator operator++(int){ iterator r(*this); ++_i; return r; }
+    bool operator==(const iterator& rhs) const { return _i==rhs._i; }
+    bool operator!=(const iterator& rhs) const { return _i!=rhs._i; }
+  private:
+    const FixedQueue* _q;
+    std::size_t _i; // distance from the front
+  };
+  FixedQueue() : _pArena(0), _data(0), _mask(0), _head(0), _size(0) {}
+  void reserve(Arena& arena,std::size_t n){
+    std::size_t capacity=16;
+    while(capacity<n) capacity*=2; // power of two, so wrapping is a mask
+    _pArena=&arena;
+    _data=arena.allocateArray<T>(capacity);
+    _mask=capacity-1;
+    _head=_size=0;
+  }
+  bool empty() const { return 0==_size; }
+  std::size_t size() const { return _size; }
+  void clear(){ _head=_size=0; }
+  T& front(){ return _data[_head]; }
+  void push_back(const T& v){
+    if(_size>_mask) grow();
+    _data[(_head+_size)&_mask]=v;
+    ++_size;
+  }
+  void pop_front(){
+    _head=(_head+1)&_mask;
+    --_size;
+  }
+  iterator begin() const { return iterator(this,0); }
+  iterator end() const { return iterator(this,_size); }
+private:
+  void grow(){
+    T* data=_pArena->allocateArray<T>(2*(_mask+1));
+    for(std::size_t i=0;i<_size;++i) data[i]=_data[(_head+i)&_mask];
+    _data=data;
+    _mask=2*(_mask+1)-1;
+    _head=0;
+  }
+  Arena* _pArena;
+  T* _data;
+  std::size_t _mask;
+  std::size_t _head;
+  std::size_t _size;
+};
+
+// ------------------------------------------------------------
+// class FixedSet
+// ------------------------------------------------------------
+template<class T>
+class FixedSet{
+/* Ordered set in a sorted array taken from an Arena, the pooled
+   replacement of std::set for the PI decisions of a backtrace.
+
+   Same ordering and uniqueness as std::set, operator< decides both, and
+   insert() keeps the element already there. Lookup is a binary search and
+   insert shifts the tail, fine for the tens of PIs of one backtrace cone.
+   Grows like FixedQueue when full, T must be a plain value as well.
+ */
+public:
+  typedef const T* iterator;
+  typedef const T* const_iterator;
+  FixedSet() : _pArena(0), _data(0), _capacity(0), _size(0) {}
+  void reserve(Arena& arena,std::size_t n){
+    _pArena=&arena;
+    _capacity=(n<16) ? 16 : n;
+    _data=arena.allocateArray<T>(_capacity);
+    _size=0;
+  }
+  bool empty() const { return 0==_size; }
+  std::size_t size() const { return _size; }
+  void clear(){ _size=0; }
+  std::pair<iterator,bool> insert(const T& v){
+    T* at=std::lower_bound(_data,_data+_size,v);
+    if(at!=_data+_size && !(v<*at)) return std::make_pair(static_cast<iterator>(at),false);
+    if(_size==_capacity){
+      std::size_t offset=at-_data;
+      T* data=_pArena->allocateArray<T>(2*_capacity);
+      std::copy(_data,_data+_size,data);
+      _data=data;
+      _capacity*=2;
+      at=_data+offset;
+    }
+    std::copy_backward(at,_data+_size,_data+_size+1);
+    *at=v;
+    ++_size;
+    return std::make_pair(static_cast<iterator>(at),true);
+  }
+  iterator begin() const { return _data; }
+  iterator end() const { return _data+_size; }
+private:
+  Arena* _pArena;
+  T* _data;
+  std::size_t _capacity;
+  std::size_t _size;
+};
+#endif // __Arena__
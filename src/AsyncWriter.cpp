@@ -0,0 +1,64 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "AsyncWriter.hpp"
+using namespace std;
+
+AsyncWriter::AsyncWriter(const string& path,size_t bufferSize,bool binary) :
+  _path(path), _bufferSize(bufferSize), _backFull(false), _closing(false), _good(false)
+{
+  _file.open(path.c_str(),binary ? (ios::out|ios::binary) : ios::out);
+  _good=_file.good();
+  _front.reserve(_bufferSize);
+  _back.reserve(_bufferSize);
+  _thread=thread(&AsyncWriter::run,this);
+}
+AsyncWriter::~AsyncWriter(){
+  close();
+}
+void AsyncWriter::write(const char* p,size_t n){
+  _front.append(p,n);
+  if(_front.size()>=_bufferSize) swapBuffers();
+}
+void AsyncWriter::flush(){
+  if(!_front.empty()) swapBuffers();
+}
+void AsyncWriter::swapBuffers(){
+  /* Only blocks if the writer thread is still busy with the previous buffer */
+  unique_lock<mutex> lock(_mutex);
+  while(_backFull) _cv.wait(lock);
+  _front.swap(_back);
+  _front.clear();
+  _backFull=true;
+  _cv.notify_all();
+}
+void AsyncWriter::close(){
+  if(!_thread.joinable()) return;
+  flush();
+  {
+    unique_lock<mutex> lock(_mutex);
+    _closing=true;
+    _cv.notify_all();
+  }
+  _thread.join();
+  _file.close();
+}
+void AsyncWriter::run(){
+  unique_lock<mutex> lock(_mutex);
+  for(;;){
+    while(!_backFull && !_closing) _cv.wait(lock);
+    if(_backFull){
+      lock.unlock(); // disk write happens outside the lock
+      _file.write(_back.data(),_back.size());
+      lock.lock();
+      if(!_file.good()) _good=false;
+      _back.clear();
+      _backFull=false;
+      _cv.notify_all();
+    }else if(_closing){
+      break;
+    }
+  }
+}
@@ -0,0 +1,61 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __AsyncWriter__
+#define __AsyncWriter__
+#include <string>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+// ------------------------------------------------------------
+// class AsyncWriter
+// ------------------------------------------------------------
+class AsyncWriter{
+/* Double buffered file writer.
+   The caller appends into the front buffer. When the front buffer reaches
+   its high water mark, it is swapped with the back buffer and a background
+   thread writes the back buffer to disk. The caller only waits if the back
+   buffer has not been written out by the time the front buffer fills again.
+
+   Usage :
+      AsyncWriter w("out.pat");
+      w.write("1 0 X\n");
+      ...
+      w.close(); // or let the destructor do it
+
+   NB - not copyable. The destructor flushes and joins the writer thread.
+ */
+public:
+  AsyncWriter(const std::string& path,std::size_t bufferSize=1<<20,bool binary=false);
+  ~AsyncWriter();
+  bool good() const { return _good; }
+  void write(const char* p,std::size_t n);
+  void write(const std::string& s){ write(s.data(),s.size()); }
+  void flush();  // hand the front buffer to the writer thread, do not wait
+  void close();  // flush, wait for the writer thread and close the file
+  const std::string& getPath() const { return _path; }
+private:
+  AsyncWriter();
+  AsyncWriter(const AsyncWriter&);
+  AsyncWriter& operator=(const AsyncWriter&);
+  void swapBuffers();
+  void run();
+
+  std::string _path;
+  std::ofstream _file;
+  std::size_t _bufferSize;
+  std::string _front;     // owned by the caller
+  std::string _back;      // owned by the writer thread while _backFull
+  bool _backFull;
+  bool _closing;
+  std::atomic<bool> _good;
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::thread _thread;
+};
+#endif // __AsyncWriter__
@@ -0,0 +1,95 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "Bench.hpp"
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <math.h>
+using namespace std;
+
+void Bench::reduce(Result& r){
+  if(r.samples.empty()){
+    r.minNs=r.medianNs=r.meanNs=r.stddevNs=0;
+    return;
+  }
+  vector<double> sorted(r.samples);
+  sort(sorted.begin(),sorted.end());
+  size_t n=sorted.size();
+  r.minNs=sorted.front();
+  r.medianNs=(0==n%2) ? (sorted[n/2-1]+sorted[n/2])/2 : sorted[n/2];
+  double sum=0;
+  for(size_t i=0;i<n;++i) sum+=sorted[i];
+  r.meanNs=sum/static_cast<double>(n);
+  double squares=0;
+  for(size_t i=0;i<n;++i) squares+=(sorted[i]-r.meanNs)*(sorted[i]-r.meanNs);
+  r.stddevNs=(n>1) ? sqrt(squares/static_cast<double>(n-1)) : 0;
+}
+bool Bench::setCounters(bool bEnable){
+  _bCounters=bEnable;
+  if(!bEnable){
+    _counters.close();
+    return true;
+  }
+  if(!_counters.isOpen() && !_counters.open()) _bCounters=false;
+  return _bCounters;
+}
+void Bench::print(ostream& os) const{
+  size_t width=10;
+  for(size_t i=0;i<_results.size();++i) width=max(width,_results[i].name.size());
+  os << "\n" << left << setw(static_cast<int>(width)) << "benchmark" << right
+     << setw(12) << "min ns/op" << setw(12) << "median" << setw(12) << "mean"
+     << setw(10) << "stddev" << setw(6) << "reps" << "\n";
+  os << fixed;
+  for(size_t i=0;i<_results.size();++i){
+    const Result& r=_results[i];
+    int precision=(r.medianNs<100) ? 2 : 1;
+    os << left << setw(static_cast<int>(width)) << r.name << right << setprecision(precision)
+       << setw(12) << r.minNs << setw(12) << r.medianNs << setw(12) << r.meanNs
+       << setw(9) << ((0==r.meanNs) ? 0.0 : 100*r.stddevNs/r.meanNs) << "%"
+       << setw(6) << r.samples.size() << "\n";
+  }
+  bool bCounters=false;
+  for(size_t i=0;i<_results.size();++i) bCounters=bCounters || (0!=_results[i].eventMask);
+  if(bCounters){
+    os << "\n" << left << setw(static_cast<int>(width)) << "per op" << right
+       << setw(12) << "cycles" << setw(12) << "instr" << setw(8) << "IPC"
+       << setw(12) << "L1D miss" << setw(12) << "LLC miss" << setw(12) << "br miss" << "\n";
+    for(size_t i=0;i<_results.size();++i){
+      const Result& r=_results[i];
+      os << left << setw(static_cast<int>(width)) << r.name << right << setprecision(2);
+      for(unsigned e=0;e<PerfCounters::NumEvents;++e){
+        if(PerfCounters::L1DMisses==e){
+          bool bIPC=0!=(r.eventMask&(1u<<PerfCounters::Cycles)) && 0!=(r.eventMask&(1u<<PerfCounters::Instructions)) && r.eventsPerOp[PerfCounters::Cycles]>0;
+          if(bIPC) os << setw(8) << r.eventsPerOp[PerfCounters::Instructions]/r.eventsPerOp[PerfCounters::Cycles];
+          else os << setw(8) << "-";
+        }
+        if(0!=(r.eventMask&(1u<<e))) os << setw(12) << r.eventsPerOp[e];
+        else os << setw(12) << "-";
+      }
+      os << "\n";
+    }
+  }
+  os.unsetf(ios::fixed);
+}
+bool Bench::writeCsv(const string& path) const{
+  ofstream os(path.c_str());
+  if(!os.good()) return false;
+  os << "benchmark,loops,ops_per_call,min_ns,median_ns,mean_ns,stddev_ns,repetitions";
+  for(unsigned e=0;e<PerfCounters::NumEvents;++e) os << "," << PerfCounters::eventName(static_cast<PerfCounters::Event>(e)) << "_per_op";
+  os << "\n";
+  os << setprecision(6);
+  for(size_t i=0;i<_results.size();++i){
+    const Result& r=_results[i];
+    os << "\"" << r.name << "\"," << r.loops << "," << r.opsPerCall << "," << r.minNs << ","
+       << r.medianNs << "," << r.meanNs << "," << r.stddevNs << "," << r.samples.size();
+    for(unsigned e=0;e<PerfCounters::NumEvents;++e){
+      os << ",";
+      if(0!=(r.eventMask&(1u<<e))) os << r.eventsPerOp[e]; // empty when not counted
+    }
+    os << "\n";
+  }
+  return os.good();
+}
@@ -0,0 +1,117 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __Bench__
+#define __Bench__
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include "PerfCounters.hpp"
+
+// ------------------------------------------------------------
+// class Bench
+// ------------------------------------------------------------
+class Bench{
+/* Repetition based micro-benchmark runner, used by atpgbench.
+
+   run(name,body,opsPerCall) first calibrates a loop count so that one
+   repetition of body() takes at least minMs, then times that many
+   repetitions. Each repetition gives a ns/op sample,
+      elapsed / ( loops * opsPerCall )
+   and the samples are reduced to min, median, mean and standard deviation.
+   Compare runs on the median, the min is the best case the code can reach.
+
+   With setCounters(true) the PerfCounters events of all repetitions are
+   divided by the total number of ops as well, giving cycles, instructions,
+   IPC and misses per op. If the counters cannot be opened only times are
+   reported.
+
+   body() must hand its result to keep() so the optimizer cannot drop it.
+   Benchmarks whose name does not contain the filter string are skipped.
+
+   Usage :
+      Bench b(15,20.0);
+      b.run("DLogic and",[&]{ ... Bench::keep(r); },1024);
+      b.print();
+ */
+public:
+  struct Result{
+    std::string name;
+    unsigned long long loops;   // body() calls per repetition
+    unsigned long long opsPerCall;
+    std::vector<double> samples; // ns/op, one per repetition
+    double minNs;
+    double medianNs;
+    double meanNs;
+    double stddevNs;
+    unsigned eventMask; // PerfCounters events counted, 0 without counters
+    double eventsPerOp[PerfCounters::NumEvents];
+  };
+  Bench(unsigned repetitions=15,double minMs=20.0) : _repetitions(repetitions), _minMs(minMs), _bCounters(false) {}
+  bool setCounters(bool bEnable); // false if the counters cannot be opened
+  const std::string& countersError() const { return _counters.error(); }
+  void setFilter(const std::string& filter){ _filter=filter; }
+  bool selected(const std::string& name) const { return std::string::npos!=name.find(_filter); }
+
+  template<class Body> void run(const std::string& name,Body body,unsigned long long opsPerCall=1);
+
+  const std::vector<Result>& results() const { return _results; }
+  void print(std::ostream& os=std::cout) const;
+  bool writeCsv(const std::string& path) const;
+
+  template<class T> static void keep(const T& value){
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink=&value;
+#endif
+  }
+  static void reduce(Result& r); // fills min, median, mean and stddev from samples
+private:
+  template<class Body> static double time(Body& body,unsigned long long loops){
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    for(unsigned long long i=0;i<loops;++i) body();
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count());
+  }
+  unsigned _repetitions;
+  double _minMs;
+  bool _bCounters;
+  PerfCounters _counters;
+  std::string _filter;
+  std::vector<Result> _results;
+};
+template<class Body>
+void Bench::run(const std::string& name,Body body,unsigned long long opsPerCall){
+  if(!selected(name)) return;
+  // calibrate, also warms caches and branch predictors
+  unsigned long long loops=1;
+  double ns=time(body,loops);
+  while(ns<_minMs*1e6){
+    unsigned long long next=(ns<1.0) ? loops*16 : static_cast<unsigned long long>(static_cast<double>(loops)*_minMs*1.2e6/ns);
+    loops=(next>loops*16) ? loops*16 : ((next>loops) ? next : loops+1);
+    ns=time(body,loops);
+  }
+  Result r;
+  r.name=name;
+  r.loops=loops;
+  r.opsPerCall=opsPerCall;
+  PerfCounters::Sample before,after;
+  bool bCounted=_bCounters && _counters.read(before);
+  for(unsigned i=0;i<_repetitions;++i){
+    r.samples.push_back(time(body,loops)/static_cast<double>(loops*opsPerCall));
+  }
+  bCounted=bCounted && _counters.read(after);
+  r.eventMask=bCounted ? _counters.supportedMask() : 0;
+  for(unsigned e=0;e<PerfCounters::NumEvents;++e){
+    double ops=static_cast<double>(_repetitions)*static_cast<double>(loops*opsPerCall);
+    r.eventsPerOp[e]=(bCounted && after.value[e]>before.value[e] && ops>0) ? static_cast<double>(after.value[e]-before.value[e])/ops : 0.0;
+  }
+  reduce(r);
+  _results.push_back(r);
+  std::cout << "." << std::flush;
+}
+#endif // __Bench__
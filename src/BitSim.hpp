@@ -0,0 +1,217 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __BitSim__
+#define __BitSim__
+#include <vector>
+#include "Netlist.hpp"
+#include "GateKernels.hpp"
+
+// ------------------------------------------------------------
+// class BitSim
+// ------------------------------------------------------------
+template<unsigned Width>
+class BitSim{
+/* Bit-parallel, three valued good machine simulator over a levelized Netlist.
+   Width patterns ( 64, 256 or 512 ) are simulated at once, one bit per pattern.
+
+   Every net holds two planes of Width bits, using dual rail encoding :
+      hi  lo
+       1   0   ONE
+       0   1   ZERO
+       0   0   X
+   so that AND is (a.hi&b.hi, a.lo|b.lo), OR is (a.hi|b.hi, a.lo&b.lo)
+   and NOT swaps the planes. Gate loops run over a fixed number of words,
+   which the compiler can unroll and vectorize.
+
+   simulate walks the groups of Netlist::getSchedule. A group of and, nand,
+   or, nor with 1 to 4 fanins, or of buf, not, out with one, runs
+   evaluateGroup<Type,Arity>, where the fanin loop is unrolled and the
+   plane operations and the inversion are fixed at compile time, so the
+   gate loop has no branch. Other groups go gate by gate through
+   evaluateGate, and cells through evaluateCell : hi is the or of the
+   on cubes of the table, each the and of hi of the inputs it wants at 1
+   and lo of those it wants at 0, lo the same over the off cubes.
+
+   setCompiled replaces all of that by the levels function of a
+   CompiledSim loaded for the same netlist and number of words.
+
+   Usage :
+      BitSim<256> sim(netlist);
+      sim.setInput(i,hi,lo);   // for each PI, Words words per plane
+      sim.simulate();
+      sim.getHi(netlist.getOutputs()[0]);
+   NB - compiler defaults of destructor, copy constructor sufficient
+ */
+public:
+  enum{Words=Width/64};
+  typedef unsigned long long Word;
+  typedef Netlist::GateId GateId;
+
+  typedef void (*CompiledLevels)(Word* hi,Word* lo,unsigned first,unsigned last); // CompiledSim::LevelsFunction
+
+  BitSim(const Netlist& n) : _n(n), _hi(n.size()*Words,0ULL), _lo(n.size()*Words,0ULL), _compiled(0) {}
+  bool good() const { return true; }
+  void setInput(std::size_t piIndex,const Word* hi,const Word* lo){
+    GateId g=_n.getInputs()[piIndex];
+    for(unsigned w=0;w<Words;++w){ _hi[g*Words+w]=hi[w]; _lo[g*Words+w]=lo[w]; }
+  }
+  void setCompiled(CompiledLevels f){ _compiled=f; } // 0 for the interpreter
+  void simulate(){
+    if(0!=_compiled){
+      _compiled(&_hi[0],&_lo[0],0,_n.getDepth()+1);
+      return;
+    }
+    const std::vector<Netlist::GateGroup>& groups=_n.getGroups();
+    const GateId* schedule=_n.getSchedule().data();
+    for(std::size_t i=0;i<groups.size();++i){
+      const Netlist::GateGroup& group=groups[i];
+      GroupKernel kernel=groupKernel(group.type,group.arity);
+      if(0!=kernel){
+        kernel(_n,schedule+group.begin,schedule+group.end,&_hi[0],&_lo[0]);
+      }else{
+        for(unsigned k=group.begin;k<group.end;++k) evaluate(schedule[k]);
+      }
+    }
+  }
+  void evaluate(GateId g){
+    if(Netlist::Lut==_n.getType(g)) evaluateCell(_n.getTable(g),_n.fanins(g),&_hi[0],&_lo[0],g);
+    else evaluateGate(_n.getType(g),_n.numFanins(g),_n.fanins(g),&_hi[0],&_lo[0],g);
+  }
+  static void evaluateGate(Netlist::GateType type,unsigned numIn,const GateId* in,Word* hiBase,Word* loBase,GateId g);
+  static void evaluateCell(const TruthTable& t,const GateId* in,Word* hiBase,Word* loBase,GateId g);
+  typedef void (*GroupKernel)(const Netlist& n,const GateId* first,const GateId* last,Word* hiBase,Word* loBase);
+  template<Netlist::GateType Type,unsigned Arity>
+  static void evaluateGroup(const Netlist& n,const GateId* first,const GateId* last,Word* hiBase,Word* loBase);
+  static GroupKernel groupKernel(Netlist::GateType type,unsigned arity); // 0 if none
+  const Word* getHi(GateId g) const { return &_hi[g*Words]; }
+  const Word* getLo(GateId g) const { return &_lo[g*Words]; }
+  const Netlist& getNetlist() const { return _n; }
+private:
+  BitSim();
+  BitSim& operator=(const BitSim&);
+  template<Netlist::GateType Type,unsigned Arity> struct Fold;
+  const Netlist& _n;
+  std::vector<Word> _hi;
+  std::vector<Word> _lo;
+  CompiledLevels _compiled;
+};
+
+template<unsigned Width>
+void BitSim<Width>::evaluateGate(Netlist::GateType type,unsigned numIn,const GateId* in,Word* hiBase,Word* loBase,GateId g){
+/* Evaluates gate g from its fanins. hiBase/loBase are the planes of net 0,
+   net k starts Words words further on. Shared with the mapped simulator,
+   which has no tables, so a cell is X here.
+*/
+  Word* hi=hiBase+g*Words;
+  Word* lo=loBase+g*Words;
+  if(Netlist::In==type) return; // set by setInput
+  if(0==numIn || Netlist::Unknown==type || Netlist::Lut==type){
+    for(unsigned w=0;w<Words;++w){ hi[w]=0ULL; lo[w]=0ULL; }
+    return;
+  }
+  const Word* aHi=hiBase+in[0]*Words;
+  const Word* aLo=loBase+in[0]*Words;
+  for(unsigned w=0;w<Words;++w){ hi[w]=aHi[w]; lo[w]=aLo[w]; }
+  switch(type){
+  case Netlist::And : case Netlist::Nand :
+    for(unsigned i=1;i<numIn;++i){
+      const Word* bHi=hiBase+in[i]*Words;
+      const Word* bLo=loBase+in[i]*Words;
+      for(unsigned w=0;w<Words;++w){ hi[w]&=bHi[w]; lo[w]|=bLo[w]; }
+    }
+    break;
+  case Netlist::Or : case Netlist::Nor :
+    for(unsigned i=1;i<numIn;++i){
+      const Word* bHi=hiBase+in[i]*Words;
+      const Word* bLo=loBase+in[i]*Words;
+      for(unsigned w=0;w<Words;++w){ hi[w]|=bHi[w]; lo[w]&=bLo[w]; }
+    }
+    break;
+  default : // Buf, Not, Out, Noop take their first fanin
+    break;
+  }
+  if(Netlist::Not==type || Netlist::Nand==type || Netlist::Nor==type){
+    for(unsigned w=0;w<Words;++w){ Word t=hi[w]; hi[w]=lo[w]; lo[w]=t; }
+  }
+}
+template<unsigned Width>
+void BitSim<Width>::evaluateCell(const TruthTable& t,const GateId* in,Word* hiBase,Word* loBase,GateId g){
+  Word* hi=hiBase+g*Words;
+  Word* lo=loBase+g*Words;
+  const std::vector<TruthTable::Cube>* covers[2]={&t.onCover(),&t.offCover()};
+  for(unsigned w=0;w<Words;++w){
+    Word out[2]={0ULL,0ULL};
+    for(unsigned c=0;c<2;++c){
+      const std::vector<TruthTable::Cube>& cover=*covers[c];
+      for(std::size_t k=0;k<cover.size();++k){
+        Word term=~0ULL;
+        for(unsigned i=0;i<t.numInputs();++i){
+          if(0==(cover[k].care&(1u<<i))) continue;
+          term&=(0!=(cover[k].value&(1u<<i))) ? hiBase[in[i]*Words+w] : loBase[in[i]*Words+w];
+        }
+        out[c]|=term;
+      }
+    }
+    hi[w]=out[0];
+    lo[w]=out[1];
+  }
+}
+template<unsigned Width>
+template<Netlist::GateType Type,unsigned Arity>
+struct BitSim<Width>::Fold{
+  // planes of word w of the first Arity fanins combined, and : hi&, lo|
+  static void apply(const GateId* in,const Word* hiBase,const Word* loBase,unsigned w,Word& hi,Word& lo){
+    Fold<Type,Arity-1>::apply(in,hiBase,loBase,w,hi,lo);
+    Word bHi=hiBase[in[Arity-1]*Words+w];
+    Word bLo=loBase[in[Arity-1]*Words+w];
+    if(GateTraits<Type>::bAnd){ hi&=bHi; lo|=bLo; }
+    else{ hi|=bHi; lo&=bLo; }
+  }
+};
+template<unsigned Width>
+template<Netlist::GateType Type>
+struct BitSim<Width>::Fold<Type,1>{
+  static void apply(const GateId* in,const Word* hiBase,const Word* loBase,unsigned w,Word& hi,Word& lo){
+    hi=hiBase[in[0]*Words+w];
+    lo=loBase[in[0]*Words+w];
+  }
+};
+template<unsigned Width>
+template<Netlist::GateType Type,unsigned Arity>
+void BitSim<Width>::evaluateGroup(const Netlist& n,const GateId* first,const GateId* last,Word* hiBase,Word* loBase){
+  for(;first!=last;++first){
+    GateId g=*first;
+    const GateId* in=n.fanins(g);
+    Word* hi=hiBase+g*Words;
+    Word* lo=loBase+g*Words;
+    for(unsigned w=0;w<Words;++w){
+      Word h,l;
+      Fold<Type,Arity>::apply(in,hiBase,loBase,w,h,l);
+      hi[w]=GateTraits<Type>::bInvert ? l : h;
+      lo[w]=GateTraits<Type>::bInvert ? h : l;
+    }
+  }
+}
+template<unsigned Width>
+typename BitSim<Width>::GroupKernel BitSim<Width>::groupKernel(Netlist::GateType type,unsigned arity){
+  static const GroupKernel Kernels[4][GateKernels::MaxArity+1]={
+    {0,&evaluateGroup<Netlist::And,1>,&evaluateGroup<Netlist::And,2>,&evaluateGroup<Netlist::And,3>,&evaluateGroup<Netlist::And,4>},
+    {0,&evaluateGroup<Netlist::Nand,1>,&evaluateGroup<Netlist::Nand,2>,&evaluateGroup<Netlist::Nand,3>,&evaluateGroup<Netlist::Nand,4>},
+    {0,&evaluateGroup<Netlist::Or,1>,&evaluateGroup<Netlist::Or,2>,&evaluateGroup<Netlist::Or,3>,&evaluateGroup<Netlist::Or,4>},
+    {0,&evaluateGroup<Netlist::Nor,1>,&evaluateGroup<Netlist::Nor,2>,&evaluateGroup<Netlist::Nor,3>,&evaluateGroup<Netlist::Nor,4>},
+  };
+  if(arity>GateKernels::MaxArity) return 0;
+  switch(type){
+  case Netlist::And : return Kernels[0][arity];
+  case Netlist::Nand : return Kernels[1][arity];
+  case Netlist::Or : return Kernels[2][arity];
+  case Netlist::Nor : return Kernels[3][arity];
+  case Netlist::Buf : case Netlist::Out : return (1==arity) ? &evaluateGroup<Netlist::Buf,1> : 0;
+  case Netlist::Not : return (1==arity) ? &evaluateGroup<Netlist::Not,1> : 0;
+  default : return 0;
+  }
+}
+#endif // __BitSim__
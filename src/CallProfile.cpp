@@ -0,0 +1,126 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "CallProfile.hpp"
+#include "ThreadRegistry.hpp"
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <algorithm>
+#include <iomanip>
+using namespace std;
+
+thread_local CallProfile::Tree* CallProfile::tTree=0;
+
+namespace{
+  struct PathStats{
+    PathStats() : calls(0), inclusive(0), exclusive(0) {}
+    unsigned long long calls;
+    unsigned long long inclusive;
+    unsigned long long exclusive;
+  };
+  typedef map<string,PathStats> PathMap; // "a;b;c" -> stats
+
+  void flatten(const CallProfile::Tree& t,PathMap& paths){
+  /* Parents come before their children in t.nodes, so one forward pass
+     can build every path from its parent's.
+  */
+    vector<string> path(t.nodes.size());
+    for(size_t i=1;i<t.nodes.size();++i){
+      const CallProfile::Node& n=t.nodes[i];
+      path[i]=(0==n.parent) ? string(n.name) : path[n.parent]+";"+n.name;
+      PathStats& s=paths[path[i]];
+      s.calls+=n.calls;
+      s.inclusive+=n.inclusive;
+      s.exclusive+=(n.inclusive>n.children) ? n.inclusive-n.children : 0;
+    }
+  }
+  void retire(CallProfile::Tree& t,PathMap& retired){ flatten(t,retired); }
+  typedef ThreadRegistry<CallProfile::Tree,PathMap> Registry; // retired : from threads that have exited
+  Registry& registry(){
+    static Registry r(retire);
+    return r;
+  }
+  bool inclusiveFirst(const PathMap::const_iterator& a,const PathMap::const_iterator& b){
+    if(a->second.inclusive!=b->second.inclusive) return a->second.inclusive>b->second.inclusive;
+    return a->first<b->first;
+  }
+}
+CallProfile::Tree::Tree(){
+  clear();
+}
+void CallProfile::Tree::clear(){
+  Node root={"",0,0,0,0,0,0,0};
+  nodes.assign(1,root);
+  stack.clear();
+  current=0;
+}
+CallProfile::Tree& CallProfile::attach(){
+  tTree=&registry().local();
+  return *tTree;
+}
+void CallProfile::enter(Id id,const char* name){
+  Tree& t=tree();
+  unsigned child=t.nodes[t.current].firstChild;
+  while(0!=child && t.nodes[child].id!=id) child=t.nodes[child].nextSibling;
+  if(0==child){ // new call path
+    child=static_cast<unsigned>(t.nodes.size());
+    Node n={name,id,t.current,0,t.nodes[t.current].firstChild,0,0,0};
+    t.nodes.push_back(n);
+    t.nodes[t.current].firstChild=child;
+  }
+  Frame f={t.current,chrono::steady_clock::now()};
+  t.stack.push_back(f);
+  t.current=child;
+}
+void CallProfile::exit(){
+  Tree& t=tree();
+  if(t.stack.empty()) return; // cleared while inside a scope
+  const Frame& f=t.stack.back();
+  unsigned long long ns=static_cast<unsigned long long>(
+    chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now()-f.start).count());
+  Node& n=t.nodes[t.current];
+  ++n.calls;
+  n.inclusive+=ns;
+  t.nodes[f.node].children+=ns;
+  t.current=f.node;
+  t.stack.pop_back();
+}
+bool CallProfile::write(const string& prefix){
+  PathMap paths;
+  {
+    Registry& r=registry();
+    lock_guard<mutex> lock(r.mutex());
+    paths=r.retired();
+    for(size_t i=0;i<r.live().size();++i) flatten(*r.live()[i],paths);
+  }
+  vector<PathMap::const_iterator> sorted;
+  for(PathMap::const_iterator it=paths.begin();it!=paths.end();++it) sorted.push_back(it);
+  sort(sorted.begin(),sorted.end(),inclusiveFirst);
+
+  ofstream table((prefix+".txt").c_str());
+  table << setw(12) << "calls" << setw(14) << "incl ms" << setw(14) << "excl ms"
+        << setw(12) << "ns/call" << "  call path\n";
+  table << fixed;
+  for(size_t i=0;i<sorted.size();++i){
+    const PathStats& s=sorted[i]->second;
+    table << setw(12) << s.calls
+          << setw(14) << setprecision(3) << static_cast<double>(s.inclusive)*1e-6
+          << setw(14) << setprecision(3) << static_cast<double>(s.exclusive)*1e-6
+          << setw(12) << setprecision(0) << (0==s.calls ? 0.0 : static_cast<double>(s.inclusive)/static_cast<double>(s.calls))
+          << "  " << sorted[i]->first << "\n";
+  }
+  ofstream folded((prefix+".folded").c_str());
+  for(PathMap::const_iterator it=paths.begin();it!=paths.end();++it){
+    if(0!=it->second.exclusive) folded << it->first << " " << it->second.exclusive << "\n";
+  }
+  return table.good() && folded.good();
+}
+void CallProfile::clear(){
+  Registry& r=registry();
+  lock_guard<mutex> lock(r.mutex());
+  for(size_t i=0;i<r.live().size();++i) r.live()[i]->clear();
+  r.retired().clear();
+}
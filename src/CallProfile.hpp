@@ -0,0 +1,68 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __CallProfile__
+#define __CallProfile__
+#include <string>
+#include <vector>
+#include <chrono>
+
+// ------------------------------------------------------------
+// class CallProfile
+// ------------------------------------------------------------
+class CallProfile{
+/* Aggregating call-tree profiler fed by Debug scopes ( Debug option C ).
+
+   Every thread keeps its own call tree in a flat vector. enter() finds or
+   adds the child of the current node with the scope's hashed id, exit()
+   adds the elapsed time to it, so a call costs two clock reads and a short
+   walk of the current node's children, with no lock and no allocation once
+   the tree has been built.
+
+   For each call path the tree holds
+      calls       number of times the path was entered
+      inclusive   time between enter and exit
+      exclusive   inclusive minus the inclusive time of its children
+   write(prefix) merges the trees of all threads by path and writes
+      prefix.txt     table sorted by inclusive time
+      prefix.folded  folded stacks, "a;b;c <exclusive ns>", for flamegraph.pl,
+                     speedscope or inferno
+   Names are kept by pointer, so scopes must use string literals.
+ */
+public:
+  typedef unsigned long long Id;
+  static void enter(Id id,const char* name);
+  static void exit();
+  static bool write(const std::string& prefix); // threads must be idle
+  static void clear();
+
+  struct Node{
+    const char* name;
+    Id id;
+    unsigned parent;
+    unsigned firstChild;
+    unsigned nextSibling;
+    unsigned long long calls;
+    unsigned long long inclusive; // ns
+    unsigned long long children;  // ns, inclusive time of the children
+  };
+  struct Frame{
+    unsigned node;
+    std::chrono::steady_clock::time_point start;
+  };
+  struct Tree{
+    Tree();
+    void clear();
+    std::vector<Node> nodes; // nodes[0] is the root
+    std::vector<Frame> stack;
+    unsigned current;
+  };
+private:
+  CallProfile();
+  static Tree& tree(){ return (0!=tTree) ? *tTree : attach(); }
+  static Tree& attach(); // first use on this thread
+  static thread_local Tree* tTree;
+};
+#endif // __CallProfile__
@@ -0,0 +1,302 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "CircuitGen.hpp"
+#include "AsyncWriter.hpp"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+using namespace std;
+
+namespace{
+  const Netlist::GateId None=~0u;
+}
+string CircuitGen::indexed(const char* prefix,size_t i){
+  char buffer[32];
+  snprintf(buffer,sizeof(buffer),"%s%lu",prefix,static_cast<unsigned long>(i));
+  return buffer;
+}
+CircuitGen::GateId CircuitGen::input(const string& name){
+  _fanout.push_back(0);
+  return _n.addGate(name,Netlist::In);
+}
+CircuitGen::GateId CircuitGen::output(const string& name,GateId driver){
+  GateId g=_n.addGate(name,Netlist::Out);
+  _fanout.push_back(0);
+  _n.addFanin(g,driver);
+  ++_fanout[driver];
+  return g;
+}
+CircuitGen::GateId CircuitGen::gate(Netlist::GateType type,GateId a){
+  GateId g=_n.addGate(indexed("g",_n.size()),type);
+  _fanout.push_back(0);
+  _n.addFanin(g,a);
+  ++_fanout[a];
+  return g;
+}
+CircuitGen::GateId CircuitGen::gate(Netlist::GateType type,GateId a,GateId b){
+  GateId g=gate(type,a);
+  _n.addFanin(g,b);
+  ++_fanout[b];
+  return g;
+}
+CircuitGen::GateId CircuitGen::gate(Netlist::GateType type,const vector<GateId>& in){
+  GateId g=gate(type,in[0]);
+  for(size_t i=1;i<in.size();++i){
+    _n.addFanin(g,in[i]);
+    ++_fanout[in[i]];
+  }
+  return g;
+}
+CircuitGen::GateId CircuitGen::exclusiveOr(GateId a,GateId b){
+  GateId n1=gate(Netlist::Nand,a,b);
+  return gate(Netlist::Nand,gate(Netlist::Nand,a,n1),gate(Netlist::Nand,b,n1));
+}
+void CircuitGen::fullAdder(GateId a,GateId b,GateId c,GateId& sum,GateId& carry){
+  // the nine nand full adder
+  GateId n1=gate(Netlist::Nand,a,b);
+  GateId s1=gate(Netlist::Nand,gate(Netlist::Nand,a,n1),gate(Netlist::Nand,b,n1));
+  GateId n5=gate(Netlist::Nand,s1,c);
+  sum=gate(Netlist::Nand,gate(Netlist::Nand,s1,n5),gate(Netlist::Nand,c,n5));
+  carry=gate(Netlist::Nand,n1,n5);
+}
+void CircuitGen::halfAdder(GateId a,GateId b,GateId& sum,GateId& carry){
+  sum=exclusiveOr(a,b);
+  carry=gate(Netlist::And,a,b);
+}
+void CircuitGen::outputUnused(const string& prefix){
+  size_t n=_n.size();
+  size_t count=0;
+  for(size_t g=0;g<n;++g){
+    if(0==_fanout[g] && Netlist::Out!=_n.getType(static_cast<GateId>(g))){
+      output(indexed(prefix.c_str(),count++),static_cast<GateId>(g));
+    }
+  }
+}
+void CircuitGen::rippleAdder(unsigned bits){
+  vector<GateId> a,b;
+  for(unsigned i=0;i<bits;++i){
+    a.push_back(input(indexed("a",i)));
+    b.push_back(input(indexed("b",i)));
+  }
+  GateId carry=input("cin");
+  for(unsigned i=0;i<bits;++i){
+    GateId sum;
+    fullAdder(a[i],b[i],carry,sum,carry);
+    output(indexed("s",i),sum);
+  }
+  output("cout",carry);
+}
+void CircuitGen::lookaheadAdder(unsigned bits){
+/* Per bit propagate p=a^b and generate g=a&b. Within a 4 bit group the
+   carry into bit k+1 is
+      g[k] | p[k]&g[k-1] | ... | p[k]&...&p[0]&c
+   with c the carry into the group, groups ripple into each other.
+ */
+  vector<GateId> a,b;
+  for(unsigned i=0;i<bits;++i){
+    a.push_back(input(indexed("a",i)));
+    b.push_back(input(indexed("b",i)));
+  }
+  GateId groupCarry=input("cin");
+  for(unsigned start=0;start<bits;start+=4){
+    unsigned width=(bits-start<4) ? bits-start : 4;
+    vector<GateId> p,g,carry(1,groupCarry);
+    for(unsigned k=0;k<width;++k){
+      p.push_back(exclusiveOr(a[start+k],b[start+k]));
+      g.push_back(gate(Netlist::And,a[start+k],b[start+k]));
+    }
+    for(unsigned k=0;k<width;++k){
+      vector<GateId> terms(1,g[k]);
+      for(unsigned j=k+1;j-->0;){
+        vector<GateId> product(p.begin()+j,p.begin()+k+1);
+        product.push_back((0==j) ? groupCarry : g[j-1]);
+        terms.push_back(gate(Netlist::And,product));
+      }
+      carry.push_back(gate(Netlist::Or,terms));
+    }
+    for(unsigned k=0;k<width;++k) output(indexed("s",start+k),exclusiveOr(p[k],carry[k]));
+    groupCarry=carry[width];
+  }
+  output("cout",groupCarry);
+}
+void CircuitGen::arrayMultiplier(unsigned bits){
+  vector<GateId> a,b;
+  for(unsigned i=0;i<bits;++i) a.push_back(input(indexed("a",i)));
+  for(unsigned i=0;i<bits;++i) b.push_back(input(indexed("b",i)));
+  vector<GateId> acc; // running sum of the partial product rows
+  for(unsigned j=0;j<bits;++j) acc.push_back(gate(Netlist::And,a[j],b[0]));
+  for(unsigned i=1;i<bits;++i){
+    GateId carry=None;
+    for(unsigned k=0;k<bits;++k){
+      GateId pp=gate(Netlist::And,a[k],b[i]);
+      size_t pos=i+k;
+      if(pos==acc.size()) acc.push_back(None);
+      GateId sum=pp;
+      if(None!=acc[pos] && None!=carry) fullAdder(acc[pos],pp,carry,sum,carry);
+      else if(None!=acc[pos]) halfAdder(acc[pos],pp,sum,carry);
+      else if(None!=carry) halfAdder(carry,pp,sum,carry);
+      acc[pos]=sum;
+    }
+    if(None!=carry) acc.push_back(carry);
+  }
+  for(size_t k=0;k<acc.size();++k) output(indexed("p",k),acc[k]);
+}
+void CircuitGen::tree(unsigned inputs,unsigned fanin){
+  if(fanin<2) fanin=2;
+  vector<GateId> level;
+  for(unsigned i=0;i<inputs;++i) level.push_back(input(indexed("i",i)));
+  bool bAnd=true;
+  while(level.size()>1){
+    vector<GateId> next;
+    for(size_t i=0;i<level.size();i+=fanin){
+      size_t end=(i+fanin<level.size()) ? i+fanin : level.size();
+      if(1==end-i) next.push_back(level[i]);
+      else next.push_back(gate(bAnd ? Netlist::And : Netlist::Or,vector<GateId>(level.begin()+i,level.begin()+end)));
+    }
+    level.swap(next);
+    bAnd=!bAnd;
+  }
+  if(!level.empty()) output("z",level[0]);
+}
+void CircuitGen::randomDag(unsigned gates,unsigned depth,unsigned maxFanin,unsigned maxFanout,double reconvergence){
+/* Gates are spread evenly over depth levels, with as many PIs as gates
+   per level. The first fanin of a gate comes from the previous level, so
+   the circuit has the requested depth. Each further fanin is, with
+   probability reconvergence, a fanin of the first fanin, which closes a
+   reconvergent path, otherwise any gate of an earlier level. Drivers that
+   already have maxFanout fanouts are avoided when another can be found.
+   One gate in ten is an inverter.
+ */
+  if(0==depth) depth=1;
+  if(maxFanin<2) maxFanin=2;
+  if(0==maxFanout) maxFanout=1;
+  unsigned width=(gates/depth>1) ? gates/depth : 1;
+  vector<GateId> fanin0,fanin1; // first two fanins of every gate, for reconvergence
+  vector<size_t> levelStart(1,_n.size());
+  for(unsigned i=0;i<width;++i){
+    input(indexed("i",i));
+    fanin0.push_back(None);
+    fanin1.push_back(None);
+  }
+  size_t base=levelStart[0];
+  static const Netlist::GateType Types[]={Netlist::Nand,Netlist::Nor,Netlist::And,Netlist::Or};
+  for(unsigned l=1;l<=depth;++l){
+    levelStart.push_back(_n.size());
+    unsigned count=width+((l<=gates%depth) ? 1 : 0);
+    for(unsigned w=0;w<count;++w){
+      bool bNot=(0==random(10));
+      unsigned numIn=bNot ? 1 : 2+random(maxFanin-1);
+      vector<GateId> in;
+      for(unsigned k=0;k<numIn;++k){
+        GateId best=None;
+        for(unsigned attempt=0;attempt<8;++attempt){
+          GateId d;
+          if(0==k){
+            size_t from=levelStart[l-1],to=levelStart[l];
+            d=static_cast<GateId>(from+random(static_cast<unsigned>(to-from)));
+          }else if(random(1000)<reconvergence*1000 && None!=fanin0[in[0]-base]){
+            GateId parent=in[0];
+            d=(None!=fanin1[parent-base] && 0!=random(2)) ? fanin1[parent-base] : fanin0[parent-base];
+          }else{
+            d=static_cast<GateId>(base+random(static_cast<unsigned>(levelStart[l]-base)));
+          }
+          if(find(in.begin(),in.end(),d)!=in.end()) continue;
+          if(None==best || _fanout[d]<_fanout[best]) best=d;
+          if(_fanout[d]<maxFanout) break;
+        }
+        if(None!=best) in.push_back(best);
+      }
+      if(1==in.size()) gate(Netlist::Not,in[0]); // also when no second distinct driver was found
+      else gate(Types[random(4)],in);
+      fanin0.push_back(in[0]);
+      fanin1.push_back((in.size()>1) ? in[1] : None);
+    }
+  }
+  outputUnused("o");
+}
+void CircuitGen::iscasBlocks(unsigned copies){
+/* c17 : 10=nand(1,3) 11=nand(3,6) 16=nand(2,11) 19=nand(11,7)
+         22=nand(10,16) 23=nand(16,19)
+   Copy 0 has five PIs, copy k>0 takes its inputs 3 and 6 from the outputs
+   22 and 23 of copy (k-1)/2, so the copies form a binary tree.
+ */
+  vector<GateId> out22,out23;
+  for(unsigned k=0;k<copies;++k){
+    string prefix=indexed("c",k)+"_";
+    GateId i1=input(prefix+"1");
+    GateId i2=input(prefix+"2");
+    GateId i3=(0==k) ? input(prefix+"3") : out22[(k-1)/2];
+    GateId i6=(0==k) ? input(prefix+"6") : out23[(k-1)/2];
+    GateId i7=input(prefix+"7");
+    GateId n10=gate(Netlist::Nand,i1,i3);
+    GateId n11=gate(Netlist::Nand,i3,i6);
+    GateId n16=gate(Netlist::Nand,i2,n11);
+    GateId n19=gate(Netlist::Nand,n11,i7);
+    out22.push_back(gate(Netlist::Nand,n10,n16));
+    out23.push_back(gate(Netlist::Nand,n16,n19));
+  }
+  outputUnused("o");
+}
+bool CircuitGen::validCircuit(const string& circuit){
+  return "adder"==circuit || "cla"==circuit || "multiplier"==circuit
+      || "tree"==circuit || "random"==circuit || "iscas"==circuit;
+}
+const char* CircuitGen::circuitNames(){
+  return "adder, cla, multiplier, tree, random or iscas";
+}
+bool CircuitGen::generate(const string& circuit,size_t gates,unsigned depth,unsigned maxFanin,unsigned maxFanout,double reconvergence){
+  unsigned g=static_cast<unsigned>(gates);
+  if("adder"==circuit){
+    rippleAdder((g/9>1) ? g/9 : 1);
+  }else if("cla"==circuit){
+    lookaheadAdder((g*2/25>1) ? g*2/25 : 1);
+  }else if("multiplier"==circuit){
+    unsigned bits=static_cast<unsigned>(sqrt(static_cast<double>(g)/10.0));
+    arrayMultiplier((bits>2) ? bits : 2);
+  }else if("tree"==circuit){
+    tree(g+1,2);
+  }else if("random"==circuit){
+    if(0==depth) depth=static_cast<unsigned>(2*log(static_cast<double>(g)+2)/log(2.0));
+    randomDag(g,depth,maxFanin,maxFanout,reconvergence);
+  }else if("iscas"==circuit){
+    iscasBlocks((g/6>1) ? g/6 : 1);
+  }else{
+    return false;
+  }
+  return true;
+}
+bool CircuitGen::writeDot(const Netlist& n,const string& path,GateId faultGate){
+  AsyncWriter w(path);
+  if(!w.good()) return false;
+  string line="digraph \"\" {\n";
+  for(size_t g=0;g<n.size();++g){
+    line+="\"n"+indexed("",g)+"\" [label=\""+n.getName(static_cast<GateId>(g))+":"+Netlist::funcName(n.getType(static_cast<GateId>(g)))+"\"];\n";
+    if(line.size()>(1<<16)){
+      w.write(line);
+      line.clear();
+    }
+  }
+  bool bFaultWritten=false;
+  for(size_t g=0;g<n.size();++g){
+    const GateId* in=n.fanins(static_cast<GateId>(g));
+    for(unsigned i=0;i<n.numFanins(static_cast<GateId>(g));++i){
+      line+="\"n"+indexed("",in[i])+"\" -> \"n"+indexed("",g)+"\"";
+      if(in[i]==faultGate && !bFaultWritten){
+        line+=" [label=\"D\"]";
+        bFaultWritten=true;
+      }
+      line+=";\n";
+    }
+    if(line.size()>(1<<16)){
+      w.write(line);
+      line.clear();
+    }
+  }
+  line+="}\n";
+  w.write(line);
+  w.close();
+  return w.good();
+}
@@ -0,0 +1,79 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __CircuitGen__
+#define __CircuitGen__
+#include <string>
+#include <vector>
+#include "Netlist.hpp"
+
+// ------------------------------------------------------------
+// class CircuitGen
+// ------------------------------------------------------------
+class CircuitGen{
+/* Synthetic circuits for scaling runs, built into a Netlist with the gate
+   functions the engine evaluates ( in, out, not, and, nand, or, nor ).
+
+   Circuits
+      adder        ripple carry adder, nine nand full adders
+      cla          carry lookahead adder, 4 bit lookahead groups
+      multiplier   array multiplier, and partial products summed by rows of
+                   ripple adders
+      tree         balanced and/or tree, levels alternate and/or
+      random       random levelized DAG, see randomDag
+      iscas        copies of ISCAS-85 c17, the inputs of copy k driven by
+                   the outputs of copy (k-1)/2, so cones overlap
+   generate(circuit,gates,...) picks the size parameter that gives roughly
+   that many gates. Every gate gets a unique name, PIs and POs are named
+   after their role ( a3, b3, s3, cout ).
+
+   writeDot writes the netlist as a digraph RunGraph reads, with edges
+   unlabelled ( initializeGraph makes them X ), except the first fanout
+   edge of faultGate which is labelled D, the seed fault for runATPG.
+
+   Usage :
+      Netlist n;
+      CircuitGen gen(n,1);
+      gen.rippleAdder(64);
+      n.levelize();
+      CircuitGen::writeDot(n,"add64.dot",n.getInputs()[0]);
+   NB - the Netlist must outlive the generator, not copyable
+ */
+public:
+  typedef Netlist::GateId GateId;
+  CircuitGen(Netlist& n,unsigned seed=1) : _n(n), _state(seed) {}
+
+  void rippleAdder(unsigned bits);
+  void lookaheadAdder(unsigned bits);
+  void arrayMultiplier(unsigned bits);
+  void tree(unsigned inputs,unsigned fanin=2);
+  void randomDag(unsigned gates,unsigned depth,unsigned maxFanin=3,unsigned maxFanout=8,double reconvergence=0.3);
+  void iscasBlocks(unsigned copies);
+
+  static bool validCircuit(const std::string& circuit);
+  static const char* circuitNames(); // for help messages
+  bool generate(const std::string& circuit,std::size_t gates,unsigned depth=0,unsigned maxFanin=3,unsigned maxFanout=8,double reconvergence=0.3);
+  static bool writeDot(const Netlist& n,const std::string& path,GateId faultGate);
+private:
+  CircuitGen();
+  CircuitGen(const CircuitGen&);
+  CircuitGen& operator=(const CircuitGen&);
+  GateId input(const std::string& name);
+  GateId output(const std::string& name,GateId driver);
+  GateId gate(Netlist::GateType type,GateId a);
+  GateId gate(Netlist::GateType type,GateId a,GateId b);
+  GateId gate(Netlist::GateType type,const std::vector<GateId>& in);
+  GateId exclusiveOr(GateId a,GateId b);
+  void fullAdder(GateId a,GateId b,GateId c,GateId& sum,GateId& carry);
+  void halfAdder(GateId a,GateId b,GateId& sum,GateId& carry);
+  void outputUnused(const std::string& prefix); // every gate without fanout gets a PO
+  unsigned random(unsigned n){ _state=_state*1664525u+1013904223u; return static_cast<unsigned>((static_cast<unsigned long long>(_state>>8)*n)>>24); }
+  static std::string indexed(const char* prefix,std::size_t i);
+
+  Netlist& _n;
+  unsigned _state;
+  std::vector<unsigned> _fanout; // per gate, while generating
+};
+#endif // __CircuitGen__
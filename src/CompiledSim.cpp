@@ -0,0 +1,223 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "CompiledSim.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <vector>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+using namespace std;
+
+const unsigned CompiledSim::Version;
+
+unsigned long long CompiledSim::hash(const Netlist& n,unsigned words){
+/* FNV-1a over the version, the width, the gate types, the tables of the
+   cells and the fanins, in gate order
+*/
+  unsigned long long h=14695981039346656037ULL;
+  struct Mix{
+    static void in(unsigned long long& h,unsigned v){
+      for(int i=0;i<4;++i){ h^=(v>>(8*i))&0xffU; h*=1099511628211ULL; }
+    }
+  };
+  Mix::in(h,Version);
+  Mix::in(h,words);
+  Mix::in(h,static_cast<unsigned>(n.size()));
+  for(Netlist::GateId g=0;g<n.size();++g){
+    Mix::in(h,n.getType(g));
+    Mix::in(h,n.numFanins(g));
+    if(Netlist::Lut==n.getType(g)){
+      TruthTable::Bits bits=n.getTable(g).bits();
+      Mix::in(h,static_cast<unsigned>(bits));
+      Mix::in(h,static_cast<unsigned>(bits>>32));
+    }
+    for(unsigned i=0;i<n.numFanins(g);++i) Mix::in(h,n.fanins(g)[i]);
+  }
+  return h;
+}
+void CompiledSim::emitGate(const Netlist& n,Netlist::GateId g,ostream& os){
+/* Same results as BitSim::evaluateGate */
+  Netlist::GateType type=n.getType(g);
+  unsigned numIn=n.numFanins(g);
+  const Netlist::GateId* in=n.fanins(g);
+  if(Netlist::In==type) return;
+  os << "    ";
+  if(0==numIn || Netlist::Unknown==type){
+    os << "H(" << g << ")=Block(); L(" << g << ")=Block();\n";
+    return;
+  }
+  if(Netlist::Lut==type){
+    os << "H(" << g << ")=";
+    emitCover(n.getTable(g).onCover(),in,os);
+    os << "; L(" << g << ")=";
+    emitCover(n.getTable(g).offCover(),in,os);
+    os << ";\n";
+    return;
+  }
+  bool bAnd=(Netlist::And==type || Netlist::Nand==type);
+  bool bOr=(Netlist::Or==type || Netlist::Nor==type);
+  bool bInvert=(Netlist::Not==type || Netlist::Nand==type || Netlist::Nor==type);
+  if(!bAnd && !bOr) numIn=1; // buf, not, out, noop take their first fanin
+  const char* hiOp=bAnd ? "&" : "|";
+  const char* loOp=bAnd ? "|" : "&";
+  ostringstream hi,lo;
+  for(unsigned i=0;i<numIn;++i){
+    hi << ((0==i) ? "" : hiOp) << "H(" << in[i] << ")";
+    lo << ((0==i) ? "" : loOp) << "L(" << in[i] << ")";
+  }
+  os << "H(" << g << ")=" << (bInvert ? lo.str() : hi.str()) << "; ";
+  os << "L(" << g << ")=" << (bInvert ? hi.str() : lo.str()) << ";\n";
+}
+void CompiledSim::emitCover(const vector<TruthTable::Cube>& cover,const Netlist::GateId* in,ostream& os){
+/* Or of the cubes, each the and of H of its inputs at 1 and L of its
+   inputs at 0, as BitSim::evaluateCell
+*/
+  if(cover.empty()) os << "Block()";
+  for(size_t k=0;k<cover.size();++k){
+    os << ((0==k) ? "(" : "|(");
+    if(0==cover[k].care) os << "~Block()";
+    for(unsigned i=0,literals=0;i<TruthTable::MaxInputs;++i){
+      if(0==(cover[k].care&(1u<<i))) continue;
+      os << ((0==literals++) ? "" : "&") << ((0!=(cover[k].value&(1u<<i))) ? "H(" : "L(") << in[i] << ")";
+    }
+    os << ")";
+  }
+}
+void CompiledSim::emit(const Netlist& n,unsigned words,ostream& os){
+  const vector<Netlist::GateId>& schedule=n.getSchedule();
+  unsigned numLevels=n.getDepth()+1;
+  unsigned long long h=hash(n,words);
+  os << "// atpgsim " << hex << h << dec << " : " << n.size() << " gates, " << numLevels << " levels, "
+     << words << " words, generated by atpg, do not edit\n"
+     << "typedef unsigned long long Word;\n";
+  if(1==words) os << "typedef Word Block;\n";
+  else os << "typedef Word Block __attribute__((vector_size(" << 8*words << "),aligned(8),may_alias));\n";
+  os << "#define H(g) hi[g]\n"
+     << "#define L(g) lo[g]\n";
+  size_t i=0;
+  for(unsigned level=0;level<numLevels;++level){
+    os << "static void level" << level << "(Block* hi,Block* lo){\n";
+    for(;i<schedule.size() && level==n.getLevel(schedule[i]);++i) emitGate(n,schedule[i],os);
+    os << "}\n";
+  }
+  os << "typedef void (*Level)(Block*,Block*);\n"
+     << "static const Level Levels[" << numLevels << "]={";
+  for(unsigned level=0;level<numLevels;++level) os << ((0==level) ? "" : ",") << "level" << level;
+  os << "};\n"
+     << "extern \"C\" void atpgsim_run(Word* hi,Word* lo,unsigned first,unsigned last){\n"
+     << "  for(unsigned l=first;l<last && l<" << numLevels << ";++l) Levels[l]((Block*)hi,(Block*)lo);\n"
+     << "}\n"
+     << "extern \"C\" unsigned long long atpgsim_hash(){ return 0x" << hex << h << dec << "ULL; }\n";
+}
+bool CompiledSim::compile(const Netlist& n,unsigned words,const string& base,const string& object){
+/* Source, log and object are written under pid suffixed names, so runs
+   that share the cache never write the same file; the object and then the
+   source are renamed into place.
+*/
+  ostringstream suffix;
+  suffix << "." << getpid();
+  const string source=base+suffix.str()+".cpp";
+  const string tmpPath=object+suffix.str();
+  const string log=base+suffix.str()+".log";
+  {
+    ofstream os(source.c_str());
+    emit(n,words,os);
+    if(!os){
+      cout << "Warning! Cannot write " << source << "\n";
+      return false;
+    }
+  }
+  // no shell : paths and $CXX go to the compiler as they are, $CXX split on blanks
+  vector<string> args;
+  const char* cxx=getenv("CXX");
+  istringstream cxxWords(string((0!=cxx && *cxx) ? cxx : "c++"));
+  for(string word;cxxWords >> word;) args.push_back(word);
+  if(args.empty()) args.push_back("c++");
+  const char* flags[]={"-O1","-shared","-fPIC","-o"}; // no -march, the cache may be shared
+  args.insert(args.end(),flags,flags+sizeof(flags)/sizeof(flags[0]));
+  args.push_back(tmpPath);
+  args.push_back(source);
+  vector<char*> argv;
+  for(size_t i=0;i<args.size();++i) argv.push_back(&args[i][0]);
+  argv.push_back(0);
+  int status=-1;
+  pid_t pid=fork();
+  if(0==pid){
+    int fd=::open(log.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0644);
+    if(fd>=0){
+      dup2(fd,1);
+      dup2(fd,2);
+      ::close(fd);
+    }
+    execvp(argv[0],&argv[0]);
+    perror(argv[0]); // into the log
+    _exit(127);
+  }
+  bool bBuilt=false;
+  if(pid>0){
+    while(waitpid(pid,&status,0)<0){
+      if(EINTR!=errno){ status=-1; break; }
+    }
+    bBuilt=(-1!=status && WIFEXITED(status) && 0==WEXITSTATUS(status));
+  }
+  if(!bBuilt || 0!=rename(tmpPath.c_str(),object.c_str())){
+    remove(tmpPath.c_str());
+    cout << "Warning! Cannot compile the netlist simulator, see " << log << "\n";
+    return false;
+  }
+  remove(log.c_str());
+  rename(source.c_str(),(base+".cpp").c_str()); // kept for reading only
+  return true;
+}
+bool CompiledSim::load(const Netlist& n,unsigned words,const string& cacheDir){
+  unload();
+  if(!validWords(words)) return false;
+  unsigned long long h=hash(n,words);
+  ostringstream base;
+  base << cacheDir << "/atpgsim_" << hex << h;
+  _path=base.str()+".so";
+  bool bCached=(0==access(_path.c_str(),R_OK));
+  if(!bCached && !compile(n,words,base.str(),_path)) return false;
+  if(!openObject(h)){
+    if(!bCached) return false;
+    cout << "Warning! Rebuilding " << _path << "\n"; // stale or foreign object in the cache
+    bCached=false;
+    if(!compile(n,words,base.str(),_path) || !openObject(h)) return false;
+  }
+  _words=words;
+  cout << "Compiled simulator " << _path << (bCached ? " ( cached )" : "") << "\n";
+  return true;
+}
+bool CompiledSim::openObject(unsigned long long h){
+/* dlopens _path and checks it is the simulator with hash h */
+  _handle=dlopen(_path.c_str(),RTLD_NOW|RTLD_LOCAL);
+  if(0==_handle){
+    const char* error=dlerror();
+    cout << "Warning! Cannot load " << _path << " : " << (error ? error : "unknown error") << "\n";
+    return false;
+  }
+  typedef unsigned long long (*HashFunction)();
+  HashFunction objectHash=reinterpret_cast<HashFunction>(dlsym(_handle,"atpgsim_hash"));
+  _run=reinterpret_cast<LevelsFunction>(dlsym(_handle,"atpgsim_run"));
+  if(0==objectHash || h!=objectHash() || 0==_run){
+    cout << "Warning! " << _path << " is not the simulator of this netlist\n";
+    unload();
+    return false;
+  }
+  return true;
+}
+void CompiledSim::unload(){
+  if(0!=_handle) dlclose(_handle);
+  _handle=0;
+  _run=0;
+  _words=0;
+}
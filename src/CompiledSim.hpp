@@ -0,0 +1,88 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __CompiledSim__
+#define __CompiledSim__
+#include <string>
+#include <iosfwd>
+#include "Netlist.hpp"
+
+// ------------------------------------------------------------
+// class CompiledSim
+// ------------------------------------------------------------
+class CompiledSim{
+/* Compiled code form of the bit-parallel simulator for one netlist.
+
+   emit writes the levelized netlist for one block width as straight-line
+   C++ : a function per level, one statement per gate on the dual rail
+   planes of BitSim, for example a nand of gates 3 and 7 into gate 12
+      H(12)=L(3)|L(7); L(12)=H(3)&H(7);
+   and a cell the or of the cubes of its table, an xor of 3 and 7
+      H(12)=(H(3)&L(7))|(L(3)&H(7)); L(12)=(L(3)&L(7))|(H(3)&H(7));
+   so there is no fanin array, no type switch and no group table left at
+   run time. H and L are a whole block of the gate, a vector of 1, 4 or 8
+   words ( 64, 256 or 512 patterns ) in the gcc vector extension, so the
+   statement is the same for every width and the compiler picks the
+   instructions. The object exports
+      extern "C" void atpgsim_run(Word* hi,Word* lo,unsigned first,unsigned last)
+   which evaluates levels first to last-1 over planes laid out as in
+   BitSim, gate g at g*words. A full good machine pass is levels 0 to
+   depth, a fault cone the levels from the fault site on.
+
+   load hashes the netlist structure ( types and fanins, not names ) and
+   the width, and looks for <dir>/atpgsim_<hash>.so. If it is not there
+   the source is emitted next to it and compiled with $CXX, c++ if not
+   set, source, log and object under names suffixed with the pid and
+   renamed into place, so concurrent runs do not see half written files. The compiler is run with fork/execvp, not
+   a shell, so the cache path is never interpreted. The object is then
+   dlopen'ed and its hash checked; a cached object that does not load or
+   has another hash is rebuilt once. load returns false, with a warning,
+   when there is no compiler or the object does not load, and the caller
+   keeps the interpreter.
+
+   Straight-line code is slow to optimize : about 0.6 ms of -O1 per gate,
+   and several times that with -O2 or with restrict pointers, for little
+   gain on code that is loads, one or two logic operations and stores.
+
+   Usage :
+      CompiledSim cs;
+      BitSim<256> sim(netlist);
+      if(cs.load(netlist,BitSim<256>::Words,"/tmp")) sim.setCompiled(cs.function());
+      sim.simulate();
+   NB - not copyable, unloads the object when destroyed. Objects are
+        built without -march, for any cpu of the compiler's target, so a
+        cache can be shared between machines of one architecture.
+ */
+public:
+  typedef unsigned long long Word;
+  typedef void (*LevelsFunction)(Word* hi,Word* lo,unsigned first,unsigned last);
+  static const unsigned Version=3; // of the emitted code and its flags, part of the hash
+
+  CompiledSim() : _handle(0), _run(0), _words(0) {}
+  ~CompiledSim(){ unload(); }
+  bool load(const Netlist& n,unsigned words,const std::string& cacheDir); // words 1, 4 or 8
+  void unload();
+  bool isLoaded() const { return 0!=_handle; }
+  LevelsFunction function() const { return _run; } // 0 if not loaded
+  unsigned getWords() const { return _words; }
+  const std::string& getPath() const { return _path; }
+
+  static bool validWords(unsigned words){ return 1==words || 4==words || 8==words; }
+  static unsigned long long hash(const Netlist& n,unsigned words);
+  static void emit(const Netlist& n,unsigned words,std::ostream& os);
+private:
+  CompiledSim(const CompiledSim&);
+  CompiledSim& operator=(const CompiledSim&);
+  static bool compile(const Netlist& n,unsigned words,const std::string& base,const std::string& object); // base.cpp is the source
+  bool openObject(unsigned long long h);
+  static void emitGate(const Netlist& n,Netlist::GateId g,std::ostream& os);
+  static void emitCover(const std::vector<TruthTable::Cube>& cover,const Netlist::GateId* in,std::ostream& os);
+
+  void* _handle;
+  LevelsFunction _run;
+  unsigned _words;
+  std::string _path;
+};
+#endif // __CompiledSim__
@@ -38,7 +38,7 @@ const DLogic  DLogic::_UNDEFINED (&m_defArr[5]);
 // khtan added
 const DLogic  DLogic::DLogicAnd[5][5]={ {ZERO,ZERO,ZERO,ZERO,ZERO},
                                         {ZERO,ONE ,D   ,_D  ,X},
-                                        {ZERO,D   ,ZERO,ZERO,X},
+                                        {ZERO,D   ,D   ,ZERO,X},
                                         {ZERO,_D  ,ZERO,_D  ,X},
                                         {ZERO,X   ,X   ,X   ,X},
                                         };
@@ -6,7 +6,13 @@
 */
 // $Id: Debug.cpp,v 1.16 2002/11/21 17:52:42 khtan Exp khtan $
 #include "Debug.hpp"
+#include "DebugSink.hpp"
+#include "TraceEvents.hpp"
+#include "CallProfile.hpp"
 #include <algorithm>
+#include <sstream>
+#include <mutex>
+#include <memory>
 #include <string.h>
 // Added enhancements turned on with preprocessor defines
 
@@ -63,47 +69,103 @@ static void f2() {
 
 #ifndef DEBUG_OFF
     // Static members
-int Debug::level = 0;
-bool Debug::Debugging = false;
-bool Debug::Tracing = false;
-bool Debug::Timing = false;
+thread_local int Debug::level = 0;
+const Debug::Filters Debug::defaultFilters;
+STD atomic<const Debug::Filters*> Debug::filters(&Debug::defaultFilters);
 STD ofstream* Debug::pFile=NULL;
 STD ostream* Debug::pDebugStream=&clog; // default on startup, use clog
 
 char Debug::separator = '?';
 
-char Debug::mybuff[200];
+thread_local char Debug::mybuff[200];
 string Debug::filename;
 
-vector<string> Debug::keywords;
-vector<string> Debug::functions;
-vector<string> Debug::timekeys;
-vector<pair<string, struct timeb> > Debug::timers;
+thread_local vector<pair<string, struct timeb> > Debug::timers;
+
+namespace{
+  mutex specifyMutex; // one specify at a time
+  thread_local ostringstream tLine;
+  thread_local vector<pair<string,unsigned long long> > tSpanTimers; // for TimeStart/TimeEnd spans
+}
 
 Debug::Debug(const char* f,bool rawtimeMode,bool bEndLine) :
 function_name(f), timing(rawtimeMode),raw_time(rawtimeMode),going_in(rawtimeMode)
 {
     level++;
-    if(tracing(function_name)) 
+    call_profiled=filters.load(memory_order_acquire)->CallProfiling;
+    if(call_profiled) CallProfile::enter(debugHash(f),f);
+    startProfile(f,profiling(f));
+    traced=tracing(function_name);
+    if(traced) 
         Enter(bEndLine);
     going_in=false;
 }
+Debug::Debug(const char* f,DebugId id,bool bEndLine) :
+timing(false),raw_time(false),going_in(false)
+{
+    level++;
+    call_profiled=filters.load(memory_order_acquire)->CallProfiling;
+    if(call_profiled) CallProfile::enter(id,f);
+    startProfile(f,profiling(id));
+    traced=tracing(id);
+    if(traced){ // only pay for the name when it is printed
+        function_name=f;
+        Enter(bEndLine);
+    }
+}
 Debug::~Debug() {
-        if(tracing(function_name)) Exit();
+        if(traced) Exit();
+        if(NULL!=profile_name) TraceEvents::span(profile_name,profile_start,TraceEvents::now());
+        if(call_profiled) CallProfile::exit();
         level--;
 }
+void Debug::startProfile(const char* f,bool bProfiled) {
+    profile_name=NULL;
+    if(bProfiled){
+        profile_name=f;
+        profile_start=TraceEvents::now();
+    }
+}
+bool Debug::profiling(DebugId f) {
+    const Filters* pF=filters.load(memory_order_acquire);
+    if(!pF->Profiling) return false;
+
+    return (pF->profiled.empty() || hasId(pF->profiled,f));
+}
+bool Debug::profiling(const char* f) {
+    // hash only when profiling is on
+    return filters.load(memory_order_acquire)->Profiling && profiling(debugHash(f));
+}
+
+bool Debug::hasId(const vector<DebugId>& ids,DebugId id) {
+    return binary_search(ids.begin(),ids.end(),id);
+}
+void Debug::addId(vector<DebugId>& ids,const string& kw) {
+    DebugId id=debugHash(kw.c_str());
+    vector<DebugId>::iterator it=lower_bound(ids.begin(),ids.end(),id);
+    if(ids.end()==it || *it!=id) ids.insert(it,id);
+}
+bool Debug::tracing(DebugId f) {
+    const Filters* pF=filters.load(memory_order_acquire);
+    if(!pF->Tracing) return false;
 
+    return (pF->functions.empty() || hasId(pF->functions,f));
+}
 bool Debug::tracing(const string & f) {
-    if(!Tracing) return false;
-    
-    return (functions.empty() || 
-    find(functions.begin(),functions.end(),f) != functions.end());
+    return tracing(debugHash(f.c_str()));
 }
+bool Debug::debugging(DebugId k) {
+    const Filters* pF=filters.load(memory_order_acquire);
+    if(!pF->Debugging) return false;
 
-bool Debug::debugging(const string & k) {
-    if(!Debugging) return false;
+    return (pF->keywords.empty() || hasId(pF->keywords,k));
+}
 
+bool Debug::debugging(const string & k) {
 #if defined DEBUG_MULT_KWDS
+    const Filters* pF=filters.load(memory_order_acquire);
+    if(!pF->Debugging) return false;
+    const vector<DebugId>& keywords=pF->keywords;
     if( keywords.empty()) return true;
     string::size_type start, end;
     string kw;
@@ -122,19 +184,20 @@ bool Debug::debugging(const string & k) {
             kw = k.substr(start,end-start);
             start = end + 1;
         }
-        if(find(keywords.begin(),keywords.end(),kw) != keywords.end()) {
+        if(hasId(keywords,debugHash(kw.c_str()))) {
             return true;
         }
     } while( end != string::npos );
     return false;
 #else
-    return (keywords.empty() || 
-    find(keywords.begin(),keywords.end(),k) != keywords.end());
+    return debugging(debugHash(k.c_str()));
 #endif
 }
 
 bool Debug::IntTiming(const string & t) {
-    if(!Timing) return false;
+    const Filters* pF=filters.load(memory_order_acquire);
+    if(!pF->Timing) return false;
+    const vector<string>& timekeys=pF->timekeys;
 
 #if defined DEBUG_MULT_KWDS
     if( timekeys.empty()) return true;
@@ -174,15 +237,17 @@ void Debug::Enter(bool bEndLine){
   sBuffer.replace(0,level-1,level-1,'*');
 #endif//EMACS_OUTLINE
 
-  (*pDebugStream) << sBuffer;
-  (*pDebugStream) << "=> " << function_name << time_stuff();
-  if(bEndLine) (*pDebugStream) << "\n";
+  out() << sBuffer;
+  out() << "=> " << function_name << time_stuff();
+  if(bEndLine) out() << "\n";
+  commit();
 }
 void Debug::Exit(){
     for(int i = 1; i < (level < limit ? level : limit) ; i++ )
-    (*pDebugStream) << "  ";
+    out() << "  ";
 
-    (*pDebugStream) << "<= " << function_name << time_stuff() << "\n";
+    out() << "<= " << function_name << time_stuff() << "\n";
+    commit();
 }
 string Debug::time_stuff() {
     if(!timing) return "";
@@ -214,33 +279,56 @@ string Debug::time_stuff() {
 }
 
 void Debug::indent() {
-    if( Tracing ) {
+    if( filters.load(memory_order_acquire)->Tracing ) {
         for( int i = 0; i <= (level < (limit + 1) ? level : (limit + 1)); i++ ) 
-        (*pDebugStream) << "  ";
+        out() << "  ";
     }
 }
+ostream& Debug::out() {
+    return tLine;
+}
+void Debug::commit() {
+/* Synchronous output is written at once, as before. Asynchronously, an
+   Enter heading without end of line waits for the next Dbg, so only whole
+   lines leave the thread.
+*/
+    const string& line=tLine.str();
+    if(line.empty()) return;
+    DebugSink& sink=DebugSink::instance();
+    if(sink.isAsync() && '\n'!=line[line.size()-1]) return;
+    sink.write(line);
+    tLine.str("");
+}
 void Debug::Dbg(const std::string& keyword, const std::string& description, char* pC){
   // cout << "-print char*\n";
   if(!debugging(keyword)) return;
   indent();
   if(NULL==pC){
-    (*pDebugStream) << keyword << ": "<< description << " = NULL\n";
+    out() << keyword << ": "<< description << " = NULL\n";
   }else{
-    (*pDebugStream) << keyword << ": "<< description << " = " << pC << "\n";
+    out() << keyword << ": "<< description << " = " << pC << "\n";
   }
+  commit();
 };
 void Debug::Dbg(const std::string& keyword, char* pC){
   // cout << "-print char*\n";
   if(!debugging(keyword)) return;
   indent();
   if(NULL==pC){
-    (*pDebugStream) << keyword << ": NULL\n";
+    out() << keyword << ": NULL\n";
   }else{
-    (*pDebugStream) << keyword << ": "<< pC << "\n";
+    out() << keyword << ": "<< pC << "\n";
   }
+  commit();
 };
 
 void Debug::TimeStart(const string &t, const char *s) {
+    if(profiling(t.c_str())){
+        unsigned int i = 0;
+        while(i < tSpanTimers.size() && tSpanTimers[i].first != t) i++;
+        if( i == tSpanTimers.size()) tSpanTimers.push_back(make_pair(t,0ULL));
+        tSpanTimers[i].second = TraceEvents::now();
+    }
     if(!IntTiming(t)) return;
     
     unsigned int i = 0;
@@ -257,10 +345,18 @@ void Debug::TimeStart(const string &t, const char *s) {
     sprintf(mybuff," %ld.%03d", tb.time, tb.millitm);
 
     indent();
-    (*pDebugStream) << t << ": " << s << mybuff << "\n";
+    out() << t << ": " << s << mybuff << "\n";
+    commit();
 }
     
 void Debug::TimeEnd(const string &t, const char *s) {
+    if(profiling(t.c_str())){
+        unsigned long long end = TraceEvents::now();
+        unsigned int i = 0;
+        while(i < tSpanTimers.size() && tSpanTimers[i].first != t) i++;
+        // without a TimeStart the span is empty, as the text timer is
+        TraceEvents::span(TraceEvents::intern(t),(i < tSpanTimers.size()) ? tSpanTimers[i].second : end,end);
+    }
     if(!IntTiming(t)) return;
     
     unsigned int i = 0;
@@ -287,11 +383,12 @@ void Debug::TimeEnd(const string &t, const char *s) {
     sprintf(mybuff, " %d.%03d", secs, millis);
 
     indent();
-    (*pDebugStream) << t << ": " << s << mybuff << "\n";
+    out() << t << ": " << s << mybuff << "\n";
+    commit();
 }
 
 void Debug::Sync() {
-    pDebugStream->flush();
+    DebugSink::instance().sync();
 }
     
 /***********************************
@@ -321,6 +418,13 @@ void Debug::Sync() {
 * Leading commas are harmless.
 **************************************/
 void Debug::specify(const char * opt) {
+  // Work on a copy, other threads keep reading the published filters
+  lock_guard<mutex> lock(specifyMutex);
+  unique_ptr<Filters> pF(new Filters(*filters.load(memory_order_acquire)));
+  vector<DebugId>& keywords=pF->keywords;
+  vector<DebugId>& functions=pF->functions;
+  vector<string>& timekeys=pF->timekeys;
+  vector<DebugId>& profiled=pF->profiled;
   string s = opt;
 
   // Find options
@@ -377,7 +481,7 @@ void Debug::specify(const char * opt) {
       // This is where we deal with the keywords and options
       switch(Option[0]) {
       case 'D':    // Turn debugging on
-        if(kw.length()) keywords.push_back(kw);
+        if(kw.length()) addId(keywords,kw);
         break;
 
       case 'O':   // Changing output, maybe
@@ -387,32 +491,37 @@ void Debug::specify(const char * opt) {
           if(kw.length() && kw != filename) {
 #endif
             filename = kw;
+            ofstream* pOldFile=pFile;
             if( kw == "-"){
               pDebugStream=&cout;
+              pFile=NULL;
             }else{ 
               if(kw == "--") {
                 pDebugStream=&clog;
+                pFile=NULL;
               }else{
-                if(NULL!=pFile){
-                  delete pFile;
-                  pFile=NULL;
-                }
                 pFile=new(ofstream);
                 pFile->open(filename.c_str(),ios::app);
                 pDebugStream=pFile;
               }
             }
+            DebugSink::instance().setStream(pDebugStream); // drains to the old stream first
+            delete pOldFile;
           }
           break;
 
         case 'T':    // Turn tracing on
-          if(kw.length()) functions.push_back(kw);
+          if(kw.length()) addId(functions,kw);
           break;
 
         case 'M':    // Turn interval timing on
           if(kw.length()) timekeys.push_back(kw);
           break;
 
+        case 'P':    // Turn profiling spans on
+          if(kw.length()) addId(profiled,kw);
+          break;
+
         default:       // Ignore other options silently
           break;
         }
@@ -420,34 +529,60 @@ void Debug::specify(const char * opt) {
       // This is where we complete dealing with options
       switch(Option[0]) {
       case 'D':    // Turn debugging on
-        Debugging = true;
+        pF->Debugging = true;
         break;
 
       case 'd':       // Turn debugging off
         CLEAR(keywords);
-        Debugging = false;
+        pF->Debugging = false;
+        break;
+
+      case 'A':       // Asynchronous output
+        DebugSink::instance().setAsync(true);
+        break;
+
+      case 'a':       // Synchronous output
+        DebugSink::instance().setAsync(false);
         break;
 
       case 'O':   // Changing output, maybe - khtan : no longer needed
         break;
 
       case 'T':    // Turn tracing on
-        Tracing = true;
+        pF->Tracing = true;
         break;
 
       case 't':       // Turn tracing off
 	    CLEAR(functions);
-        Tracing = false;
+        pF->Tracing = false;
         break;
             
       case 'M':       // Turn interval timing on
-        Timing = true;
+        pF->Timing = true;
+        break;
+
+      case 'P':       // Turn profiling spans on
+        pF->Profiling = true;
+        break;
+
+      case 'C':       // Turn call-tree profiling on
+        pF->CallProfiling = true;
+        break;
+
+      case 'c':       // Turn call-tree profiling off
+        pF->CallProfiling = false;
+        break;
+
+      case 'p':       // Turn profiling spans off
+        CLEAR(profiled);
+        pF->Profiling = false;
+        CLEAR(tSpanTimers);
         break;
 
       case 'm':       // Turn interval timing off
 	    CLEAR(timekeys);
         CLEAR(timers);
-        Timing = false;
+        pF->Timing = false;
         break;
 
       default:       // Ignore other options silently
@@ -455,5 +590,10 @@ void Debug::specify(const char * opt) {
       }
       j = k; // Advance to next option
     } // end of loop on finding options
+  // Publish. The old set may still be in use by another thread, so it is
+  // retired rather than deleted; specify is rare enough for that not to matter.
+  static vector<unique_ptr<const Filters> > retired;
+  const Filters* pOld=filters.exchange(pF.release(),memory_order_acq_rel);
+  if(&defaultFilters!=pOld) retired.push_back(unique_ptr<const Filters>(pOld));
 }
 #endif // ndef DEBUG_OFF
@@ -454,6 +454,45 @@
    Added two specializations for char* case.
 7) By templating Debug code, added a Debug.hpp for ease of compilation, and 
    use on VC6 projects.
+8) Added compile-time gated tracing for hot functions.
+      DEBUG_SCOPE(level,"name");           // replaces Debug D("name");
+      DEBUG_DBG("1","description",expr);   // replaces D.Dbg("1","description",expr);
+   A scope whose level is above DEBUG_COMPILE_LEVEL becomes an empty object
+   and its DEBUG_DBG calls fold away, so neither the Debug object nor the
+   arguments cost anything. Otherwise expr is only evaluated when the keyword
+   is being debugged. Levels are DEBUG_LEVEL_PHASE ( runATPG and friends ),
+   DEBUG_LEVEL_STEP ( one per decision or propagation ) and DEBUG_LEVEL_GATE
+   ( per gate evaluation ). DEBUG_COMPILE_LEVEL defaults to DEBUG_LEVEL_GATE,
+   or to 0 with DEBUG_OFF. NDEBUG does not change it : the timing spans
+   and the call profile ( options P and C ) come from these scopes, and a
+   release build still has them. Define DEBUG_COMPILE_LEVEL to
+   DEBUG_LEVEL_PHASE to keep only the outer scopes in a fast build.
+   Function names and keywords are now matched on 64 bit FNV-1a hashes kept
+   in sorted vectors. DEBUG_ID computes the hash at compile time, so the
+   runtime check is a flag test and a binary search, with no string built.
+   DEBUG_DBG takes a single keyword, even with DEBUG_MULT_KWDS.
+9) Made Debug thread-aware.
+   Call depth, interval timers and the line being built are per thread, so
+   every thread gets its own indentation. Complete lines go to a DebugSink.
+   The option A enables asynchronous output : each thread writes into its
+   own lock-free ring and a background thread merges the rings by time
+   stamp onto the output stream. a goes back to synchronous output.
+      -x "T?D?A?O?trace.out"
+   specify() may be called from any thread. It publishes a new set of
+   keywords and flags that other threads pick up on their next check;
+   m clears the timers of the calling thread only.
+10) Added profiling spans for Chrome trace-event / Perfetto.
+   The option P records a TraceEvents span, with steady_clock nanosecond
+   time stamps, for every Debug scope and every TimeStart/TimeEnd pair,
+   per thread and independent of T and M. Keywords after P restrict it to
+   those function names or timer keywords, as with T. p stops recording.
+   Nothing is printed; TraceEvents::write saves the spans ( atpg -tj ).
+   Scope names are kept by pointer, so pass string literals.
+11) Added an aggregating call-tree profiler.
+   The option C feeds every Debug scope to CallProfile, which keeps per
+   thread call path statistics ( calls, inclusive and exclusive time ) in
+   memory instead of printing => and <= lines. c stops it. The table and
+   folded stacks are written by CallProfile::write ( atpg -cp ).
  */
 #ifndef DEBUG_CLASS_DEFINED
 #define DEBUG_CLASS_DEFINED 1
@@ -471,6 +510,8 @@
    #include <utility> // STL96: includes function.h, must be before string
    #include <string>
    #include <vector>
+   #include <type_traits>
+   #include <atomic>
 #ifdef STL96
    #include <iostream.h>
    #include <fstream.h>
@@ -483,11 +524,18 @@
 
 #define DECLARE_DEBUG(name) Debug D(name)
 
+typedef unsigned long long DebugId;
+inline constexpr DebugId debugHash(const char* s,DebugId h=14695981039346656037ULL){
+  return (0==*s) ? h : debugHash(s+1,(h^static_cast<unsigned char>(*s))*1099511628211ULL);
+}
+
 #ifdef DEBUG_OFF
 class Debug {
 public:
   Debug(const char* f,bool rawtimeMode=false,bool bEndLine=false){}
+  Debug(const char* f,DebugId id,bool bEndLine=false){}
     ~Debug() {}
+    static bool debugging(DebugId){ return false; }
     template<class T> void Dbg(const STD string& keyword, const STD string& description, T* pT){}
     template<class T> void Dbg(const STD string& keyword, const STD string& description, const T& tValue){}
                       void Dbg(const STD string& keyword, const STD string& description, char* pC) {}
@@ -512,21 +560,25 @@ public:
 #else
     Debug(const char* f,bool rawtimeMode=false,bool bEndLine=true);
 #endif
+    Debug(const char* f,DebugId id,bool bEndLine=false); // no function timing
     ~Debug();
+    static bool debugging(DebugId keyword); // for DEBUG_DBG
     void Dbg(const STD string& keyword, const STD string& description, char* pC);
     template<class T> void Dbg(const STD string& keyword, const STD string& description, const T* pT){
       if(!debugging(keyword)) return;
       indent();
       if(NULL==pT){
-        (*pDebugStream) << keyword << ": "<< description << " = NULL\n";
+        out() << keyword << ": "<< description << " = NULL\n";
       }else{
-        (*pDebugStream) << keyword << ": "<< description << " = " << (*pT) << "\n";
+        out() << keyword << ": "<< description << " = " << (*pT) << "\n";
       }
+      commit();
     }
     template<class T> void Dbg(const STD string& keyword, const STD string& description, const T& tValue){
       if(!debugging(keyword)) return;
       indent();
-      (*pDebugStream) << keyword << ": "<< description << " = " << tValue << "\n";
+      out() << keyword << ": "<< description << " = " << tValue << "\n";
+      commit();
     }
     void Dbg(const STD string& keyword, char* pC);
     template<class T> void Dbg(const STD string& keyword, const T* pT){
@@ -534,16 +586,18 @@ public:
       if(!debugging(keyword)) return;
       indent();
       if(NULL==pT){
-        (*pDebugStream) << keyword << ": NULL\n";
+        out() << keyword << ": NULL\n";
       }else{
-        (*pDebugStream) << keyword << ": " << (*pT) << "\n";
+        out() << keyword << ": " << (*pT) << "\n";
       }
+      commit();
     }
     template<class T> void Dbg(const STD string& keyword, const T& tValue){
       // cout <<"-print T&\n";
       if(!debugging(keyword)) return;
       indent();
-      (*pDebugStream) << keyword << ": "<< (const T) tValue << "\n";
+      out() << keyword << ": "<< (const T) tValue << "\n";
+      commit();
     }
     static void specify( const char * );
     static void TimeStart(const STD string &, const char *);
@@ -553,29 +607,47 @@ private:
     // Constants
     enum {limit = 12};// indentation limit for tracing
 
+    // Keywords and flags set by specify. Published whole, never modified
+    struct Filters{
+      Filters() : Debugging(false), Tracing(false), Timing(false), Profiling(false), CallProfiling(false) {}
+      bool Debugging; // Controls printing in Dbg calls
+      bool Tracing;   // Controls printing in ctor and dtor calls
+      bool Timing;    // Controls interval timing
+      bool Profiling; // Controls recording of TraceEvents spans
+      bool CallProfiling; // Controls CallProfile aggregation
+      STD vector<DebugId> keywords;  // sorted hashes
+      STD vector<DebugId> functions; // sorted hashes
+      STD vector<DebugId> profiled;  // sorted hashes
+      STD vector<STD string> timekeys;
+    };
+
     // Static members
-    static int level; // Counts the depth of function calling
-    static bool Debugging; // Controls printing in Dbg calls
-    static bool Tracing;   // Controls printing in ctor and dtor calls
-    static bool Timing;    // Controls interval timing
+    static thread_local int level; // Counts the depth of function calling, per thread
+    static const Filters defaultFilters;
+    static STD atomic<const Filters*> filters;
 
     static char separator;
     static STD string filename;
     static STD ofstream* pFile;
-    static STD ostream* pDebugStream;
+    static STD ostream* pDebugStream; // set by specify, written by the DebugSink
     static bool use_cout;
     static bool use_clog;
 
-    static STD vector<STD string> keywords;
-    static STD vector<STD string> functions;
-    static STD vector<STD string> timekeys;
-    static STD vector<STD pair<STD string, struct timeb> > timers;
-    static char mybuff[200];
+    static thread_local STD vector<STD pair<STD string, struct timeb> > timers;
+    static thread_local char mybuff[200];
 
     // Internal functions
+    static bool tracing(DebugId);
+    static bool profiling(DebugId);
+    static bool profiling(const char*);
+    void startProfile(const char* f,bool bProfiled);
+    static bool hasId(const STD vector<DebugId>&,DebugId);
+    static void addId(STD vector<DebugId>&,const STD string&);
     bool tracing(const STD string &); // Tells whether to do tracing or not
     bool debugging(const STD string &); // Tells whether to do debugging or not.
                     // Both of these look at the flag and at the vector.
+    static STD ostream& out(); // This thread's line buffer
+    static void commit();      // Sends out() to the DebugSink once it holds whole lines
     static void indent();  // Indents the output line
     void Enter(bool); // Gets us into a function with proper indents, printing the name of the function.
     void Exit();    // Gets us out of a function with proper indents.
@@ -586,6 +658,10 @@ private:
 
     // object data;
     STD string function_name;
+    bool traced;
+    bool call_profiled;
+    const char* profile_name; // NULL unless this scope is profiled
+    unsigned long long profile_start;
     bool timing;
     bool raw_time;
     bool going_in;
@@ -593,6 +669,36 @@ private:
 };
 
 #endif
+
+// ------------------------------------------------------------
+// class DebugScope, see 8) above
+// ------------------------------------------------------------
+#define DEBUG_LEVEL_PHASE 1
+#define DEBUG_LEVEL_STEP  2
+#define DEBUG_LEVEL_GATE  3
+#ifndef DEBUG_COMPILE_LEVEL
+#  if defined(DEBUG_OFF)
+#    define DEBUG_COMPILE_LEVEL 0
+#  else
+#    define DEBUG_COMPILE_LEVEL DEBUG_LEVEL_GATE
+#  endif
+#endif
+
+template<bool Enabled> class DebugScope;
+template<> class DebugScope<false>{
+public:
+  DebugScope(const char*,DebugId){}
+  static bool debugging(DebugId){ return false; }
+  template<class... Args> void Dbg(const Args&...){}
+};
+template<> class DebugScope<true> : public Debug{
+public:
+  DebugScope(const char* f,DebugId id) : Debug(f,id) {}
+};
+
+#define DEBUG_ID(name) (std::integral_constant<DebugId,debugHash(name)>::value)
+#define DEBUG_SCOPE(level,name) DebugScope<((level)<=DEBUG_COMPILE_LEVEL)> D(name,DEBUG_ID(name))
+#define DEBUG_DBG(keyword,...) do{ if(D.debugging(DEBUG_ID(keyword))) D.Dbg(keyword,__VA_ARGS__); }while(0)
 #endif
 
 
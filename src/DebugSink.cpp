@@ -0,0 +1,194 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "DebugSink.hpp"
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+using namespace std;
+
+// ------------------------------------------------------------
+// class DebugRing
+// ------------------------------------------------------------
+namespace{
+  const size_t HeaderBytes=2*sizeof(unsigned long long);
+  size_t padded(size_t n){ return (n+7)&~static_cast<size_t>(7); }
+  bool earlier(const DebugRing::Record& a,const DebugRing::Record& b){ return a.stamp<b.stamp; }
+}
+DebugRing::DebugRing(size_t index,size_t capacity) :
+  _buffer(capacity), _mask(capacity-1), _index(index), _head(0), _tail(0) {}
+
+void DebugRing::copyIn(size_t at,const void* p,size_t n){
+  size_t start=at&_mask;
+  size_t first=min(n,_buffer.size()-start);
+  memcpy(&_buffer[start],p,first);
+  if(first<n) memcpy(&_buffer[0],static_cast<const char*>(p)+first,n-first);
+}
+void DebugRing::copyOut(size_t at,void* p,size_t n) const{
+  size_t start=at&_mask;
+  size_t first=min(n,_buffer.size()-start);
+  memcpy(p,&_buffer[start],first);
+  if(first<n) memcpy(static_cast<char*>(p)+first,&_buffer[0],n-first);
+}
+bool DebugRing::push(unsigned long long stamp,const char* p,size_t n){
+  size_t head=_head.load(memory_order_relaxed);
+  size_t tail=_tail.load(memory_order_acquire);
+  size_t need=HeaderBytes+padded(n);
+  if(_buffer.size()-(head-tail)<need) return false;
+  unsigned long long length=n;
+  copyIn(head,&stamp,sizeof(stamp));
+  copyIn(head+sizeof(stamp),&length,sizeof(length));
+  copyIn(head+HeaderBytes,p,n);
+  _head.store(head+need,memory_order_release);
+  return true;
+}
+void DebugRing::drain(vector<Record>& records,string& text){
+  size_t tail=_tail.load(memory_order_relaxed);
+  size_t head=_head.load(memory_order_acquire);
+  while(tail!=head){
+    Record r;
+    unsigned long long length;
+    copyOut(tail,&r.stamp,sizeof(r.stamp));
+    copyOut(tail+sizeof(r.stamp),&length,sizeof(length));
+    r.ring=_index;
+    r.offset=text.size();
+    r.length=static_cast<size_t>(length);
+    text.resize(r.offset+r.length);
+    copyOut(tail+HeaderBytes,&text[r.offset],r.length);
+    records.push_back(r);
+    tail+=HeaderBytes+padded(r.length);
+  }
+  _tail.store(tail,memory_order_release);
+}
+// ------------------------------------------------------------
+// class DebugSink
+// ------------------------------------------------------------
+DebugSink& DebugSink::instance(){
+  static DebugSink sink;
+  return sink;
+}
+DebugSink::DebugSink() : _pStream(&clog), _async(false), _stopping(false), _rings(retireRing), _nextIndex(0) {}
+DebugSink::~DebugSink(){
+  setAsync(false);
+  sync();
+  lock_guard<mutex> lock(_rings.mutex());
+  for(size_t i=0;i<_rings.live().size();++i) delete _rings.live()[i]->pRing;
+  for(size_t i=0;i<_rings.retired().size();++i) delete _rings.retired()[i];
+}
+unsigned long long DebugSink::now(){
+  return static_cast<unsigned long long>(chrono::duration_cast<chrono::nanoseconds>(
+    chrono::steady_clock::now().time_since_epoch()).count());
+}
+void DebugSink::retireRing(ThreadRing& t,vector<DebugRing*>& retired){
+  if(0!=t.pRing) retired.push_back(t.pRing);
+}
+DebugRing* DebugSink::threadRing(){
+/* One ring per logging thread, created on its first asynchronous write.
+   The ring outlives the thread until the writer has drained it.
+*/
+  ThreadRing& t=_rings.local();
+  if(0==t.pRing){
+    lock_guard<mutex> lock(_rings.mutex());
+    t.pRing=new DebugRing(_nextIndex++,RingBytes);
+  }
+  return t.pRing;
+}
+void DebugSink::write(const string& lines){
+  if(!isAsync()){
+    lock_guard<mutex> lock(_streamMutex);
+    (*_pStream) << lines;
+    return;
+  }
+  DebugRing* pRing=threadRing();
+  size_t n=min(lines.size(),static_cast<size_t>(RingBytes)-HeaderBytes-8); // longer lines are cut
+  unsigned long long stamp=now();
+  while(!pRing->push(stamp,lines.data(),n)){
+    if(isAsync()){
+      this_thread::yield(); // ring full, let the writer catch up
+    }else{                  // switched to synchronous while we waited
+      lock_guard<mutex> lock(_drainMutex);
+      drain();
+    }
+  }
+}
+bool DebugSink::drain(){
+/* Takes everything currently in the rings, merges it by time stamp and
+   writes it out. Returns false if there was nothing to write.
+*/
+  vector<DebugRing*> rings;
+  {
+    lock_guard<mutex> lock(_rings.mutex());
+    for(size_t i=0;i<_rings.live().size();++i) if(0!=_rings.live()[i]->pRing) rings.push_back(_rings.live()[i]->pRing);
+    rings.insert(rings.end(),_rings.retired().begin(),_rings.retired().end());
+  }
+  _records.clear();
+  _text.clear();
+  for(size_t i=0;i<rings.size();++i) rings[i]->drain(_records,_text);
+  if(_records.empty()){
+    lock_guard<mutex> lock(_rings.mutex()); // reclaim rings of finished threads
+    vector<DebugRing*>& retired=_rings.retired();
+    for(size_t i=0;i<retired.size();){
+      if(retired[i]->empty()){
+        delete retired[i];
+        retired.erase(retired.begin()+i);
+      }else{
+        ++i;
+      }
+    }
+    return false;
+  }
+  stable_sort(_records.begin(),_records.end(),earlier); // keeps per-ring order on ties
+  _merged.clear();
+  for(size_t i=0;i<_records.size();++i) _merged.append(&_text[_records[i].offset],_records[i].length);
+  lock_guard<mutex> lock(_streamMutex);
+  _pStream->write(_merged.data(),_merged.size());
+  return true;
+}
+void DebugSink::run(){
+  bool bDirty=false;
+  while(!_stopping.load(memory_order_acquire)){
+    bool bWrote;
+    {
+      lock_guard<mutex> lock(_drainMutex);
+      bWrote=drain();
+    }
+    if(bWrote){
+      bDirty=true;
+    }else{
+      if(bDirty){
+        lock_guard<mutex> lock(_streamMutex);
+        _pStream->flush();
+        bDirty=false;
+      }
+      this_thread::sleep_for(chrono::microseconds(500));
+    }
+  }
+}
+void DebugSink::setAsync(bool bAsync){
+  if(bAsync==isAsync()) return;
+  if(bAsync){
+    _stopping.store(false,memory_order_release);
+    _async.store(true,memory_order_release);
+    _thread=thread(&DebugSink::run,this);
+  }else{
+    _async.store(false,memory_order_release);
+    _stopping.store(true,memory_order_release);
+    if(_thread.joinable()) _thread.join();
+    sync();
+  }
+}
+void DebugSink::sync(){
+  {
+    lock_guard<mutex> lock(_drainMutex);
+    while(drain());
+  }
+  lock_guard<mutex> lock(_streamMutex);
+  _pStream->flush();
+}
+void DebugSink::setStream(ostream* pStream){
+  sync();
+  lock_guard<mutex> lock(_streamMutex);
+  _pStream=pStream;
+}
@@ -0,0 +1,102 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __DebugSink__
+#define __DebugSink__
+#include <string>
+#include <vector>
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include "ThreadRegistry.hpp"
+
+// ------------------------------------------------------------
+// class DebugRing
+// ------------------------------------------------------------
+class DebugRing{
+/* Lock-free single producer, single consumer byte ring of time stamped
+   records. The owning thread is the only producer; the DebugSink writer
+   ( or whoever holds the sink's drain lock ) is the only consumer.
+   Record layout : uint64 time stamp, uint64 length, characters, padded
+   to 8 bytes. Records may wrap around the end of the buffer.
+   NB - not copyable.
+ */
+public:
+  struct Record{
+    unsigned long long stamp;
+    std::size_t ring;     // index of the ring in the sink
+    std::size_t offset;   // into the drain scratch text
+    std::size_t length;
+  };
+  DebugRing(std::size_t index,std::size_t capacity); // capacity is a power of 2
+  bool push(unsigned long long stamp,const char* p,std::size_t n); // false if full
+  void drain(std::vector<Record>& records,std::string& text); // appends and consumes
+  bool empty() const { return _head.load(std::memory_order_acquire)==_tail.load(std::memory_order_relaxed); }
+  std::size_t getIndex() const { return _index; }
+private:
+  DebugRing(const DebugRing&);
+  DebugRing& operator=(const DebugRing&);
+  void copyIn(std::size_t at,const void* p,std::size_t n);
+  void copyOut(std::size_t at,void* p,std::size_t n) const;
+
+  std::vector<char> _buffer;
+  std::size_t _mask;
+  std::size_t _index;
+  alignas(64) std::atomic<std::size_t> _head; // producer
+  alignas(64) std::atomic<std::size_t> _tail; // consumer
+};
+// ------------------------------------------------------------
+// class DebugSink
+// ------------------------------------------------------------
+class DebugSink{
+/* Destination of all Debug output. Debug builds each line in a per-thread
+   buffer and hands complete lines to write().
+   Synchronous mode ( default ) writes the line to the stream under a mutex,
+   so lines from different threads never mix and the order against other
+   program output is kept.
+   Asynchronous mode ( Debug option A ) gives every logging thread its own
+   DebugRing. write() only copies the line into the ring, and a background
+   writer drains all rings, merges their records by time stamp and writes
+   them to the stream. Per-thread order is always preserved. A producer only
+   waits when its ring is full.
+   NB - one instance, see instance(). Not copyable.
+ */
+public:
+  static DebugSink& instance();
+  ~DebugSink();
+  void write(const std::string& lines);
+  void setStream(std::ostream* pStream);
+  void setAsync(bool bAsync);
+  bool isAsync() const { return _async.load(std::memory_order_relaxed); }
+  void sync(); // everything written so far is flushed to the stream
+private:
+  DebugSink();
+  DebugSink(const DebugSink&);
+  DebugSink& operator=(const DebugSink&);
+  struct ThreadRing{
+    ThreadRing() : pRing(0) {}
+    DebugRing* pRing; // made on the first asynchronous write
+  };
+  static void retireRing(ThreadRing& t,std::vector<DebugRing*>& retired);
+  DebugRing* threadRing();
+  bool drain();  // caller holds _drainMutex
+  void run();
+  static unsigned long long now();
+
+  enum{RingBytes=1<<20};
+  std::ostream* _pStream;
+  std::atomic<bool> _async;
+  std::atomic<bool> _stopping;
+  std::mutex _streamMutex;             // synchronous writes and stream changes
+  std::mutex _drainMutex;              // single consumer of the rings
+  ThreadRegistry<ThreadRing,std::vector<DebugRing*> > _rings; // retired : rings of exited threads, until drained
+  std::size_t _nextIndex;              // under _rings.mutex()
+  std::vector<DebugRing::Record> _records; // drain scratch
+  std::string _text;                       // drain scratch
+  std::string _merged;                     // drain scratch, in time order
+  std::thread _thread;
+};
+#endif // __DebugSink__
@@ -0,0 +1,348 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "DotStore.hpp"
+#include "Netlist.hpp"
+#include "MemStats.hpp"
+#include <algorithm>
+#include <sstream>
+#include <ctype.h>
+#include <string.h>
+using namespace std;
+
+struct DotStore::Token{
+  enum Type{End,Name,Punct,Bad};
+  Type type;
+  const char* begin;
+  size_t length;
+  bool bEscaped; // quoted with \" or a line continuation inside
+  char punct;    // { } [ ] = ; , : and '>' for ->, '-' for --
+};
+class DotStore::Lexer{
+/* Splits the file text into names and punctuation. A name is an
+   identifier, a numeral, a quoted string or an <html> string, its token
+   points into the text without the quotes.
+*/
+public:
+  Lexer(const char* begin,const char* end) : _p(begin), _end(end), _begin(begin), _line(1) {}
+  Token next(){
+    skip();
+    Token t;
+    t.type=Token::Name;
+    t.begin=_p;
+    t.length=0;
+    t.bEscaped=false;
+    t.punct=0;
+    if(_p>=_end){ t.type=Token::End; return t; }
+    char c=*_p;
+    if('"'==c){
+      t.begin=++_p;
+      while(_p<_end && '"'!=*_p){
+        if('\\'==*_p && _p+1<_end && ('"'==_p[1] || '\n'==_p[1])){ t.bEscaped=true; ++_p; }
+        if('\n'==*_p) ++_line;
+        ++_p;
+      }
+      if(_p>=_end){ t.type=Token::Bad; return t; }
+      t.length=_p-t.begin;
+      ++_p;
+      return t;
+    }
+    if('<'==c){
+      int depth=0;
+      t.begin=_p+1;
+      for(;_p<_end;++_p){
+        if('<'==*_p) ++depth;
+        else if('>'==*_p && 0==--depth) break;
+        else if('\n'==*_p) ++_line;
+      }
+      if(_p>=_end){ t.type=Token::Bad; return t; }
+      t.length=_p-t.begin;
+      ++_p;
+      return t;
+    }
+    if('-'==c && _p+1<_end && ('>'==_p[1] || '-'==_p[1])){
+      t.type=Token::Punct;
+      t.punct=('>'==_p[1]) ? '>' : '-';
+      _p+=2;
+      return t;
+    }
+    if(strchr("{}[]=;,:",c)){
+      t.type=Token::Punct;
+      t.punct=c;
+      ++_p;
+      return t;
+    }
+    while(_p<_end && (isalnum(static_cast<unsigned char>(*_p)) || '_'==*_p || '.'==*_p || '-'==*_p || *_p<0)){
+      if('-'==*_p && _p+1<_end && ('>'==_p[1] || '-'==_p[1])) break;
+      ++_p;
+    }
+    t.length=_p-t.begin;
+    if(0==t.length) t.type=Token::Bad;
+    return t;
+  }
+  Token peek(){
+    const char* p=_p;
+    unsigned line=_line;
+    Token t=next();
+    _p=p;
+    _line=line;
+    return t;
+  }
+  unsigned line() const { return _line; }
+  static bool isKeyword(const Token& t,const char* word){
+    size_t n=strlen(word);
+    if(t.length!=n) return false;
+    for(size_t i=0;i<n;++i) if(tolower(static_cast<unsigned char>(t.begin[i]))!=word[i]) return false;
+    return true;
+  }
+  static string text(const Token& t){
+  /* value of a name, with the escapes of a quoted string resolved */
+    if(!t.bEscaped) return string(t.begin,t.length);
+    string s;
+    s.reserve(t.length);
+    for(size_t i=0;i<t.length;++i){
+      if('\\'==t.begin[i] && i+1<t.length && '"'==t.begin[i+1]) continue;
+      if('\\'==t.begin[i] && i+1<t.length && '\n'==t.begin[i+1]){ ++i; continue; }
+      s+=t.begin[i];
+    }
+    return s;
+  }
+  static StringPool::Id intern(const Token& t){
+    if(!t.bEscaped) return StringPool::global().intern(t.begin,t.length);
+    return StringPool::global().intern(text(t));
+  }
+private:
+  void skip(){
+  /* white space and comments, # lines are C preprocessor output */
+    while(_p<_end){
+      if('\n'==*_p){ ++_line; ++_p; }
+      else if(isspace(static_cast<unsigned char>(*_p))) ++_p;
+      else if('/'==*_p && _p+1<_end && '/'==_p[1]) skipLine();
+      else if('#'==*_p && (_p==_begin || '\n'==_p[-1])) skipLine();
+      else if('/'==*_p && _p+1<_end && '*'==_p[1]){
+        for(_p+=2;_p<_end && !('*'==*_p && _p+1<_end && '/'==_p[1]);++_p) if('\n'==*_p) ++_line;
+        _p=(_p<_end) ? _p+2 : _end;
+      }else break;
+    }
+  }
+  void skipLine(){ while(_p<_end && '\n'!=*_p) ++_p; }
+  const char* _p;
+  const char* _end;
+  const char* _begin;
+  unsigned _line;
+};
+DotStore::DotStore(bool bKeepAll) : _bKeepAll(bKeepAll) {
+  _labelKey=StringPool::global().intern("label");
+  _nodeIdKey=StringPool::global().intern("node_id");
+}
+bool DotStore::fail(const Lexer& lex,const string& message){
+  ostringstream os;
+  os << message << " at line " << lex.line();
+  _error=os.str();
+  return false;
+}
+bool DotStore::read(const string& path){
+  MEMSTATS_TAG(MemStats::Graph);
+  _error.clear();
+  if(!_file.openRead(path)){
+    _error="Cannot read "+path;
+    return false;
+  }
+  _file.sequential();
+  if(_bKeepAll && _file.size()>~0u){
+    _file.close();
+    _error=path+" is too large to keep attributes";
+    return false;
+  }
+  Lexer lex(_file.data(),_file.data()+_file.size());
+  bool bGood=parse(lex);
+  if(bGood){
+    // number the vertices in node_id order, as read_graphviz does
+    StringPool& pool=StringPool::global();
+    vector<Index> order(numVertices());
+    for(Index v=0;v<order.size();++v) order[v]=v;
+    sort(order.begin(),order.end(),[&](Index a,Index b){ return strcmp(pool.c_str(_nodeId[a]),pool.c_str(_nodeId[b]))<0; });
+    vector<Index> renumber(order.size());
+    vector<Id> nodeId(order.size()),name(order.size()),func(order.size());
+    for(Index v=0;v<order.size();++v){
+      renumber[order[v]]=v;
+      nodeId[v]=_nodeId[order[v]];
+      name[v]=_name[order[v]];
+      func[v]=_func[order[v]];
+    }
+    _nodeId.swap(nodeId);
+    _name.swap(name);
+    _func.swap(func);
+    _byNodeId.clear();
+    for(Index v=0;v<numVertices();++v) _byNodeId.insert(_nodeId,v);
+    for(Index e=0;e<numEdges();++e){
+      _source[e]=renumber[_source[e]];
+      _target[e]=renumber[_target[e]];
+    }
+    for(size_t a=0;a<_attrs[Vertex].size();++a) _attrs[Vertex][a].owner=renumber[_attrs[Vertex][a].owner];
+    for(int k=Vertex;k<=Edge;++k) stable_sort(_attrs[k].begin(),_attrs[k].end());
+  }
+  if(!bGood || !_bKeepAll) _file.close();
+  return bGood;
+}
+bool DotStore::parse(Lexer& lex){
+  Token t=lex.next();
+  if(Token::Name==t.type && Lexer::isKeyword(t,"strict")) t=lex.next();
+  if(Token::Name==t.type && Lexer::isKeyword(t,"graph")) return fail(lex,"Graph file type not supported");
+  if(Token::Name!=t.type || !Lexer::isKeyword(t,"digraph")) return fail(lex,"Expected digraph");
+  t=lex.next();
+  if(Token::Name==t.type) t=lex.next();
+  if(Token::Punct!=t.type || '{'!=t.punct) return fail(lex,"Expected {");
+  vector<Token> nodeDefaults,edgeDefaults,attrs,chain;
+  for(;;){
+    t=lex.next();
+    if(Token::End==t.type) return fail(lex,"Missing }");
+    if(Token::Bad==t.type) return fail(lex,"Bad token");
+    if(Token::Punct==t.type){
+      if('}'==t.punct) break;
+      if(';'==t.punct) continue;
+      return fail(lex,string("Unexpected ")+t.punct);
+    }
+    if(Lexer::isKeyword(t,"subgraph")) return fail(lex,"Subgraphs not supported");
+    if(Lexer::isKeyword(t,"node") || Lexer::isKeyword(t,"edge") || Lexer::isKeyword(t,"graph")){
+      attrs.clear();
+      if(!parseAttrList(lex,attrs)) return false;
+      if(Lexer::isKeyword(t,"node")) nodeDefaults.insert(nodeDefaults.end(),attrs.begin(),attrs.end());
+      else if(Lexer::isKeyword(t,"edge")) edgeDefaults.insert(edgeDefaults.end(),attrs.begin(),attrs.end());
+      continue;
+    }
+    Token n=lex.peek();
+    if(Token::Punct==n.type && '='==n.punct){ // graph attribute
+      lex.next();
+      if(Token::Name!=lex.next().type) return fail(lex,"Expected attribute value");
+      continue;
+    }
+    chain.assign(1,t);
+    for(;;){
+      n=lex.peek();
+      if(Token::Punct==n.type && ':'==n.punct){ // port, and compass point
+        lex.next();
+        if(Token::Name!=lex.next().type) return fail(lex,"Expected port");
+        continue;
+      }
+      if(Token::Punct==n.type && '-'==n.punct) return fail(lex,"Undirected edge in a digraph");
+      if(Token::Punct!=n.type || '>'!=n.punct) break;
+      lex.next();
+      Token target=lex.next();
+      if(Token::Name!=target.type) return fail(lex,"Expected edge target");
+      chain.push_back(target);
+    }
+    attrs.clear();
+    if(!parseAttrList(lex,attrs)) return false;
+    Index first=vertex(chain[0],nodeDefaults);
+    if(1==chain.size()){
+      apply(Vertex,first,attrs);
+      continue;
+    }
+    for(size_t i=1;i<chain.size();++i){
+      Index target=vertex(chain[i],nodeDefaults);
+      Index e=static_cast<Index>(numEdges());
+      _source.push_back(first);
+      _target.push_back(target);
+      _edgeLabel.push_back(StringPool::NoId);
+      apply(Edge,e,edgeDefaults);
+      apply(Edge,e,attrs);
+      first=target;
+    }
+  }
+  return true;
+}
+bool DotStore::parseAttrList(Lexer& lex,vector<Token>& attrs){
+/* Zero or more [ key=value, ... ], appended to attrs as key, value pairs */
+  for(;;){
+    Token t=lex.peek();
+    if(Token::Punct!=t.type || '['!=t.punct) return true;
+    lex.next();
+    for(;;){
+      Token key=lex.next();
+      if(Token::Punct==key.type && ']'==key.punct) break;
+      if(Token::Punct==key.type && (','==key.punct || ';'==key.punct)) continue;
+      if(Token::Name!=key.type) return fail(lex,"Expected attribute name");
+      Token eq=lex.next();
+      if(Token::Punct!=eq.type || '='!=eq.punct) return fail(lex,"Expected =");
+      Token value=lex.next();
+      if(Token::Name!=value.type) return fail(lex,"Expected attribute value");
+      attrs.push_back(key);
+      attrs.push_back(value);
+    }
+  }
+}
+DotStore::Index DotStore::vertex(const Token& t,const vector<Token>& defaults){
+  Id id=Lexer::intern(t);
+  Index v=_byNodeId.find(_nodeId,id);
+  if(IdIndex::None!=v) return v;
+  v=static_cast<Index>(numVertices());
+  _nodeId.push_back(id);
+  _name.push_back(StringPool::global().intern("",0));
+  _func.push_back(StringPool::NoId);
+  _byNodeId.insert(_nodeId,v);
+  apply(Vertex,v,defaults);
+  return v;
+}
+void DotStore::apply(Kind kind,Index i,const vector<Token>& attrs){
+  StringPool& pool=StringPool::global();
+  for(size_t a=0;a+1<attrs.size();a+=2){
+    const Token& key=attrs[a];
+    const Token& value=attrs[a+1];
+    Id keyId=Lexer::intern(key);
+    if(_labelKey==keyId){
+      if(Edge==kind){
+        _edgeLabel[i]=Lexer::intern(value);
+      }else{
+        // label == name:func, with default func==noop, as NodeHelper
+        string label=Lexer::text(value);
+        string::size_type colon=label.find(':');
+        _name[i]=pool.intern(label.substr(0,colon));
+        _func[i]=(string::npos==colon) ? StringPool::NoId : pool.intern(label.substr(colon+1));
+      }
+    }else if(_bKeepAll){
+      Attr r;
+      r.owner=i;
+      r.key=keyId;
+      r.offset=static_cast<unsigned>(value.begin-_file.data());
+      r.length=static_cast<unsigned>(value.length);
+      _attrs[kind].push_back(r);
+    }
+  }
+}
+string DotStore::value(Kind kind,Index i,const string& key) const{
+  StringPool& pool=StringPool::global();
+  Id keyId=pool.find(key);
+  if(StringPool::NoId==keyId) return "";
+  if(_labelKey==keyId){
+    if(Edge==kind) return (StringPool::NoId==_edgeLabel[i]) ? "" : pool.str(_edgeLabel[i]);
+    return (StringPool::NoId==_func[i]) ? pool.str(_name[i]) : pool.str(_name[i])+":"+pool.str(_func[i]);
+  }
+  if(Vertex==kind && _nodeIdKey==keyId) return pool.str(_nodeId[i]);
+  Attr probe={i,StringPool::NoId,0,0};
+  pair<vector<Attr>::const_iterator,vector<Attr>::const_iterator> range=equal_range(_attrs[kind].begin(),_attrs[kind].end(),probe);
+  for(vector<Attr>::const_iterator it=range.second;it!=range.first;){
+    --it; // the last one set wins
+    if(it->key==keyId) return string(_file.data()+it->offset,it->length);
+  }
+  return "";
+}
+bool DotStore::compile(Netlist& n) const{
+/* One gate per vertex, one fanin per edge, as RunGraph::compileNetlist */
+  MEMSTATS_TAG(MemStats::Netlist);
+  StringPool& pool=StringPool::global();
+  Id noop=pool.intern("noop");
+  for(Index v=0;v<numVertices();++v){
+    n.addGate(_name[v],pool.str((StringPool::NoId==_func[v]) ? noop : _func[v]));
+  }
+  for(Index e=0;e<numEdges();++e) n.addFanin(_target[e],_source[e]);
+  return n.levelize();
+}
+size_t DotStore::bytes() const{
+  return (_nodeId.capacity()+_name.capacity()+_func.capacity()+_edgeLabel.capacity())*sizeof(Id)
+        +(_source.capacity()+_target.capacity())*sizeof(Index)
+        +(_attrs[Vertex].capacity()+_attrs[Edge].capacity())*sizeof(Attr)
+        +_byNodeId.bytes();
+}
@@ -0,0 +1,102 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __DotStore__
+#define __DotStore__
+#include <string>
+#include <vector>
+#include "StringPool.hpp"
+#include "MappedNetlist.hpp"
+
+class Netlist;
+// ------------------------------------------------------------
+// class DotStore
+// ------------------------------------------------------------
+class DotStore{
+/* Compact attribute store for a digraph dot file, read without the BGL
+   graph and its GraphvizAttrList maps.
+
+   RunGraph gives every vertex and edge a std::map<string,string>, so the
+   layout attributes dot writes ( color, fontname, fontsize, pos, ... ) cost
+   a map node and two strings each, kilobytes per gate. DotStore keeps only
+   what the tool reads, interned in StringPool::global()
+      vertex   node_id, and the label split as NodeHelper does, name and func
+      edge     source and target vertex, label
+   which is 12 bytes per vertex and per edge, plus the name characters.
+   Keys and repeated values ( "in", "nand", "X", "ONE" ) are stored once.
+
+   With bKeepAll the file stays mapped and every other attribute is kept as
+   a 16 byte record { owner, interned key, offset, length } into the file
+   text, raw as written there, without the quotes and with escapes as is.
+
+   Vertices are numbered in node_id order, as read_graphviz does ( its
+   node table is a std::map ), so compile() gives the same gate ids, and
+   the same PI/PO order, as RunGraph::compileNetlist.
+
+   Reads the dot subset the tool writes and reads : node, edge and default
+   attribute statements ( node [...], edge [...] ), graph attributes, which
+   are skipped, ports, which are dropped, and line, block and # comments.
+   Subgraphs and undirected graphs are errors.
+
+   Usage :
+      DotStore dot;
+      if(!dot.read("f.dot")) cout << "Error! " << dot.error() << "\n";
+      Netlist n;
+      dot.compile(n);
+   NB - not copyable. Files with attributes kept must be under 4 GB
+ */
+public:
+  typedef StringPool::Id Id;
+  typedef unsigned Index;
+  enum Kind{Vertex,Edge};
+
+  explicit DotStore(bool bKeepAll=false);
+  bool read(const std::string& path);
+  const std::string& error() const { return _error; }
+  bool compile(Netlist& n) const; // false if the netlist has a combinational loop
+
+  std::size_t numVertices() const { return _nodeId.size(); }
+  std::size_t numEdges() const { return _source.size(); }
+  Id getNodeId(Index v) const { return _nodeId[v]; }
+  Id getName(Index v) const { return _name[v]; }
+  Id getFunc(Index v) const { return _func[v]; }       // NoId without ':' in the label
+  Index getSource(Index e) const { return _source[e]; }
+  Index getTarget(Index e) const { return _target[e]; }
+  Id getEdgeLabel(Index e) const { return _edgeLabel[e]; } // NoId without label
+  std::string value(Kind kind,Index i,const std::string& key) const; // "" if not set or not kept
+  std::size_t bytes() const; // heap held, the string pool and the mapped file excluded
+private:
+  DotStore(const DotStore&);
+  DotStore& operator=(const DotStore&);
+  struct Attr{
+    Index owner;
+    Id key;
+    unsigned offset; // into the file
+    unsigned length;
+    bool operator<(const Attr& rhs) const { return owner<rhs.owner; }
+  };
+  struct Token;
+  class Lexer;
+  bool parse(Lexer& lex);
+  bool parseAttrList(Lexer& lex,std::vector<Token>& attrs);
+  Index vertex(const Token& t,const std::vector<Token>& defaults); // adds it if new
+  void apply(Kind kind,Index i,const std::vector<Token>& attrs);
+  bool fail(const Lexer& lex,const std::string& message);
+
+  bool _bKeepAll;
+  std::string _error;
+  MappedFile _file;           // only kept open with bKeepAll
+  std::vector<Id> _nodeId;
+  std::vector<Id> _name;
+  std::vector<Id> _func;
+  IdIndex _byNodeId;
+  std::vector<Index> _source;
+  std::vector<Index> _target;
+  std::vector<Id> _edgeLabel;
+  std::vector<Attr> _attrs[2]; // the rest, by Kind, sorted by owner
+  Id _labelKey;
+  Id _nodeIdKey;
+};
+#endif // __DotStore__
@@ -0,0 +1,191 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __FaultSim__
+#define __FaultSim__
+#include <vector>
+#include <type_traits>
+#include "Netlist.hpp"
+#include "LogicAlgebra.hpp"
+
+// ------------------------------------------------------------
+// class FaultSim
+// ------------------------------------------------------------
+template<class V>
+class FaultSim{
+/* Single pattern, event driven stuck-at fault simulator over a levelized
+   Netlist, in the algebra LogicAlgebra<V>.
+
+   simulate evaluates the good machine over Netlist::getSchedule, in 3
+   values whatever V, the cheapest algebra that holds it, and sets every
+   value of V from it. detects
+   then injects one fault, stuck on the output of a gate ( pin Stem ) or on
+   one of its fanin pins, and evaluates only the gates whose inputs
+   changed, level by level, until the change dies out or a fault effect
+   reaches an out gate. The good values are restored before it returns, so
+   every fault of a fault list runs against the same good machine.
+
+   The algebra decides what the simulator can see : FiveValued is the
+   D-calculus of the ATPG engine; NineValued keeps the known half of a
+   pair, so an effect that meets an X and reconverges can still be
+   detected. ThreeValued holds one machine, so the values are those of the
+   faulty machine alone, the fault site is the stuck value, and an out gate
+   detects when its value and the good one are known and differ. That sees
+   what NineValued sees, on the smallest tables.
+
+   checkpointFaults lists the faults runFaultList targets : both polarities
+   on every fanout branch of a stem with more than one fanout and on every
+   branch of a PI.
+
+   Usage :
+      FaultSim<NineValued> sim(netlist);
+      sim.setInput(i,NineValued::One);   // for each PI, X if not set
+      sim.simulate();
+      vector<FaultSim<NineValued>::Fault> faults;
+      FaultSim<NineValued>::checkpointFaults(netlist,faults);
+      bool bDetected=sim.detects(faults[0]);
+   NB - compiler defaults of destructor, copy constructor sufficient
+ */
+public:
+  typedef LogicAlgebra<V> Algebra;
+  typedef LogicAlgebra<ThreeValued> GoodAlgebra;
+  typedef typename Algebra::Value Value;
+  static const bool bOneMachine=std::is_same<V,ThreeValued>::value; // the faulty machine alone
+  typedef Netlist::GateId GateId;
+  static const unsigned Stem=~0u;
+  struct Fault{
+    GateId gate;
+    unsigned pin; // into fanins(gate), or Stem for the output
+    bool stuckAt;
+  };
+
+  FaultSim(const Netlist& n);
+  void setInput(std::size_t piIndex,unsigned v){ // v known in both machines, or X
+    GateId g=_n.getInputs()[piIndex];
+    _value[g]=static_cast<Value>(v);
+    _good[g]=static_cast<Value>(V::good(v));
+  }
+  void simulate();
+  bool detects(const Fault& f);
+  unsigned getValue(GateId g) const { return _value[g]; }
+  unsigned getGood(GateId g) const { return _good[g]; } // ThreeValued
+  const Netlist& getNetlist() const { return _n; }
+  static void checkpointFaults(const Netlist& n,std::vector<Fault>& faults);
+private:
+  FaultSim();
+  FaultSim& operator=(const FaultSim&);
+  unsigned evaluate(GateId g,unsigned pin,unsigned pinValue);
+  unsigned evaluateGood(GateId g);
+  static unsigned inject(unsigned v,bool stuckAt){
+    return bOneMachine ? Algebra::fromBool(stuckAt) : Algebra::inject(v,stuckAt);
+  }
+  bool isEffect(GateId g,unsigned v) const {
+    return bOneMachine ? (ThreeValued::X!=v && ThreeValued::X!=_good[g] && v!=_good[g]) : Algebra::isEffect(v);
+  }
+  bool change(GateId g,unsigned v); // true for a fault effect on an out gate
+  void schedule(GateId g);
+
+  const Netlist& _n;
+  std::vector<Value> _value;
+  std::vector<Value> _good;                   // good machine, ThreeValued
+  std::vector<Value> _in;                     // fanin values of the gate being evaluated
+  std::vector<std::vector<GateId> > _level;   // gates to evaluate, by level
+  std::vector<char> _queued;
+  std::vector<std::pair<GateId,Value> > _saved; // good values overwritten by detects
+};
+
+template<class V>
+const unsigned FaultSim<V>::Stem;
+template<class V>
+const bool FaultSim<V>::bOneMachine;
+
+template<class V>
+FaultSim<V>::FaultSim(const Netlist& n)
+  : _n(n), _value(n.size(),static_cast<Value>(Algebra::unknown())), _good(n.size(),static_cast<Value>(ThreeValued::X)), _level(n.getDepth()+1), _queued(n.size(),0) {
+  unsigned maxFanin=0;
+  for(GateId g=0;g<n.size();++g) if(n.numFanins(g)>maxFanin) maxFanin=n.numFanins(g);
+  _in.resize(maxFanin+1);
+}
+template<class V>
+void FaultSim<V>::simulate(){
+  const std::vector<GateId>& order=_n.getSchedule();
+  for(std::size_t i=0;i<order.size();++i){
+    GateId g=order[i];
+    if(Netlist::In==_n.getType(g)) continue;
+    _good[g]=static_cast<Value>(evaluateGood(g));
+    _value[g]=static_cast<Value>(V::value(_good[g],_good[g]));
+  }
+}
+template<class V>
+unsigned FaultSim<V>::evaluateGood(GateId g){
+  unsigned numIn=_n.numFanins(g);
+  const GateId* fanin=_n.fanins(g);
+  for(unsigned i=0;i<numIn;++i) _in[i]=_good[fanin[i]];
+  if(Netlist::Lut==_n.getType(g)) return GoodAlgebra::evaluateCell(_n.getTable(g),&_in[0]);
+  return GoodAlgebra::evaluate(_n.getType(g),&_in[0],numIn);
+}
+template<class V>
+unsigned FaultSim<V>::evaluate(GateId g,unsigned pin,unsigned pinValue){
+/* The gate from the current values, with fanin pin forced to pinValue */
+  unsigned numIn=_n.numFanins(g);
+  const GateId* fanin=_n.fanins(g);
+  for(unsigned i=0;i<numIn;++i) _in[i]=_value[fanin[i]];
+  if(pin<numIn) _in[pin]=static_cast<Value>(pinValue);
+  if(Netlist::Lut==_n.getType(g)) return Algebra::evaluateCell(_n.getTable(g),&_in[0]);
+  return Algebra::evaluate(_n.getType(g),&_in[0],numIn);
+}
+template<class V>
+void FaultSim<V>::schedule(GateId g){
+  if(_queued[g]) return;
+  _queued[g]=1;
+  _level[_n.getLevel(g)].push_back(g);
+}
+template<class V>
+bool FaultSim<V>::change(GateId g,unsigned v){
+  if(_value[g]==v) return false;
+  _saved.push_back(std::make_pair(g,_value[g]));
+  _value[g]=static_cast<Value>(v);
+  if(Netlist::Out==_n.getType(g) && isEffect(g,v)) return true;
+  const GateId* fanout=_n.fanouts(g);
+  for(unsigned i=0;i<_n.numFanouts(g);++i) schedule(fanout[i]);
+  return false;
+}
+template<class V>
+bool FaultSim<V>::detects(const Fault& f){
+  bool bDetected=false;
+  if(Stem==f.pin){
+    bDetected=change(f.gate,inject(_value[f.gate],f.stuckAt));
+  }else{
+    unsigned site=inject(_value[_n.fanins(f.gate)[f.pin]],f.stuckAt);
+    bDetected=change(f.gate,evaluate(f.gate,f.pin,site));
+  }
+  for(unsigned l=_n.getLevel(f.gate)+1;l<_level.size();++l){
+    std::vector<GateId>& gates=_level[l];
+    for(std::size_t i=0;i<gates.size();++i){
+      _queued[gates[i]]=0;
+      if(!bDetected) bDetected=change(gates[i],evaluate(gates[i],Stem,0));
+    }
+    gates.clear();
+  }
+  while(!_saved.empty()){
+    _value[_saved.back().first]=_saved.back().second;
+    _saved.pop_back();
+  }
+  return bDetected;
+}
+template<class V>
+void FaultSim<V>::checkpointFaults(const Netlist& n,std::vector<Fault>& faults){
+  for(GateId g=0;g<n.size();++g){
+    const GateId* fanin=n.fanins(g);
+    for(unsigned pin=0;pin<n.numFanins(g);++pin){
+      if(n.numFanouts(fanin[pin])<2 && Netlist::In!=n.getType(fanin[pin])) continue;
+      for(int stuckAt=0;stuckAt<2;++stuckAt){
+        Fault f={g,pin,1==stuckAt};
+        faults.push_back(f);
+      }
+    }
+  }
+}
+#endif // __FaultSim__
@@ -0,0 +1,129 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "GateCounts.hpp"
+#include "NetSignals.hpp"
+#include <cassert>
+using namespace std;
+
+GateCounts::Func GateCounts::funcFromName(const string& func){
+  if("and"==func) return And;
+  if("nand"==func) return Nand;
+  if("or"==func) return Or;
+  if("nor"==func) return Nor;
+  return Other;
+}
+void GateCounts::grow(size_t numVertices){
+  while(_first.size()<=numVertices) _first.push_back(_inputs.size());
+  if(_func.size()<numVertices) _func.resize(numVertices,Other);
+}
+void GateCounts::addInput(Vertex target,Vertex source,Edge e){
+  assert(_first.size()<=target+1); // no inputs added to a later target yet
+  grow(target);
+  Input in={source,e};
+  _inputs.push_back(in);
+}
+void GateCounts::setFunc(Vertex v,Func f){
+  grow(v+1);
+  _func[v]=f;
+}
+void GateCounts::setTable(Vertex v,const TruthTable& t){
+  setFunc(v,Table);
+  if(_cell.size()<=v) _cell.resize(v+1,0);
+  for(_cell[v]=0;_cell[v]<_tables.size() && !(_tables[_cell[v]]==t);++_cell[v]);
+  if(_cell[v]==_tables.size()) _tables.push_back(t);
+}
+void GateCounts::clear(size_t numVertices){
+  grow(numVertices);
+  Counts allX={{0,0,0,0,0}};
+  _counts.assign(numVertices,allX);
+  _watch[0].resize(numVertices);
+  _watch[1].resize(numVertices);
+  for(Vertex v=0;v<numVertices;++v){
+    unsigned n=fanin(v);
+    _counts[v].n[DLogic::X.GetInt()]=n;
+    _watch[0][v]=(0<n) ? 0 : n;
+    _watch[1][v]=(1<n) ? 1 : n;
+  }
+}
+DLogic GateCounts::evaluate(Vertex v) const{
+  const unsigned* n=_counts[v].n;
+  unsigned zero=n[DLogic::ZERO.GetInt()],one=n[DLogic::ONE.GetInt()];
+  unsigned d=n[DLogic::D.GetInt()],nd=n[DLogic::_D.GetInt()],x=n[DLogic::X.GetInt()];
+  /* Each machine is 0, 1 or 2 for X. For and a 0 in either machine
+     decides it, for or a 1 does.
+  */
+  int good,faulty;
+  bool bInvert=false;
+  switch(_func[v]){
+  case Nand :
+    bInvert=true; // fall through
+  case And :
+    good=(0<zero+nd) ? 0 : ((0<x) ? 2 : 1);
+    faulty=(0<zero+d) ? 0 : ((0<x) ? 2 : 1);
+    break;
+  case Nor :
+    bInvert=true; // fall through
+  case Or :
+    good=(0<one+d) ? 1 : ((0<x) ? 2 : 0);
+    faulty=(0<one+nd) ? 1 : ((0<x) ? 2 : 0);
+    break;
+  default :
+    return DLogic::X;
+  }
+  if(2==good || 2==faulty) return DLogic::X;
+  if(bInvert){
+    good=1-good;
+    faulty=1-faulty;
+  }
+  static const DLogic* const pair[2][2]={{&DLogic::ZERO,&DLogic::_D},{&DLogic::D,&DLogic::ONE}};
+  return *pair[good][faulty];
+}
+DLogic GateCounts::evaluate(Vertex v,const NetSignals& nets) const{
+  if(Table!=_func[v]) return evaluate(v);
+  const TruthTable& t=table(v);
+  if(t.numInputs()!=fanin(v)) return DLogic::X;
+  DLogic in[TruthTable::MaxInputs];
+  const Input* inputs=&_inputs[0]+_first[v];
+  for(unsigned i=0;i<t.numInputs();++i) in[i]=nets.branch(inputs[i].source,inputs[i].edge);
+  return t.evaluate(in);
+}
+DLogic GateCounts::enablingValue(Vertex v,Edge e) const{
+  switch(_func[v]){
+  case And : case Nand : return DLogic::ONE;
+  case Or : case Nor : return DLogic::ZERO;
+  case Table :
+    for(unsigned pin=0;pin<fanin(v);++pin){
+      if(_inputs[_first[v]+pin].edge==e && pin<table(v).numInputs()) return table(v).enablingValue(pin);
+    }
+    return DLogic::X;
+  default :
+    return DLogic::X;
+  }
+}
+bool GateCounts::dPassable(Vertex v,const DLogic& result) const{
+  const unsigned* n=_counts[v].n;
+  if(0<n[DLogic::X.GetInt()]) return true; // too early to tell
+  if(0==n[DLogic::D.GetInt()]+n[DLogic::_D.GetInt()]) return true;
+  return DLogic::D==result||DLogic::_D==result;
+}
+bool GateCounts::isX(const Input& in,const NetSignals& nets) const{
+  return DLogic::X==nets.branch(in.source,in.edge);
+}
+unsigned GateCounts::advance(Vertex v,unsigned from,const NetSignals& nets) const{
+  unsigned n=fanin(v);
+  const Input* inputs=&_inputs[0]+_first[v];
+  while(from<n && !isX(inputs[from],nets)) ++from;
+  return from;
+}
+unsigned GateCounts::watchedXs(Vertex v,const NetSignals& nets){
+  unsigned n=fanin(v);
+  unsigned& w0=_watch[0][v];
+  unsigned& w1=_watch[1][v];
+  w0=advance(v,w0,nets);
+  if(w1<=w0) w1=w0+1;
+  w1=(w1<n) ? advance(v,w1,nets) : n;
+  return (w0<n ? 1 : 0)+(w1<n ? 1 : 0);
+}
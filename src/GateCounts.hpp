@@ -0,0 +1,107 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __GateCounts__
+#define __GateCounts__
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "DLogic.hpp"
+#include "TruthTable.hpp"
+
+class NetSignals;
+// ------------------------------------------------------------
+// class GateCounts
+// ------------------------------------------------------------
+class GateCounts{
+/* Input counters per gate for incremental evaluation of and, nand, or
+   and nor.
+
+   Each gate keeps how many of its inputs are ZERO, ONE, D, _D and X. An
+   input changing value moves one count, O(1), and the output follows from
+   the counts without looking at the inputs, O(1) whatever the fanin. The
+   good and faulty machines are evaluated separately, so for and
+      good   0 if any input is ZERO or _D, else X if any is X, else 1
+      faulty 0 if any input is ZERO or D,  else X if any is X, else 1
+   and the pair gives ZERO, ONE, D ( 1/0 ), _D ( 0/1 ), or X if either is
+   X. or is the dual. This is the value of the DLogic tables independent
+   of the input order, which folding the tables left to right is not : for
+   D,_D,X it gives ZERO but for D,X,_D it gives X.
+
+   Two watched inputs per gate find the inputs still at X. A watch rests
+   on an X input and moves on when the input is found driven; inputs only
+   go from X to a value until clear(), so the watches only move forward
+   and all queries of one fault cost O(fanin) together.
+      watchedXs(v)   0  every input driven, the output is final
+                     1  one input left
+                     2  two or more inputs still X
+   so a D-frontier gate whose inputs are all driven is dropped without a
+   scan of its inputs.
+
+   A cell ( xor, mux, aoi21 ... ) has func Table and its TruthTable, input
+   i being the i-th addInput of the gate. The counts do not give its
+   output, evaluate(v,nets) reads its inputs off the nets and looks them
+   up in the table; for the other funcs it is evaluate(v).
+   enablingValue(v,e) is the value the input on edge e of v should have
+   for the other inputs to reach the output : ONE for and and nand, ZERO
+   for or and nor, from the table for a cell, X for the rest.
+
+   Usage :
+      GateCounts gates;
+      gates.addInput(v,u,edgeIndex);              // in target order
+      gates.setFunc(v,GateCounts::funcFromName("nand"));  // or setTable(v,t) for a cell
+      gates.clear(num_vertices(g));               // every input X, after the addInput
+      gates.change(v,DLogic::X,DLogic::D);        // one input of v
+      DLogic out=gates.evaluate(v);
+      if(0==gates.watchedXs(v,nets)) ...
+   NB - compiler defaults of destructor, copy constructor, operator= sufficient
+ */
+public:
+  typedef std::size_t Vertex;
+  typedef std::size_t Edge;
+  enum Func{And,Nand,Or,Nor,Table,Other};
+  static Func funcFromName(const std::string& func); // Other if not and, nand, or, nor
+
+  GateCounts() {}
+  void addInput(Vertex target,Vertex source,Edge e); // targets in ascending order
+  void setFunc(Vertex v,Func f);
+  void setTable(Vertex v,const TruthTable& t); // func Table
+  std::size_t size() const { return _func.size(); }
+  void clear(std::size_t numVertices); // every input X, the watches back on the first inputs
+
+  void change(Vertex v,const DLogic& from,const DLogic& to){
+    --_counts[v].n[from.GetInt()];
+    ++_counts[v].n[to.GetInt()];
+  }
+  unsigned count(Vertex v,const DLogic& d) const { return _counts[v].n[d.GetInt()]; }
+  unsigned fanin(Vertex v) const { return _first[v+1]-_first[v]; }
+  Func func(Vertex v) const { return _func[v]; }
+  const TruthTable& table(Vertex v) const { return _tables[_cell[v]]; } // Table gates only
+  DLogic evaluate(Vertex v) const; // X for Table and Other
+  DLogic evaluate(Vertex v,const NetSignals& nets) const;
+  DLogic enablingValue(Vertex v,Edge e) const;
+  bool dPassable(Vertex v,const DLogic& result) const; // as DPassable on the inputs of v
+
+  unsigned watchedXs(Vertex v,const NetSignals& nets); // 0, 1 or 2, see above
+private:
+  struct Input{
+    Vertex source;
+    Edge edge;
+  };
+  struct Counts{
+    unsigned n[5]; // by DLogic::GetInt, ZERO, ONE, D, _D, X
+  };
+  bool isX(const Input& in,const NetSignals& nets) const;
+  unsigned advance(Vertex v,unsigned from,const NetSignals& nets) const; // next X input at or after from
+  void grow(std::size_t numVertices); // _first and _func cover numVertices
+  std::vector<Func> _func;
+  std::vector<unsigned> _first;    // inputs of v are _inputs[_first[v]] to _inputs[_first[v+1]-1]
+  std::vector<Input> _inputs;
+  std::vector<Counts> _counts;
+  std::vector<unsigned> _watch[2]; // offsets from _first[v], fanin(v) if none
+  std::vector<unsigned> _cell;     // into _tables, for Table gates
+  std::vector<TruthTable> _tables;
+};
+#endif // __GateCounts__
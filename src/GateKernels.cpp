@@ -0,0 +1,41 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "GateKernels.hpp"
+using namespace std;
+
+const DLogic* const GateKernels::Values[5]={&DLogic::ZERO,&DLogic::ONE,&DLogic::D,&DLogic::_D,&DLogic::X};
+
+GateKernels::KernelFunction GateKernels::kernel(Netlist::GateType type,unsigned numIn){
+  static const KernelFunction Kernels[4][MaxArity+1]={
+    {0,&Kernel<Netlist::And,1>::evaluate,&Kernel<Netlist::And,2>::evaluate,&Kernel<Netlist::And,3>::evaluate,&Kernel<Netlist::And,4>::evaluate},
+    {0,&Kernel<Netlist::Nand,1>::evaluate,&Kernel<Netlist::Nand,2>::evaluate,&Kernel<Netlist::Nand,3>::evaluate,&Kernel<Netlist::Nand,4>::evaluate},
+    {0,&Kernel<Netlist::Or,1>::evaluate,&Kernel<Netlist::Or,2>::evaluate,&Kernel<Netlist::Or,3>::evaluate,&Kernel<Netlist::Or,4>::evaluate},
+    {0,&Kernel<Netlist::Nor,1>::evaluate,&Kernel<Netlist::Nor,2>::evaluate,&Kernel<Netlist::Nor,3>::evaluate,&Kernel<Netlist::Nor,4>::evaluate},
+  };
+  if(numIn>MaxArity) return 0;
+  switch(type){
+  case Netlist::And : return Kernels[0][numIn];
+  case Netlist::Nand : return Kernels[1][numIn];
+  case Netlist::Or : return Kernels[2][numIn];
+  case Netlist::Nor : return Kernels[3][numIn];
+  default : return 0;
+  }
+}
+DLogic GateKernels::evaluate(Netlist::GateType type,const DLogic* in,unsigned numIn){
+  KernelFunction k=kernel(type,numIn);
+  if(0!=k) return k(in);
+  bool bAnd=(Netlist::And==type || Netlist::Nand==type);
+  if(0==numIn || !(bAnd || Netlist::Or==type || Netlist::Nor==type)) return DLogic::X;
+  // wide gates, each machine apart as the kernels
+  unsigned good=FiveValued::good(in[0].GetInt()),faulty=FiveValued::faulty(in[0].GetInt());
+  for(unsigned i=1;i<numIn;++i){
+    good=bAnd ? Component::andOf(good,FiveValued::good(in[i].GetInt())) : Component::orOf(good,FiveValued::good(in[i].GetInt()));
+    faulty=bAnd ? Component::andOf(faulty,FiveValued::faulty(in[i].GetInt())) : Component::orOf(faulty,FiveValued::faulty(in[i].GetInt()));
+  }
+  unsigned result=FiveValued::value(good,faulty);
+  if(Netlist::Nand==type || Netlist::Nor==type) result=Algebra::Not[result];
+  return value(result);
+}
@@ -0,0 +1,68 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __GateKernels__
+#define __GateKernels__
+#include "DLogic.hpp"
+#include "Netlist.hpp"
+#include "LogicAlgebra.hpp"
+
+// ------------------------------------------------------------
+// class GateKernels
+// ------------------------------------------------------------
+class GateKernels{
+/* DLogic gate evaluation unrolled at compile time for 1 to 4 inputs.
+
+   Kernel<Type,Arity> folds the good and the faulty machine of its inputs
+   apart, in the components of LogicAlgebra<FiveValued>, indexed by
+   GetInt, and makes the DLogic of the pair at the end, with the loop
+   resolved by the compiler : no vector, no functor and no string
+   compare. A fold of the DLogicAnd table would lose the pair at the
+   first X, and(D,X,_D) X where each machine gives 0, so the result
+   would depend on the order of the pins; this one does not.
+
+   evaluate picks the kernel from a table by type and arity; wider gates
+   take the generic loop over the same tables. Types without a model
+   ( buf, not and the rest for more than one input ) give X, as
+   EvaluateMultipleInputs does.
+
+   Usage :
+      DLogic in[3]={DLogic::ONE,DLogic::D,DLogic::X};
+      DLogic out=GateKernels::evaluate(Netlist::Nand,in,3);
+      out=GateKernels::Kernel<Netlist::Nand,3>::evaluate(in);
+ */
+public:
+  enum{MaxArity=4};
+  typedef LogicAlgebra<FiveValued> Algebra;
+  template<Netlist::GateType Type,unsigned Arity> struct Kernel;
+  typedef DLogic (*KernelFunction)(const DLogic* in);
+
+  static DLogic evaluate(Netlist::GateType type,const DLogic* in,unsigned numIn);
+  static KernelFunction kernel(Netlist::GateType type,unsigned numIn); // 0 beyond MaxArity or without a model
+  static const DLogic& value(unsigned index){ return *Values[index]; } // of a GetInt
+private:
+  GateKernels();
+  static const DLogic* const Values[5];
+};
+
+template<Netlist::GateType Type,unsigned Arity>
+struct GateKernels::Kernel{
+  static unsigned good(const DLogic* in){ return GateTraits<Type>::combine(Kernel<Type,Arity-1>::good(in),FiveValued::good(in[Arity-1].GetInt())); }
+  static unsigned faulty(const DLogic* in){ return GateTraits<Type>::combine(Kernel<Type,Arity-1>::faulty(in),FiveValued::faulty(in[Arity-1].GetInt())); }
+  static unsigned fold(const DLogic* in){ return FiveValued::value(good(in),faulty(in)); }
+  static DLogic evaluate(const DLogic* in){
+    return value(GateTraits<Type>::bInvert ? Algebra::Not[fold(in)] : fold(in));
+  }
+};
+template<Netlist::GateType Type>
+struct GateKernels::Kernel<Type,1>{
+  static unsigned good(const DLogic* in){ return FiveValued::good(in[0].GetInt()); }
+  static unsigned faulty(const DLogic* in){ return FiveValued::faulty(in[0].GetInt()); }
+  static unsigned fold(const DLogic* in){ return in[0].GetInt(); }
+  static DLogic evaluate(const DLogic* in){
+    return value(GateTraits<Type>::bInvert ? Algebra::Not[fold(in)] : fold(in));
+  }
+};
+#endif // __GateKernels__
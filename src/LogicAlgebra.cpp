@@ -0,0 +1,47 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "LogicAlgebra.hpp"
+using namespace std;
+
+const char* ThreeValued::name(unsigned v){
+  static const char* Names[Size]={"0","1","X"};
+  return (v<Size) ? Names[v] : "?";
+}
+const char* FiveValued::name(unsigned v){
+  static const char* Names[Size]={"0","1","D","_D","X"};
+  return (v<Size) ? Names[v] : "?";
+}
+const char* NineValued::name(unsigned v){
+  static const char* Names[Size]={"0/0","0/1","0/X","1/0","1/1","1/X","X/0","X/1","X/X"};
+  return (v<Size) ? Names[v] : "?";
+}
+
+namespace{
+/* The DLogicAnd, DLogicOr and DLogicNot tables of DLogic.cpp, by GetInt.
+   The 5 valued algebra built from the components must give the same.
+*/
+constexpr unsigned char DLogicAndTable[25]={0,0,0,0,0, 0,1,2,3,4, 0,2,2,0,4, 0,3,0,3,4, 0,4,4,4,4};
+constexpr unsigned char DLogicOrTable[25]={0,1,2,3,4, 1,1,1,1,1, 2,1,2,1,4, 3,1,1,3,4, 4,1,4,4,4};
+constexpr unsigned char DLogicNotTable[5]={1,0,3,2,4};
+template<unsigned N>
+constexpr bool sameTable(const LogicTable<N>& t,const unsigned char* expected,unsigned i=0){
+  return N==i || (t[i]==expected[i] && sameTable(t,expected,i+1));
+}
+typedef LogicAlgebra<FiveValued> Five;
+static_assert(sameTable(Five::And,DLogicAndTable),"5 valued and differs from DLogicAnd");
+static_assert(sameTable(Five::Or,DLogicOrTable),"5 valued or differs from DLogicOr");
+static_assert(sameTable(Five::Not,DLogicNotTable),"5 valued not differs from DLogicNot");
+// 9 values keep what 5 lose : D and X is X/0, not X
+static_assert(NineValued::value(Component::X,Component::Zero)==LogicAlgebra<NineValued>::And[NineValued::D*NineValued::Size+NineValued::X],"9 valued D and X");
+static_assert(FiveValued::X==Five::And[FiveValued::D*FiveValued::Size+FiveValued::X],"5 valued D and X");
+// 3 values are the components themselves, the good machine of FaultSim
+typedef LogicAlgebra<ThreeValued> Three;
+static_assert(ThreeValued::Zero==Component::Zero && ThreeValued::One==Component::One && ThreeValued::X==Component::X,"3 valued is Component");
+static_assert(ThreeValued::X==Three::And[ThreeValued::One*ThreeValued::Size+ThreeValued::X],"3 valued 1 and X");
+static_assert(ThreeValued::Zero==Three::And[ThreeValued::Zero*ThreeValued::Size+ThreeValued::X],"3 valued 0 and X");
+static_assert(ThreeValued::One==Three::Or[ThreeValued::One*ThreeValued::Size+ThreeValued::X],"3 valued 1 or X");
+static_assert(ThreeValued::X==Three::Not[ThreeValued::X],"3 valued not X");
+}
@@ -0,0 +1,262 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __LogicAlgebra__
+#define __LogicAlgebra__
+#include "Netlist.hpp"
+
+/** Multi-valued logic algebras
+
+A value of a fault simulation is a pair of components, the value of the
+good machine and the value of the faulty machine, each 0, 1 or X. An
+algebra is the set of pairs it can tell apart. The gate functions work
+on each component alone, so every truth table of an algebra follows from
+three component tables, and LogicAlgebra<V> builds them at compile time
+from the value set V, which only says how its values split into
+components and how a pair maps back to a value.
+
+   ThreeValued  0 1 X                       one machine
+   FiveValued   0 1 D _D X                  Roth's D-calculus, as DLogic,
+                                            any pair with an X is X
+   NineValued   every pair, 0/0 0/1 ... X/X Muth, keeps 1/X, X/0, ...
+
+The cheapest algebra is used for each task : good machine simulation
+needs 3 values, fault propagation 5, and 9 values only pay when a fault
+effect meets an X and reconverges, where 5 values lose the known half of
+the pair. FaultSim runs its good machine in 3 values whatever its own
+algebra, and with ThreeValued simulates the faulty machine alone against
+it. BitSim is the bit-parallel 3 valued good machine. The tables are 9,
+25 or 81 bytes.
+
+A value set is a struct with
+   enum{Size=...}
+   static constexpr unsigned good(unsigned v), faulty(unsigned v)
+   static constexpr unsigned value(unsigned good,unsigned faulty)
+   static const char* name(unsigned v)
+Components are Component::Zero, One and X. value must give the closest
+value the set has for a pair it cannot hold, X if nothing closer.
+ */
+// ------------------------------------------------------------
+// struct Component
+// ------------------------------------------------------------
+struct Component{
+/* The value of one machine, and the three gate functions on it */
+  enum{Zero=0,One=1,X=2};
+  static constexpr unsigned andOf(unsigned a,unsigned b){
+    return (Zero==a || Zero==b) ? Zero : ((X==a || X==b) ? X : One);
+  }
+  static constexpr unsigned orOf(unsigned a,unsigned b){
+    return (One==a || One==b) ? One : ((X==a || X==b) ? X : Zero);
+  }
+  static constexpr unsigned notOf(unsigned a){ return (X==a) ? X : One-a; }
+};
+// ------------------------------------------------------------
+// struct ThreeValued
+// ------------------------------------------------------------
+struct ThreeValued{
+  enum{Size=3};
+  enum Value{Zero,One,X}; // the order of Component
+  static constexpr unsigned good(unsigned v){ return v; }
+  static constexpr unsigned faulty(unsigned v){ return v; }
+  static constexpr unsigned value(unsigned g,unsigned f){ return (g==f) ? g : static_cast<unsigned>(X); }
+  static const char* name(unsigned v);
+};
+// ------------------------------------------------------------
+// struct FiveValued
+// ------------------------------------------------------------
+struct FiveValued{
+  enum{Size=5};
+  enum Value{Zero,One,D,DBar,X}; // the order of DLogic::GetInt
+  static constexpr unsigned good(unsigned v){
+    return (Zero==v || DBar==v) ? Component::Zero : ((X==v) ? Component::X : Component::One);
+  }
+  static constexpr unsigned faulty(unsigned v){
+    return (Zero==v || D==v) ? Component::Zero : ((X==v) ? Component::X : Component::One);
+  }
+  static constexpr unsigned value(unsigned g,unsigned f){
+    return (Component::X==g || Component::X==f) ? static_cast<unsigned>(X)
+         : ((g==f) ? g : ((Component::One==g) ? static_cast<unsigned>(D) : static_cast<unsigned>(DBar)));
+  }
+  static const char* name(unsigned v);
+};
+// ------------------------------------------------------------
+// struct NineValued
+// ------------------------------------------------------------
+struct NineValued{
+  enum{Size=9};
+  enum Value{Zero=0,DBar=1,One=4,D=3,X=8}; // good*3+faulty, the others have no name
+  static constexpr unsigned good(unsigned v){ return v/3; }
+  static constexpr unsigned faulty(unsigned v){ return v%3; }
+  static constexpr unsigned value(unsigned g,unsigned f){ return g*3+f; }
+  static const char* name(unsigned v);
+};
+
+template<unsigned... I> struct LogicIndices{};
+template<unsigned N,unsigned... I> struct MakeLogicIndices : MakeLogicIndices<N-1,N-1,I...>{};
+template<unsigned... I> struct MakeLogicIndices<0,I...>{ typedef LogicIndices<I...> type; };
+template<unsigned N>
+struct LogicTable{
+  unsigned char v[N];
+  constexpr unsigned operator[](unsigned i) const { return v[i]; }
+};
+// ------------------------------------------------------------
+// struct LogicOps
+// ------------------------------------------------------------
+template<class V>
+struct LogicOps{
+/* The operations of the value set V from its components, and the tables
+   built from them. Apart from LogicAlgebra so that the tables can be
+   constexpr members there.
+ */
+  typedef unsigned char Value;
+  enum{Size=V::Size};
+  typedef LogicTable<Size*Size> BinaryTable;
+  typedef LogicTable<Size> UnaryTable;
+
+  static constexpr unsigned andOf(unsigned a,unsigned b){
+    return V::value(Component::andOf(V::good(a),V::good(b)),Component::andOf(V::faulty(a),V::faulty(b)));
+  }
+  static constexpr unsigned orOf(unsigned a,unsigned b){
+    return V::value(Component::orOf(V::good(a),V::good(b)),Component::orOf(V::faulty(a),V::faulty(b)));
+  }
+  static constexpr unsigned notOf(unsigned a){
+    return V::value(Component::notOf(V::good(a)),Component::notOf(V::faulty(a)));
+  }
+  static constexpr unsigned inject(unsigned v,bool stuckAt){
+    return V::value(V::good(v),stuckAt ? Component::One : Component::Zero);
+  }
+  static constexpr bool isEffect(unsigned v){
+    return Component::X!=V::good(v) && Component::X!=V::faulty(v) && V::good(v)!=V::faulty(v);
+  }
+  static constexpr unsigned fromBool(bool b){ return V::value(b ? Component::One : Component::Zero,b ? Component::One : Component::Zero); }
+  static constexpr unsigned unknown(){ return V::value(Component::X,Component::X); }
+
+  template<unsigned... I>
+  static constexpr BinaryTable makeAnd(LogicIndices<I...>){ return BinaryTable{{static_cast<Value>(andOf(I/Size,I%Size))...}}; }
+  template<unsigned... I>
+  static constexpr BinaryTable makeOr(LogicIndices<I...>){ return BinaryTable{{static_cast<Value>(orOf(I/Size,I%Size))...}}; }
+  template<unsigned... I>
+  static constexpr UnaryTable makeNot(LogicIndices<I...>){ return UnaryTable{{static_cast<Value>(notOf(I))...}}; }
+};
+// ------------------------------------------------------------
+// class LogicAlgebra
+// ------------------------------------------------------------
+template<class V>
+class LogicAlgebra : public LogicOps<V>{
+/* Truth tables of the value set V, built at compile time.
+
+   andOf, orOf and notOf combine the components of their operands, the
+   tables hold them for every pair of values, And and Or indexed by
+   a*Size+b. A gate of more than two inputs is not a fold of the tables :
+   with 5 values D and X is X, so and(D,X,_D) would be X, where each
+   machine alone gives 0. Kernel<Type,Arity> folds the good and the faulty
+   components of 1 to 4 inputs apart, the loop unrolled, and makes the
+   value of the pair at the end, so the result does not depend on the
+   order of the pins. evaluate dispatches on type and arity and loops the
+   same way for wider gates, as GateKernels does for DLogic. evaluateCell
+   looks each component up in the table of a cell.
+
+   inject(v,stuckAt) is v with its faulty component stuck, and isEffect(v)
+   is a fault effect : both components known and different.
+
+   Usage :
+      typedef LogicAlgebra<NineValued> L;
+      unsigned char in[2]={NineValued::D,NineValued::X};
+      unsigned char out=L::evaluate(Netlist::Nand,in,2);  // X/1
+      cout << NineValued::name(out);
+   NB - only static members
+ */
+public:
+  typedef LogicOps<V> Ops;
+  typedef typename Ops::Value Value;
+  typedef typename Ops::BinaryTable BinaryTable;
+  typedef typename Ops::UnaryTable UnaryTable;
+  enum{Size=V::Size};
+  using Ops::unknown;
+
+  static constexpr BinaryTable And=Ops::makeAnd(typename MakeLogicIndices<Size*Size>::type());
+  static constexpr BinaryTable Or=Ops::makeOr(typename MakeLogicIndices<Size*Size>::type());
+  static constexpr UnaryTable Not=Ops::makeNot(typename MakeLogicIndices<Size>::type());
+
+  template<Netlist::GateType Type,unsigned Arity> struct Kernel;
+  static unsigned evaluate(Netlist::GateType type,const Value* in,unsigned numIn);
+  static unsigned evaluateCell(const TruthTable& t,const Value* in);
+private:
+  LogicAlgebra();
+};
+template<class V> constexpr typename LogicAlgebra<V>::BinaryTable LogicAlgebra<V>::And;
+template<class V> constexpr typename LogicAlgebra<V>::BinaryTable LogicAlgebra<V>::Or;
+template<class V> constexpr typename LogicAlgebra<V>::UnaryTable LogicAlgebra<V>::Not;
+
+// ------------------------------------------------------------
+// struct GateTraits
+// ------------------------------------------------------------
+template<Netlist::GateType Type>
+struct GateTraits{
+/* How a gate type evaluates : and or or of its inputs, then inverted or not.
+   buf, not and out take their one input.
+ */
+  static constexpr bool bAnd=(Netlist::And==Type || Netlist::Nand==Type);
+  static constexpr bool bOr=(Netlist::Or==Type || Netlist::Nor==Type);
+  static constexpr bool bInvert=(Netlist::Nand==Type || Netlist::Nor==Type || Netlist::Not==Type);
+  static constexpr unsigned combine(unsigned a,unsigned b){ return bAnd ? Component::andOf(a,b) : Component::orOf(a,b); }
+};
+
+template<class V>
+template<Netlist::GateType Type,unsigned Arity>
+struct LogicAlgebra<V>::Kernel{
+  static unsigned good(const Value* in){ return GateTraits<Type>::combine(Kernel<Type,Arity-1>::good(in),V::good(in[Arity-1])); }
+  static unsigned faulty(const Value* in){ return GateTraits<Type>::combine(Kernel<Type,Arity-1>::faulty(in),V::faulty(in[Arity-1])); }
+  static unsigned fold(const Value* in){ return V::value(good(in),faulty(in)); }
+  static unsigned evaluate(const Value* in){ return GateTraits<Type>::bInvert ? Not[fold(in)] : fold(in); }
+};
+template<class V>
+template<Netlist::GateType Type>
+struct LogicAlgebra<V>::Kernel<Type,1>{
+  static unsigned good(const Value* in){ return V::good(in[0]); }
+  static unsigned faulty(const Value* in){ return V::faulty(in[0]); }
+  static unsigned fold(const Value* in){ return in[0]; }
+  static unsigned evaluate(const Value* in){ return GateTraits<Type>::bInvert ? Not[fold(in)] : fold(in); }
+};
+template<class V>
+unsigned LogicAlgebra<V>::evaluate(Netlist::GateType type,const Value* in,unsigned numIn){
+/* and, nand, or, nor of any arity, buf, not, out of their first input,
+   X for the rest and for gates without inputs
+*/
+  if(0==numIn) return unknown();
+  switch(type){
+  case Netlist::Buf : case Netlist::Out : case Netlist::Noop : return in[0];
+  case Netlist::Not : return Not[in[0]];
+  case Netlist::And : case Netlist::Nand : case Netlist::Or : case Netlist::Nor : break;
+  default : return unknown();
+  }
+  bool bAnd=(Netlist::And==type || Netlist::Nand==type);
+  unsigned result;
+  switch(numIn){
+  case 1 : result=in[0]; break;
+  case 2 : result=bAnd ? Kernel<Netlist::And,2>::fold(in) : Kernel<Netlist::Or,2>::fold(in); break;
+  case 3 : result=bAnd ? Kernel<Netlist::And,3>::fold(in) : Kernel<Netlist::Or,3>::fold(in); break;
+  case 4 : result=bAnd ? Kernel<Netlist::And,4>::fold(in) : Kernel<Netlist::Or,4>::fold(in); break;
+  default : // each machine apart, as the kernels
+    unsigned good=V::good(in[0]),faulty=V::faulty(in[0]);
+    for(unsigned i=1;i<numIn;++i){
+      good=bAnd ? Component::andOf(good,V::good(in[i])) : Component::orOf(good,V::good(in[i]));
+      faulty=bAnd ? Component::andOf(faulty,V::faulty(in[i])) : Component::orOf(faulty,V::faulty(in[i]));
+    }
+    result=V::value(good,faulty);
+    break;
+  }
+  return (Netlist::Nand==type || Netlist::Nor==type) ? Not[result] : result;
+}
+template<class V>
+unsigned LogicAlgebra<V>::evaluateCell(const TruthTable& t,const Value* in){
+  unsigned good[TruthTable::MaxInputs],faulty[TruthTable::MaxInputs];
+  for(unsigned i=0;i<t.numInputs();++i){
+    good[i]=V::good(in[i]);
+    faulty[i]=V::faulty(in[i]);
+  }
+  return V::value(t.component(good),t.component(faulty));
+}
+#endif // __LogicAlgebra__
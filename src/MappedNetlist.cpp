@@ -0,0 +1,273 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "MappedNetlist.hpp"
+#include <fstream>
+#include <iostream>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using namespace std;
+
+// ------------------------------------------------------------
+// class MappedFile
+// ------------------------------------------------------------
+bool MappedFile::openRead(const string& path){
+  close();
+  _fd=::open(path.c_str(),O_RDONLY);
+  if(_fd<0) return false;
+  struct stat st;
+  if(0!=fstat(_fd,&st) || 0==st.st_size){ close(); return false; }
+  _size=static_cast<size_t>(st.st_size);
+  void* p=mmap(0,_size,PROT_READ,MAP_SHARED,_fd,0);
+  if(MAP_FAILED==p){ close(); return false; }
+  _base=static_cast<char*>(p);
+  return true;
+}
+bool MappedFile::openScratch(size_t size){
+  close();
+  if(0==size) return false;
+  const char* dir=getenv("TMPDIR");
+  string path=string(dir ? dir : "/tmp")+"/atpgXXXXXX";
+  _fd=mkstemp(&path[0]);
+  if(_fd<0) return false;
+  unlink(path.c_str()); // goes away with the last reference
+  if(0!=ftruncate(_fd,static_cast<off_t>(size))){ close(); return false; }
+  void* p=mmap(0,size,PROT_READ|PROT_WRITE,MAP_SHARED,_fd,0);
+  if(MAP_FAILED==p){ close(); return false; }
+  _base=static_cast<char*>(p);
+  _size=size;
+  return true;
+}
+void MappedFile::close(){
+  if(0!=_base) munmap(_base,_size);
+  if(_fd>=0) ::close(_fd);
+  _base=0;
+  _size=0;
+  _fd=-1;
+}
+void MappedFile::advise(size_t offset,size_t length,int advice) const{
+  if(0==_base || 0==length) return;
+  static const size_t PageSize=static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t start=offset-offset%PageSize; // madvise wants a page aligned start
+  madvise(_base+start,length+(offset-start),advice);
+}
+void MappedFile::willNeed(size_t offset,size_t length) const{
+  advise(offset,length,MADV_WILLNEED);
+}
+void MappedFile::dontNeed(size_t offset,size_t length) const{
+  advise(offset,length,MADV_DONTNEED);
+}
+void MappedFile::sequential() const{
+  advise(0,_size,MADV_SEQUENTIAL);
+}
+// ------------------------------------------------------------
+// class MappedNetlist
+// ------------------------------------------------------------
+const char* MappedNetlist::Magic="ATPGNETM";
+
+namespace{
+  void putUInt(ofstream& os,unsigned u){ os.write(reinterpret_cast<const char*>(&u),sizeof(u)); }
+  void putULong(ofstream& os,unsigned long long u){ os.write(reinterpret_cast<const char*>(&u),sizeof(u)); }
+  bool fits(unsigned long long offset,unsigned long long bytes,size_t size){
+    return offset<=size && bytes<=size-offset; // no overflow of offset+bytes
+  }
+  void padTo(ofstream& os,unsigned long long offset){
+    static const char Zeros[4096]={0};
+    unsigned long long at=static_cast<unsigned long long>(os.tellp());
+    while(at<offset){
+      size_t n=static_cast<size_t>(std::min<unsigned long long>(offset-at,sizeof(Zeros)));
+      os.write(Zeros,n);
+      at+=n;
+    }
+  }
+}
+bool MappedNetlist::write(const Netlist& n,const string& path,size_t blockBytes){
+  if(!n.isLevelized()) return false;
+  if(0!=n.numTables()) cout << "Warning! The mapped netlist keeps no cell tables, cells simulate as X\n";
+  const unsigned long long PageSize=static_cast<unsigned long long>(sysconf(_SC_PAGESIZE));
+  const vector<GateId>& order=n.getOrder();
+  // cut the level order into blocks
+  vector<Block> blocks;
+  Block current={0,0,0,0,0,0};
+  for(size_t i=0;i<order.size();++i){
+    GateId g=order[i];
+    unsigned long long bytes=4*(2+n.numFanins(g));
+    if(0!=current.numGates && current.bytes+bytes>blockBytes){
+      blocks.push_back(current);
+      Block next={0,0,0,0,0,0};
+      current=next;
+    }
+    if(0==current.numGates) current.firstLevel=n.getLevel(g);
+    current.lastLevel=n.getLevel(g);
+    current.bytes+=bytes;
+    ++current.numGates;
+  }
+  if(0!=current.numGates) blocks.push_back(current);
+  // metadata sizes, then page aligned block offsets
+  unsigned long long offBlocks=8+7*4+5*8;
+  unsigned long long offInputs=offBlocks+blocks.size()*sizeof(Block);
+  unsigned long long offOutputs=offInputs+4*n.getInputs().size();
+  unsigned long long offLevels=offOutputs+4*n.getOutputs().size();
+  unsigned long long offNames=offLevels+4*n.size();
+  unsigned long long end=offNames;
+  for(size_t i=0;i<n.getInputs().size();++i) end+=4+n.getName(n.getInputs()[i]).size();
+  for(size_t i=0;i<n.getOutputs().size();++i) end+=4+n.getName(n.getOutputs()[i]).size();
+  for(size_t b=0;b<blocks.size();++b){
+    end=(end+PageSize-1)/PageSize*PageSize;
+    blocks[b].offset=end;
+    end+=blocks[b].bytes;
+  }
+
+  ofstream os(path.c_str(),ios::out|ios::binary|ios::trunc);
+  if(!os.good()) return false;
+  os.write(Magic,8);
+  putUInt(os,Version);
+  putUInt(os,static_cast<unsigned>(n.size()));
+  putUInt(os,static_cast<unsigned>(n.getInputs().size()));
+  putUInt(os,static_cast<unsigned>(n.getOutputs().size()));
+  putUInt(os,n.getDepth());
+  putUInt(os,static_cast<unsigned>(blocks.size()));
+  putUInt(os,0);
+  putULong(os,offBlocks);
+  putULong(os,offInputs);
+  putULong(os,offOutputs);
+  putULong(os,offLevels);
+  putULong(os,offNames);
+  if(!blocks.empty()) os.write(reinterpret_cast<const char*>(&blocks[0]),blocks.size()*sizeof(Block));
+  for(size_t i=0;i<n.getInputs().size();++i) putUInt(os,n.getInputs()[i]);
+  for(size_t i=0;i<n.getOutputs().size();++i) putUInt(os,n.getOutputs()[i]);
+  for(size_t g=0;g<n.size();++g) putUInt(os,n.getLevel(static_cast<GateId>(g)));
+  for(size_t i=0;i<n.getInputs().size();++i){
+    const string& name=n.getName(n.getInputs()[i]);
+    putUInt(os,static_cast<unsigned>(name.size()));
+    os.write(name.data(),name.size());
+  }
+  for(size_t i=0;i<n.getOutputs().size();++i){
+    const string& name=n.getName(n.getOutputs()[i]);
+    putUInt(os,static_cast<unsigned>(name.size()));
+    os.write(name.data(),name.size());
+  }
+  size_t i=0;
+  for(size_t b=0;b<blocks.size();++b){
+    padTo(os,blocks[b].offset);
+    for(unsigned k=0;k<blocks[b].numGates;++k,++i){
+      GateId g=order[i];
+      putUInt(os,g);
+      putUInt(os,static_cast<unsigned>(n.getType(g))|(n.numFanins(g)<<8));
+      os.write(reinterpret_cast<const char*>(n.fanins(g)),4*n.numFanins(g));
+    }
+  }
+  return os.good();
+}
+bool MappedNetlist::open(const string& path){
+/* Every section, block and name is checked against the size of the mapped
+   file before any of them is read, and each block is walked once so every
+   gate record fits its block and names gates below numGates, so a truncated
+   or corrupt file fails here instead of faulting later.
+*/
+  _blocks.clear();
+  _inputs.clear();
+  _outputs.clear();
+  _ioByName.clear();
+  _numGates=0;
+  _levels=0;
+  if(!_file.openRead(path) || _file.size()<8+7*4+5*8) return false;
+  const char* p=_file.data();
+  const size_t size=_file.size();
+  if(0!=memcmp(p,Magic,8)) return false;
+  const unsigned* u=reinterpret_cast<const unsigned*>(p+8);
+  if(Version!=u[0]) return false;
+  unsigned numGates=u[1];
+  unsigned numInputs=u[2],numOutputs=u[3];
+  unsigned numBlocks=u[5];
+  unsigned long long off[5]; // at p+36, not 8 byte aligned
+  memcpy(off,p+8+7*4,sizeof(off));
+  if(!fits(off[0],static_cast<unsigned long long>(numBlocks)*sizeof(Block),size)
+     || !fits(off[1],4ULL*numInputs,size)
+     || !fits(off[2],4ULL*numOutputs,size)
+     || !fits(off[3],4ULL*numGates,size)
+     || !fits(off[4],0,size)) return false;
+  const Block* blocks=reinterpret_cast<const Block*>(p+off[0]);
+  unsigned long long numRecords=0;
+  for(unsigned b=0;b<numBlocks;++b){
+    if(!fits(blocks[b].offset,blocks[b].bytes,size) || 0!=blocks[b].offset%4) return false;
+    const unsigned* rec=reinterpret_cast<const unsigned*>(p+blocks[b].offset);
+    unsigned long long left=blocks[b].bytes/4;
+    for(unsigned k=0;k<blocks[b].numGates;++k){
+      if(left<2 || rec[0]>=numGates || (rec[1]&0xFF)>=Netlist::NumGateTypes) return false;
+      unsigned numFanins=rec[1]>>8;
+      if(left-2<numFanins) return false;
+      for(unsigned i=0;i<numFanins;++i) if(rec[2+i]>=numGates) return false;
+      left-=2+numFanins;
+      rec+=2+numFanins;
+    }
+    if(0!=left) return false;
+    numRecords+=blocks[b].numGates;
+    _file.dontNeed(blocks[b].offset,blocks[b].bytes);
+  }
+  if(numRecords!=numGates) return false;
+  const unsigned* inputs=reinterpret_cast<const unsigned*>(p+off[1]);
+  const unsigned* outputs=reinterpret_cast<const unsigned*>(p+off[2]);
+  for(unsigned i=0;i<numInputs;++i) if(inputs[i]>=numGates) return false;
+  for(unsigned i=0;i<numOutputs;++i) if(outputs[i]>=numGates) return false;
+  unsigned long long at=off[4];
+  for(unsigned i=0;i<numInputs+numOutputs;++i){
+    unsigned len;
+    if(!fits(at,4,size)) return false;
+    memcpy(&len,p+at,4);
+    if(!fits(at+4,len,size)) return false;
+    at+=4+len;
+  }
+
+  _numGates=numGates;
+  _depth=u[4];
+  _blocks.assign(blocks,blocks+numBlocks);
+  _inputs.assign(inputs,inputs+numInputs);
+  _outputs.assign(outputs,outputs+numOutputs);
+  _levels=reinterpret_cast<const unsigned*>(p+off[3]);
+  const char* names=p+off[4];
+  for(unsigned i=0;i<numInputs+numOutputs;++i){
+    unsigned len;
+    memcpy(&len,names,4);
+    _ioByName[string(names+4,len)]=(i<numInputs) ? _inputs[i] : _outputs[i-numInputs];
+    names+=4+len;
+  }
+  _file.sequential();
+  return true;
+}
+MappedNetlist::GateId MappedNetlist::findGate(const string& name) const{
+  map<string,GateId>::const_iterator it=_ioByName.find(name);
+  return (_ioByName.end()==it) ? static_cast<GateId>(_numGates) : it->second;
+}
+void MappedNetlist::faultCone(GateId root,vector<GateId>& cone) const{
+/* Appends root and every gate it reaches, in level order. A gate is in the
+   cone when one of its fanins is, so a single forward walk over the blocks,
+   starting with the block that holds the root's level, is enough. A root
+   that is no gate, as findGate returns on a miss, appends nothing.
+*/
+  if(root>=_numGates) return;
+  vector<bool> inCone(_numGates,false);
+  inCone[root]=true;
+  cone.push_back(root);
+  unsigned rootLevel=getLevel(root);
+  size_t first=0;
+  while(first<_blocks.size() && _blocks[first].lastLevel<rootLevel) ++first;
+  forEachGate(first,[&](GateId g,Netlist::GateType,unsigned numIn,const GateId* in){
+    for(unsigned i=0;i<numIn;++i){
+      if(inCone[in[i]]){
+        if(!inCone[g]){
+          inCone[g]=true;
+          cone.push_back(g);
+        }
+        break;
+      }
+    }
+    return true;
+  });
+}
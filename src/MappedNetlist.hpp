@@ -0,0 +1,175 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __MappedNetlist__
+#define __MappedNetlist__
+#include <string>
+#include <vector>
+#include <map>
+#include "Netlist.hpp"
+#include "BitSim.hpp"
+
+// ------------------------------------------------------------
+// class MappedFile
+// ------------------------------------------------------------
+class MappedFile{
+/* A file mapped into memory with mmap.
+   openRead maps an existing file read only. openScratch maps a new, already
+   unlinked file of the given size read/write, so its pages can be written
+   back and dropped by the OS instead of counting against RSS.
+   NB - not copyable. The destructor unmaps and closes.
+ */
+public:
+  MappedFile() : _fd(-1), _base(0), _size(0) {}
+  ~MappedFile(){ close(); }
+  bool openRead(const std::string& path);
+  bool openScratch(std::size_t size);
+  void close();
+  bool good() const { return 0!=_base; }
+  char* data() const { return _base; }
+  std::size_t size() const { return _size; }
+  void willNeed(std::size_t offset,std::size_t length) const; // start read-ahead
+  void dontNeed(std::size_t offset,std::size_t length) const; // release pages
+  void sequential() const;
+private:
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+  void advise(std::size_t offset,std::size_t length,int advice) const;
+  int _fd;
+  char* _base;
+  std::size_t _size;
+};
+// ------------------------------------------------------------
+// class MappedNetlist
+// ------------------------------------------------------------
+class MappedNetlist{
+/* Out-of-core form of a levelized Netlist.
+   write() stores the gates in level order as variable length records
+      uint32 gate id, uint32 type | numFanins<<8, uint32 fanin[numFanins]
+   cut into page aligned blocks of about blockBytes. open() maps the file;
+   only the block directory, the PI/PO lists and the PI/PO names are read
+   into memory. Everything else is paged in by the OS as the blocks are
+   walked, with explicit madvise read-ahead of the next block and release
+   of the finished one, so resident memory stays near a few blocks.
+
+   File layout, host byte order :
+      char[8] "ATPGNETM", uint32 version, gates, inputs, outputs, depth, blocks
+      uint64  offsets of : block directory, inputs, outputs, levels, names
+      block directory : uint64 offset, uint64 bytes, uint32 gates, first level, last level, pad
+      inputs, outputs : uint32 gate ids
+      levels          : uint32 per gate
+      names           : PI then PO names, uint32 length + characters
+      blocks          : page aligned gate records
+   Cell tables are not stored, a lut gate simulates as X.
+   NB - not copyable.
+ */
+public:
+  typedef Netlist::GateId GateId;
+  struct Block{
+    unsigned long long offset;
+    unsigned long long bytes;
+    unsigned numGates;
+    unsigned firstLevel;
+    unsigned lastLevel;
+    unsigned pad;
+  };
+  static const char* Magic;
+  static const unsigned Version=1;
+  static bool write(const Netlist& n,const std::string& path,std::size_t blockBytes=1<<20);
+
+  MappedNetlist() : _numGates(0), _depth(0), _levels(0), _release(true) {}
+  bool open(const std::string& path);
+  std::size_t size() const { return _numGates; }
+  unsigned getDepth() const { return _depth; }
+  unsigned getLevel(GateId g) const { return _levels[g]; }
+  const std::vector<GateId>& getInputs() const { return _inputs; }
+  const std::vector<GateId>& getOutputs() const { return _outputs; }
+  GateId findGate(const std::string& name) const; // PIs and POs only
+  std::size_t numBlocks() const { return _blocks.size(); }
+  const Block& getBlock(std::size_t b) const { return _blocks[b]; }
+  void setRelease(bool bRelease){ _release=bRelease; } // drop finished blocks
+
+  template<class Functor> void forEachGate(std::size_t firstBlock,Functor f) const;
+  void faultCone(GateId root,std::vector<GateId>& cone) const;
+private:
+  MappedNetlist(const MappedNetlist&);
+  MappedNetlist& operator=(const MappedNetlist&);
+  MappedFile _file;
+  std::size_t _numGates;
+  unsigned _depth;
+  const unsigned* _levels;
+  bool _release;
+  std::vector<Block> _blocks;
+  std::vector<GateId> _inputs;
+  std::vector<GateId> _outputs;
+  std::map<std::string,GateId> _ioByName;
+};
+
+template<class Functor>
+void MappedNetlist::forEachGate(std::size_t firstBlock,Functor f) const{
+/* Calls f(gate,type,numFanins,fanins) for every gate from firstBlock on, in
+   level order, one block at a time. Return false from f to stop early.
+*/
+  for(std::size_t b=firstBlock;b<_blocks.size();++b){
+    const Block& block=_blocks[b];
+    if(b+1<_blocks.size()) _file.willNeed(_blocks[b+1].offset,_blocks[b+1].bytes);
+    const unsigned* p=reinterpret_cast<const unsigned*>(_file.data()+block.offset);
+    bool bContinue=true;
+    for(unsigned i=0;i<block.numGates && bContinue;++i){
+      unsigned numFanins=p[1]>>8;
+      bContinue=f(static_cast<GateId>(p[0]),static_cast<Netlist::GateType>(p[1]&0xFF),numFanins,
+                  reinterpret_cast<const GateId*>(p+2));
+      p+=2+numFanins;
+    }
+    if(_release) _file.dontNeed(block.offset,block.bytes);
+    if(!bContinue) break;
+  }
+}
+// ------------------------------------------------------------
+// class MappedBitSim
+// ------------------------------------------------------------
+template<unsigned Width>
+class MappedBitSim{
+/* BitSim over a MappedNetlist. Net values live in a scratch mapping instead
+   of the heap, so both the netlist and the values can be paged by the OS.
+   Same interface as BitSim, so PatternSim can drive either.
+   NB - not copyable.
+ */
+public:
+  enum{Words=Width/64};
+  typedef unsigned long long Word;
+  typedef Netlist::GateId GateId;
+  MappedBitSim(const MappedNetlist& n) : _n(n), _hi(0), _lo(0){
+    std::size_t planeBytes=n.size()*Words*sizeof(Word);
+    if(_values.openScratch(2*planeBytes)){
+      _hi=reinterpret_cast<Word*>(_values.data());
+      _lo=reinterpret_cast<Word*>(_values.data()+planeBytes);
+    }
+  }
+  bool good() const { return _values.good(); }
+  void setInput(std::size_t piIndex,const Word* hi,const Word* lo){
+    GateId g=_n.getInputs()[piIndex];
+    for(unsigned w=0;w<Words;++w){ _hi[g*Words+w]=hi[w]; _lo[g*Words+w]=lo[w]; }
+  }
+  void simulate(){
+    Word* hi=_hi;
+    Word* lo=_lo;
+    _n.forEachGate(0,[hi,lo](GateId g,Netlist::GateType type,unsigned numIn,const GateId* in){
+      BitSim<Width>::evaluateGate(type,numIn,in,hi,lo,g);
+      return true;
+    });
+  }
+  const Word* getHi(GateId g) const { return _hi+g*Words; }
+  const Word* getLo(GateId g) const { return _lo+g*Words; }
+private:
+  MappedBitSim();
+  MappedBitSim(const MappedBitSim&);
+  MappedBitSim& operator=(const MappedBitSim&);
+  const MappedNetlist& _n;
+  MappedFile _values;
+  Word* _hi;
+  Word* _lo;
+};
+#endif // __MappedNetlist__
@@ -0,0 +1,308 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "MemStats.hpp"
+#include <new>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__GNUC__) && defined(__linux__)
+#include <execinfo.h>
+#include <cxxabi.h>
+#define MEMSTATS_SITES
+#endif
+using namespace std;
+
+thread_local unsigned char MemStats::tTag=MemStats::Untagged;
+
+namespace{
+  struct Header{ // in front of every block, keeps the block 16 byte aligned
+    size_t size;
+    unsigned tag;
+    unsigned pad;
+  };
+  // zero initialized before any constructor runs, so usable from the first operator new
+  atomic<long long> sInUse[MemStats::NumTags];
+  atomic<long long> sPeak[MemStats::NumTags];
+  atomic<unsigned long long> sAllocs[MemStats::NumTags];
+  atomic<unsigned long long> sFrees[MemStats::NumTags];
+  atomic<bool> sSites(false);
+  thread_local bool tInSite=false;
+
+  const unsigned SiteDepth=10;
+  const unsigned SiteSlots=1024; // open addressing, full table drops new sites
+  struct Site{
+    unsigned long long key;
+    void* frames[SiteDepth];
+    int depth;
+    unsigned tag;
+    unsigned long long allocs;
+    unsigned long long bytes;
+  };
+  struct SiteTable{ // no allocation inside, it is filled from operator new
+    mutex m;
+    Site slots[SiteSlots];
+    unsigned used;
+    unsigned long long dropped;
+  };
+  SiteTable sSiteTable; // zero initialized
+
+  struct Snapshot{
+    const char* phase;
+    MemStats::Counters c[MemStats::NumTags];
+  };
+  struct Registry{
+    mutex m;
+    vector<Snapshot> snapshots;
+  };
+  Registry& registry(){
+    static Registry r;
+    return r;
+  }
+  bool loopTag(unsigned tag){
+    return MemStats::DFrontier==tag || MemStats::Backtrace==tag || MemStats::Propagation==tag;
+  }
+}
+const char* MemStats::tagName(Tag t){
+  static const char* Names[NumTags]={"untagged","graph","reverse_graph","dfrontier","backtrace","propagation","netlist","patterns"};
+  return Names[t];
+}
+void* MemStats::allocate(size_t size){
+  Header* h=static_cast<Header*>(malloc(sizeof(Header)+size));
+  if(0==h) return 0;
+  unsigned tag=tTag;
+  h->size=size;
+  h->tag=tag;
+  long long now=sInUse[tag].fetch_add(static_cast<long long>(size),memory_order_relaxed)+static_cast<long long>(size);
+  long long peak=sPeak[tag].load(memory_order_relaxed);
+  while(now>peak && !sPeak[tag].compare_exchange_weak(peak,now,memory_order_relaxed)){}
+  sAllocs[tag].fetch_add(1,memory_order_relaxed);
+  if(loopTag(tag) && sSites.load(memory_order_relaxed)) recordSite(tag,size);
+  return h+1;
+}
+void MemStats::release(void* p){
+  if(0==p) return;
+  Header* h=static_cast<Header*>(p)-1;
+  sInUse[h->tag].fetch_sub(static_cast<long long>(h->size),memory_order_relaxed);
+  sFrees[h->tag].fetch_add(1,memory_order_relaxed);
+  free(h);
+}
+void MemStats::recordSite(unsigned tag,size_t size){
+#ifdef MEMSTATS_SITES
+  if(tInSite) return; // backtrace() itself may allocate the first time
+  tInSite=true;
+  void* frames[SiteDepth];
+  int depth=::backtrace(frames,SiteDepth);
+  unsigned long long key=tag;
+  for(int i=0;i<depth;++i) key=(key^reinterpret_cast<unsigned long long>(frames[i]))*1099511628211ull;
+  if(0==key) key=1;
+  SiteTable& t=sSiteTable;
+  {
+    lock_guard<mutex> lock(t.m);
+    unsigned i=static_cast<unsigned>(key%SiteSlots);
+    for(unsigned probe=0;probe<SiteSlots;++probe,i=(i+1)%SiteSlots){
+      Site& s=t.slots[i];
+      if(0==s.key){
+        s.key=key;
+        memcpy(s.frames,frames,sizeof(frames));
+        s.depth=depth;
+        s.tag=tag;
+        ++t.used;
+      }
+      if(key==s.key){
+        ++s.allocs;
+        s.bytes+=size;
+        tInSite=false;
+        return;
+      }
+    }
+    ++t.dropped;
+  }
+  tInSite=false;
+#else
+  (void)tag;
+  (void)size;
+#endif
+}
+void MemStats::enableSites(bool bEnable){
+  sSites.store(bEnable);
+}
+void MemStats::get(Counters c[NumTags]){
+  for(unsigned t=0;t<NumTags;++t){
+    c[t].inUse=sInUse[t].load(memory_order_relaxed);
+    c[t].peak=sPeak[t].load(memory_order_relaxed);
+    c[t].allocs=sAllocs[t].load(memory_order_relaxed);
+    c[t].frees=sFrees[t].load(memory_order_relaxed);
+  }
+}
+void MemStats::mark(const char* phase){
+  Scope untagged(Untagged); // the snapshot itself is not part of any subsystem
+  Snapshot s;
+  s.phase=phase;
+  get(s.c);
+  for(unsigned t=0;t<NumTags;++t) sPeak[t].store(sInUse[t].load(memory_order_relaxed),memory_order_relaxed);
+  Registry& r=registry();
+  lock_guard<mutex> lock(r.m);
+  r.snapshots.push_back(s);
+}
+namespace{
+  void writeCounters(ostream& os,const char* phase,const MemStats::Counters c[MemStats::NumTags]){
+    os << "\n" << phase << "\n";
+    os << "  " << left << setw(14) << "tag" << right << setw(14) << "in use" << setw(14) << "peak"
+       << setw(12) << "allocs" << setw(12) << "frees" << "\n";
+    MemStats::Counters sum={0,0,0,0};
+    for(unsigned t=0;t<MemStats::NumTags;++t){
+      if(0==c[t].allocs && 0==c[t].frees) continue;
+      os << "  " << left << setw(14) << MemStats::tagName(static_cast<MemStats::Tag>(t)) << right
+         << setw(14) << c[t].inUse << setw(14) << c[t].peak << setw(12) << c[t].allocs << setw(12) << c[t].frees << "\n";
+      sum.inUse+=c[t].inUse;
+      sum.allocs+=c[t].allocs;
+      sum.frees+=c[t].frees;
+    }
+    os << "  " << left << setw(14) << "total" << right << setw(14) << sum.inUse << setw(14) << ""
+       << setw(12) << sum.allocs << setw(12) << sum.frees << "\n";
+  }
+#ifdef MEMSTATS_SITES
+  string frameName(const char* symbol){
+  /* backtrace_symbols gives "binary(mangled+0x1f) [0x...]", keep the
+     demangled function, or binary(+offset) when there is no symbol.
+  */
+    const char* open=strchr(symbol,'(');
+    const char* plus=(0!=open) ? strchr(open,'+') : 0;
+    if(0==open || 0==plus || plus==open+1){
+      const char* end=(0!=open) ? strchr(open,')') : 0;
+      return (0!=end) ? string(symbol,end+1) : string(symbol);
+    }
+    string mangled(open+1,plus);
+    int status=0;
+    char* demangled=abi::__cxa_demangle(mangled.c_str(),0,0,&status);
+    string name=(0==status && 0!=demangled) ? string(demangled) : mangled;
+    free(demangled);
+    if(name.size()>100) name=name.substr(0,97)+"...";
+    return name;
+  }
+  bool hookFrame(const string& name){
+    return 0==name.compare(0,10,"MemStats::") || 0==name.compare(0,12,"operator new");
+  }
+#endif
+  void writeSites(ostream& os){
+#ifdef MEMSTATS_SITES
+  /* Repeated frames ( recursion of depth_first_visit ) are shown once, and
+     stacks that are then the same in the frames shown are merged.
+  */
+    SiteTable& t=sSiteTable;
+    vector<Site> sites;
+    unsigned long long dropped;
+    {
+      lock_guard<mutex> lock(t.m);
+      for(unsigned i=0;i<SiteSlots;++i) if(0!=t.slots[i].key) sites.push_back(t.slots[i]);
+      dropped=t.dropped;
+    }
+    const unsigned Frames=4;
+    map<pair<unsigned,string>,pair<unsigned long long,unsigned long long> > merged; // (tag,stack) to (allocs,bytes)
+    unsigned long long total=0;
+    for(size_t i=0;i<sites.size();++i){
+      const Site& s=sites[i];
+      string stack;
+      char** symbols=backtrace_symbols(s.frames,s.depth);
+      unsigned printed=0;
+      string previous;
+      for(int f=0;0!=symbols && f<s.depth && printed<Frames;++f){
+        string name=frameName(symbols[f]);
+        if(hookFrame(name) || name==previous) continue;
+        previous=name;
+        stack+=((0==printed) ? "" : "\n                                      <- ")+name;
+        ++printed;
+      }
+      free(symbols);
+      pair<unsigned long long,unsigned long long>& m=merged[make_pair(s.tag,stack)];
+      m.first+=s.allocs;
+      m.second+=s.bytes;
+      total+=s.allocs;
+    }
+    typedef pair<pair<unsigned,string>,pair<unsigned long long,unsigned long long> > Entry;
+    vector<Entry> order(merged.begin(),merged.end());
+    sort(order.begin(),order.end(),[](const Entry& a,const Entry& b){ return a.second.first>b.second.first; });
+    os << "\nHot allocation sites in the ATPG loop, " << order.size() << " sites, " << total << " allocations";
+    if(0!=dropped) os << ", " << dropped << " allocations not recorded ( table full )";
+    os << "\n";
+    os << "  " << right << setw(10) << "allocs" << setw(12) << "bytes" << "  " << left << setw(12) << "tag" << "call stack, innermost first\n";
+    const size_t Shown=20;
+    for(size_t i=0;i<order.size() && i<Shown;++i){
+      os << "  " << right << setw(10) << order[i].second.first << setw(12) << order[i].second.second << "  " << left
+         << setw(12) << MemStats::tagName(static_cast<MemStats::Tag>(order[i].first.first)) << order[i].first.second << "\n";
+    }
+    if(order.size()>Shown) os << "  ... " << order.size()-Shown << " more\n";
+#else
+    os << "\nAllocation sites need glibc backtrace(), not available on this platform\n";
+#endif
+  }
+}
+bool MemStats::write(const string& path){
+  Scope untagged(Untagged);
+  ofstream os(path.c_str());
+  if(!os.good()) return false;
+  os << "Heap by subsystem, bytes requested ( the " << sizeof(Header) << " byte header of each block not included )\n";
+  os << "peak is the largest in use since the previous phase\n";
+  {
+    Registry& r=registry();
+    lock_guard<mutex> lock(r.m);
+    for(size_t i=0;i<r.snapshots.size();++i){
+      string phase=string("after ")+r.snapshots[i].phase;
+      writeCounters(os,phase.c_str(),r.snapshots[i].c);
+    }
+  }
+  Counters c[NumTags];
+  get(c);
+  writeCounters(os,"at exit",c);
+  if(sSites.load()) writeSites(os);
+  return os.good();
+}
+
+#ifndef MEMSTATS_OFF
+// ------------------------------------------------------------
+// global operator new and delete
+// ------------------------------------------------------------
+void* operator new(size_t size){
+  void* p=MemStats::allocate(size);
+  if(0==p) throw bad_alloc();
+  return p;
+}
+void* operator new[](size_t size){
+  void* p=MemStats::allocate(size);
+  if(0==p) throw bad_alloc();
+  return p;
+}
+void* operator new(size_t size,const nothrow_t&) noexcept{
+  return MemStats::allocate(size);
+}
+void* operator new[](size_t size,const nothrow_t&) noexcept{
+  return MemStats::allocate(size);
+}
+void operator delete(void* p) noexcept{
+  MemStats::release(p);
+}
+void operator delete[](void* p) noexcept{
+  MemStats::release(p);
+}
+void operator delete(void* p,size_t) noexcept{
+  MemStats::release(p);
+}
+void operator delete[](void* p,size_t) noexcept{
+  MemStats::release(p);
+}
+void operator delete(void* p,const nothrow_t&) noexcept{
+  MemStats::release(p);
+}
+void operator delete[](void* p,const nothrow_t&) noexcept{
+  MemStats::release(p);
+}
+#endif
@@ -0,0 +1,96 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __MemStats__
+#define __MemStats__
+#include <string>
+#include <cstddef>
+
+// ------------------------------------------------------------
+// class MemStats
+// ------------------------------------------------------------
+class MemStats{
+/* Heap accounting by subsystem, to find out what a large design spends
+   its memory on.
+
+   MemStats.cpp replaces the global operator new and delete. Every block
+   gets a 16 byte header holding its size and the tag of the thread that
+   allocated it, so a block freed on another thread, or after its Scope
+   has ended, is still taken off the right tag. Per tag it keeps
+      in use   bytes requested and not yet freed ( headers not included )
+      peak     largest in use since the previous mark()
+      allocs   operator new calls
+      frees    operator delete calls
+   The tag is a thread_local set by a Scope, blocks allocated outside any
+   scope count as untagged.
+
+   Tags
+      Graph         the BGL adjacency list and its Graphviz attribute maps,
+                    or a DotStore
+      ReverseGraph  the reverse_graph adaptor used by backtrace
+      DFrontier     the D-frontier deque and updateDFrontier
+      Backtrace     set<VertexSignalPair> and the DFS color map
+      Propagation   the propagation deque and the NetSignals store
+      Netlist       compiled Netlist
+      Patterns      pattern files and PatternSim
+
+   mark(phase) records a snapshot of all tags at a phase boundary, and
+   resets the peaks so that each snapshot shows the peak within its phase.
+   write(path) prints the snapshots and, if enableSites(true) was called,
+   the allocation sites seen under the ATPG loop tags ( DFrontier,
+   Backtrace, Propagation ) ordered by count. A site is the call stack a
+   few frames above operator new, taken with backtrace(), which costs
+   about a microsecond per allocation, so sites are off by default. Link
+   with -rdynamic to get function names instead of offsets, addr2line
+   resolves the offsets otherwise.
+
+   Use the macros, they expand to nothing when compiled with MEMSTATS_OFF,
+   which also leaves operator new alone :
+      MEMSTATS_TAG(MemStats::Backtrace);   // tags the enclosing scope
+      MEMSTATS_MARK("load");
+   NB - counters are shared atomics, an allocation costs a few relaxed
+        atomic adds on top of malloc
+ */
+public:
+  enum Tag{Untagged,Graph,ReverseGraph,DFrontier,Backtrace,Propagation,Netlist,Patterns,NumTags};
+  struct Counters{
+    long long inUse;
+    long long peak;
+    unsigned long long allocs;
+    unsigned long long frees;
+  };
+  class Scope{
+  public:
+    Scope(Tag t) : _previous(tTag) { tTag=static_cast<unsigned char>(t); }
+    ~Scope(){ tTag=_previous; }
+  private:
+    Scope(const Scope&);
+    Scope& operator=(const Scope&);
+    unsigned char _previous;
+  };
+  static Tag current(){ return static_cast<Tag>(tTag); }
+  static void get(Counters c[NumTags]);
+  static void mark(const char* phase);
+  static void enableSites(bool bEnable);
+  static bool write(const std::string& path);
+  static const char* tagName(Tag t);
+
+  // operator new and delete, in MemStats.cpp
+  static void* allocate(std::size_t size);
+  static void release(void* p);
+private:
+  MemStats();
+  static void recordSite(unsigned tag,std::size_t size);
+  static thread_local unsigned char tTag;
+};
+
+#ifdef MEMSTATS_OFF
+#define MEMSTATS_TAG(t)
+#define MEMSTATS_MARK(p)
+#else
+#define MEMSTATS_TAG(t) MemStats::Scope memStatsScope(t)
+#define MEMSTATS_MARK(p) MemStats::mark(p)
+#endif
+#endif // __MemStats__
@@ -0,0 +1,67 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "NetSignals.hpp"
+#include <algorithm>
+using namespace std;
+
+void NetSignals::clear(size_t numVertices){
+  _net.assign(numVertices,DLogic::X);
+  if(_fanout.size()!=numVertices) _fanout.assign(numVertices,0);
+  _numBranches.assign(numVertices,0);
+  _branches.clear();
+  _bLoaded=true;
+}
+const DLogic& NetSignals::findBranch(Vertex source,Edge e) const{
+  Branch probe={source,e,DLogic::X};
+  vector<Branch>::const_iterator it=lower_bound(_branches.begin(),_branches.end(),probe);
+  return (_branches.end()!=it && it->source==source && it->edge==e) ? it->value : _net[source];
+}
+void NetSignals::setBranch(Vertex source,Edge e,const DLogic& d){
+  Branch b={source,e,d};
+  vector<Branch>::iterator it=lower_bound(_branches.begin(),_branches.end(),b);
+  if(_branches.end()!=it && it->source==source && it->edge==e){
+    it->value=d;
+  }else{
+    _branches.insert(it,b);
+    ++_numBranches[source];
+  }
+}
+unsigned NetSignals::drive(Vertex v,const DLogic& d){
+  unsigned notX=0;
+  unsigned stemBranches=_fanout[v]-_numBranches[v];
+  if(DLogic::X==_net[v]) _net[v]=d;
+  else notX+=stemBranches;
+  if(0==_numBranches[v]) return notX;
+  Branch probe={v,0,DLogic::X};
+  for(vector<Branch>::iterator it=lower_bound(_branches.begin(),_branches.end(),probe);_branches.end()!=it && v==it->source;++it){
+    if(DLogic::X==it->value) it->value=d;
+    else ++notX;
+  }
+  return notX;
+}
+DLogic NetSignals::evaluate(Vertex v,bool& bIncompatible) const{
+  bIncompatible=false;
+  const DLogic* pReal=0; // first value other than X
+  if(_fanout[v]>_numBranches[v] && DLogic::X!=_net[v]) pReal=&_net[v];
+  if(0!=_numBranches[v]){
+    Branch probe={v,0,DLogic::X};
+    for(vector<Branch>::const_iterator it=lower_bound(_branches.begin(),_branches.end(),probe);_branches.end()!=it && v==it->source;++it){
+      if(DLogic::X==it->value) continue;
+      if(0==pReal) pReal=&it->value;
+      else if(*pReal!=it->value) bIncompatible=true;
+    }
+  }
+  return (bIncompatible || 0==pReal) ? DLogic::X : *pReal;
+}
+bool NetSignals::hasX(Vertex v) const{
+  if(_fanout[v]>_numBranches[v] && DLogic::X==_net[v]) return true;
+  if(0==_numBranches[v]) return false;
+  Branch probe={v,0,DLogic::X};
+  for(vector<Branch>::const_iterator it=lower_bound(_branches.begin(),_branches.end(),probe);_branches.end()!=it && v==it->source;++it){
+    if(DLogic::X==it->value) return true;
+  }
+  return false;
+}
@@ -0,0 +1,78 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __NetSignals__
+#define __NetSignals__
+#include <vector>
+#include <cstddef>
+#include "DLogic.hpp"
+
+// ------------------------------------------------------------
+// class NetSignals
+// ------------------------------------------------------------
+class NetSignals{
+/* Signal values of the ATPG search, one per net instead of one per edge.
+
+   Every vertex drives one net, its stem, and each out edge is a fanout
+   branch. A branch reads the stem value unless it has a value of its own,
+   which only the injected branch faults have ( a D or _D on one branch of
+   a fanout ), or edges whose label differed from the first out edge of
+   their vertex in the input file. Branch values are kept in a short array
+   sorted by vertex, and a count per vertex lets every other net skip it,
+   so reading a branch, driving a net and evaluating a net are O(1) plus
+   the branch values of that one vertex, whatever the fanout.
+
+   drive and evaluate keep the rules of the edge label code they replace
+      drive(v,d)     sets the stem and every X branch value to d, the
+                     other branches keep their value and are counted
+      evaluate(v)    the one non X value on v's branches, X if none, and
+                     bIncompatible if there are two different ones
+
+   Vertices are vecS indices and edges their edge_index, so the store does
+   not depend on the graph type.
+
+   Usage :
+      NetSignals s;
+      s.clear(num_vertices(g));               // every net X
+      s.setFanout(v,out_degree(v,g));         // for every vertex
+      s.setBranch(u,edgeIndex,DLogic::D);     // inject a branch fault
+      s.branch(source(e,g),edgeIndex)         // value on edge e
+   NB - compiler defaults of destructor, copy constructor, operator= sufficient
+ */
+public:
+  typedef std::size_t Vertex;
+  typedef std::size_t Edge;
+
+  NetSignals() : _bLoaded(false) {}
+  void clear(std::size_t numVertices); // every net X, fanouts kept if the size is the same
+  void setFanout(Vertex v,unsigned numBranches){ _fanout[v]=numBranches; }
+  bool loaded() const { return _bLoaded; }
+  std::size_t size() const { return _net.size(); }
+
+  const DLogic& net(Vertex v) const { return _net[v]; }
+  void setNet(Vertex v,const DLogic& d){ _net[v]=d; }
+  const DLogic& branch(Vertex source,Edge e) const {
+    return (0==_numBranches[source]) ? _net[source] : findBranch(source,e);
+  }
+  void setBranch(Vertex source,Edge e,const DLogic& d); // own value for one branch
+  unsigned drive(Vertex v,const DLogic& d); // returns the branches that were not X
+  DLogic evaluate(Vertex v,bool& bIncompatible) const;
+  bool hasX(Vertex v) const;
+  std::size_t numBranchValues() const { return _branches.size(); }
+private:
+  struct Branch{
+    Vertex source;
+    Edge edge;
+    DLogic value;
+    bool operator<(const Branch& rhs) const { return source<rhs.source || (source==rhs.source && edge<rhs.edge); }
+  };
+  const DLogic& findBranch(Vertex source,Edge e) const;
+  bool _bLoaded;
+  std::vector<DLogic> _net;              // stem value per vertex
+  std::vector<unsigned> _fanout;         // out edges per vertex
+  std::vector<unsigned> _numBranches;    // branch values per vertex
+  std::vector<Branch> _branches;         // sorted by source, edge
+};
+#endif // __NetSignals__
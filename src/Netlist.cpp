@@ -0,0 +1,308 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "Netlist.hpp"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <assert.h>
+using namespace std;
+
+Netlist::GateType Netlist::typeFromFunc(const string& func){
+  /* Same function names as EvaluateSingleInput and EvaluateMultipleInputs */
+  if("in"==func) return In;
+  if("out"==func) return Out;
+  if("noop"==func) return Noop;
+  if("buf"==func) return Buf;
+  if("inv"==func || "not"==func) return Not;
+  if("and"==func) return And;
+  if("nand"==func) return Nand;
+  if("or"==func) return Or;
+  if("nor"==func) return Nor;
+  return Unknown;
+}
+const char* Netlist::funcName(GateType t){
+  static const char* Names[NumGateTypes]={"unknown","noop","in","out","buf","not","and","nand","or","nor","lut"};
+  return (t<NumGateTypes) ? Names[t] : Names[Unknown];
+}
+Netlist::Ordering Netlist::orderingFromName(const string& name){
+  for(unsigned o=0;o<NumOrderings;++o) if(name==orderingName(static_cast<Ordering>(o))) return static_cast<Ordering>(o);
+  return NumOrderings;
+}
+const char* Netlist::orderingName(Ordering o){
+  static const char* Names[NumOrderings]={"file","level","rcm","cone"};
+  return (o<NumOrderings) ? Names[o] : "unknown";
+}
+const char* Netlist::orderingNames(){
+  return "file, level, rcm or cone";
+}
+Netlist::GateId Netlist::addGate(const string& name,GateType type){
+  return addGate(StringPool::global().intern(name),type);
+}
+Netlist::GateId Netlist::addGate(StringPool::Id name,GateType type){
+  assert(!_levelized);
+  GateId g=static_cast<GateId>(_type.size());
+  _type.push_back(static_cast<unsigned char>(type));
+  _name.push_back(name);
+  _pending.push_back(vector<GateId>());
+  _byName.insert(_name,g);
+  if(In==type) _inputs.push_back(g);
+  if(Out==type) _outputs.push_back(g);
+  return g;
+}
+Netlist::GateId Netlist::addGate(const string& name,const string& func){
+  return addGate(StringPool::global().intern(name),func);
+}
+Netlist::GateId Netlist::addGate(StringPool::Id name,const string& func){
+  GateType type=typeFromFunc(func);
+  if(Unknown!=type || !TruthTable::isCell(func)) return addGate(name,type);
+  GateId g=addGate(name,Lut);
+  _pendingCells.push_back(make_pair(g,StringPool::global().intern(func)));
+  return g;
+}
+void Netlist::addFanin(GateId g,GateId driver){
+  assert(!_levelized && g<size() && driver<size());
+  _pending[g].push_back(driver);
+}
+Netlist::GateId Netlist::findGate(const string& name) const{
+  StringPool::Id id=StringPool::global().find(name);
+  unsigned g=(StringPool::NoId==id) ? IdIndex::None : _byName.find(_name,id);
+  return (IdIndex::None==g) ? static_cast<GateId>(size()) : static_cast<GateId>(g);
+}
+bool Netlist::levelize(){
+/* Builds the fanin/fanout rows and a level order with Kahn's algorithm.
+   Level of a gate is one more than the highest level of its fanins, gates
+   without fanins are level 0. _order is sorted by level, so every gate
+   appears after all of its fanins.
+*/
+  size_t n=size();
+  _faninStart.assign(n+1,0);
+  _fanoutStart.assign(n+1,0);
+  for(size_t g=0;g<n;++g){
+    _faninStart[g+1]=_faninStart[g]+_pending[g].size();
+    for(size_t i=0;i<_pending[g].size();++i) ++_fanoutStart[_pending[g][i]+1];
+  }
+  for(size_t g=0;g<n;++g) _fanoutStart[g+1]+=_fanoutStart[g];
+  _fanin.resize(_faninStart[n]);
+  _fanout.resize(_fanoutStart[n]);
+  vector<unsigned> fill(_fanoutStart.begin(),_fanoutStart.end()-1);
+  for(size_t g=0;g<n;++g){
+    for(size_t i=0;i<_pending[g].size();++i){
+      GateId d=_pending[g][i];
+      _fanin[_faninStart[g]+i]=d;
+      _fanout[fill[d]++]=static_cast<GateId>(g);
+    }
+  }
+  vector<vector<GateId> >().swap(_pending);
+  makeTables();
+
+  _level.assign(n,0);
+  _order.clear();
+  _order.reserve(n);
+  vector<unsigned> remaining(n);
+  for(size_t g=0;g<n;++g){
+    remaining[g]=numFanins(static_cast<GateId>(g));
+    if(0==remaining[g]) _order.push_back(static_cast<GateId>(g));
+  }
+  for(size_t head=0;head<_order.size();++head){
+    GateId g=_order[head];
+    for(unsigned i=0;i<numFanouts(g);++i){
+      GateId f=fanouts(g)[i];
+      if(_level[f]<_level[g]+1) _level[f]=_level[g]+1;
+      if(0==--remaining[f]) _order.push_back(f);
+    }
+  }
+  _levelized=true;
+  if(_order.size()!=n) return false;
+  // Kahn's order is topological but not sorted by level, make it so
+  sortByLevel();
+  return true;
+}
+void Netlist::makeTables(){
+/* One table per cell function and number of fanins */
+  if(_pendingCells.empty()) return;
+  StringPool& pool=StringPool::global();
+  map<pair<StringPool::Id,unsigned>,unsigned> known;
+  _cell.assign(size(),0);
+  for(size_t i=0;i<_pendingCells.size();++i){
+    GateId g=_pendingCells[i].first;
+    pair<StringPool::Id,unsigned> key(_pendingCells[i].second,numFanins(g));
+    map<pair<StringPool::Id,unsigned>,unsigned>::iterator it=known.find(key);
+    if(known.end()==it){
+      TruthTable t;
+      unsigned index=~0u;
+      if(TruthTable::fromFunc(pool.str(key.first),key.second,t)){
+        index=static_cast<unsigned>(_tables.size());
+        _tables.push_back(t);
+      }
+      it=known.insert(make_pair(key,index)).first;
+    }
+    if(~0u==it->second){
+      cout << "Warning! Gate " << getName(g) << " : no " << pool.str(key.first) << " cell of "
+           << key.second << " inputs, simulated as X\n";
+      _type[g]=static_cast<unsigned char>(Unknown);
+    }else{
+      _cell[g]=it->second;
+    }
+  }
+  vector<pair<GateId,StringPool::Id> >().swap(_pendingCells);
+}
+void Netlist::sortByLevel(){
+/* _order by level, gates of one level by id */
+  size_t n=size();
+  _depth=0;
+  for(size_t g=0;g<n;++g) if(_level[g]>_depth) _depth=_level[g];
+  vector<unsigned> count(_depth+2,0);
+  for(size_t g=0;g<n;++g) ++count[_level[g]+1];
+  for(unsigned l=0;l<=_depth;++l) count[l+1]+=count[l];
+  _order.resize(n);
+  for(size_t g=0;g<n;++g) _order[count[_level[g]]++]=static_cast<GateId>(g);
+  groupByKind();
+}
+void Netlist::groupByKind(){
+/* _schedule is _order with each level stably sorted by type and arity,
+   _groups the runs of one type and arity
+*/
+  size_t n=_order.size();
+  _schedule=_order;
+  _groups.clear();
+  for(size_t begin=0;begin<n;){
+    size_t end=begin;
+    unsigned level=_level[_schedule[begin]];
+    while(end<n && level==_level[_schedule[end]]) ++end;
+    stable_sort(_schedule.begin()+begin,_schedule.begin()+end,[this](GateId a,GateId b){
+      return _type[a]<_type[b] || (_type[a]==_type[b] && numFanins(a)<numFanins(b));
+    });
+    for(size_t i=begin;i<end;){
+      GateId g=_schedule[i];
+      GateGroup group={getType(g),numFanins(g),static_cast<unsigned>(i),static_cast<unsigned>(i)};
+      while(group.end<end && _type[_schedule[group.end]]==_type[g] && numFanins(_schedule[group.end])==group.arity) ++group.end;
+      _groups.push_back(group);
+      i=group.end;
+    }
+    begin=end;
+  }
+}
+void Netlist::computeOrdering(Ordering o,vector<GateId>& newToOld) const{
+  assert(_levelized);
+  size_t n=size();
+  newToOld.clear();
+  newToOld.reserve(n);
+  vector<char> seen(n,0);
+  if(LevelOrder==o){
+    // BFS from the sources along the fanouts, then a stable sort by level
+    for(size_t g=0;g<n;++g){
+      if(0==numFanins(static_cast<GateId>(g))){ newToOld.push_back(static_cast<GateId>(g)); seen[g]=1; }
+    }
+    for(size_t head=0;head<newToOld.size();++head){
+      GateId g=newToOld[head];
+      for(unsigned i=0;i<numFanouts(g);++i){
+        GateId f=fanouts(g)[i];
+        if(!seen[f]){ seen[f]=1; newToOld.push_back(f); }
+      }
+    }
+    vector<unsigned> count(_depth+2,0);
+    for(size_t g=0;g<n;++g) ++count[_level[g]+1];
+    for(unsigned l=0;l<=_depth;++l) count[l+1]+=count[l];
+    vector<GateId> bfs(newToOld);
+    for(size_t i=0;i<n;++i) newToOld[count[_level[bfs[i]]]++]=bfs[i];
+  }else if(RcmOrder==o){
+    vector<unsigned> degree(n);
+    vector<GateId> byDegree(n);
+    for(size_t g=0;g<n;++g){
+      degree[g]=numFanins(static_cast<GateId>(g))+numFanouts(static_cast<GateId>(g));
+      byDegree[g]=static_cast<GateId>(g);
+    }
+    stable_sort(byDegree.begin(),byDegree.end(),[&](GateId a,GateId b){ return degree[a]<degree[b]; });
+    vector<GateId> neighbours;
+    for(size_t start=0;start<n;++start){
+      if(seen[byDegree[start]]) continue;
+      size_t head=newToOld.size();
+      newToOld.push_back(byDegree[start]);
+      seen[byDegree[start]]=1;
+      for(;head<newToOld.size();++head){
+        GateId g=newToOld[head];
+        neighbours.clear();
+        for(unsigned i=0;i<numFanins(g);++i) if(!seen[fanins(g)[i]]){ seen[fanins(g)[i]]=1; neighbours.push_back(fanins(g)[i]); }
+        for(unsigned i=0;i<numFanouts(g);++i) if(!seen[fanouts(g)[i]]){ seen[fanouts(g)[i]]=1; neighbours.push_back(fanouts(g)[i]); }
+        stable_sort(neighbours.begin(),neighbours.end(),[&](GateId a,GateId b){ return degree[a]<degree[b]; });
+        newToOld.insert(newToOld.end(),neighbours.begin(),neighbours.end());
+      }
+    }
+    reverse(newToOld.begin(),newToOld.end());
+  }else if(ConeOrder==o){
+    // postorder DFS through the fanins, from the POs, then from any other sink
+    vector<GateId> roots(_outputs);
+    for(size_t g=0;g<n;++g) if(0==numFanouts(static_cast<GateId>(g))) roots.push_back(static_cast<GateId>(g));
+    for(size_t g=0;g<n;++g) roots.push_back(static_cast<GateId>(g));
+    vector<pair<GateId,unsigned> > stack;
+    for(size_t r=0;r<roots.size();++r){
+      if(seen[roots[r]]) continue;
+      seen[roots[r]]=1;
+      stack.push_back(make_pair(roots[r],0u));
+      while(!stack.empty()){
+        GateId g=stack.back().first;
+        unsigned& next=stack.back().second;
+        if(next<numFanins(g)){
+          GateId d=fanins(g)[next++];
+          if(!seen[d]){ seen[d]=1; stack.push_back(make_pair(d,0u)); }
+        }else{
+          newToOld.push_back(g);
+          stack.pop_back();
+        }
+      }
+    }
+  }else{
+    for(size_t g=0;g<n;++g) newToOld.push_back(static_cast<GateId>(g));
+  }
+}
+void Netlist::renumber(const vector<GateId>& newToOld){
+  assert(_levelized && newToOld.size()==size());
+  size_t n=size();
+  vector<GateId> oldToNew(n);
+  for(size_t g=0;g<n;++g) oldToNew[newToOld[g]]=static_cast<GateId>(g);
+  vector<unsigned char> type(n);
+  vector<StringPool::Id> name(n);
+  vector<unsigned> level(n);
+  vector<GateId> original(n);
+  vector<unsigned> cell(_cell.empty() ? 0 : n);
+  vector<unsigned> faninStart(n+1,0),fanoutStart(n+1,0);
+  vector<GateId> fanin,fanout;
+  fanin.reserve(_fanin.size());
+  fanout.reserve(_fanout.size());
+  for(size_t g=0;g<n;++g){
+    GateId old=newToOld[g];
+    type[g]=_type[old];
+    name[g]=_name[old];
+    level[g]=_level[old];
+    original[g]=getOriginalId(old);
+    if(!_cell.empty()) cell[g]=_cell[old];
+    for(unsigned i=0;i<numFanins(old);++i) fanin.push_back(oldToNew[fanins(old)[i]]);
+    for(unsigned i=0;i<numFanouts(old);++i) fanout.push_back(oldToNew[fanouts(old)[i]]);
+    faninStart[g+1]=static_cast<unsigned>(fanin.size());
+    fanoutStart[g+1]=static_cast<unsigned>(fanout.size());
+  }
+  _type.swap(type);
+  _name.swap(name);
+  _level.swap(level);
+  _original.swap(original);
+  _cell.swap(cell);
+  _faninStart.swap(faninStart);
+  _fanin.swap(fanin);
+  _fanoutStart.swap(fanoutStart);
+  _fanout.swap(fanout);
+  for(size_t i=0;i<_inputs.size();++i) _inputs[i]=oldToNew[_inputs[i]];
+  for(size_t i=0;i<_outputs.size();++i) _outputs[i]=oldToNew[_outputs[i]];
+  // same gate found for a repeated name as before
+  _byName.clear();
+  for(size_t g=0;g<n;++g) _byName.insert(_name,oldToNew[g]);
+  sortByLevel();
+}
+void Netlist::reorder(Ordering o){
+  if(FileOrder==o) return;
+  vector<GateId> newToOld;
+  computeOrdering(o,newToOld);
+  renumber(newToOld);
+}
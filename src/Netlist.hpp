@@ -0,0 +1,141 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __Netlist__
+#define __Netlist__
+#include <string>
+#include <vector>
+#include <utility>
+#include "StringPool.hpp"
+#include "TruthTable.hpp"
+
+// ------------------------------------------------------------
+// class Netlist
+// ------------------------------------------------------------
+class Netlist{
+/* Compiled, levelized form of the circuit graph, used by the simulators.
+   Each gate drives exactly one net, so gates and nets share the same id.
+   Gate ids follow the order of addGate, which for a compiled RunGraph is
+   the vertex order, so the PI/PO order matches the pattern files.
+
+   Build :
+      Netlist n;
+      GateId a=n.addGate("a",Netlist::In);
+      GateId z=n.addGate("z",Netlist::Not);
+      n.addFanin(z,a);
+      n.levelize();
+
+   Fanins and fanouts are kept in flat arrays ( compressed rows ) once
+   levelize has been called. addGate/addFanin after levelize are not allowed.
+   Names are interned in StringPool::global(), a gate keeps the 4 byte Id.
+
+   Reorder :
+      n.reorder(Netlist::ConeOrder);
+   renumbers every gate for cache locality, once levelized. Gate ids from
+   a dot file follow node_id order, so the fanins of a gate are scattered
+   over the arrays; the orderings put gates that are evaluated together
+   next to each other
+      file    as read, no renumbering
+      level   levelized BFS, by level, and within a level in the order BFS
+              from the sources reaches the gates, so fanouts of one gate
+              stay together
+      rcm     reverse Cuthill-McKee over fanins and fanouts, bandwidth
+              reduction, each component started at a lowest degree gate
+      cone    DFS from each PO in turn through the fanins, postorder, so
+              every output cone is a contiguous run of ids
+   Every per-gate array is renumbered, fanin order within a gate is kept,
+   and the PI and PO lists keep their order, so pattern files still match.
+   getOriginalId maps a gate back to its id before any renumbering.
+
+   Schedule :
+      getSchedule() is the level order with the gates of each level sorted
+      by type and number of fanins, and getGroups() the runs of one type
+      and arity in it, so a simulator can run one kernel, specialized for
+      the type and arity, over a whole group without a switch per gate.
+      Gates of one level do not depend on each other, any order of them
+      is a valid evaluation order.
+
+   Cells :
+      GateId x=n.addGate("x","aoi21");
+   adds a gate by the function name of its vertex label. Primitives get
+   their type, names TruthTable::isCell knows become Lut gates, whose
+   table is built by levelize for the number of fanins added, in fanin
+   order, and is then getTable(x). A cell with no table of that many
+   inputs becomes Unknown, with a warning. Gates of one cell share a table.
+   NB - compiler defaults of destructor, copy constructor, operator= sufficient
+ */
+public:
+  typedef unsigned GateId;
+  enum GateType{Unknown,Noop,In,Out,Buf,Not,And,Nand,Or,Nor,Lut,NumGateTypes};
+  static GateType typeFromFunc(const std::string& func);
+  static const char* funcName(GateType t);
+  enum Ordering{FileOrder,LevelOrder,RcmOrder,ConeOrder,NumOrderings};
+  struct GateGroup{
+    GateType type;
+    unsigned arity;
+    unsigned begin; // into getSchedule()
+    unsigned end;
+  };
+  static Ordering orderingFromName(const std::string& name); // NumOrderings if unknown
+  static const char* orderingName(Ordering o);
+  static const char* orderingNames(); // for help messages
+
+  Netlist() : _levelized(false), _depth(0) {}
+  GateId addGate(const std::string& name,GateType type);
+  GateId addGate(StringPool::Id name,GateType type); // name from StringPool::global()
+  GateId addGate(const std::string& name,const std::string& func); // primitive or cell, see Cells
+  GateId addGate(StringPool::Id name,const std::string& func);
+  void addFanin(GateId g,GateId driver);
+  bool levelize(); // false if the netlist has a combinational loop
+  void computeOrdering(Ordering o,std::vector<GateId>& newToOld) const;
+  void renumber(const std::vector<GateId>& newToOld); // gate newToOld[g] becomes g
+  void reorder(Ordering o);
+
+  std::size_t size() const { return _type.size(); }
+  bool isLevelized() const { return _levelized; }
+  GateType getType(GateId g) const { return static_cast<GateType>(_type[g]); }
+  std::string getName(GateId g) const { return StringPool::global().str(_name[g]); }
+  StringPool::Id getNameId(GateId g) const { return _name[g]; }
+  unsigned getLevel(GateId g) const { return _level[g]; }
+  unsigned getDepth() const { return _depth; }
+  unsigned numFanins(GateId g) const { return _faninStart[g+1]-_faninStart[g]; }
+  const GateId* fanins(GateId g) const { return _fanin.data()+_faninStart[g]; }
+  unsigned numFanouts(GateId g) const { return _fanoutStart[g+1]-_fanoutStart[g]; }
+  const GateId* fanouts(GateId g) const { return _fanout.data()+_fanoutStart[g]; }
+  const std::vector<GateId>& getOrder() const { return _order; }   // level order
+  const std::vector<GateId>& getSchedule() const { return _schedule; } // level order, grouped
+  const std::vector<GateGroup>& getGroups() const { return _groups; }
+  const std::vector<GateId>& getInputs() const { return _inputs; }
+  const std::vector<GateId>& getOutputs() const { return _outputs; }
+  GateId findGate(const std::string& name) const; // returns size() if not found
+  GateId getOriginalId(GateId g) const { return _original.empty() ? g : _original[g]; }
+  const TruthTable& getTable(GateId g) const { return _tables[_cell[g]]; } // Lut gates only
+  std::size_t numTables() const { return _tables.size(); }
+private:
+  void makeTables();
+  void sortByLevel();
+  void groupByKind();
+  bool _levelized;
+  unsigned _depth;
+  std::vector<unsigned char> _type;
+  std::vector<StringPool::Id> _name;
+  std::vector<unsigned> _level;
+  std::vector<std::vector<GateId> > _pending; // fanins before levelize
+  std::vector<unsigned> _faninStart;
+  std::vector<GateId> _fanin;
+  std::vector<unsigned> _fanoutStart;
+  std::vector<GateId> _fanout;
+  std::vector<GateId> _order;
+  std::vector<GateId> _schedule;
+  std::vector<GateGroup> _groups;
+  std::vector<GateId> _inputs;
+  std::vector<GateId> _outputs;
+  IdIndex _byName;
+  std::vector<GateId> _original; // empty until renumbered
+  std::vector<std::pair<GateId,StringPool::Id> > _pendingCells; // Lut gates and their function before levelize
+  std::vector<unsigned> _cell;      // into _tables, empty without cells
+  std::vector<TruthTable> _tables;
+};
+#endif // __Netlist__
@@ -0,0 +1,78 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __ParallelFormat__
+#define __ParallelFormat__
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "AsyncWriter.hpp"
+
+// ------------------------------------------------------------
+// function formatInOrder
+// ------------------------------------------------------------
+template<class FormatFunctor>
+void formatInOrder(AsyncWriter& w,std::size_t numChunks,unsigned numThreads,FormatFunctor format){
+/* Formats numChunks chunks of text on numThreads worker threads and writes
+   them to w in chunk order. format(chunk,text) appends chunk's text and must
+   only read shared data.
+   Workers run at most a window of chunks ahead of the writer, so memory
+   stays bounded no matter how large the output is.
+*/
+  if(numThreads<2 || numChunks<2){
+    std::string text;
+    for(std::size_t c=0;c<numChunks;++c){
+      text.clear();
+      format(c,text);
+      w.write(text);
+    }
+    return;
+  }
+  const std::size_t Window=4*numThreads;
+  std::vector<std::string> slot(Window);
+  std::vector<bool> ready(Window,false);
+  std::size_t next=0;     // next chunk to hand out
+  std::size_t written=0;  // chunks already written
+  std::mutex m;
+  std::condition_variable cv;
+  std::vector<std::thread> workers;
+  for(unsigned t=0;t<numThreads;++t){
+    workers.push_back(std::thread([&](){
+      std::string text;
+      for(;;){
+        std::size_t c;
+        {
+          std::unique_lock<std::mutex> lock(m);
+          while(next<numChunks && next>=written+Window) cv.wait(lock);
+          if(next>=numChunks) return;
+          c=next++;
+        }
+        text.clear();
+        format(c,text);
+        std::unique_lock<std::mutex> lock(m);
+        slot[c%Window].swap(text);
+        ready[c%Window]=true;
+        cv.notify_all();
+      }
+    }));
+  }
+  std::string text;
+  for(std::size_t c=0;c<numChunks;++c){
+    {
+      std::unique_lock<std::mutex> lock(m);
+      while(!ready[c%Window]) cv.wait(lock);
+      text.swap(slot[c%Window]);
+      ready[c%Window]=false;
+    }
+    w.write(text);  // may wait on the disk, workers keep formatting
+    std::unique_lock<std::mutex> lock(m);
+    ++written;
+    cv.notify_all();
+  }
+  for(std::size_t t=0;t<workers.size();++t) workers[t].join();
+}
+#endif // __ParallelFormat__
@@ -0,0 +1,257 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "PatternFile.hpp"
+#include <algorithm>
+#include <sstream>
+using namespace std;
+
+const char* PatternFile::Magic="ATPGPATB";
+
+PatternFile::Format PatternFile::formatFromString(const string& s){
+  if("bin"==s || "binary"==s) return Binary;
+  return Text;
+}
+char PatternFile::toChar(const DLogic& d){
+  static const char Chars[]={'0','1','D','B','X'}; // indexed by DLogic::GetInt
+  return d.valid() ? Chars[d.GetInt()] : 'X';
+}
+DLogic PatternFile::fromChar(char c){
+  switch(c){
+  case '0': return DLogic::ZERO;
+  case '1': return DLogic::ONE;
+  case 'D': return DLogic::D;
+  case 'B': return DLogic::_D;
+  default : return DLogic::X;
+  }
+}
+// ------------------------------------------------------------
+// class PatternWriter
+// ------------------------------------------------------------
+PatternWriter::PatternWriter(const string& path,PatternFile::Format format,
+                             const vector<string>& piNames,const vector<string>& poNames) :
+  _writer(path,1<<20,PatternFile::Binary==format), _format(format),
+  _numPI(piNames.size()), _numPO(poNames.size()), _count(0)
+{
+  writeHeader(piNames,poNames);
+}
+PatternWriter::~PatternWriter(){
+  close();
+}
+void PatternWriter::writeUInt(unsigned u){
+  _writer.write(reinterpret_cast<const char*>(&u),sizeof(u));
+}
+void PatternWriter::writeHeader(const vector<string>& piNames,const vector<string>& poNames){
+  if(PatternFile::Text==_format){
+    string header="# atpg patterns\nPI";
+    for(vector<string>::const_iterator it=piNames.begin();it!=piNames.end();++it) header+=" "+*it;
+    header+="\nPO";
+    for(vector<string>::const_iterator it=poNames.begin();it!=poNames.end();++it) header+=" "+*it;
+    header+="\n";
+    _writer.write(header);
+  }else{
+    _writer.write(PatternFile::Magic,8);
+    writeUInt(PatternFile::Version);
+    writeUInt(static_cast<unsigned>(_numPI));
+    writeUInt(static_cast<unsigned>(_numPO));
+    for(vector<string>::const_iterator it=piNames.begin();it!=piNames.end();++it){
+      writeUInt(static_cast<unsigned>(it->size()));
+      _writer.write(*it);
+    }
+    for(vector<string>::const_iterator it=poNames.begin();it!=poNames.end();++it){
+      writeUInt(static_cast<unsigned>(it->size()));
+      _writer.write(*it);
+    }
+    _planes.resize(3*PatternFile::planeWords(_numPI+_numPO));
+  }
+}
+void PatternWriter::addPattern(const vector<DLogic>& piValues,const vector<DLogic>& poValues){
+  /* Missing trailing values are written as X, extra values are ignored */
+  if(PatternFile::Text==_format){
+    _line.clear();
+    for(size_t i=0;i<_numPI;++i) _line+=(i<piValues.size()) ? PatternFile::toChar(piValues[i]) : 'X';
+    _line+=' ';
+    for(size_t i=0;i<_numPO;++i) _line+=(i<poValues.size()) ? PatternFile::toChar(poValues[i]) : 'X';
+    _line+='\n';
+    _writer.write(_line);
+  }else{
+    size_t words=PatternFile::planeWords(_numPI+_numPO);
+    if(0==words){ ++_count; return; }
+    std::fill(_planes.begin(),_planes.end(),0ULL);
+    unsigned long long* care=&_planes[0];
+    unsigned long long* good=care+words;
+    unsigned long long* faulty=good+words;
+    for(size_t i=0;i<_numPI+_numPO;++i){
+      DLogic d=(i<_numPI) ? (i<piValues.size() ? piValues[i] : DLogic::X)
+                          : (i-_numPI<poValues.size() ? poValues[i-_numPI] : DLogic::X);
+      if(!d.valid() || DLogic::X==d) continue;
+      unsigned long long bit=1ULL<<(i%64);
+      care[i/64]|=bit;
+      if(DLogic::ONE==d || DLogic::D==d) good[i/64]|=bit;
+      if(DLogic::ONE==d || DLogic::_D==d) faulty[i/64]|=bit;
+    }
+    _writer.write(reinterpret_cast<const char*>(&_planes[0]),_planes.size()*sizeof(unsigned long long));
+  }
+  ++_count;
+}
+// ------------------------------------------------------------
+// class PatternBlock
+// ------------------------------------------------------------
+void PatternBlock::resize(size_t width,size_t numSignals){
+  _width=width;
+  _words=(width+63)/64;
+  _signals=numSignals;
+  _care.assign(_words*_signals,0ULL);
+  _good.assign(_words*_signals,0ULL);
+  _count=0;
+}
+void PatternBlock::clear(){
+  std::fill(_care.begin(),_care.end(),0ULL);
+  std::fill(_good.begin(),_good.end(),0ULL);
+  _count=0;
+}
+void PatternBlock::swap(PatternBlock& rhs){
+  std::swap(_width,rhs._width);
+  std::swap(_words,rhs._words);
+  std::swap(_signals,rhs._signals);
+  std::swap(_count,rhs._count);
+  _care.swap(rhs._care);
+  _good.swap(rhs._good);
+}
+// ------------------------------------------------------------
+// class PatternReader
+// ------------------------------------------------------------
+PatternReader::PatternReader(const string& path,size_t blockWidth,size_t readAhead) :
+  _format(PatternFile::Text), _blockWidth(blockWidth), _good(false),
+  _eof(false), _stopping(false)
+{
+  _file.open(path.c_str(),ios::in|ios::binary);
+  if(_file.good()) _good=readHeader();
+  if(!_good) return;
+  if(readAhead<2) readAhead=2;
+  _blocks.resize(readAhead);
+  for(size_t i=0;i<_blocks.size();++i){
+    _blocks[i].resize(_blockWidth,_piNames.size()+_poNames.size());
+    _free.push_back(&_blocks[i]);
+  }
+  _thread=thread(&PatternReader::run,this);
+}
+PatternReader::~PatternReader(){
+  if(!_thread.joinable()) return;
+  {
+    unique_lock<mutex> lock(_mutex);
+    _stopping=true;
+    _cv.notify_all();
+  }
+  _thread.join();
+}
+bool PatternReader::readUInt(unsigned& u){
+  return static_cast<bool>(_file.read(reinterpret_cast<char*>(&u),sizeof(u)));
+}
+bool PatternReader::readString(string& s){
+  unsigned len=0;
+  if(!readUInt(len)) return false;
+  s.resize(len);
+  return 0==len || static_cast<bool>(_file.read(&s[0],len));
+}
+bool PatternReader::readHeader(){
+  char magic[8];
+  if(_file.read(magic,8) && 0==string(magic,8).compare(PatternFile::Magic)){
+    _format=PatternFile::Binary;
+    unsigned version=0,numPI=0,numPO=0;
+    if(!readUInt(version) || PatternFile::Version!=version) return false;
+    if(!readUInt(numPI) || !readUInt(numPO)) return false;
+    _piNames.resize(numPI);
+    _poNames.resize(numPO);
+    for(unsigned i=0;i<numPI;++i) if(!readString(_piNames[i])) return false;
+    for(unsigned i=0;i<numPO;++i) if(!readString(_poNames[i])) return false;
+    _record.resize(PatternFile::recordBytes(numPI+numPO)/sizeof(PatternBlock::Word));
+    return true;
+  }
+  _format=PatternFile::Text;
+  _file.clear();
+  _file.seekg(0);
+  bool bPI=false;
+  while(getline(_file,_line)){
+    if(_line.empty() || '#'==_line[0]) continue;
+    istringstream names(_line);
+    string key,name;
+    names >> key;
+    vector<string>& target=("PI"==key) ? _piNames : _poNames;
+    if("PI"!=key && "PO"!=key) return false;
+    while(names >> name) target.push_back(name);
+    if("PI"==key) bPI=true;
+    if("PO"==key) return bPI; // records follow the PO line
+  }
+  return false;
+}
+bool PatternReader::fill(PatternBlock& b){
+/* Reads up to getBlockWidth() patterns into b. Returns false at end of file */
+  b.clear();
+  size_t numSignals=_piNames.size()+_poNames.size();
+  size_t count=0;
+  if(PatternFile::Text==_format){
+    while(count<_blockWidth && getline(_file,_line)){
+      if(_line.empty() || '#'==_line[0]) continue;
+      size_t signal=0;
+      for(size_t i=0;i<_line.size() && signal<numSignals;++i){
+        char c=_line[i];
+        if(' '==c || '\t'==c || '\r'==c) continue;
+        DLogic d=PatternFile::fromChar(c);
+        bool care=(DLogic::X!=d);
+        b.set(signal++,count,care,care && (DLogic::ONE==d || DLogic::D==d));
+      }
+      ++count;
+    }
+  }else{
+    size_t words=PatternFile::planeWords(numSignals);
+    size_t bytes=_record.size()*sizeof(PatternBlock::Word);
+    while(count<_blockWidth && 0!=bytes && _file.read(reinterpret_cast<char*>(&_record[0]),bytes)){
+      const PatternBlock::Word* care=&_record[0];
+      const PatternBlock::Word* good=care+words;
+      for(size_t signal=0;signal<numSignals;++signal){
+        PatternBlock::Word bit=1ULL<<(signal%64);
+        b.set(signal,count,0!=(care[signal/64]&bit),0!=(good[signal/64]&bit));
+      }
+      ++count;
+    }
+  }
+  b.setCount(count);
+  return count==_blockWidth;
+}
+void PatternReader::run(){
+  unique_lock<mutex> lock(_mutex);
+  while(!_eof && !_stopping){
+    while(_free.empty() && !_stopping) _cv.wait(lock);
+    if(_stopping) break;
+    PatternBlock* pB=_free.front();
+    _free.pop_front();
+    lock.unlock(); // parse outside the lock
+    bool bMore=fill(*pB);
+    lock.lock();
+    if(!bMore) _eof=true;
+    _full.push_back(pB);
+    _cv.notify_all();
+  }
+  _eof=true;
+  _cv.notify_all();
+}
+bool PatternReader::nextBlock(PatternBlock& b){
+  if(!_good) return false;
+  unique_lock<mutex> lock(_mutex);
+  while(_full.empty() && !_eof) _cv.wait(lock);
+  if(_full.empty()) return false;
+  PatternBlock* pB=_full.front();
+  _full.pop_front();
+  if(0==pB->getCount()){ // end of file fell on a block boundary
+    _free.push_back(pB);
+    return false;
+  }
+  b.swap(*pB);
+  if(pB->getWidth()!=_blockWidth) pB->resize(_blockWidth,_piNames.size()+_poNames.size());
+  _free.push_back(pB);
+  _cv.notify_all();
+  return true;
+}
@@ -0,0 +1,185 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __PatternFile__
+#define __PatternFile__
+#include <string>
+#include <vector>
+#include "DLogic.hpp"
+#include "AsyncWriter.hpp"
+#include <fstream>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/** Pattern file formats
+
+Both formats carry the same information : the names of the primary inputs
+and primary outputs, followed by one record per pattern holding a DLogic
+value for every PI then every PO.
+
+Text format ( PatternFile::Text )
+   # comment lines are ignored
+   PI J K L M N
+   PO Z
+   11X11 D
+   0X1X1 1
+   - one line per pattern, PI values, a blank, then PO values
+   - one character per signal : 0 1 X D B, where B is _D ( D-bar )
+
+Binary format ( PatternFile::Binary )
+   char[8]  magic "ATPGPATB"
+   uint32   version, number of PIs, number of POs
+   names    PI names then PO names, each as uint32 length + characters
+   records  fixed size, one per pattern
+
+   A record is three bit planes over all PI+PO signals, each plane padded
+   to whole uint64 words : care, good, faulty. Signal i lives in bit i%64
+   of word i/64. A signal whose care bit is 0 is X, otherwise its value
+   is the (good,faulty) pair ZERO=(0,0) ONE=(1,1) D=(1,0) _D=(0,1).
+   All integers are written in host byte order.
+ */
+// ------------------------------------------------------------
+// class PatternFile
+// ------------------------------------------------------------
+class PatternFile{
+/* Format constants and DLogic encoding shared by the pattern reader and writer
+ */
+public:
+  enum Format{Text,Binary};
+  static const char* Magic;        // 8 characters, no terminator written
+  static const unsigned Version=1;
+  static Format formatFromString(const std::string& s); // "bin"/"binary" else Text
+  static char toChar(const DLogic& d);
+  static DLogic fromChar(char c);
+  static std::size_t planeWords(std::size_t numSignals){ return (numSignals+63)/64; }
+  static std::size_t recordBytes(std::size_t numSignals){ return 3*planeWords(numSignals)*sizeof(unsigned long long); }
+private:
+  PatternFile();
+};
+// ------------------------------------------------------------
+// class PatternWriter
+// ------------------------------------------------------------
+class PatternWriter{
+/* Writes ATPG patterns in text or binary form.
+   Formatting happens on the calling thread into a small scratch buffer, the
+   disk writes are done by an AsyncWriter, so the ATPG loop never waits on
+   the file unless both buffers are full.
+   NB - not copyable. The destructor closes the file.
+ */
+public:
+  PatternWriter(const std::string& path,PatternFile::Format format,
+                const std::vector<std::string>& piNames,const std::vector<std::string>& poNames);
+  ~PatternWriter();
+  bool good() const { return _writer.good(); }
+  void addPattern(const std::vector<DLogic>& piValues,const std::vector<DLogic>& poValues);
+  std::size_t getCount() const { return _count; }
+  PatternFile::Format getFormat() const { return _format; }
+  void close(){ _writer.close(); }
+private:
+  PatternWriter();
+  PatternWriter(const PatternWriter&);
+  PatternWriter& operator=(const PatternWriter&);
+  void writeHeader(const std::vector<std::string>& piNames,const std::vector<std::string>& poNames);
+  void writeUInt(unsigned u);
+
+  AsyncWriter _writer;
+  PatternFile::Format _format;
+  std::size_t _numPI;
+  std::size_t _numPO;
+  std::size_t _count;
+  std::string _line;                    // scratch for text records
+  std::vector<unsigned long long> _planes; // scratch for binary records
+};
+// ------------------------------------------------------------
+// class PatternBlock
+// ------------------------------------------------------------
+class PatternBlock{
+/* Up to getWidth() patterns, transposed for bit-parallel simulation.
+   Signals are in pattern file order ( PIs then POs ); each signal has a care
+   plane and a good plane of getWords() words, one bit per pattern. Bits at or
+   beyond getCount() are X ( care 0 ).
+   NB - compiler defaults of destructor, copy constructor, operator= sufficient
+ */
+public:
+  typedef unsigned long long Word;
+  PatternBlock() : _width(0), _words(0), _signals(0), _count(0) {}
+  void resize(std::size_t width,std::size_t numSignals);
+  void clear();
+  void swap(PatternBlock& rhs);
+  void set(std::size_t signal,std::size_t pattern,bool care,bool good){
+    Word bit=1ULL<<(pattern%64);
+    std::size_t w=signal*_words+pattern/64;
+    if(care) _care[w]|=bit;
+    if(good) _good[w]|=bit;
+  }
+  std::size_t getWidth() const { return _width; }
+  std::size_t getWords() const { return _words; }
+  std::size_t getCount() const { return _count; }
+  void setCount(std::size_t count){ _count=count; }
+  const Word* getCare(std::size_t signal) const { return &_care[signal*_words]; }
+  const Word* getGood(std::size_t signal) const { return &_good[signal*_words]; }
+private:
+  std::size_t _width;
+  std::size_t _words;
+  std::size_t _signals;
+  std::size_t _count;
+  std::vector<Word> _care;
+  std::vector<Word> _good;
+};
+// ------------------------------------------------------------
+// class PatternReader
+// ------------------------------------------------------------
+class PatternReader{
+/* Streams a text or binary pattern file in blocks of blockWidth patterns.
+   The format is recognised from the file's first bytes. A read-ahead thread
+   parses and transposes the next blocks while the caller simulates the
+   current one. At most readAhead blocks are in memory at any time, so the
+   pattern set is never loaded as a whole.
+
+   Usage :
+      PatternReader r("grade.pat",256);
+      PatternBlock b;
+      while(r.nextBlock(b)){ ... }
+   NB - not copyable. The destructor stops and joins the read-ahead thread.
+ */
+public:
+  PatternReader(const std::string& path,std::size_t blockWidth,std::size_t readAhead=4);
+  ~PatternReader();
+  bool good() const { return _good; }
+  PatternFile::Format getFormat() const { return _format; }
+  const std::vector<std::string>& getPINames() const { return _piNames; }
+  const std::vector<std::string>& getPONames() const { return _poNames; }
+  std::size_t getBlockWidth() const { return _blockWidth; }
+  bool nextBlock(PatternBlock& b); // false when the file is exhausted
+private:
+  PatternReader();
+  PatternReader(const PatternReader&);
+  PatternReader& operator=(const PatternReader&);
+  bool readHeader();
+  bool readUInt(unsigned& u);
+  bool readString(std::string& s);
+  bool fill(PatternBlock& b);    // read-ahead thread only
+  void run();
+
+  std::ifstream _file;
+  PatternFile::Format _format;
+  std::vector<std::string> _piNames;
+  std::vector<std::string> _poNames;
+  std::size_t _blockWidth;
+  bool _good;
+  std::string _line;                          // read-ahead thread scratch
+  std::vector<PatternBlock::Word> _record;    // read-ahead thread scratch
+  std::vector<PatternBlock> _blocks;
+  std::deque<PatternBlock*> _free;
+  std::deque<PatternBlock*> _full;
+  bool _eof;
+  bool _stopping;
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::thread _thread;
+};
+#endif // __PatternFile__
@@ -0,0 +1,186 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "PatternSim.hpp"
+#include "BitSim.hpp"
+#include "FaultSim.hpp"
+#include "CompiledSim.hpp"
+#include "MappedNetlist.hpp"
+#include "RunStats.hpp"
+#include "MemStats.hpp"
+#include <iostream>
+#include <chrono>
+#include <unordered_map>
+using namespace std;
+
+namespace{
+// only the in-core BitSim runs compiled code
+template<class Sim>
+void useCompiled(Sim& /*sim*/,const CompiledSim* /*pCompiled*/){}
+template<unsigned Width>
+void useCompiled(BitSim<Width>& sim,const CompiledSim* pCompiled){
+  if(0!=pCompiled && BitSim<Width>::Words==pCompiled->getWords()) sim.setCompiled(pCompiled->function());
+}
+}
+template<class NetlistType>
+void PatternSim::mapInputs(const NetlistType& n,const vector<string>& piNames,vector<size_t>& piIndex){
+/* file signal -> netlist PI index, getInputs().size() for names the
+   netlist does not have. Netlist PIs absent from the file stay X.
+*/
+  piIndex.assign(piNames.size(),n.getInputs().size());
+  unordered_map<typename NetlistType::GateId,size_t> inputOf; // gate -> netlist PI index
+  for(size_t k=0;k<n.getInputs().size();++k) inputOf[n.getInputs()[k]]=k;
+  for(size_t i=0;i<piNames.size();++i){
+    typename unordered_map<typename NetlistType::GateId,size_t>::const_iterator it=inputOf.find(n.findGate(piNames[i]));
+    if(inputOf.end()!=it) piIndex[i]=it->second;
+  }
+}
+template<class Sim,class NetlistType>
+bool PatternSim::simulateBlocks(const NetlistType& n,PatternReader& r,Stats& stats,const CompiledSim* pCompiled){
+  typedef typename Sim::Word Word;
+  const unsigned Words=Sim::Words;
+  const vector<string>& piNames=r.getPINames();
+  const vector<string>& poNames=r.getPONames();
+  vector<size_t> piIndex;
+  mapInputs(n,piNames,piIndex);
+  vector<typename NetlistType::GateId> poGate(poNames.size());
+  for(size_t i=0;i<poNames.size();++i) poGate[i]=n.findGate(poNames[i]);
+
+  Sim sim(n);
+  if(!sim.good()){
+    cout << "Error! Cannot allocate simulation values\n";
+    return false;
+  }
+  useCompiled(sim,pCompiled);
+  PatternBlock b;
+  Word hi[Words],lo[Words],bad[Words];
+  while(r.nextBlock(b)){
+    for(size_t i=0;i<piNames.size();++i){
+      if(piIndex[i]==n.getInputs().size()) continue;
+      const Word* care=b.getCare(i);
+      const Word* good=b.getGood(i);
+      for(unsigned w=0;w<Words;++w){ hi[w]=care[w]&good[w]; lo[w]=care[w]&~good[w]; }
+      sim.setInput(piIndex[i],hi,lo);
+    }
+    sim.simulate();
+    for(unsigned w=0;w<Words;++w) bad[w]=0ULL;
+    for(size_t i=0;i<poNames.size();++i){
+      if(poGate[i]>=n.size()) continue;
+      const Word* care=b.getCare(piNames.size()+i);
+      const Word* good=b.getGood(piNames.size()+i);
+      const Word* sHi=sim.getHi(poGate[i]);
+      const Word* sLo=sim.getLo(poGate[i]);
+      for(unsigned w=0;w<Words;++w) bad[w]|=care[w]&((good[w]&~sHi[w])|(~good[w]&~sLo[w]));
+    }
+    for(unsigned w=0;w<Words;++w) stats.mismatches+=__builtin_popcountll(bad[w]);
+    stats.patterns+=b.getCount();
+    ++stats.blocks;
+  }
+  return true;
+}
+bool PatternSim::simulateFile(const Netlist& n,const string& path,unsigned width,Stats& stats,const CompiledSim* pCompiled){
+  return simulate<BitSim>(n,path,width,stats,pCompiled);
+}
+bool PatternSim::simulateMappedFile(const MappedNetlist& n,const string& path,unsigned width,Stats& stats){
+  return simulate<MappedBitSim>(n,path,width,stats,0);
+}
+template<template<unsigned> class Sim,class NetlistType>
+bool PatternSim::simulate(const NetlistType& n,const string& path,unsigned width,Stats& stats,const CompiledSim* pCompiled){
+  if(!validWidth(width)){
+    cout << "Error! Pattern block width must be 64, 256 or 512\n";
+    return false;
+  }
+  PatternReader r(path,width);
+  if(!r.good()){
+    cout << "Error! Cannot read pattern file " << path << "\n";
+    return false;
+  }
+  chrono::steady_clock::time_point start=chrono::steady_clock::now();
+  bool bOk=false;
+  {
+    STATS_PHASE(RunStats::Simulate);
+    MEMSTATS_TAG(MemStats::Patterns);
+    switch(width){
+    case 64  : bOk=simulateBlocks<Sim<64> >(n,r,stats,pCompiled);  break;
+    case 256 : bOk=simulateBlocks<Sim<256> >(n,r,stats,pCompiled); break;
+    case 512 : bOk=simulateBlocks<Sim<512> >(n,r,stats,pCompiled); break;
+    }
+  }
+  MEMSTATS_MARK("simulate");
+  if(!bOk) return false;
+  stats.seconds=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+  cout << "Simulated " << stats.patterns << " patterns in " << stats.blocks << " blocks of " << width
+       << " ( " << (PatternFile::Binary==r.getFormat() ? "binary" : "text")
+       << ((0!=pCompiled) ? ", compiled" : "") << " )\n";
+  cout << "\tPO mismatches :\t" << stats.mismatches << "\n";
+  cout << "\tSeconds :\t" << stats.seconds << "\n";
+  if(stats.seconds>0.0) cout << "\tPatterns/second :\t" << static_cast<double>(stats.patterns)/stats.seconds << "\n";
+  return true;
+}
+template<class V>
+bool PatternSim::gradeBlocks(const Netlist& n,PatternReader& r,Stats& stats){
+  typedef FaultSim<V> Sim;
+  typedef typename Sim::Algebra Algebra;
+  const vector<string>& piNames=r.getPINames();
+  vector<size_t> piIndex;
+  mapInputs(n,piNames,piIndex);
+  vector<typename Sim::Fault> faults;
+  Sim::checkpointFaults(n,faults);
+  stats.faults=faults.size();
+
+  Sim sim(n);
+  PatternBlock b;
+  while(r.nextBlock(b) && !faults.empty()){
+    for(size_t p=0;p<b.getCount() && !faults.empty();++p){
+      PatternBlock::Word bit=1ULL<<(p%64);
+      for(size_t i=0;i<piNames.size();++i){
+        if(piIndex[i]==n.getInputs().size()) continue;
+        bool bCare=0!=(b.getCare(i)[p/64]&bit);
+        bool bGood=0!=(b.getGood(i)[p/64]&bit);
+        sim.setInput(piIndex[i],bCare ? Algebra::fromBool(bGood) : Algebra::unknown());
+      }
+      sim.simulate();
+      // fault dropping, keeps the order of the rest
+      size_t kept=0;
+      for(size_t f=0;f<faults.size();++f){
+        if(sim.detects(faults[f])) ++stats.detected;
+        else faults[kept++]=faults[f];
+      }
+      faults.resize(kept);
+    }
+    stats.patterns+=b.getCount();
+    ++stats.blocks;
+  }
+  return true;
+}
+bool PatternSim::gradeFile(const Netlist& n,const string& path,unsigned algebra,Stats& stats){
+  if(!validAlgebra(algebra)){
+    cout << "Error! Fault grading needs the 3, 5 or 9 valued algebra\n";
+    return false;
+  }
+  PatternReader r(path,64);
+  if(!r.good()){
+    cout << "Error! Cannot read pattern file " << path << "\n";
+    return false;
+  }
+  chrono::steady_clock::time_point start=chrono::steady_clock::now();
+  bool bOk=false;
+  {
+    STATS_PHASE(RunStats::Simulate);
+    MEMSTATS_TAG(MemStats::Patterns);
+    switch(algebra){
+    case 3 : bOk=gradeBlocks<ThreeValued>(n,r,stats); break;
+    case 5 : bOk=gradeBlocks<FiveValued>(n,r,stats);  break;
+    case 9 : bOk=gradeBlocks<NineValued>(n,r,stats);  break;
+    }
+  }
+  MEMSTATS_MARK("grade");
+  if(!bOk) return false;
+  stats.seconds=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+  cout << "Fault graded " << stats.patterns << " patterns, " << algebra << " valued\n";
+  cout << "\tDetected :\t" << stats.detected << " of " << stats.faults << " checkpoint faults\n";
+  cout << "\tSeconds :\t" << stats.seconds << "\n";
+  return true;
+}
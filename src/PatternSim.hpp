@@ -0,0 +1,56 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __PatternSim__
+#define __PatternSim__
+#include <string>
+#include <vector>
+#include "Netlist.hpp"
+#include "PatternFile.hpp"
+class MappedNetlist;
+class CompiledSim;
+
+// ------------------------------------------------------------
+// class PatternSim
+// ------------------------------------------------------------
+class PatternSim{
+/* Streams a pattern file through the bit-parallel simulator.
+   PIs and POs are matched to the netlist by name. For every pattern whose
+   simulated good machine response differs from a known PO value in the
+   file, the pattern is counted as a mismatch. Throughput is reported in
+   patterns/second.
+   simulateFile runs the compiled code of a loaded CompiledSim if given.
+   simulateMappedFile does the same over an out-of-core MappedNetlist.
+   gradeFile fault simulates the patterns one by one on the checkpoint
+   faults with FaultSim, in the 3, 5 or 9 valued algebra, dropping a fault
+   once a pattern detects it, and reports how many are detected.
+ */
+public:
+  struct Stats{
+    Stats() : patterns(0), blocks(0), mismatches(0), faults(0), detected(0), seconds(0.0) {}
+    std::size_t patterns;
+    std::size_t blocks;
+    std::size_t mismatches;
+    std::size_t faults;   // gradeFile only
+    std::size_t detected;
+    double seconds;
+  };
+  static bool simulateFile(const Netlist& n,const std::string& path,unsigned width,Stats& stats,const CompiledSim* pCompiled=0);
+  static bool simulateMappedFile(const MappedNetlist& n,const std::string& path,unsigned width,Stats& stats);
+  static bool gradeFile(const Netlist& n,const std::string& path,unsigned algebra,Stats& stats);
+  static bool validAlgebra(unsigned algebra){ return 3==algebra || 5==algebra || 9==algebra; }
+  static bool validWidth(unsigned width){ return 64==width || 256==width || 512==width; }
+private:
+  template<template<unsigned> class Sim,class NetlistType>
+  static bool simulate(const NetlistType& n,const std::string& path,unsigned width,Stats& stats,const CompiledSim* pCompiled);
+  template<class Sim,class NetlistType>
+  static bool simulateBlocks(const NetlistType& n,PatternReader& r,Stats& stats,const CompiledSim* pCompiled);
+  template<class NetlistType>
+  static void mapInputs(const NetlistType& n,const std::vector<std::string>& piNames,std::vector<std::size_t>& piIndex);
+  template<class V>
+  static bool gradeBlocks(const Netlist& n,PatternReader& r,Stats& stats);
+  PatternSim();
+};
+#endif // __PatternSim__
@@ -0,0 +1,110 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "PerfCounters.hpp"
+#include <string.h>
+#include <errno.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+PerfCounters::PerfCounters() : _count(0), _leader(-1) {
+  for(unsigned e=0;e<NumEvents;++e){ _fd[e]=-1; _slot[e]=0; }
+}
+PerfCounters::~PerfCounters(){
+  close();
+}
+const char* PerfCounters::eventName(Event e){
+  static const char* Names[NumEvents]={"cycles","instructions","l1d_misses","llc_misses","branch_misses"};
+  return Names[e];
+}
+unsigned PerfCounters::supportedMask() const{
+  unsigned mask=0;
+  for(unsigned e=0;e<NumEvents;++e) if(_fd[e]>=0) mask|=1u<<e;
+  return mask;
+}
+#ifdef __linux__
+namespace{
+  int openEvent(unsigned type,unsigned long long config,int group){
+    struct perf_event_attr attr;
+    memset(&attr,0,sizeof(attr));
+    attr.size=sizeof(attr);
+    attr.type=type;
+    attr.config=config;
+    attr.disabled=(-1==group) ? 1 : 0; // the leader starts the group
+    attr.exclude_kernel=1;
+    attr.exclude_hv=1;
+    attr.read_format=PERF_FORMAT_GROUP|PERF_FORMAT_TOTAL_TIME_ENABLED|PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open,&attr,0,-1,group,0));
+  }
+  unsigned long long cacheConfig(unsigned cache,unsigned op,unsigned result){
+    return cache|(op<<8)|(result<<16);
+  }
+}
+bool PerfCounters::open(){
+  close();
+  static const unsigned Type[NumEvents]={PERF_TYPE_HARDWARE,PERF_TYPE_HARDWARE,PERF_TYPE_HW_CACHE,PERF_TYPE_HARDWARE,PERF_TYPE_HARDWARE};
+  const unsigned long long Config[NumEvents]={
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    cacheConfig(PERF_COUNT_HW_CACHE_L1D,PERF_COUNT_HW_CACHE_OP_READ,PERF_COUNT_HW_CACHE_RESULT_MISS),
+    PERF_COUNT_HW_CACHE_MISSES, // last level cache
+    PERF_COUNT_HW_BRANCH_MISSES
+  };
+  int firstErrno=0;
+  for(unsigned e=0;e<NumEvents;++e){
+    _fd[e]=openEvent(Type[e],Config[e],_leader);
+    if(_fd[e]<0){
+      if(0==firstErrno) firstErrno=errno;
+      continue;
+    }
+    _slot[e]=_count++;
+    if(_leader<0) _leader=_fd[e];
+  }
+  if(_leader<0){
+    _error=string("perf_event_open: ")+strerror(firstErrno);
+    if(EACCES==firstErrno || EPERM==firstErrno) _error+=" ( check /proc/sys/kernel/perf_event_paranoid )";
+    if(ENOENT==firstErrno || ENODEV==firstErrno || EOPNOTSUPP==firstErrno) _error+=" ( no hardware counters, container or VM? )";
+    return false;
+  }
+  ioctl(_leader,PERF_EVENT_IOC_RESET,PERF_IOC_FLAG_GROUP);
+  ioctl(_leader,PERF_EVENT_IOC_ENABLE,PERF_IOC_FLAG_GROUP);
+  return true;
+}
+void PerfCounters::close(){
+  for(unsigned e=0;e<NumEvents;++e){
+    if(_fd[e]>=0) ::close(_fd[e]);
+    _fd[e]=-1;
+  }
+  _leader=-1;
+  _count=0;
+}
+bool PerfCounters::read(Sample& s) const{
+  memset(&s,0,sizeof(s));
+  if(_leader<0) return false;
+  unsigned long long buffer[3+NumEvents]; // nr, time enabled, time running, values
+  if(::read(_leader,buffer,sizeof(buffer))<static_cast<ssize_t>((3+_count)*sizeof(buffer[0]))) return false;
+  double scale=(0!=buffer[2] && buffer[2]<buffer[1]) ? static_cast<double>(buffer[1])/static_cast<double>(buffer[2]) : 1.0;
+  for(unsigned e=0;e<NumEvents;++e){
+    if(_fd[e]>=0) s.value[e]=static_cast<unsigned long long>(static_cast<double>(buffer[3+_slot[e]])*scale);
+  }
+  return true;
+}
+#else
+bool PerfCounters::open(){
+  _error="perf_event_open: not available on this platform";
+  return false;
+}
+void PerfCounters::close(){
+}
+bool PerfCounters::read(Sample& s) const{
+  memset(&s,0,sizeof(s));
+  return false;
+}
+#endif
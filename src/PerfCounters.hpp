@@ -0,0 +1,56 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __PerfCounters__
+#define __PerfCounters__
+#include <string>
+
+// ------------------------------------------------------------
+// class PerfCounters
+// ------------------------------------------------------------
+class PerfCounters{
+/* Hardware performance counters of the calling thread, through Linux
+   perf_event_open ( user space only, so perf_event_paranoid 2 is enough ).
+
+   The events are opened as one group, so a single read() returns all of
+   them, scaled up when the kernel had to multiplex the group. An event the
+   CPU or the hypervisor does not offer is left out of the group and reads
+   as 0, supported() tells which. When nothing can be opened ( no PMU in a
+   container or VM, seccomp, not Linux ) open() returns false and error()
+   says why; callers carry on without counters.
+
+   Usage :
+      PerfCounters pc;
+      PerfCounters::Sample before,after;
+      if(pc.open()) pc.read(before);
+      ...
+      if(pc.isOpen()) pc.read(after);   // after.value[e]-before.value[e]
+   NB - counts the thread that called open(), not copyable
+ */
+public:
+  enum Event{Cycles,Instructions,L1DMisses,LLCMisses,BranchMisses,NumEvents};
+  struct Sample{
+    unsigned long long value[NumEvents];
+  };
+  PerfCounters();
+  ~PerfCounters();
+  bool open();
+  void close();
+  bool isOpen() const { return _leader>=0; }
+  bool supported(Event e) const { return _fd[e]>=0; }
+  unsigned supportedMask() const; // bit e set if event e is counted
+  bool read(Sample& s) const;
+  const std::string& error() const { return _error; }
+  static const char* eventName(Event e);
+private:
+  PerfCounters(const PerfCounters&);
+  PerfCounters& operator=(const PerfCounters&);
+  int _fd[NumEvents];
+  unsigned _slot[NumEvents]; // position of the event in the group read
+  unsigned _count;           // events in the group
+  int _leader;
+  std::string _error;
+};
+#endif // __PerfCounters__
@@ -0,0 +1,232 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "Progress.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <string.h>
+#include <errno.h>
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// zero initialized, workers may count before start()
+Progress::Counter Progress::sTotal;
+Progress::Counter Progress::sProcessed;
+Progress::Counter Progress::sDetected;
+Progress::Counter Progress::sAborted;
+Progress::Counter Progress::sPatterns;
+Progress::Counter Progress::sBacktracks;
+
+namespace{
+  typedef chrono::steady_clock Clock;
+  struct Sample{
+    Clock::time_point time;
+    unsigned long long processed;
+    unsigned long long backtracks;
+  };
+  struct Reporter{
+    Reporter() : bRunning(false), bStop(false), interval(10.0), listenFd(-1), pOs(0) {}
+    mutex m; // guards everything below but the thread and the stream
+    condition_variable wake;
+    bool bRunning;
+    bool bStop;
+    thread worker;
+    double interval; // seconds
+    int listenFd;    // -1 without socket
+    string socketPath;
+    ofstream file;
+    ostream* pOs;    // file, or cerr for "-"
+    Clock::time_point start;
+    Sample previous; // at the last line written
+  };
+  Reporter& reporter(){
+    static Reporter r;
+    return r;
+  }
+#ifndef WIN32
+  int listenOn(const string& path){
+    struct sockaddr_un addr;
+    memset(&addr,0,sizeof(addr));
+    addr.sun_family=AF_UNIX;
+    if(path.size()>=sizeof(addr.sun_path)) return -1;
+    strncpy(addr.sun_path,path.c_str(),sizeof(addr.sun_path)-1);
+    struct stat st;
+    if(0==lstat(path.c_str(),&st)){
+      if(!S_ISSOCK(st.st_mode)){ // a mistyped path, never remove a file
+        errno=EEXIST;
+        return -1;
+      }
+      unlink(path.c_str()); // left by an earlier run
+    }
+    int fd=socket(AF_UNIX,SOCK_STREAM,0);
+    if(fd<0) return -1;
+    // non blocking, so accept returns at once when the client left after poll
+    int flags=fcntl(fd,F_GETFL,0);
+    if(flags<0 || 0!=fcntl(fd,F_SETFL,flags|O_NONBLOCK)
+       || 0!=bind(fd,reinterpret_cast<struct sockaddr*>(&addr),sizeof(addr)) || 0!=listen(fd,8)){
+      int error=errno;
+      close(fd);
+      errno=error; // for the warning
+      return -1;
+    }
+    return fd;
+  }
+  void answerClients(int listenFd,int timeoutMs){
+  /* Waits up to timeoutMs for clients, each gets the current line */
+    struct pollfd p;
+    p.fd=listenFd;
+    p.events=POLLIN;
+    p.revents=0;
+    if(poll(&p,1,timeoutMs)<=0) return;
+    int client=accept(listenFd,0,0);
+    if(client<0) return;
+    string text=Progress::line()+"\n";
+    const char* data=text.c_str();
+    size_t left=text.size();
+    while(left>0){
+      ssize_t n=send(client,data,left,MSG_NOSIGNAL);
+      if(n<=0 && EINTR!=errno) break;
+      if(n>0){ data+=n; left-=static_cast<size_t>(n); }
+    }
+    close(client);
+  }
+#endif
+}
+string Progress::format(bool bAdvance,bool bDone){
+  Reporter& r=reporter();
+  Sample now;
+  now.time=Clock::now();
+  now.processed=sProcessed.value.load(memory_order_relaxed);
+  now.backtracks=sBacktracks.value.load(memory_order_relaxed);
+  unsigned long long total=sTotal.value.load(memory_order_relaxed);
+  unsigned long long detected=sDetected.value.load(memory_order_relaxed);
+  unsigned long long aborted=sAborted.value.load(memory_order_relaxed);
+  unsigned long long patterns=sPatterns.value.load(memory_order_relaxed);
+  Sample previous;
+  Clock::time_point start;
+  {
+    lock_guard<mutex> lock(r.m);
+    previous=r.previous;
+    start=r.start;
+    if(bAdvance) r.previous=now;
+  }
+  double elapsed=chrono::duration<double>(now.time-start).count();
+  double span=chrono::duration<double>(now.time-previous.time).count();
+  unsigned long long remaining=(total>now.processed) ? total-now.processed : 0;
+  ostringstream os;
+  os << fixed << setprecision(1);
+  os << "{\"elapsed_s\":" << elapsed << ",\"faults\":" << total << ",\"processed\":" << now.processed
+     << ",\"remaining\":" << remaining << ",\"detected\":" << detected << ",\"aborted\":" << aborted << ",\"coverage\":";
+  if(0!=now.processed) os << setprecision(2) << 100.0*static_cast<double>(detected)/static_cast<double>(now.processed) << setprecision(1);
+  else os << "null";
+  os << ",\"patterns\":" << patterns << ",\"faults_per_s\":";
+  if(span>0) os << static_cast<double>(now.processed-previous.processed)/span;
+  else os << "null";
+  os << ",\"backtracks_per_s\":";
+  if(span>0) os << static_cast<double>(now.backtracks-previous.backtracks)/span;
+  else os << "null";
+  os << ",\"eta_s\":";
+  if(0!=now.processed && elapsed>0) os << static_cast<double>(remaining)*elapsed/static_cast<double>(now.processed);
+  else os << "null";
+  os << ",\"done\":" << (bDone ? "true" : "false") << "}";
+  return os.str();
+}
+void Progress::report(){
+  Reporter& r=reporter();
+  Clock::time_point next=Clock::now()+chrono::duration_cast<Clock::duration>(chrono::duration<double>(r.interval));
+  for(;;){
+    {
+      unique_lock<mutex> lock(r.m);
+      if(r.bStop) break;
+      if(r.listenFd<0){
+        r.wake.wait_until(lock,next,[&r]{ return r.bStop; });
+        if(r.bStop) break;
+      }
+    }
+#ifndef WIN32
+    if(r.listenFd>=0){
+    /* poll in short slices so that stop() is seen quickly, a sleeping
+       thread costs the workers nothing
+    */
+      long long ms=chrono::duration_cast<chrono::milliseconds>(next-Clock::now()).count();
+      answerClients(r.listenFd,static_cast<int>((ms<0) ? 0 : ((ms>100) ? 100 : ms)));
+    }
+#endif
+    if(Clock::now()>=next){
+      *r.pOs << format(true,false) << endl;
+      next+=chrono::duration_cast<Clock::duration>(chrono::duration<double>(r.interval));
+    }
+  }
+}
+bool Progress::start(double intervalSeconds,const string& outputPath,const string& socketPath){
+  Reporter& r=reporter();
+  stop();
+  if(intervalSeconds<=0) intervalSeconds=10.0;
+  if("-"==outputPath){
+    r.pOs=&cerr;
+  }else{
+    r.file.open(outputPath.c_str());
+    if(!r.file.good()){
+      cout << "Error! Cannot write progress " << outputPath << "\n";
+      return false;
+    }
+    r.pOs=&r.file;
+  }
+  if(!socketPath.empty()){
+#ifndef WIN32
+    r.listenFd=listenOn(socketPath);
+    if(r.listenFd<0) cout << "Warning! Cannot listen on progress socket " << socketPath << " : " << strerror(errno) << "\n";
+    else r.socketPath=socketPath;
+#else
+    cout << "Warning! No progress socket on this platform\n";
+#endif
+  }
+  {
+    lock_guard<mutex> lock(r.m);
+    r.interval=intervalSeconds;
+    r.bStop=false;
+    r.start=Clock::now();
+    r.previous.time=r.start;
+    r.previous.processed=sProcessed.value.load(memory_order_relaxed);
+    r.previous.backtracks=sBacktracks.value.load(memory_order_relaxed);
+  }
+  r.worker=thread(report);
+  r.bRunning=true;
+  return true;
+}
+void Progress::stop(){
+  Reporter& r=reporter();
+  if(!r.bRunning) return;
+  {
+    lock_guard<mutex> lock(r.m);
+    r.bStop=true;
+  }
+  r.wake.notify_all();
+  r.worker.join();
+  r.bRunning=false;
+  *r.pOs << format(true,true) << endl;
+#ifndef WIN32
+  if(r.listenFd>=0){
+    close(r.listenFd);
+    unlink(r.socketPath.c_str());
+  }
+#endif
+  r.listenFd=-1;
+  if(r.file.is_open()) r.file.close();
+  r.pOs=0;
+}
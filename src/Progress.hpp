@@ -0,0 +1,72 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __Progress__
+#define __Progress__
+#include <string>
+#include <atomic>
+
+// ------------------------------------------------------------
+// class Progress
+// ------------------------------------------------------------
+class Progress{
+/* Live progress of a long ATPG run, reported from a thread of its own.
+
+   The workers only bump relaxed atomic counters, once per fault, pattern
+   and backtrack, each counter on its own cache line. start() launches
+   the reporter thread, which every interval seconds writes one JSON line
+      {"elapsed_s":60.0,"faults":1000,"processed":250,"remaining":750,
+       "detected":240,"aborted":2,"coverage":96.00,"patterns":240,"faults_per_s":4.2,
+       "backtracks_per_s":17.5,"eta_s":180.0,"done":false}
+   to the output path ( "-" is stderr ). The rates are over the last
+   interval, the ETA uses the average rate since start and is null until
+   a fault has finished. coverage is detected / processed in percent;
+   aborted faults, whose search was given up, count as processed but never
+   as detected.
+   stop() writes a last line with "done":true and joins the thread.
+
+   With a socket path the reporter also listens on a Unix-domain stream
+   socket there; every client that connects is sent the current line and
+   the connection is closed, so a monitoring script can poll with
+      socat - UNIX-CONNECT:atpg.sock
+   An existing socket at that path is replaced, any other file is left
+   alone and the socket is not opened.
+
+   Usage :
+      Progress::start(10.0,"-","");
+      Progress::setTotal(faults.size());
+      ... Progress::faultDone(bDetected);
+      Progress::stop();
+ */
+public:
+  static bool start(double intervalSeconds,const std::string& outputPath,const std::string& socketPath);
+  static void stop();
+  static void setTotal(unsigned long long faults){ sTotal.value.store(faults,std::memory_order_relaxed); }
+  static void faultDone(bool bDetected){
+    sProcessed.value.fetch_add(1,std::memory_order_relaxed);
+    if(bDetected) sDetected.value.fetch_add(1,std::memory_order_relaxed);
+  }
+  static void faultAborted(){ // given up, neither detected nor untestable
+    sProcessed.value.fetch_add(1,std::memory_order_relaxed);
+    sAborted.value.fetch_add(1,std::memory_order_relaxed);
+  }
+  static void pattern(){ sPatterns.value.fetch_add(1,std::memory_order_relaxed); }
+  static void backtrack(){ sBacktracks.value.fetch_add(1,std::memory_order_relaxed); }
+  static std::string line(){ return format(false,false); } // current JSON line, without newline
+private:
+  Progress();
+  static std::string format(bool bAdvance,bool bDone); // bAdvance starts the next rate interval
+  static void report(); // the reporter thread
+  struct alignas(64) Counter{ // one cache line each, workers do not share lines
+    std::atomic<unsigned long long> value;
+  };
+  static Counter sTotal;
+  static Counter sProcessed;
+  static Counter sDetected;
+  static Counter sAborted;
+  static Counter sPatterns;
+  static Counter sBacktracks;
+};
+#endif // __Progress__
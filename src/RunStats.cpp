@@ -0,0 +1,140 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "RunStats.hpp"
+#include "ThreadRegistry.hpp"
+#include <fstream>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <sys/resource.h>
+using namespace std;
+
+thread_local RunStats::Block* RunStats::tBlock=0;
+std::atomic<bool> RunStats::sCounters(false);
+
+namespace{
+  struct ThreadBlock{
+    ThreadBlock() : countersTried(false) {}
+    RunStats::Block block;
+    PerfCounters counters;
+    bool countersTried;
+  };
+  void fold(ThreadBlock& t,RunStats::Block& retired){ retired.add(t.block); }
+  typedef ThreadRegistry<ThreadBlock,RunStats::Block> Registry; // retired : folded in by threads that have exited
+  Registry& registry(){
+    static Registry r(fold);
+    return r;
+  }
+  string& firstCountersError(){ // first failure to open PerfCounters, under the registry mutex
+    static string error;
+    return error;
+  }
+}
+void RunStats::Block::clear(){
+  for(unsigned i=0;i<NumCounters;++i) counters[i]=0;
+  for(unsigned i=0;i<NumPhases;++i) phaseNs[i]=0;
+  for(unsigned i=0;i<NumPhases;++i) for(unsigned e=0;e<PerfCounters::NumEvents;++e) phaseEvents[i][e]=0;
+  eventMask=0;
+  dFrontierMax=0;
+}
+void RunStats::Block::add(const Block& rhs){
+  for(unsigned i=0;i<NumCounters;++i) counters[i]+=rhs.counters[i];
+  for(unsigned i=0;i<NumPhases;++i) phaseNs[i]+=rhs.phaseNs[i];
+  for(unsigned i=0;i<NumPhases;++i) for(unsigned e=0;e<PerfCounters::NumEvents;++e) phaseEvents[i][e]+=rhs.phaseEvents[i][e];
+  eventMask|=rhs.eventMask;
+  dFrontierMax=max(dFrontierMax,rhs.dFrontierMax);
+}
+RunStats::Block& RunStats::attach(){
+  tBlock=&registry().local().block;
+  return *tBlock;
+}
+PerfCounters* RunStats::counters(){
+  ThreadBlock& t=registry().local();
+  if(!t.countersTried){
+    t.countersTried=true;
+    if(!t.counters.open()){
+      lock_guard<mutex> lock(registry().mutex());
+      if(firstCountersError().empty()) firstCountersError()=t.counters.error();
+    }
+  }
+  return t.counters.isOpen() ? &t.counters : 0;
+}
+string RunStats::countersError(){
+  lock_guard<mutex> lock(registry().mutex());
+  return firstCountersError();
+}
+void RunStats::PhaseTimer::startCounters(){
+  _pCounters=counters();
+  if(0!=_pCounters && !_pCounters->read(_events)) _pCounters=0;
+}
+void RunStats::PhaseTimer::stopCounters(){
+  PerfCounters::Sample end;
+  if(!_pCounters->read(end)) return;
+  Block& b=local();
+  for(unsigned e=0;e<PerfCounters::NumEvents;++e){
+    if(end.value[e]>_events.value[e]) b.phaseEvents[_phase][e]+=end.value[e]-_events.value[e];
+  }
+  b.eventMask|=_pCounters->supportedMask();
+}
+RunStats::Block RunStats::total(){
+/* Blocks of live threads are read without synchronization, so call this
+   once the worker threads are idle.
+*/
+  Registry& r=registry();
+  lock_guard<mutex> lock(r.mutex());
+  Block b=r.retired();
+  for(size_t i=0;i<r.live().size();++i) b.add(r.live()[i]->block);
+  return b;
+}
+long RunStats::peakRSSKb(){
+  struct rusage usage;
+  if(0!=getrusage(RUSAGE_SELF,&usage)) return -1;
+  return usage.ru_maxrss; // kilobytes on Linux
+}
+const char* RunStats::counterName(Counter c){
+  static const char* Names[NumCounters]={"gate_evals","events","backtraces","decisions","backtracks","implications"};
+  return Names[c];
+}
+const char* RunStats::phaseName(Phase p){
+  static const char* Names[NumPhases]={"load","initialize","backtrace","propagate","simulate"};
+  return Names[p];
+}
+bool RunStats::writeJson(const string& path){
+  Block b=total();
+  ofstream os(path.c_str());
+  if(!os.good()) return false;
+  os << "{\n  \"counters\": {";
+  for(unsigned i=0;i<NumCounters;++i){
+    os << (0==i ? "\n" : ",\n") << "    \"" << counterName(static_cast<Counter>(i)) << "\": " << b.counters[i];
+  }
+  os << "\n  },\n  \"dfrontier_max\": " << b.dFrontierMax << ",\n  \"phase_seconds\": {";
+  for(unsigned i=0;i<NumPhases;++i){
+    os << (0==i ? "\n" : ",\n") << "    \"" << phaseName(static_cast<Phase>(i)) << "\": " << static_cast<double>(b.phaseNs[i])*1e-9;
+  }
+  os << "\n  },\n  \"peak_rss_kb\": " << peakRSSKb();
+  if(countersEnabled()){
+    // unsupported events are null, so they cannot be mistaken for zero counts
+    string error=countersError();
+    os << ",\n  \"perf\": {\n    \"available\": " << ((0!=b.eventMask) ? "true" : "false");
+    if(!error.empty()) os << ",\n    \"error\": \"" << error << "\"";
+    if(0!=b.eventMask){
+      os << ",\n    \"phases\": {";
+      for(unsigned i=0;i<NumPhases;++i){
+        os << (0==i ? "\n" : ",\n") << "      \"" << phaseName(static_cast<Phase>(i)) << "\": {";
+        for(unsigned e=0;e<PerfCounters::NumEvents;++e){
+          os << (0==e ? "" : ", ") << "\"" << PerfCounters::eventName(static_cast<PerfCounters::Event>(e)) << "\": ";
+          if(0!=(b.eventMask&(1u<<e))) os << b.phaseEvents[i][e];
+          else os << "null";
+        }
+        os << "}";
+      }
+      os << "\n    }";
+    }
+    os << "\n  }";
+  }
+  os << "\n}\n";
+  return os.good();
+}
@@ -0,0 +1,115 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __RunStats__
+#define __RunStats__
+#include <string>
+#include <chrono>
+#include <atomic>
+#include "PerfCounters.hpp"
+
+// ------------------------------------------------------------
+// class RunStats
+// ------------------------------------------------------------
+class RunStats{
+/* Hot path counters and phase timers for tuning ATPG runs.
+
+   Every thread counts into its own thread_local Block, so counting is a
+   plain increment with no sharing. total() merges the blocks of all live
+   threads with those already folded in by threads that have exited.
+
+   Counters
+      GateEvals     single input and counted multiple input evaluations
+      Events        vertices scheduled on the propagation container
+      Backtraces    backtraceVertex calls
+      Decisions     PI assignments tried from a backtrace
+      Backtracks    decisions that ended in a conflict ( inconsistent output
+                    or non D passable gate ), where PODEM would backtrack
+      Implications  gate outputs set by propagation
+   plus the largest D-frontier seen, and the time spent in the phases
+   Load, Initialize ( initializeGraph ), Backtrace, Propagate and Simulate
+   ( PatternSim ).
+
+   With enableCounters(true) every phase also accumulates the hardware
+   counters of PerfCounters ( cycles, instructions, L1D, LLC and branch
+   misses ). Each thread opens its own counters the first time it enters
+   a phase; a phase costs two read() calls more, so leave it off unless
+   the numbers are wanted. Where counters cannot be opened the phases are
+   timed as before and writeJson reports why.
+
+   Use the macros, they expand to nothing when compiled with STATS_OFF :
+      STATS_COUNT(RunStats::GateEvals);
+      STATS_DFRONTIER(_df.size());
+      STATS_PHASE(RunStats::Propagate);   // times the enclosing scope
+
+   writeJson adds the peak resident set size ( getrusage ) to the totals.
+ */
+public:
+  enum Counter{GateEvals,Events,Backtraces,Decisions,Backtracks,Implications,NumCounters};
+  enum Phase{Load,Initialize,Backtrace,Propagate,Simulate,NumPhases};
+  struct Block{
+    Block(){ clear(); }
+    void clear();
+    void add(const Block& rhs);
+    unsigned long long counters[NumCounters];
+    unsigned long long dFrontierMax;
+    unsigned long long phaseNs[NumPhases];
+    unsigned long long phaseEvents[NumPhases][PerfCounters::NumEvents];
+    unsigned eventMask; // PerfCounters events counted by at least one thread
+  };
+  class PhaseTimer{
+  public:
+    PhaseTimer(Phase p) : _phase(p), _pCounters(0) {
+      if(sCounters.load(std::memory_order_relaxed)) startCounters();
+      _start=std::chrono::steady_clock::now();
+    }
+    ~PhaseTimer(){
+      local().phaseNs[_phase]+=static_cast<unsigned long long>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-_start).count());
+      if(0!=_pCounters) stopCounters();
+    }
+  private:
+    PhaseTimer(const PhaseTimer&);
+    PhaseTimer& operator=(const PhaseTimer&);
+    void startCounters();
+    void stopCounters();
+    Phase _phase;
+    std::chrono::steady_clock::time_point _start;
+    PerfCounters* _pCounters; // 0 unless counting
+    PerfCounters::Sample _events;
+  };
+
+  static void count(Counter c,unsigned long long n=1){ local().counters[c]+=n; }
+  static void dFrontier(std::size_t size){
+    Block& b=local();
+    if(size>b.dFrontierMax) b.dFrontierMax=size;
+  }
+  static Block total();
+  static long peakRSSKb();
+  static const char* counterName(Counter c);
+  static const char* phaseName(Phase p);
+  static bool writeJson(const std::string& path);
+  static void enableCounters(bool bEnable){ sCounters.store(bEnable); }
+  static bool countersEnabled(){ return sCounters.load(); }
+  static std::string countersError(); // why counters could not be opened, empty if they could
+private:
+  RunStats();
+  static Block& local(){ return (0!=tBlock) ? *tBlock : attach(); }
+  static Block& attach(); // first use on this thread
+  static PerfCounters* counters(); // this thread's, 0 if they cannot be opened
+  static thread_local Block* tBlock;
+  static std::atomic<bool> sCounters;
+};
+
+#ifdef STATS_OFF
+#define STATS_COUNT(c)
+#define STATS_DFRONTIER(n)
+#define STATS_PHASE(p)
+#else
+#define STATS_COUNT(c) RunStats::count(c)
+#define STATS_DFRONTIER(n) RunStats::dFrontier(n)
+#define STATS_PHASE(p) RunStats::PhaseTimer statsPhaseTimer(p)
+#endif
+#endif // __RunStats__
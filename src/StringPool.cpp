@@ -0,0 +1,89 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "StringPool.hpp"
+#include <string.h>
+using namespace std;
+
+const StringPool::Id StringPool::NoId;
+const unsigned IdIndex::None;
+
+StringPool& StringPool::global(){
+  static StringPool pool;
+  return pool;
+}
+StringPool::StringPool() : _start(1,0), _table(64,NoId) {
+}
+size_t StringPool::hash(const char* s,size_t length){
+  size_t h=2166136261u;
+  for(size_t i=0;i<length;++i){
+    h^=static_cast<unsigned char>(s[i]);
+    h*=16777619u;
+  }
+  return h;
+}
+size_t StringPool::slot(const char* s,size_t length) const{
+  size_t mask=_table.size()-1;
+  for(size_t i=hash(s,length)&mask;;i=(i+1)&mask){
+    Id id=_table[i];
+    if(NoId==id) return i;
+    if(this->length(id)==length && 0==memcmp(c_str(id),s,length)) return i;
+  }
+}
+StringPool::Id StringPool::find(const char* s,size_t length) const{
+  return _table[slot(s,length)];
+}
+StringPool::Id StringPool::intern(const char* s,size_t length){
+  size_t i=slot(s,length);
+  if(NoId!=_table[i]) return _table[i];
+  Id id=static_cast<Id>(size());
+  _chars.insert(_chars.end(),s,s+length);
+  _chars.push_back('\0');
+  _start.push_back(_chars.size());
+  _table[i]=id;
+  if(2*size()>_table.size()) grow();
+  return id;
+}
+void StringPool::grow(){
+  vector<Id> table(2*_table.size(),NoId);
+  size_t mask=table.size()-1;
+  for(Id id=0;id<size();++id){
+    size_t i=hash(c_str(id),length(id))&mask;
+    while(NoId!=table[i]) i=(i+1)&mask;
+    table[i]=id;
+  }
+  _table.swap(table);
+}
+size_t StringPool::bytes() const{
+  return _chars.capacity()+_start.capacity()*sizeof(size_t)+_table.capacity()*sizeof(Id);
+}
+unsigned IdIndex::find(const vector<Id>& keys,Id key) const{
+  if(_table.empty()) return None;
+  size_t mask=_table.size()-1;
+  for(size_t i=hash(key)&mask;None!=_table[i];i=(i+1)&mask){
+    if(keys[_table[i]]==key) return _table[i];
+  }
+  return None;
+}
+void IdIndex::insert(const vector<Id>& keys,unsigned index){
+  if(2*(_used+1)>_table.size()){
+    vector<unsigned> table((_table.empty()) ? 64 : 2*_table.size(),None);
+    size_t mask=table.size()-1;
+    for(size_t s=0;s<_table.size();++s){
+      if(None==_table[s]) continue;
+      size_t i=hash(keys[_table[s]])&mask;
+      while(None!=table[i]) i=(i+1)&mask;
+      table[i]=_table[s];
+    }
+    _table.swap(table);
+  }
+  size_t mask=_table.size()-1;
+  size_t i=hash(keys[index])&mask;
+  for(;None!=_table[i];i=(i+1)&mask){
+    if(keys[_table[i]]==keys[index]) return; // first index wins
+  }
+  _table[i]=index;
+  ++_used;
+}
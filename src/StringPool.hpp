@@ -0,0 +1,90 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __StringPool__
+#define __StringPool__
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// ------------------------------------------------------------
+// class StringPool
+// ------------------------------------------------------------
+class StringPool{
+/* Interned strings, each distinct string is stored once and named by a
+   dense 32 bit Id, so equal strings compare as equal Ids.
+
+   The characters sit back to back in one array, nul terminated, with an
+   offset per Id and an open addressing hash table of Ids ( FNV-1a, linear
+   probing, at most half full ). A string costs its length plus about 17
+   bytes, against 32 bytes and usually a heap block for a std::string.
+   Nothing is ever removed.
+
+   global() is the pool shared by Netlist and DotStore, so attribute keys,
+   function names and gate names read from different files share storage.
+
+   Usage :
+      StringPool& pool=StringPool::global();
+      StringPool::Id label=pool.intern("label");
+      if(label==pool.find(key)) ...
+      cout << pool.c_str(label);
+   NB - not thread safe. A c_str() pointer is good until the next intern()
+ */
+public:
+  typedef unsigned Id;
+  static const Id NoId=~0u;
+  static StringPool& global();
+
+  StringPool();
+  Id intern(const char* s,std::size_t length);
+  Id intern(const std::string& s){ return intern(s.data(),s.size()); }
+  Id find(const char* s,std::size_t length) const; // NoId if never interned
+  Id find(const std::string& s) const { return find(s.data(),s.size()); }
+  const char* c_str(Id id) const { return &_chars[_start[id]]; }
+  std::size_t length(Id id) const { return _start[id+1]-_start[id]-1; }
+  std::string str(Id id) const { return std::string(c_str(id),length(id)); }
+  std::size_t size() const { return _start.size()-1; }
+  std::size_t bytes() const; // heap held, capacities included
+private:
+  StringPool(const StringPool&);
+  StringPool& operator=(const StringPool&);
+  static std::size_t hash(const char* s,std::size_t length);
+  std::size_t slot(const char* s,std::size_t length) const; // of the string, or the empty slot for it
+  void grow();
+  std::vector<char> _chars;
+  std::vector<std::size_t> _start; // size()+1 offsets into _chars
+  std::vector<Id> _table;          // power of two slots, NoId is empty
+};
+
+// ------------------------------------------------------------
+// class IdIndex
+// ------------------------------------------------------------
+class IdIndex{
+/* Map from an interned string to a dense index, for name lookups.
+   The caller keeps the Id of every index in its own array, the table only
+   holds indices ( open addressing, at most half full ), so a lookup costs
+   4 to 8 bytes per entry instead of a std::map node.
+
+   Usage :
+      vector<StringPool::Id> names;   // name of index i
+      IdIndex byName;
+      names.push_back(id); byName.insert(names,names.size()-1);
+      unsigned i=byName.find(names,id);  // None if absent
+   NB - insert keeps the first index of a name, as std::map::insert does
+ */
+public:
+  typedef StringPool::Id Id;
+  static const unsigned None=~0u;
+  IdIndex() : _used(0) {}
+  unsigned find(const std::vector<Id>& keys,Id key) const;
+  void insert(const std::vector<Id>& keys,unsigned index);
+  void clear(){ std::vector<unsigned>().swap(_table); _used=0; }
+  std::size_t bytes() const { return _table.capacity()*sizeof(unsigned); }
+private:
+  static std::size_t hash(Id key){ return static_cast<std::size_t>(key)*0x9E3779B1u; }
+  std::vector<unsigned> _table; // power of two slots, None is empty
+  std::size_t _used;
+};
+#endif // __StringPool__
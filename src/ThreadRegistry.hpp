@@ -0,0 +1,73 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __ThreadRegistry__
+#define __ThreadRegistry__
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+// ------------------------------------------------------------
+// class ThreadRegistry
+// ------------------------------------------------------------
+template<class T,class Retired>
+class ThreadRegistry{
+/* The per-thread state of a subsystem that a reader collects from every
+   thread. local() gives the calling thread its own T, made on its first
+   call and listed in live() until the thread exits; then retire folds it
+   into retired(), under the lock, and it is gone.
+
+   A thread writes its own T without the lock. Readers take mutex() and
+   walk live() and retired(); what they read of a live T is only settled
+   once its thread is idle, as RunStats::total and the writers document.
+
+   Usage :
+      void fold(Counts& t,Counts& retired){ retired.add(t); }
+      ThreadRegistry<Counts,Counts>& registry(){
+        static ThreadRegistry<Counts,Counts> r(fold);
+        return r;
+      }
+      ++registry().local().events;
+      std::lock_guard<std::mutex> lock(registry().mutex());
+      Counts all=registry().retired();
+      for(size_t i=0;i<registry().live().size();++i) all.add(*registry().live()[i]);
+   NB - one registry per T and Retired : the thread_local behind local()
+        belongs to the type, not to the instance. Not copyable.
+ */
+public:
+  typedef void (*Retire)(T& t,Retired& retired);
+  explicit ThreadRegistry(Retire retire) : _retire(retire) {}
+  T& local();
+  std::mutex& mutex(){ return _m; }
+  std::vector<T*>& live(){ return _live; }  // under mutex()
+  Retired& retired(){ return _retired; }    // under mutex()
+private:
+  ThreadRegistry(const ThreadRegistry&);
+  ThreadRegistry& operator=(const ThreadRegistry&);
+  struct Owner{
+    explicit Owner(ThreadRegistry& r) : registry(r) {
+      std::lock_guard<std::mutex> lock(registry._m);
+      registry._live.push_back(&t);
+    }
+    ~Owner(){
+      std::lock_guard<std::mutex> lock(registry._m);
+      registry._live.erase(std::find(registry._live.begin(),registry._live.end(),&t));
+      registry._retire(t,registry._retired);
+    }
+    ThreadRegistry& registry;
+    T t;
+  };
+
+  std::mutex _m;
+  std::vector<T*> _live;
+  Retired _retired;
+  Retire _retire;
+};
+template<class T,class Retired>
+T& ThreadRegistry<T,Retired>::local(){
+  static thread_local Owner owner(*this);
+  return owner.t;
+}
+#endif // __ThreadRegistry__
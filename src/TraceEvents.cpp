@@ -0,0 +1,117 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "TraceEvents.hpp"
+#include "AsyncWriter.hpp"
+#include "ThreadRegistry.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <algorithm>
+#include <stdio.h>
+#include <unistd.h>
+using namespace std;
+
+thread_local vector<TraceEvents::Span>* TraceEvents::tBuffer=0;
+
+namespace{
+  struct ThreadSpans{
+    ThreadSpans() : tid(nextTid++) {}
+    static atomic<unsigned> nextTid;
+    unsigned tid;
+    vector<TraceEvents::Span> spans;
+  };
+  atomic<unsigned> ThreadSpans::nextTid(1);
+  void keep(ThreadSpans& t,vector<ThreadSpans>& retired){ if(!t.spans.empty()) retired.push_back(t); }
+  typedef ThreadRegistry<ThreadSpans,vector<ThreadSpans> > Registry; // retired : from threads that have exited
+  Registry& registry(){
+    static Registry r(keep);
+    return r;
+  }
+  set<string>& names(){ // interned span names, under the registry mutex
+    static set<string> s;
+    return s;
+  }
+  void appendJsonString(string& out,const char* s){
+    out+='"';
+    for(;0!=*s;++s){
+      if('"'==*s || '\\'==*s) out+='\\';
+      if(static_cast<unsigned char>(*s)<0x20) continue; // no control characters in names
+      out+=*s;
+    }
+    out+='"';
+  }
+  void appendMicroseconds(string& out,unsigned long long ns){
+    char buffer[32];
+    snprintf(buffer,sizeof(buffer),"%llu.%03llu",ns/1000,ns%1000);
+    out+=buffer;
+  }
+  void appendSpans(string& out,const ThreadSpans& t,unsigned pid,bool& bFirst){
+    char buffer[64];
+    for(size_t i=0;i<t.spans.size();++i){
+      const TraceEvents::Span& s=t.spans[i];
+      out+=bFirst ? "\n" : ",\n";
+      bFirst=false;
+      out+="{\"name\":";
+      appendJsonString(out,s.name);
+      out+=",\"cat\":\"atpg\",\"ph\":\"X\",\"ts\":";
+      appendMicroseconds(out,s.begin);
+      out+=",\"dur\":";
+      appendMicroseconds(out,s.end-s.begin);
+      snprintf(buffer,sizeof(buffer),",\"pid\":%u,\"tid\":%u}",pid,t.tid);
+      out+=buffer;
+    }
+  }
+}
+unsigned long long TraceEvents::now(){
+  static const chrono::steady_clock::time_point Origin=chrono::steady_clock::now();
+  return static_cast<unsigned long long>(
+    chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now()-Origin).count());
+}
+vector<TraceEvents::Span>& TraceEvents::attach(){
+  tBuffer=&registry().local().spans;
+  return *tBuffer;
+}
+const char* TraceEvents::intern(const string& name){
+  lock_guard<mutex> lock(registry().mutex());
+  return names().insert(name).first->c_str(); // set nodes never move
+}
+size_t TraceEvents::size(){
+  Registry& r=registry();
+  lock_guard<mutex> lock(r.mutex());
+  size_t n=0;
+  for(size_t i=0;i<r.live().size();++i) n+=r.live()[i]->spans.size();
+  for(size_t i=0;i<r.retired().size();++i) n+=r.retired()[i].spans.size();
+  return n;
+}
+bool TraceEvents::write(const string& path){
+  Registry& r=registry();
+  lock_guard<mutex> lock(r.mutex());
+  AsyncWriter w(path);
+  if(!w.good()) return false;
+  unsigned pid=static_cast<unsigned>(getpid());
+  string out="{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool bFirst=true;
+  for(size_t i=0;i<r.live().size();++i){
+    appendSpans(out,*r.live()[i],pid,bFirst);
+    w.write(out);
+    out.clear();
+  }
+  for(size_t i=0;i<r.retired().size();++i){
+    appendSpans(out,r.retired()[i],pid,bFirst);
+    w.write(out);
+    out.clear();
+  }
+  w.write("\n]}\n");
+  w.close();
+  return w.good();
+}
+void TraceEvents::clear(){
+  Registry& r=registry();
+  lock_guard<mutex> lock(r.mutex());
+  for(size_t i=0;i<r.live().size();++i) r.live()[i]->spans.clear();
+  r.retired().clear();
+}
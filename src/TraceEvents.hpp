@@ -0,0 +1,47 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __TraceEvents__
+#define __TraceEvents__
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------
+// class TraceEvents
+// ------------------------------------------------------------
+class TraceEvents{
+/* High resolution timing spans, written as Chrome trace-event JSON that
+   chrome://tracing and Perfetto ( ui.perfetto.dev ) load directly.
+
+   Time is steady_clock nanoseconds since the first call to now(). Every
+   thread appends complete spans ( begin, end, name ) to its own buffer,
+   so recording takes no lock. Buffers of exited threads are kept until
+   write(). Debug records a span per profiled scope and per TimeStart /
+   TimeEnd pair, see option P in Debug.hpp.
+
+   Span names must outlive the recording; string literals do, anything
+   else goes through intern().
+ */
+public:
+  struct Span{
+    const char* name;
+    unsigned long long begin;
+    unsigned long long end;
+  };
+  static unsigned long long now();
+  static void span(const char* name,unsigned long long begin,unsigned long long end){
+    buffer().push_back(Span{name,begin,end});
+  }
+  static const char* intern(const std::string& name);
+  static std::size_t size(); // spans recorded so far
+  static bool write(const std::string& path); // threads must be idle
+  static void clear();
+private:
+  TraceEvents();
+  static std::vector<Span>& buffer(){ return (0!=tBuffer) ? *tBuffer : attach(); }
+  static std::vector<Span>& attach(); // first use on this thread
+  static thread_local std::vector<Span>* tBuffer;
+};
+#endif // __TraceEvents__
@@ -0,0 +1,176 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "TruthTable.hpp"
+#include "LogicAlgebra.hpp"
+#include "GateKernels.hpp"
+#include <cstdlib>
+using namespace std;
+
+TruthTable::TruthTable(unsigned numIn,Bits bits) : _numIn(numIn), _bits(replicate(numIn,bits)){
+  makeCovers();
+}
+TruthTable::Bits TruthTable::variable(unsigned i){
+  static const Bits Vars[MaxInputs]={0xAAAAAAAAAAAAAAAAULL,0xCCCCCCCCCCCCCCCCULL,0xF0F0F0F0F0F0F0F0ULL,
+                                     0xFF00FF00FF00FF00ULL,0xFFFF0000FFFF0000ULL,0xFFFFFFFF00000000ULL};
+  return Vars[i];
+}
+TruthTable::Bits TruthTable::replicate(unsigned numIn,Bits bits){
+  for(unsigned n=numIn;n<MaxInputs;++n){
+    unsigned width=1u<<n;
+    bits=(bits&((1ULL<<width)-1))|(bits<<width);
+  }
+  return bits;
+}
+TruthTable::Bits TruthTable::cofactor(Bits f,unsigned pin,bool value){
+/* f with input pin fixed, replicated over both halves */
+  unsigned shift=1u<<pin;
+  Bits half=f&(value ? variable(pin) : ~variable(pin));
+  return value ? (half|(half>>shift)) : (half|(half<<shift));
+}
+TruthTable::Bits TruthTable::agreeing(unsigned care,unsigned value){
+  Bits m=~0ULL;
+  for(unsigned i=0;i<MaxInputs;++i){
+    if(0!=(care&(1u<<i))) m&=(0!=(value&(1u<<i))) ? variable(i) : ~variable(i);
+  }
+  return m;
+}
+void TruthTable::makeCovers(){
+/* Every cube over the inputs, 3^numIn at most 729, kept if it is an
+   implicant and no cube with one literal less is.
+*/
+  _on.clear();
+  _off.clear();
+  unsigned numCubes=1;
+  for(unsigned i=0;i<_numIn;++i) numCubes*=3;
+  for(unsigned c=0;c<numCubes;++c){
+    unsigned care=0,value=0,digits=c;
+    for(unsigned i=0;i<_numIn;++i,digits/=3){
+      if(2==digits%3) continue; // don't care
+      care|=1u<<i;
+      if(1==digits%3) value|=1u<<i;
+    }
+    Bits m=agreeing(care,value);
+    bool bOn=(_bits&m)==m;
+    bool bOff=0==(_bits&m);
+    if(!bOn && !bOff) continue;
+    bool bPrime=true;
+    for(unsigned i=0;i<_numIn && bPrime;++i){
+      if(0==(care&(1u<<i))) continue;
+      Bits wider=agreeing(care&~(1u<<i),value&~(1u<<i));
+      if(bOn && (_bits&wider)==wider) bPrime=false;
+      if(bOff && 0==(_bits&wider)) bPrime=false;
+    }
+    if(!bPrime) continue;
+    Cube cube={static_cast<unsigned char>(care),static_cast<unsigned char>(value)};
+    (bOn ? _on : _off).push_back(cube);
+  }
+}
+unsigned TruthTable::component(const unsigned* in) const{
+  unsigned care=0,value=0;
+  for(unsigned i=0;i<_numIn;++i){
+    if(Component::X==in[i]) continue;
+    care|=1u<<i;
+    if(Component::One==in[i]) value|=1u<<i;
+  }
+  Bits m=agreeing(care,value);
+  Bits r=_bits&m;
+  return (0==r) ? static_cast<unsigned>(Component::Zero) : ((m==r) ? static_cast<unsigned>(Component::One) : static_cast<unsigned>(Component::X));
+}
+DLogic TruthTable::evaluate(const DLogic* in) const{
+  unsigned good[MaxInputs],faulty[MaxInputs];
+  for(unsigned i=0;i<_numIn;++i){
+    good[i]=FiveValued::good(in[i].GetInt());
+    faulty[i]=FiveValued::faulty(in[i].GetInt());
+  }
+  return GateKernels::value(FiveValued::value(component(good),component(faulty)));
+}
+DLogic TruthTable::controllingValue(unsigned pin) const{
+  for(int v=0;v<2;++v){
+    Bits f=cofactor(_bits,pin,1==v);
+    if(0==f || ~0ULL==f) return (1==v) ? DLogic::ONE : DLogic::ZERO;
+  }
+  return DLogic::X;
+}
+unsigned TruthTable::observable(Bits f,unsigned pin) const{
+  unsigned n=0;
+  for(unsigned i=0;i<_numIn;++i){
+    if(i!=pin && cofactor(f,i,false)!=cofactor(f,i,true)) ++n;
+  }
+  return n;
+}
+DLogic TruthTable::enablingValue(unsigned pin) const{
+  unsigned zero=observable(cofactor(_bits,pin,false),pin);
+  unsigned one=observable(cofactor(_bits,pin,true),pin);
+  return (zero>one) ? DLogic::ZERO : DLogic::ONE;
+}
+namespace{
+bool groups(const string& digits,unsigned numIn,vector<unsigned>& sizes){
+/* aoi211 : groups of 2, 1 and 1 inputs, adding up to numIn */
+  unsigned total=0;
+  sizes.clear();
+  for(string::size_type i=0;i<digits.size();++i){
+    if(digits[i]<'1' || digits[i]>'6') return false;
+    sizes.push_back(static_cast<unsigned>(digits[i]-'0'));
+    total+=sizes.back();
+  }
+  return 1<sizes.size() && total==numIn;
+}
+bool isHex(const string& func,string::size_type from){
+  return from<func.size() && func.size()-from<=16 && string::npos==func.find_first_not_of("0123456789abcdefABCDEF",from);
+}
+}
+bool TruthTable::isCell(const string& func){
+/* By name alone, fromFunc still decides for a number of inputs */
+  if("xor"==func || "xnor"==func || "mux"==func || "maj"==func) return true;
+  if(0==func.compare(0,4,"lut_")) return isHex(func,4);
+  if(0!=func.compare(0,2,"ao") && 0!=func.compare(0,2,"oa")) return false;
+  string::size_type from=(2<func.size() && 'i'==func[2]) ? 3 : 2;
+  vector<unsigned> sizes;
+  for(unsigned n=2;n<=MaxInputs;++n) if(groups(func.substr(from),n,sizes)) return true;
+  return false;
+}
+bool TruthTable::fromFunc(const string& func,unsigned numIn,TruthTable& t){
+  if(0==numIn || numIn>MaxInputs) return false;
+  Bits all=~0ULL,any=0ULL,parity=0ULL;
+  for(unsigned i=0;i<numIn;++i){
+    all&=variable(i);
+    any|=variable(i);
+    parity^=variable(i);
+  }
+  Bits bits=0;
+  if("and"==func) bits=all;
+  else if("nand"==func) bits=~all;
+  else if("or"==func) bits=any;
+  else if("nor"==func) bits=~any;
+  else if(("buf"==func) && 1==numIn) bits=variable(0);
+  else if(("inv"==func || "not"==func) && 1==numIn) bits=~variable(0);
+  else if("xor"==func && 1<numIn) bits=parity;
+  else if("xnor"==func && 1<numIn) bits=~parity;
+  else if("mux"==func && 3==numIn) bits=(variable(2)&variable(1))|(~variable(2)&variable(0));
+  else if("maj"==func && 1==numIn%2){
+    for(unsigned m=0;m<(1u<<numIn);++m) if(2*static_cast<unsigned>(__builtin_popcount(m))>numIn) bits|=1ULL<<m;
+  }else if(0==func.compare(0,4,"lut_")){
+    if(!isHex(func,4)) return false;
+    bits=strtoull(func.c_str()+4,0,16);
+    if(numIn<MaxInputs && 0!=(bits&~((1ULL<<(1u<<numIn))-1))) return false; // more minterms than inputs
+  }else{
+    bool bAndOr=(0==func.compare(0,2,"ao"));
+    if(!bAndOr && 0!=func.compare(0,2,"oa")) return false;
+    bool bInvert=(2<func.size() && 'i'==func[2]);
+    vector<unsigned> sizes;
+    if(!groups(func.substr(bInvert ? 3 : 2),numIn,sizes)) return false;
+    bits=bAndOr ? 0ULL : ~0ULL;
+    unsigned pin=0;
+    for(size_t g=0;g<sizes.size();++g){
+      Bits term=bAndOr ? ~0ULL : 0ULL;
+      for(unsigned i=0;i<sizes[g];++i,++pin) term=bAndOr ? (term&variable(pin)) : (term|variable(pin));
+      bits=bAndOr ? (bits|term) : (bits&term);
+    }
+    if(bInvert) bits=~bits;
+  }
+  t=TruthTable(numIn,bits);
+  return true;
+}
@@ -0,0 +1,96 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __TruthTable__
+#define __TruthTable__
+#include <string>
+#include <vector>
+#include "DLogic.hpp"
+
+// ------------------------------------------------------------
+// class TruthTable
+// ------------------------------------------------------------
+class TruthTable{
+/* Function of a cell of up to 6 inputs as a bit-packed look up table.
+
+   Bit m of bits() is the output for the input minterm m, input i being
+   bit i of m, inputs numbered in the order of the in edges of the vertex.
+   The table is kept replicated over all 64 bits, so inputs beyond
+   numInputs() are don't cares and every operation below is a few word
+   operations whatever the number of inputs.
+
+   fromFunc knows the cells of a vertex label by name :
+      and nand or nor buf inv not        the primitives, any fanin
+      xor xnor                           parity, 2 to 6 inputs
+      mux                                d0, d1, s : s ? d1 : d0
+      maj                                majority, odd fanin
+      aoi21 aoi22 aoi211 ... oai..       inverted and-or, or-and, one digit
+      ao.. oa..                          per group, the groups in input order
+      lut_<hex>                          the table itself, bit m is minterm m
+   isCell is true for the names other than the primitives, from the name
+   alone, so it is cheap enough to ask for every vertex.
+
+   Evaluation is exact for three values, each machine apart : the known
+   inputs select the minterms that agree with them, the output is 0 or 1
+   if all of those agree, X if not. So xor(D,D) is ZERO and mux(ONE,ONE,X)
+   is ONE. The bit-parallel simulators use onCover() and offCover(), the
+   prime implicants of the function and of its complement : the output is
+   1 where some on cube has all its literals known and true, which for the
+   full set of primes is the same exact three valued result.
+
+   controllingValue(pin) is the value of the input that alone fixes the
+   output, X if there is none. enablingValue(pin) is the value a side
+   input should take so that the other inputs still reach the output :
+   the complement of a controlling value, otherwise the value that leaves
+   more inputs observable, ONE on a tie. For the primitives these are the
+   controlling and non-controlling values of the gate.
+
+   Usage :
+      TruthTable t;
+      if(TruthTable::fromFunc("aoi21",3,t)){
+        DLogic in[3]={DLogic::ONE,DLogic::D,DLogic::ZERO};
+        DLogic out=t.evaluate(in);              // _D
+        DLogic side=t.enablingValue(2);         // ZERO
+      }
+   NB - compiler defaults of destructor, copy constructor, operator= sufficient
+ */
+public:
+  enum{MaxInputs=6};
+  typedef unsigned long long Bits;
+  struct Cube{
+    unsigned char care;  // inputs in the product term
+    unsigned char value; // their values, within care
+  };
+  TruthTable() : _numIn(0), _bits(0) {}
+  TruthTable(unsigned numIn,Bits bits);
+  static bool fromFunc(const std::string& func,unsigned numIn,TruthTable& t); // false if no such cell of numIn inputs
+  static bool isCell(const std::string& func);
+
+  unsigned numInputs() const { return _numIn; }
+  Bits bits() const { return _bits; }
+  bool output(unsigned minterm) const { return 0!=((_bits>>minterm)&1ULL); }
+  unsigned component(const unsigned* in) const; // Component::Zero, One or X per input, see LogicAlgebra
+  DLogic evaluate(const DLogic* in) const;
+  const std::vector<Cube>& onCover() const { return _on; }
+  const std::vector<Cube>& offCover() const { return _off; }
+
+  DLogic controllingValue(unsigned pin) const;
+  DLogic enablingValue(unsigned pin) const;
+  bool dependsOn(unsigned pin) const { return cofactor(_bits,pin,false)!=cofactor(_bits,pin,true); }
+  bool operator==(const TruthTable& rhs) const { return _numIn==rhs._numIn && _bits==rhs._bits; }
+private:
+  static Bits variable(unsigned i); // minterms with input i at 1
+  static Bits replicate(unsigned numIn,Bits bits);
+  static Bits cofactor(Bits f,unsigned pin,bool value);
+  static Bits agreeing(unsigned care,unsigned value); // minterms that agree with the literals
+  void makeCovers();
+  unsigned observable(Bits f,unsigned pin) const; // inputs other than pin that f depends on
+
+  unsigned _numIn;
+  Bits _bits;
+  std::vector<Cube> _on;
+  std::vector<Cube> _off;
+};
+#endif // __TruthTable__
@@ -0,0 +1,60 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#include "ValueChangeDump.hpp"
+#include "AsyncWriter.hpp"
+#include <stdio.h>
+#include <time.h>
+using namespace std;
+
+string ValueChangeDump::identifier(size_t signal){
+  /* printable characters '!' to '~', least significant first */
+  string id;
+  do{
+    id+=static_cast<char>('!'+signal%94);
+    signal/=94;
+  }while(0!=signal);
+  return id;
+}
+bool ValueChangeDump::write(const string& path,const string& scope) const{
+  static const char* Values[]={"b00 ","b11 ","b10 ","b01 ","bxx "}; // indexed by DLogic::GetInt
+  AsyncWriter w(path);
+  if(!w.good()) return false;
+  time_t Clock;
+  time(&Clock);
+  string line="$date\n  ";
+  line+=asctime(localtime(&Clock));
+  line+="$end\n$version\n  atpg value change dump\n$end\n$timescale 1ns $end\n";
+  line+="$scope module "+(scope.empty() ? string("atpg") : scope)+" $end\n";
+  w.write(line);
+  vector<string> ids(_names.size());
+  for(size_t i=0;i<_names.size();++i){
+    ids[i]=identifier(i);
+    string name=_names[i];
+    for(string::size_type k=0;k<name.size();++k) if(' '==name[k]) name[k]='_';
+    w.write("$var wire 2 "+ids[i]+" "+name+" $end\n");
+  }
+  w.write("$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n");
+  for(size_t i=0;i<ids.size();++i) w.write("bxx "+ids[i]+"\n");
+  w.write("$end\n");
+  unsigned lastStep=0;
+  for(vector<Record>::const_iterator it=_changes.begin();it!=_changes.end();++it){
+    unsigned step=static_cast<unsigned>(*it>>32);
+    size_t signal=static_cast<size_t>((*it>>3)&0x1FFFFFFF);
+    unsigned value=static_cast<unsigned>(*it&7);
+    if(signal>=ids.size() || value>4) continue;
+    if(step!=lastStep){
+      char stamp[16];
+      sprintf(stamp,"#%u\n",step);
+      w.write(stamp);
+      lastStep=step;
+    }
+    w.write(Values[value]);
+    w.write(ids[signal]);
+    w.write("\n",1);
+  }
+  w.close();
+  return w.good();
+}
@@ -0,0 +1,63 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#ifndef __ValueChangeDump__
+#define __ValueChangeDump__
+#include <string>
+#include <vector>
+#include "DLogic.hpp"
+
+// ------------------------------------------------------------
+// class ValueChangeDump
+// ------------------------------------------------------------
+class ValueChangeDump{
+/* Records signal changes made during ATPG and writes them as a VCD file
+   that any waveform viewer can load. This replaces dumping the whole graph
+   with writeGraph("debug.dot") on every iteration of runATPG.
+
+   A change is packed into one 64 bit word : step (32 bits), signal (29 bits)
+   and DLogic value (3 bits), so recording is a single push_back. Writes
+   that leave a signal at its last recorded value are not changes and are
+   dropped. Time in the VCD file is the step counter, advanced once per
+   propagation event.
+
+   Each signal is dumped as a 2 bit vector {good,faulty} :
+      ZERO b00   ONE b11   D b10   _D b01   X bxx
+
+   clear() empties the dump for the next run, see RunGraph::runFaultList.
+
+   Compile with VCD_OFF to remove recording from RunGraph altogether.
+   NB - compiler defaults of destructor, copy constructor, operator= sufficient
+ */
+public:
+  typedef unsigned long long Record;
+  ValueChangeDump() : _step(0) {}
+  void setSignals(const std::vector<std::string>& names){
+    _names=names;
+    _last.assign(names.size(),static_cast<unsigned char>(DLogic::X.GetInt()));
+  }
+  void clear(){ // starts a new dump of the same signals
+    _step=0;
+    _last.assign(_last.size(),static_cast<unsigned char>(DLogic::X.GetInt()));
+    _changes.clear();
+  }
+  void step(){ ++_step; }
+  unsigned getStep() const { return _step; }
+  void record(std::size_t signal,const DLogic& value){
+    unsigned char v=static_cast<unsigned char>(value.valid() ? value.GetInt() : DLogic::X.GetInt());
+    if(signal>=_last.size() || _last[signal]==v) return; // not a change
+    _last[signal]=v;
+    _changes.push_back((static_cast<Record>(_step)<<32)|(static_cast<Record>(signal&0x1FFFFFFF)<<3)|v);
+  }
+  std::size_t size() const { return _changes.size(); }
+  bool write(const std::string& path,const std::string& scope) const;
+  static std::string identifier(std::size_t signal); // VCD short identifier
+private:
+  unsigned _step;
+  std::vector<std::string> _names;
+  std::vector<unsigned char> _last; // last recorded value per signal
+  std::vector<Record> _changes;
+};
+#endif // __ValueChangeDump__
@@ -7,31 +7,115 @@
 #endif
 
 #include <iostream>
+#include <stdlib.h>
 using std::cout;
 
 #include "SupportGraph.hpp"
 #include "atpg.hpp"
 #include "CmdLine.hpp"
+#include "PatternSim.hpp"
+#include "CompiledSim.hpp"
+#include "Aig.hpp"
+#include "MappedNetlist.hpp"
+#include "RunStats.hpp"
+#include "TraceEvents.hpp"
+#include "CallProfile.hpp"
+#include "MemStats.hpp"
+#include "Progress.hpp"
+#include "DotStore.hpp"
 void processCmdLine(CmdLine& cL,int argc,char** argv){
   cL.addStandaloneSwitch("-i","initialize graph");
   cL.addStandaloneSwitch("-atpg","run atpg algorithm");
+  cL.addStandaloneSwitch("-faults","run atpg on every checkpoint fault");
+  cL.addParameterSwitch("--progress","undefined","write progress json lines path, - for stderr");
+  cL.addParameterSwitch("--progress-interval","10","seconds between progress lines");
+  cL.addParameterSwitch("--progress-socket","undefined","also answer progress on this unix socket path");
   cL.addStandaloneSwitch("-h","print this help message");
   cL.addParameterSwitch("-t","undefined","run test");
   cL.addParameterSwitch("-r","undefined","read dot file path");
   cL.addParameterSwitch("-w","undefined","write dot file path");
+  cL.addParameterSwitch("-wm","dot","write mode, dot, values or full");
+  cL.addParameterSwitch("-j","1","number of worker threads");
+  cL.addParameterSwitch("-p","undefined","write pattern file path");
+  cL.addParameterSwitch("-pf","text","pattern file format, text or bin");
+  cL.addParameterSwitch("-vcd","undefined","write atpg value change dump path, path.N.vcd per fault with -faults");
+  cL.addParameterSwitch("-s","undefined","simulate pattern file path");
+  cL.addParameterSwitch("-sw","64","simulation block width, 64, 256 or 512");
+  cL.addParameterSwitch("-cs","undefined","simulate -s with native code compiled for the netlist, cached in this directory");
+  cL.addStandaloneSwitch("-fg","fault grade the -s pattern file on the checkpoint faults");
+  cL.addParameterSwitch("-algebra","5","logic values for -fg, 3, 5 or 9");
+  cL.addParameterSwitch("-nm","undefined","write mapped netlist path");
+  cL.addParameterSwitch("-rm","undefined","read mapped netlist path, instead of -r");
+  cL.addParameterSwitch("-fc","undefined","print fault cone size of this PI, with -rm");
+  cL.addParameterSwitch("-rc","undefined","read dot file path into the compact store, for -s and -nm, instead of -r");
+  cL.addStandaloneSwitch("-ka","keep every dot attribute with -rc, as offsets into the file");
+  cL.addStandaloneSwitch("-aig","structurally hash the netlist into an and-inverter graph for -s and -nm");
+  cL.addParameterSwitch("-aigmap","undefined","write the original nets and faults on the and-inverter graph, path");
+  cL.addParameterSwitch("-order","file",string("renumber the netlist for -s and -nm, ")+Netlist::orderingNames());
+  cL.addParameterSwitch("--stats-json","undefined","write run statistics json path");
+  cL.addStandaloneSwitch("--perf","add hardware counters per phase to --stats-json");
+  cL.addParameterSwitch("-tj","undefined","write chrome trace-event json path");
+  cL.addParameterSwitch("--mem-report","undefined","write heap usage by subsystem path");
+  cL.addStandaloneSwitch("--mem-sites","add hot allocation sites of the atpg loop to --mem-report");
+  cL.addParameterSwitch("-cp","undefined","write call-tree profile, path prefix for .txt and .folded");
   cL.addParameterSwitch("-x","T?D?O?-","debug option, default to trace and debug to stdout");
   cL.process(argc,argv);
 }
+void processNetlist(Netlist& netlist,CmdLine& cL){
+/* The compiled netlist pipeline of -r and -rc : -aig, -order, -nm, then
+   -s with -cs and -fg.
+*/
+  if("set"==cL.switchValue("-aig")){
+    Aig::hashNetlist(netlist,("undefined"!=cL.switchValue("-aigmap")) ? cL.switchValue("-aigmap") : "");
+  }
+  netlist.reorder(Netlist::orderingFromName(cL.switchValue("-order")));
+  if("undefined"!=cL.switchValue("-nm") && !MappedNetlist::write(netlist,cL.switchValue("-nm"))){
+    cout << "Error! Cannot write mapped netlist " << cL.switchValue("-nm") << "\n";
+  }
+  if("undefined"!=cL.switchValue("-s")){
+    PatternSim::Stats stats;
+    CompiledSim compiled;
+    bool bCompiled="undefined"!=cL.switchValue("-cs") && compiled.load(netlist,atoi(cL.switchValue("-sw").c_str())/64,cL.switchValue("-cs"));
+    PatternSim::simulateFile(netlist,cL.switchValue("-s"),atoi(cL.switchValue("-sw").c_str()),stats,bCompiled ? &compiled : 0);
+    if("set"==cL.switchValue("-fg")){
+      PatternSim::Stats gradeStats;
+      PatternSim::gradeFile(netlist,cL.switchValue("-s"),atoi(cL.switchValue("-algebra").c_str()),gradeStats);
+    }
+  }
+}
 int main(int argc,char** argv){
   /** Outline of source file organization
    SUBSYSTEM                  | SOURCE FILES
    ---------------------------+-----------------------------------------                         
    Command line               | CmdLine.h, CmdLine.cpp
-   Program tracing            | Debug.hpp
+   Program tracing            | Debug.hpp, DebugSink.hpp, DebugSink.cpp
+   Per-thread state           | ThreadRegistry.hpp
+   Run statistics             | RunStats.hpp, RunStats.cpp, PerfCounters.hpp, PerfCounters.cpp
+   Timing spans               | TraceEvents.hpp, TraceEvents.cpp
+   Call-tree profile          | CallProfile.hpp, CallProfile.cpp
+   Heap accounting            | MemStats.hpp, MemStats.cpp
+   Progress reporting         | Progress.hpp, Progress.cpp
    Multi-valued logic         | DLogic.hpp
+   Multi-valued algebras      | LogicAlgebra.hpp, LogicAlgebra.cpp, FaultSim.hpp
+   Cell truth tables          | TruthTable.hpp, TruthTable.cpp
    Graph visualization and IO | modifications to Graphviz.hpp
+   Pattern file IO            | PatternFile.hpp, PatternFile.cpp, AsyncWriter.hpp
+   Compiled netlist           | Netlist.hpp, Netlist.cpp
+   Net signal storage         | NetSignals.hpp, NetSignals.cpp
+   Incremental gate eval      | GateCounts.hpp, GateCounts.cpp
+   Fixed-arity gate kernels   | GateKernels.hpp, GateKernels.cpp
+   Interned strings           | StringPool.hpp, StringPool.cpp
+   Compact dot reader         | DotStore.hpp, DotStore.cpp
+   Out-of-core netlist        | MappedNetlist.hpp, MappedNetlist.cpp
+   ATPG waveforms             | ValueChangeDump.hpp, ValueChangeDump.cpp
+   Bit-parallel simulation    | BitSim.hpp, PatternSim.hpp, PatternSim.cpp
+   Compiled-code simulation   | CompiledSim.hpp, CompiledSim.cpp
+   Structural hashing         | Aig.hpp, Aig.cpp
    Driver program             | atpg.cpp
-   EDA algorithm - basic DFT  | atpg.hpp, DFrontier.hpp
+   Micro-benchmarks           | Bench.hpp, Bench.cpp, atpgbench.cpp
+   Synthetic circuits         | CircuitGen.hpp, CircuitGen.cpp, atpggen.cpp
+   Scaling benchmark          | atpgscale.cpp
+   EDA algorithm - basic DFT  | atpg.hpp, DFrontier.hpp, Arena.hpp, Arena.cpp
 
    INCLUSION TREE ( -+-> means "includes" )
      -atpg.cpp -+->CmdLine.h
@@ -52,8 +136,62 @@ int main(int argc,char** argv){
   cout << "$Id$\n";
   CmdLine cLine;
   processCmdLine(cLine,argc,argv);
+  // before any reader, so -r, -rc and -rm are all traced, counted and profiled
+  if("undefined"!=cLine.switchValue("-tj")) Debug::specify("P?");
+  if("set"==cLine.switchValue("--perf")) RunStats::enableCounters(true);
+  if("undefined"!=cLine.switchValue("-cp")) Debug::specify("C?");
+  if("set"==cLine.switchValue("--mem-sites")) MemStats::enableSites(true);
   if("set"==cLine.switchValue("-h")){
     cLine.printSwitches();
+  }else if(Netlist::NumOrderings==Netlist::orderingFromName(cLine.switchValue("-order"))){
+    cout << "Error! Unknown ordering " << cLine.switchValue("-order") << ", use " << Netlist::orderingNames() << "\n";
+#if defined(DEBUG_OFF) || 0==DEBUG_COMPILE_LEVEL
+  }else if("undefined"!=cLine.switchValue("-tj")){
+    cout << "Error! -tj needs the timing spans, not compiled in ( DEBUG_OFF or DEBUG_COMPILE_LEVEL 0 )\n";
+    return 1;
+  }else if("undefined"!=cLine.switchValue("-cp")){
+    cout << "Error! -cp needs the call-tree profile, not compiled in ( DEBUG_OFF or DEBUG_COMPILE_LEVEL 0 )\n";
+    return 1;
+#endif
+  }else if("undefined"!=cLine.switchValue("-rm")){
+    MappedNetlist mapped;
+    if(!mapped.open(cLine.switchValue("-rm"))){
+      cout << "Error! Cannot read mapped netlist " << cLine.switchValue("-rm") << "\n";
+    }else{
+      cout << "Mapped netlist " << mapped.size() << " gates, depth " << mapped.getDepth()
+           << ", " << mapped.numBlocks() << " blocks\n";
+      if("undefined"!=cLine.switchValue("-fc")){
+        MappedNetlist::GateId root=mapped.findGate(cLine.switchValue("-fc"));
+        if(root<mapped.size()){
+          std::vector<MappedNetlist::GateId> cone;
+          mapped.faultCone(root,cone);
+          cout << "Fault cone of " << cLine.switchValue("-fc") << " : " << cone.size() << " gates\n";
+        }else{
+          cout << "Error! No PI or PO named " << cLine.switchValue("-fc") << "\n";
+        }
+      }
+      if("undefined"!=cLine.switchValue("-s")){
+        PatternSim::Stats stats;
+        PatternSim::simulateMappedFile(mapped,cLine.switchValue("-s"),atoi(cLine.switchValue("-sw").c_str()),stats);
+      }
+    }
+  }else if("undefined"!=cLine.switchValue("-rc")){
+    DotStore dot("set"==cLine.switchValue("-ka"));
+    if(!dot.read(cLine.switchValue("-rc"))){
+      cout << "Error! " << dot.error() << "\n";
+    }else{
+      Netlist netlist;
+      bool bCompiled=dot.compile(netlist);
+      size_t gates=(0==dot.numVertices()) ? 1 : dot.numVertices();
+      cout << "Compact dot " << dot.numVertices() << " vertices, " << dot.numEdges() << " edges, "
+           << dot.bytes() << " bytes, " << dot.bytes()/gates << " per gate, string pool "
+           << StringPool::global().bytes() << " bytes\n";
+      if(!bCompiled){
+        cout << "Error! Netlist has a combinational loop\n";
+      }else{
+        processNetlist(netlist,cLine);
+      }
+    }
   }else{
     const string& inputFile=cLine.switchValue("-r");
     if("undefined"!=inputFile){
@@ -66,10 +204,39 @@ int main(int argc,char** argv){
         tGraph.setDebug(cLine.switchValue("-x"));
         if("set"==cLine.switchValue("-i")) tGraph.initializeGraph();
         if("undefined"!=cLine.switchValue("-t")) tGraph.test(cLine.switchValue("-t"));
+        if("undefined"!=cLine.switchValue("-vcd")) tGraph.openValueChangeDump(cLine.switchValue("-vcd"));
+        if("undefined"!=cLine.switchValue("-p")) tGraph.openPatternFile(cLine.switchValue("-p"),cLine.switchValue("-pf"));
+        if("set"==cLine.switchValue("-atpg")){ // the fault seeded in the file
+          tGraph.runATPG();
+          tGraph.reportRun();
+        }
+        if("set"==cLine.switchValue("-faults")){
+          const string& progressPath=cLine.switchValue("--progress");
+          const string& socketPath=cLine.switchValue("--progress-socket");
+          bool bProgress=false;
+          if("undefined"!=progressPath || "undefined"!=socketPath){
+            bProgress=Progress::start(atof(cLine.switchValue("--progress-interval").c_str()),
+                                      ("undefined"!=progressPath) ? progressPath : "-",
+                                      ("undefined"!=socketPath) ? socketPath : "");
+          }
+          tGraph.runFaultList();
+          if(bProgress) Progress::stop();
+        }
 
-//        if("set"==cLine.switchValue("-atpg")) tGraph.runATPG();
-
-        if("undefined"!=cLine.switchValue("-w")) tGraph.writeGraph(cLine.switchValue("-w"));
+        if("undefined"!=cLine.switchValue("-s") || "undefined"!=cLine.switchValue("-nm")){
+          Netlist netlist;
+          if(tGraph.compileNetlist(netlist)) processNetlist(netlist,cLine);
+        }
+        if("undefined"!=cLine.switchValue("-w")){
+          const string& writeMode=cLine.switchValue("-wm");
+          if("values"==writeMode){
+            tGraph.writeGraphValues(cLine.switchValue("-w"));
+          }else if("full"==writeMode){
+            tGraph.writeGraphParallel(cLine.switchValue("-w"),atoi(cLine.switchValue("-j").c_str()));
+          }else{
+            tGraph.writeGraph(cLine.switchValue("-w"));
+          }
+        }
       }else if(SupportGraph::Graph==dotFileType){
         cout << "Graph file type not supported. Skipping\n";
       }else{
@@ -77,5 +244,27 @@ int main(int argc,char** argv){
       }
     }
   }
+  const string& tracePath=cLine.switchValue("-tj");
+  if("undefined"!=tracePath){ // not compiled in is refused above
+    if(!TraceEvents::write(tracePath)) cout << "Error! Cannot write " << tracePath << "\n";
+  }
+  const string& profilePath=cLine.switchValue("-cp");
+  if("undefined"!=profilePath){ // not compiled in is refused above
+    if(!CallProfile::write(profilePath)) cout << "Error! Cannot write " << profilePath << ".txt/.folded\n";
+  }
+  const string& statsPath=cLine.switchValue("--stats-json");
+  if("undefined"!=statsPath){
+#ifdef STATS_OFF
+    cout << "Warning! Run statistics not compiled in ( STATS_OFF )\n";
+#endif
+    if(!RunStats::writeJson(statsPath)) cout << "Error! Cannot write " << statsPath << "\n";
+  }
+  const string& memPath=cLine.switchValue("--mem-report");
+  if("undefined"!=memPath){
+#ifdef MEMSTATS_OFF
+    cout << "Warning! Heap accounting not compiled in ( MEMSTATS_OFF )\n";
+#endif
+    if(!MemStats::write(memPath)) cout << "Error! Cannot write " << memPath << "\n";
+  }
   return 0;
 }
@@ -13,6 +13,7 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <map>
 #include <deque>
 // boost inclusions, except config.hpp
 #include <boost/static_assert.hpp>
@@ -32,6 +33,18 @@
 #include "Debug.hpp"
 #include "DFrontier.hpp"
 #include "DLogic.hpp"
+#include "PatternFile.hpp"
+#include "Netlist.hpp"
+#include "ValueChangeDump.hpp"
+#include "ParallelFormat.hpp"
+#include "RunStats.hpp"
+#include "MemStats.hpp"
+#include "Progress.hpp"
+#include "Arena.hpp"
+#include "NetSignals.hpp"
+#include "GateCounts.hpp"
+#include "GateKernels.hpp"
+#include "TruthTable.hpp"
 // std namespace usage
 using namespace std;
 // boost namespace usage
@@ -127,10 +140,10 @@ private:
 // function putDescendantsInDFrontier
 // function putDescendantsInPContainer
 // ------------------------------------------------------------
-template<class VertexType,class VertexAttrMapType>
-void dumpDFrontier(std::deque<VertexType>& dF,VertexAttrMapType& vMap){
-  typedef std::deque<VertexType> DFrontierType;
-  Debug D("dumpDFrontier");
+template<class DFrontierType,class VertexAttrMapType>
+void dumpDFrontier(DFrontierType& dF,VertexAttrMapType& vMap){
+  DEBUG_SCOPE(DEBUG_LEVEL_GATE,"dumpDFrontier");
+  if(!D.debugging(DEBUG_ID("1"))) return;
   ostringstream outputString;
   if(0==dF.size()){
     outputString << "empty";
@@ -139,12 +152,12 @@ void dumpDFrontier(std::deque<VertexType>& dF,VertexAttrMapType& vMap){
       outputString << vMap[*iD]["label"]+",";
     }
   }
-  D.Dbg("1","DFrontier==",outputString.str());
+  DEBUG_DBG("1","DFrontier==",outputString.str());
 };
-template<class VertexType,class VertexAttrMapType>
-void dumpSetVS(std::set<VertexSignalPair<VertexType> > & sVS,VertexAttrMapType& vMap){
-  typedef set<VertexSignalPair<VertexType> > SetVertexSignalPairType;
-  Debug D("dumpSetVS");
+template<class SetVertexSignalPairType,class VertexAttrMapType>
+void dumpSetVS(SetVertexSignalPairType& sVS,VertexAttrMapType& vMap){
+  DEBUG_SCOPE(DEBUG_LEVEL_STEP,"dumpSetVS");
+  if(!D.debugging(DEBUG_ID("1"))) return;
   ostringstream outputString;
   if(0==sVS.size()){
     outputString << "empty";
@@ -155,14 +168,14 @@ void dumpSetVS(std::set<VertexSignalPair<VertexType> > & sVS,VertexAttrMapType&
       outputString << ",";
     }
   }
-  D.Dbg("1","sVS==",outputString.str());
+  DEBUG_DBG("1","sVS==",outputString.str());
 };
-template<class VertexType, class GraphType> 
-void putDescendantsInDFrontier(VertexType& v,GraphType& g,std::deque<VertexType>& dF){
+template<class VertexType, class GraphType, class DFrontierType> 
+void putDescendantsInDFrontier(VertexType& v,GraphType& g,DFrontierType& dF){
   typedef typename boost::property_map<GraphType,boost::vertex_attribute_t>::type VertexAttrMapType;
   typedef typename boost::graph_traits<GraphType>::adjacency_iterator AdjacencyIteratorType;
-  typedef std::deque<VertexType> DFrontierType;
-    Debug D("putDescendantsInDFrontier");
+    DEBUG_SCOPE(DEBUG_LEVEL_GATE,"putDescendantsInDFrontier");
+    MEMSTATS_TAG(MemStats::DFrontier);
     VertexAttrMapType vMap=boost::get(boost::vertex_attribute,g);
     AdjacencyIteratorType startAI, endAI;
     for(tie(startAI,endAI)=adjacent_vertices(v,g);startAI!=endAI;++startAI){
@@ -171,19 +184,21 @@ void putDescendantsInDFrontier(VertexType& v,GraphType& g,std::deque<VertexType>
         dF.push_back(*startAI);
       }//if *startAI not already in DFrontier
     }//for adjacent_vertices
+    STATS_DFRONTIER(dF.size());
     dumpDFrontier(dF,vMap);
 };
-template<class VertexType, class GraphType> 
-void putDescendantsInPContainer(VertexType& v,GraphType& g,std::deque<VertexType>& cV){
+template<class VertexType, class GraphType, class PropagateContainerType> 
+void putDescendantsInPContainer(VertexType& v,GraphType& g,PropagateContainerType& cV){
   typedef typename boost::property_map<GraphType,boost::vertex_attribute_t>::type VertexAttrMapType;
   typedef typename boost::graph_traits<GraphType>::adjacency_iterator AdjacencyIteratorType;
-    Debug D("putDescendantsInPContainer");
+    DEBUG_SCOPE(DEBUG_LEVEL_GATE,"putDescendantsInPContainer");
     VertexAttrMapType vMap=boost::get(vertex_attribute,g);
-    D.Dbg("1","source vertex==",vMap[v]["label"]);
+    DEBUG_DBG("1","source vertex==",vMap[v]["label"]);
     AdjacencyIteratorType startAI, endAI;
     for(tie(startAI,endAI)=adjacent_vertices(v,g);startAI!=endAI;++startAI){
-        D.Dbg("1","descendant vertex ==",vMap[*startAI]["label"]);
+        DEBUG_DBG("1","descendant vertex ==",vMap[*startAI]["label"]);
         cV.push_back(*startAI);
+        STATS_COUNT(RunStats::Events);
     }//for adjacent_vertices
 };
 // ------------------------------------------------------------
@@ -191,10 +206,9 @@ void putDescendantsInPContainer(VertexType& v,GraphType& g,std::deque<VertexType
 // struct isXTypeFunctor
 // function DPassable
 // function OutputConsistent
-// function EvaluateOutputs
+// function CellTable
 // function EvaluateSingleInput
 // function EvaluateMultipleInputs
-// function setOutputEdges
 // ------------------------------------------------------------
 struct isDTypeFunctor{
   bool operator()(const DLogic& lhs) const{
@@ -247,107 +261,68 @@ bool OutputConsistent(DLogic sA, DLogic sB){
       return true;
     }
 };
-template<class Vertex,class GraphType> 
-DLogic EvaluateOutputs(Vertex& v, GraphType& g){
-  /* The functionality can be described as follows :
-     RealSignals, R=={ONE,ZERO,D,_D}
-     Since the vertex has 0 inputs, we are talking about ensuring that all
-     out_edges have the same signal value. This can then be used to
-     set the remaining out_edges
-     Set of out_edges | Evaluated result
-     -----------------|-----------------
-     R,X,X,X          |  R
-     R,R,X,X          |  R
-     R1,R2,X,X        |  assert error ( R1 != R2 )
-     X,X,X,X          |  X
-
-     By convention, 
-     D==good/bad==0/1 and _D==1/0
-     Should _D and 1 be considered compatible?
-  */ 
-  typedef typename boost::property_map<GraphType,boost::vertex_attribute_t>::type VertexAttrMapType;
-  typedef typename boost::property_map<GraphType,boost::edge_attribute_t>::type EdgeAttrMapType;
-  typedef typename boost::graph_traits<GraphType>::out_edge_iterator OutEdgeIteratorType;
-  Debug D("EvaluateOutputs");
-  VertexAttrMapType vMap=boost::get(boost::vertex_attribute,g);
-  EdgeAttrMapType eMap=boost::get(boost::edge_attribute,g);
-  string VertexLabel=vMap[v]["label"];
-  D.Dbg("1","vertex label==",VertexLabel);
-  OutEdgeIteratorType startEI,endEI;
-  set<string> RealSignalSet;
-  for(  tie(startEI,endEI)=out_edges(v,g);startEI!=endEI;++startEI){
-    string& signal=eMap[*startEI]["label"];
-    D.Dbg("1","signal==",signal);
-    if("X"!=signal){
-      RealSignalSet.insert(signal);
-    }//if
-  }//for
-  string sResult="X";
-  switch(RealSignalSet.size()){
-  case 0: // bec no driving signal found
-    break;
-  case 1: // one consistent driving signal found
-    sResult=*(RealSignalSet.begin()); 
-    break;
-  default : // more than one incompatible driving signal
-    cout << "Error! More than one incompatible signal found on out_edges of " << VertexLabel << "\n";
-    break;
-  }//switch
-  D.Dbg("1","sResult==",sResult);
-  return DLogic(sResult);
+const TruthTable* CellTable(const string& func,unsigned numIn){
+/* The table of the cell func of numIn inputs, 0 if there is none. Each
+   thread parses a func and fanin once, every later evaluation of it in the
+   run reuses the table.
+*/
+  if(numIn>TruthTable::MaxInputs || !TruthTable::isCell(func)) return 0;
+  typedef map<string,pair<bool,TruthTable> > Tables;
+  static thread_local Tables tables[TruthTable::MaxInputs+1];
+  Tables::iterator it=tables[numIn].find(func);
+  if(tables[numIn].end()==it){
+    TruthTable table;
+    bool bCell=TruthTable::fromFunc(func,numIn,table);
+    it=tables[numIn].insert(make_pair(func,make_pair(bCell,table))).first;
+  }
+  return it->second.first ? &it->second.second : 0;
 };
-DLogic EvaluateSingleInput(const string& func,const string& input){
-  Debug D("EvaluateSingleInput");
-  D.Dbg("1","func=",func);
-  D.Dbg("1","input=",input);
+DLogic EvaluateSingleInput(const string& func,DLogic input){
+  DEBUG_SCOPE(DEBUG_LEVEL_GATE,"EvaluateSingleInput");
+  STATS_COUNT(RunStats::GateEvals);
+  DEBUG_DBG("1","func=",func);
+  DEBUG_DBG("1","input=",input);
 
   DLogic result(input);
 
+  const TruthTable* table=0;
   if("inv"==func || "not"==func){
     result = (! result);
+  }else if(0!=(table=CellTable(func,1))){
+    result=table->evaluate(&input);
   }
   // D.Dbg("1","result==",result.GetString());
-    D.Dbg("1","result==",result);
+    DEBUG_DBG("1","result==",result);
   return result;
 };
-DLogic EvaluateMultipleInputs(const string& func,vector<DLogic>& v){
-  Debug D("EvaluateMultipleInputs");
-  static DLogicAndFunctor<DLogic> DLogicAnd;
-  static DLogicOrFunctor<DLogic> DLogicOr;
-  D.Dbg("1","func=",func);
-  ostringstream outputString;
-  std::copy(v.begin(),v.end(),ostream_iterator<DLogic>(outputString,","));
-  D.Dbg("1","inputs==",outputString.str());
-
-  DLogic result=DLogic::X;
-  if("nand"==func){
-     result= ! std::accumulate(v.begin(),v.end(),DLogic::ONE,DLogicAnd);
-  }else if("nor"==func){
-     result= ! std::accumulate(v.begin(),v.end(),DLogic::ZERO,DLogicOr);
-  }else if("and"==func){
-     result=std::accumulate(v.begin(),v.end(),DLogic::ONE,DLogicAnd);
-  }else if("or"==func){
-     result=std::accumulate(v.begin(),v.end(),DLogic::ZERO,DLogicOr);
-  }
-  D.Dbg("1","result==",result.GetString());
+DLogic EvaluateSingleInput(const string& func,const string& input){
+  return EvaluateSingleInput(func,DLogic(input));
+};
+DLogic EvaluateMultipleInputs(const string& func,const DLogic* in,unsigned numIn){
+  /* Unrolled kernels up to GateKernels::MaxArity inputs, the table fold
+     beyond. The cells TruthTable knows from their table, X for any other
+     func but nand, nor, and, or.
+  */
+  DEBUG_SCOPE(DEBUG_LEVEL_GATE,"EvaluateMultipleInputs");
+  STATS_COUNT(RunStats::GateEvals);
+  DEBUG_DBG("1","func=",func);
+  DEBUG_DBG("1","inputs==",[in,numIn]{
+    ostringstream outputString;
+    std::copy(in,in+numIn,ostream_iterator<DLogic>(outputString,","));
+    return outputString.str();
+  }());
+  Netlist::GateType type=Netlist::Unknown; // only the four funcs below are compared
+  if("nand"==func) type=Netlist::Nand;
+  else if("nor"==func) type=Netlist::Nor;
+  else if("and"==func) type=Netlist::And;
+  else if("or"==func) type=Netlist::Or;
+  const TruthTable* table=(Netlist::Unknown==type) ? CellTable(func,numIn) : 0;
+  DLogic result=(0!=table) ? table->evaluate(in) : GateKernels::evaluate(type,in,numIn);
+  DEBUG_DBG("1","result==",result.GetString());
   return result;
 };
-template<class VertexType,class GraphType>
-void setOutputEdges(VertexType& v, GraphType& g, DLogic d){
-  typedef typename boost::graph_traits<GraphType>::out_edge_iterator OutEdgeIteratorType;
-  typedef typename boost::property_map<GraphType,boost::edge_attribute_t>::type EdgeAttrMapType;
-  Debug D("setOutputEdges");
-  EdgeAttrMapType eMap=boost::get(edge_attribute,g);
-  OutEdgeIteratorType startEI,endEI;
-  string signal=d.GetString();
-  for(  tie(startEI,endEI)=out_edges(v,g);startEI!=endEI;++startEI){
-    string& edgeLabel=eMap[*startEI]["label"];
-    if("X"==edgeLabel){
-      eMap[*startEI]["label"]=signal;
-    }else{
-      cout << "Warning! Output edge should be X\n";
-    }
-  }
+DLogic EvaluateMultipleInputs(const string& func,vector<DLogic>& v){
+  return EvaluateMultipleInputs(func,v.empty() ? 0 : &v[0],static_cast<unsigned>(v.size()));
 };
 // ------------------------------------------------------------
 // class XEdgeVisitor
@@ -372,27 +347,6 @@ private:
   EdgeAttrMapType _EdgeAttrMap;
 };
 // ------------------------------------------------------------
-// class GetSignalFunctor
-// ------------------------------------------------------------
-template<typename GraphType>
-class GetSignalFunctor : public unary_function<typename boost::graph_traits<GraphType>::edge_descriptor,DLogic>{
-/* functor to return signal value of an edge
-   NB - compiler defaults of desctructor, copy constructor sufficient
- */
-public:
-  typedef typename boost::property_map<GraphType,boost::edge_attribute_t>::type EdgeAttrMapType;
-  typedef typename boost::graph_traits<GraphType>::edge_descriptor EdgeType;
-  GetSignalFunctor(GraphType& g){ _E=boost::get(edge_attribute,g);};
-  DLogic operator()(const EdgeType& e) const {
-    string& signal=_E[e]["label"];
-    return DLogic(signal);
-  };
-private:
-  GetSignalFunctor();
-  GetSignalFunctor& operator=(const GetSignalFunctor&);
-  EdgeAttrMapType _E;
-};
-// ------------------------------------------------------------
 // class NodeHelper
 // ------------------------------------------------------------
 class NodeHelper{
@@ -405,7 +359,7 @@ public:
   NodeHelper(const string& label){
     string::size_type dotLocation=label.find_first_of(":");
     if(string::npos!=dotLocation){
-      setName(label.substr(1,dotLocation));
+      setName(label.substr(0,dotLocation));
       setFunc(label.substr(dotLocation+1));
     }else{
       setName(label);
@@ -434,42 +388,35 @@ class BacktraceVisitor : public boost::default_dfs_visitor {
 */
 public:
   typedef typename boost::property_map<GraphType,boost::vertex_attribute_t>::const_type ConstVertexAttrMapType;
-  typedef typename boost::property_map<GraphType,boost::edge_attribute_t>::type EdgeAttrMapType;
   typedef typename boost::graph_traits<GraphType>::in_edge_iterator InEdgeIteratorType;
   typedef typename boost::graph_traits<GraphType>::out_edge_iterator OutEdgeIteratorType;
   typedef typename boost::graph_traits<GraphType>::vertex_descriptor VertexType;
-  typedef set<VertexSignalPair<VertexType> > SetVertexSignalPairType;
+  typedef FixedSet<VertexSignalPair<VertexType> > SetVertexSignalPairType;
 
-  BacktraceVisitor(const GraphType& g,EdgeAttrMapType& eM,SetVertexSignalPairType& setVS) : _EdgeAttrMap(eM), _SetVS(setVS){}
-  /* BacktraceVisitor is used with GraphType==<reverse_graph<G>>, so the GraphType edge attr map has to be passed in */
+  BacktraceVisitor(const NetSignals& nets,const GateCounts& gates,SetVertexSignalPairType& setVS) : _Nets(nets), _Gates(gates), _SetVS(setVS){}
+  /* BacktraceVisitor is used with GraphType==<reverse_graph<G>>, so the signals and gates of G are passed in */
   
   template<class Vertex>bool HasXs(Vertex v,const GraphType& g);
   template<class Vertex>DLogic suggestEnablingSignal(Vertex v, const GraphType & g);
   template<class Vertex>void  discover_vertex(Vertex v, const GraphType & g);
+  template<class Vertex>static const string& getLabel(Vertex v,const GraphType& g);
 
 private:
   BacktraceVisitor();
   BacktraceVisitor& operator=(const BacktraceVisitor&);
-  EdgeAttrMapType& _EdgeAttrMap;
+  const NetSignals& _Nets;
+  const GateCounts& _Gates;
   SetVertexSignalPairType& _SetVS; // set of vertex-signal
 };
 
 template <typename GraphType>
 template<class Vertex>bool BacktraceVisitor<GraphType>::HasXs(Vertex v,const GraphType& g){
-    Debug D("HasXs");
-    string VertexLabel=boost::get(boost::vertex_attribute,g,v)["label"];
-    D.Dbg("1","vertex label==",VertexLabel);
+    DEBUG_SCOPE(DEBUG_LEVEL_GATE,"HasXs");
+    DEBUG_DBG("1","vertex label==",boost::get(boost::vertex_attribute,g,v)["label"]);
 
-    InEdgeIteratorType startEI,endEI;
-    bool bReturn=false;
-    for(tie(startEI,endEI)=in_edges(v,g);startEI!=endEI;++startEI){
-      string& edgeLabel=_EdgeAttrMap[*startEI]["label"];
-      D.Dbg("1","edgeLabel==",edgeLabel);       
-      if("X"==edgeLabel){
-        bReturn=true;
-        break;
-      }
-     }
+    // the in edges of v in the reverse graph are the branches of its net
+    bool bReturn=_Nets.hasX(v);
+    DEBUG_DBG("1","net has X==",bReturn);
     return bReturn;
   }
 
@@ -479,22 +426,37 @@ template <typename GraphType>
        their func values. Return enabling signal, based on func values if
        NAND,NOR,AND and OR found. Otherwise, no simple algorithm exists, so we
        return DLogic::ONE
+       A cell counts as AND where its truth table wants ONE on the pin v
+       drives, as OR where it wants ZERO, see GateCounts::enablingValue.
        Refactor this function if more models have to be supported.
     */
-    Debug D("getEnablingSignal");
-    set<string> setFunc;
-    // process source vertices, putting func in set
+    DEBUG_SCOPE(DEBUG_LEVEL_GATE,"getEnablingSignal");
+    // process source vertices, counting distinct funcs without a set<string>
     InEdgeIteratorType startEI,endEI;
     Vertex vSource;
+    string sFunc;
+    unsigned numFuncs=0;
     for(tie(startEI,endEI)=in_edges(v,g);startEI!=endEI;++startEI){
       vSource=source(*startEI,g);
-      NodeHelper hSource(boost::get(vertex_attribute,g,vSource)["label"]);
-      setFunc.insert(hSource.getFunc());
+      const char* func="noop";
+      if(vSource<_Gates.size() && GateCounts::Table==_Gates.func(vSource)){
+        DLogic value=_Gates.enablingValue(vSource,boost::get(boost::edge_index,g,*startEI));
+        func=(DLogic::ZERO==value) ? "or" : "and";
+      }else{
+        const string& sourceLabel=getLabel(vSource,g);
+        string::size_type colon=sourceLabel.find(':');
+        if(string::npos!=colon) func=sourceLabel.c_str()+colon+1; // see NodeHelper
+      }
+      if(0==numFuncs){
+        sFunc=func;
+        numFuncs=1;
+      }else if(sFunc!=func){
+        numFuncs=2;
+      }
     }//for
 
     DLogic dResult=DLogic::ONE; // default
-    string& sFunc=const_cast<string&>(*(setFunc.begin()));
-    switch(setFunc.size()) {
+    switch(numFuncs) {
     case 0: 
       cout << "Warning: vertex drives no function model.\n";
       break;
@@ -509,15 +471,15 @@ template <typename GraphType>
       cout << "Warning: vertex drives multiple function models. Using default enabling signal.\n";
       break;
     }//switch
-    D.Dbg("1","dResult==",dResult.GetString());
+    DEBUG_DBG("1","dResult==",dResult.GetString());
     return dResult;
   }
 
 template <typename GraphType>
   template <class Vertex > void  BacktraceVisitor<GraphType>::discover_vertex(Vertex v, const GraphType & g){
-    Debug D("discover_vertex");
-    string VertexLabel=boost::get(boost::vertex_attribute,g,v)["label"];
-    D.Dbg("1","vertex label==",VertexLabel);
+    DEBUG_SCOPE(DEBUG_LEVEL_GATE,"discover_vertex");
+    const string& VertexLabel=getLabel(v,g);
+    DEBUG_DBG("1","vertex label==",VertexLabel);
     NodeHelper VertexHelper(VertexLabel);
     const string& VertexFunc=VertexHelper.getFunc();
     if("in"==VertexFunc){
@@ -527,6 +489,18 @@ template <typename GraphType>
       }
     }//if input vertices
   }
+
+template <typename GraphType>
+  template <class Vertex> const string& BacktraceVisitor<GraphType>::getLabel(Vertex v,const GraphType& g){
+    /* The label by reference, through the const property map, instead of
+       copying the whole attribute map of the vertex.
+    */
+    static const string NoLabel;
+    ConstVertexAttrMapType vMap=boost::get(boost::vertex_attribute,g);
+    const GraphvizAttrList& attrs=vMap[v];
+    GraphvizAttrList::const_iterator it=attrs.find("label");
+    return (attrs.end()!=it) ? it->second : NoLabel;
+  }
 // ------------------------------------------------------------
 // class RunGraph
 // ------------------------------------------------------------
@@ -537,6 +511,7 @@ class RunGraph{
 public:
    typedef typename boost::property_map<GraphType,boost::vertex_attribute_t>::type VertexAttrMapType; 
    typedef typename boost::property_map<GraphType,boost::edge_attribute_t>::type EdgeAttrMapType;
+   typedef typename boost::property_map<GraphType,boost::edge_index_t>::type EdgeIndexMapType;
    typedef typename boost::ref_property_map<GraphType*,string> GraphAttrMapType;
 
      typedef typename boost::graph_traits<GraphType>::vertex_descriptor VertexType;
@@ -544,9 +519,20 @@ public:
       typedef typename boost::graph_traits<GraphType>::edge_iterator EdgeIteratorType;
       typedef typename boost::graph_traits<GraphType>::in_edge_iterator InEdgeIteratorType;
       typedef typename boost::graph_traits<GraphType>::out_edge_iterator OutEdgeIteratorType;
-      typedef std::deque<VertexType> DFrontierType;
-      typedef std::deque<VertexType> PropagateContainerType;
-      typedef set<VertexSignalPair<VertexType> > SetVertexSignalPairType;
+      typedef typename boost::graph_traits<GraphType>::edge_descriptor EdgeType;
+      typedef FixedQueue<VertexType> DFrontierType;
+      typedef FixedQueue<VertexType> PropagateContainerType;
+      typedef FixedSet<VertexSignalPair<VertexType> > SetVertexSignalPairType;
+      typedef typename boost::graph_traits<reverse_graph<GraphType> >::out_edge_iterator ReverseOutEdgeIteratorType;
+      typedef std::pair<VertexType,std::pair<ReverseOutEdgeIteratorType,ReverseOutEdgeIteratorType> > BacktraceFrameType;
+      typedef std::pair<VertexType,DLogic> DecisionType;
+      struct RunEnd{ // how the last runATPG ended, see printFinishStats
+        bool bDFrontierEmpty;
+        bool bFirstOutputFound;
+        bool bFirstNonDPassable;
+        bool bFirstInconsistentOutput;
+        bool bAborted; // stopped by a repeated pass, neither detected nor bad
+      };
       // Needs boost::               Y                    N                            Y                    N
   // BOOST_STATIC_ASSERT((boost::is_same<GraphType,GraphvizGraph>::value || boost::is_same<GraphType,GraphvizDigraph>::value));
 
@@ -554,20 +540,51 @@ public:
       ~RunGraph();
       void setDebug(const string& dString);
       void initializeGraph();
+      // net signals, see NetSignals
+      void loadSignals();
+      void storeSignals();
+      DLogic edgeSignal(const EdgeType& e) const { return _nets.branch(source(e,_g),_ei[e]); }
+      DLogic evaluateNet(VertexType v);
+      void driveNet(VertexType v,DLogic d);
+      void clearSignals();
+      void injectFault(const EdgeType& e,DLogic d);
       void backtraceVertex(const VertexType& v);
       // propagate code
       bool processOutput(VertexType v,GraphType& g,PropagateContainerType& cv,DLogic outS,DLogic currentS);
       tripleBool propagateChange(VertexType v, GraphType& g,PropagateContainerType& cv);
       tripleBool propagateVertex(VertexType v, DLogic driveSignal);
       // driver code
-      void runATPG();
+      bool runATPG(); // true if the fault reached an output, no report
+      void reportRun(); // printFinishStats and the value change dump of the last runATPG
+      const RunEnd& lastRun() const { return _lastRun; }
+      void runFaultList();
       void test(const string& startLabel);
 
       VertexType endVertex(){ return *vertices(_g).second; }; // syntatic sugar for making vertex checks clearer. Q, should keep value or call vertices each time?
       VertexType findVertexWithLabel(const string& label);
       void writeGraph(const string& path);
+      void writeGraphValues(const string& path);
+      void writeGraphParallel(const string& path,unsigned numThreads);
+      string vertexId(VertexType v) const;
+      // pattern output
+      void getPorts(vector<VertexType>& vPI,vector<VertexType>& vPO);
+      void openPatternFile(const string& path,const string& format);
+      void recordPattern();
+      // value change dump, compiled out with VCD_OFF
+      void openValueChangeDump(const string& path);
+      void writeValueChangeDump(const string& path);
+#ifdef VCD_OFF
+      void traceStep(){}
+      void traceChange(VertexType v,DLogic s){}
+#else
+      void traceStep(){ if(NULL!=_pVCD) _pVCD->step(); }
+      void traceChange(VertexType v,DLogic s){ if(NULL!=_pVCD) _pVCD->record(v,s); }
+#endif
+      // compiled netlist for the simulators
+      bool compileNetlist(Netlist& n);
       void seedDFrontier(DFrontierType& dF);
       void updateDFrontier(DFrontierType& dF);
+      void resetSearchState();
       void printFinishStats(bool DFrontierEmpty,bool FirstOutputFound, bool FirstNonDPassable, bool FirstInconsistentOutput);
       const string getVersion(){ return _Version; };
       static string _Version;
@@ -578,9 +595,22 @@ private:
       GraphType _g;
       VertexAttrMapType _v;
       EdgeAttrMapType _e;
+      EdgeIndexMapType _ei;
+      NetSignals _nets; // the edge labels once initializeGraph has run
+      GateCounts _gates; // input counts of the gates, follow _nets
       DFrontierType _df;
       reverse_graph<GraphType>* _pRG;
       SetVertexSignalPairType _setVS;
+      // search state reused from fault to fault, see resetSearchState
+      Arena _arena;                        // _df, _cV and _setVS
+      PropagateContainerType _cV;          // propagateVertex
+      vector<default_color_type> _colors;  // backtraceVertex
+      vector<BacktraceFrameType> _backtraceStack;
+      vector<DecisionType> _decisions,_lastDecisions; // runATPG
+      RunEnd _lastRun;
+      PatternWriter* _pPatterns; // NULL unless openPatternFile was called
+      ValueChangeDump* _pVCD;    // NULL unless openValueChangeDump was called
+      string _vcdPath;
 };
 template<typename G>
 string RunGraph<G>::_Version="$Id$";
@@ -603,20 +633,40 @@ RunGraph<G>::RunGraph(const string& path) {
   dp.property("name",gname);
 
   cout << "Reading " << path << "\n";
-  read_graphviz(path.c_str(),_g, dp, "node_id");
+  {
+    STATS_PHASE(RunStats::Load);
+    MEMSTATS_TAG(MemStats::Graph);
+    read_graphviz(path.c_str(),_g, dp, "node_id");
+  }
   //_v=boost::get(vertex_attribute,_g);
   //_e=boost::get(edge_attribute,_g);
-  _df.clear();
-  _setVS.clear();
-  _pRG=new reverse_graph<G>(_g);
+  _ei=boost::get(edge_index,_g);
+  {
+    EdgeIteratorType firstEI,lastEI;
+    int index=0;
+    for(tie(firstEI,lastEI)=edges(_g);firstEI!=lastEI;++firstEI) put(_ei,*firstEI,index++);
+  }
+  resetSearchState();
+  {
+    MEMSTATS_TAG(MemStats::ReverseGraph);
+    _pRG=new reverse_graph<G>(_g);
+  }
+  _pPatterns=NULL;
+  _pVCD=NULL;
+  RunEnd none={false,false,false,false,false};
+  _lastRun=none;
+  MEMSTATS_MARK("load");
 };
 
 template<typename G>
 RunGraph<G>::~RunGraph(){
+  delete _pPatterns; // flushes and closes the pattern file
+  delete _pVCD;
   delete _pRG;
 };
 template<typename G>
 void RunGraph<G>::writeGraph(const string& path){
+ storeSignals();
  dynamic_properties dp;
 
   VertexAttrMapType name = get(vertex_name, _g);
@@ -636,6 +686,245 @@ void RunGraph<G>::writeGraph(const string& path){
   std::ofstream ofs( path.c_str() );
   write_graphviz_dp(ofs,_g, dp);
 };
+// ------------------------------------------------------------
+// function appendDotString
+// ------------------------------------------------------------
+void appendDotString(const string& value,string& text){
+/* Appends value as a DOT quoted string, with '"' and '\\' escaped, so a
+   value ending in a backslash cannot swallow the closing quote
+*/
+  text+='"';
+  for(string::size_type i=0;i<value.size();++i){
+    if('"'==value[i] || '\\'==value[i]) text+='\\';
+    text+=value[i];
+  }
+  text+='"';
+};
+// ------------------------------------------------------------
+// function appendDotAttributes
+// ------------------------------------------------------------
+void appendDotAttributes(const GraphvizAttrList& attrs,string& text){
+/* Appends [key="value", ...] for a DOT statement, nothing when no key but
+   node_id is set. Reads the map only, so it is safe to call from several
+   formatting threads at once.
+*/
+  bool bFirst=true;
+  for(GraphvizAttrList::const_iterator it=attrs.begin();it!=attrs.end();++it){
+    if("node_id"==it->first) continue;
+    text+=bFirst ? " [" : ", ";
+    bFirst=false;
+    text+=it->first;
+    text+='=';
+    appendDotString(it->second,text);
+  }
+  if(!bFirst) text+="]";
+};
+template<typename G>
+string RunGraph<G>::vertexId(VertexType v) const{
+/* DOT node id of v, read without inserting into the attribute map */
+  const GraphvizAttrList& attrs=boost::get(vertex_attribute,_g)[v];
+  GraphvizAttrList::const_iterator it=attrs.find("node_id");
+  if(attrs.end()!=it) return it->second;
+  return "n"+boost::lexical_cast<string>(v);
+};
+template<typename G>
+void RunGraph<G>::writeGraphValues(const string& path){
+/* Writes only the ATPG results : one line per driven net with the signal on
+   its out edges, then one line per edge whose signal differs from its net,
+   which are the injected branch faults. Lines are keyed by DOT node id, so
+   they can be applied to the input .dot file as a patch.
+      n5 _D
+      n5 -> n10 D
+*/
+  DEBUG_SCOPE(DEBUG_LEVEL_PHASE,"writeGraphValues");
+  storeSignals();
+  cout << "Writing " << path << "\n";
+  AsyncWriter w(path);
+  w.write("# atpg net values\n# node_id value\n# node_id -> node_id value\n");
+  VertexIteratorType viStart,viEnd;
+  OutEdgeIteratorType startEI,endEI;
+  string line,branches;
+  for(tie(viStart,viEnd)=vertices(_g);viStart!=viEnd;++viStart){
+    tie(startEI,endEI)=out_edges(*viStart,_g);
+    if(startEI==endEI) continue;
+    const string& netValue=_e[*startEI]["label"];
+    string id=vertexId(*viStart);
+    line=id+" "+netValue+"\n";
+    for(;startEI!=endEI;++startEI){
+      const string& value=_e[*startEI]["label"];
+      if(value!=netValue) line+=id+" -> "+vertexId(target(*startEI,_g))+" "+value+"\n";
+    }
+    w.write(line);
+  }
+  w.close();
+};
+template<typename G>
+void RunGraph<G>::writeGraphParallel(const string& path,unsigned numThreads){
+/* Writes the complete annotated graph as DOT. Vertex and edge statements
+   are formatted in chunks of vertices on numThreads workers and written in
+   order by formatInOrder. Chunks 0..n-1 hold vertex statements, chunks
+   n..2n-1 the out edges of the same vertex ranges.
+*/
+  DEBUG_SCOPE(DEBUG_LEVEL_PHASE,"writeGraphParallel");
+  storeSignals();
+  cout << "Writing " << path << "\n";
+  const size_t ChunkSize=4096;
+  size_t numVertices=num_vertices(_g);
+  size_t numVertexChunks=(numVertices+ChunkSize-1)/ChunkSize;
+  const G& g=_g;
+
+  AsyncWriter w(path);
+  string header="digraph ";
+  appendDotString(get_property(_g,graph_name),header);
+  header+=" {\n";
+  const GraphvizAttrList& graphAttrs=get_property(_g,graph_graph_attribute);
+  if(!graphAttrs.empty()){
+    header+="graph";
+    appendDotAttributes(graphAttrs,header);
+    header+=";\n";
+  }
+  w.write(header);
+  formatInOrder(w,2*numVertexChunks,numThreads,[&](size_t chunk,string& text){
+    bool bEdges=(chunk>=numVertexChunks);
+    size_t first=(chunk%numVertexChunks)*ChunkSize;
+    size_t last=std::min(first+ChunkSize,numVertices);
+    OutEdgeIteratorType startEI,endEI;
+    for(size_t i=first;i<last;++i){
+      VertexType v=vertex(i,g);
+      if(!bEdges){
+        appendDotString(vertexId(v),text);
+        appendDotAttributes(boost::get(vertex_attribute,g)[v],text);
+        text+=";\n";
+      }else{
+        for(tie(startEI,endEI)=out_edges(v,g);startEI!=endEI;++startEI){
+          appendDotString(vertexId(v),text);
+          text+=" -> ";
+          appendDotString(vertexId(target(*startEI,g)),text);
+          appendDotAttributes(boost::get(edge_attribute,g)[*startEI],text);
+          text+=";\n";
+        }
+      }
+    }
+  });
+  w.write("}\n");
+  w.close();
+};
+template<typename G>
+void RunGraph<G>::getPorts(vector<VertexType>& vPI,vector<VertexType>& vPO){
+/* Collects the primary inputs and outputs in vertex order. This is the
+   PI/PO order used in the pattern files.
+*/
+   VertexIteratorType viStart,viEnd;
+   for(tie(viStart,viEnd)=vertices(_g);viStart!=viEnd;++viStart){
+      NodeHelper VertexHelper(_v[*viStart]["label"]);
+      if("in"==VertexHelper.getFunc()){
+        vPI.push_back(*viStart);
+      }else if("out"==VertexHelper.getFunc()){
+        vPO.push_back(*viStart);
+      }
+   }
+};
+template<typename G>
+void RunGraph<G>::openPatternFile(const string& path,const string& format){
+  DEBUG_SCOPE(DEBUG_LEVEL_PHASE,"openPatternFile");
+  MEMSTATS_TAG(MemStats::Patterns);
+  vector<VertexType> vPI,vPO;
+  getPorts(vPI,vPO);
+  vector<string> piNames,poNames;
+  for(typename vector<VertexType>::iterator it=vPI.begin();it!=vPI.end();++it){
+    piNames.push_back(NodeHelper(_v[*it]["label"]).getName());
+  }
+  for(typename vector<VertexType>::iterator it=vPO.begin();it!=vPO.end();++it){
+    poNames.push_back(NodeHelper(_v[*it]["label"]).getName());
+  }
+  delete _pPatterns;
+  cout << "Writing patterns to " << path << "\n";
+  _pPatterns=new PatternWriter(path,PatternFile::formatFromString(format),piNames,poNames);
+  if(!_pPatterns->good()) cout << "Warning! Cannot open pattern file " << path << "\n";
+};
+template<typename G>
+void RunGraph<G>::recordPattern(){
+/* Appends the current PI assignment and PO response as one pattern.
+   PI values come from their output edges, PO values from their input edge.
+*/
+  DEBUG_SCOPE(DEBUG_LEVEL_STEP,"recordPattern");
+  MEMSTATS_TAG(MemStats::Patterns);
+  if(NULL==_pPatterns) return;
+  vector<VertexType> vPI,vPO;
+  getPorts(vPI,vPO);
+  vector<DLogic> piValues,poValues;
+  for(typename vector<VertexType>::iterator it=vPI.begin();it!=vPI.end();++it){
+    piValues.push_back(evaluateNet(*it));
+  }
+  InEdgeIteratorType startEI,endEI;
+  for(typename vector<VertexType>::iterator it=vPO.begin();it!=vPO.end();++it){
+    DLogic poSignal=DLogic::X;
+    for(tie(startEI,endEI)=in_edges(*it,_g);startEI!=endEI;++startEI){
+      DLogic signal=edgeSignal(*startEI);
+      if(DLogic::X!=signal){
+        poSignal=signal;
+        break;
+      }
+    }
+    poValues.push_back(poSignal);
+  }
+  _pPatterns->addPattern(piValues,poValues);
+};
+template<typename G>
+void RunGraph<G>::openValueChangeDump(const string& path){
+/* Starts recording signal changes, one VCD signal per vertex output */
+#ifdef VCD_OFF
+  cout << "Warning! Value change dump not compiled in ( VCD_OFF )\n";
+#else
+  DEBUG_SCOPE(DEBUG_LEVEL_PHASE,"openValueChangeDump");
+  vector<string> names;
+  VertexIteratorType viStart,viEnd;
+  for(tie(viStart,viEnd)=vertices(_g);viStart!=viEnd;++viStart){
+    names.push_back(NodeHelper(_v[*viStart]["label"]).getName());
+  }
+  delete _pVCD;
+  _pVCD=new ValueChangeDump;
+  _pVCD->setSignals(names);
+  _vcdPath=path;
+#endif
+};
+template<typename G>
+void RunGraph<G>::writeValueChangeDump(const string& path){
+/* Writes the changes recorded since the last write to path, then clears
+   the recorder so the next run starts its own dump
+*/
+  if(NULL==_pVCD) return;
+  cout << "Writing " << path << " ( " << _pVCD->size() << " changes in " << _pVCD->getStep() << " steps )\n";
+  if(!_pVCD->write(path,get_property(_g,graph_name))){
+    cout << "Warning! Cannot write value change dump " << path << "\n";
+  }
+  _pVCD->clear();
+};
+template<typename G>
+bool RunGraph<G>::compileNetlist(Netlist& n){
+/* One gate per vertex, in vertex order, with the gate function taken from
+   the vertex label. Each edge becomes a fanin of its target vertex, in
+   in_edges order, which is the order of the pins of a cell.
+*/
+  DEBUG_SCOPE(DEBUG_LEVEL_PHASE,"compileNetlist");
+  MEMSTATS_TAG(MemStats::Netlist);
+  VertexIteratorType viStart,viEnd;
+  for(tie(viStart,viEnd)=vertices(_g);viStart!=viEnd;++viStart){
+    NodeHelper VertexHelper(_v[*viStart]["label"]);
+    n.addGate(VertexHelper.getName(),VertexHelper.getFunc());
+  }
+  InEdgeIteratorType firstEI,lastEI;
+  for(tie(viStart,viEnd)=vertices(_g);viStart!=viEnd;++viStart){
+    for(tie(firstEI,lastEI)=in_edges(*viStart,_g);firstEI!=lastEI;++firstEI){
+      n.addFanin(static_cast<Netlist::GateId>(*viStart),static_cast<Netlist::GateId>(source(*firstEI,_g)));
+    }
+  }
+  bool bLevelized=n.levelize();
+  if(!bLevelized) cout << "Error! Netlist has a combinational loop\n";
+  DEBUG_DBG("1","netlist depth==",n.getDepth());
+  MEMSTATS_MARK("compile");
+  return bLevelized;
+};
 template<typename G>
 typename RunGraph<G>::VertexType RunGraph<G>::findVertexWithLabel(const string& label){
    VertexIteratorType viStart,viEnd;
@@ -655,11 +944,14 @@ void RunGraph<G>::seedDFrontier(DFrontierType& dF){
    we can study multiple faults. Alternate implementation could return when
    first fault found.
 */
-   Debug D("seedDFrontier");
+   DEBUG_SCOPE(DEBUG_LEVEL_STEP,"seedDFrontier");
+   MEMSTATS_TAG(MemStats::DFrontier);
    EdgeIteratorType firstEI,lastEI;
    VertexType vTarget;
    for(tie(firstEI,lastEI)=edges(_g);firstEI!=lastEI;++firstEI){
-     if(("D"==_e[*firstEI]["label"])||("_D"==_e[*firstEI]["label"])){
+     DLogic signal=edgeSignal(*firstEI);
+     if(DLogic::D==signal||DLogic::_D==signal){
+      traceChange(source(*firstEI,_g),signal);
       vTarget=target(*firstEI,_g);
       typename DFrontierType::iterator iVertexFound=std::find(dF.begin(),dF.end(),vTarget);
       if(dF.end()==iVertexFound){
@@ -667,30 +959,39 @@ void RunGraph<G>::seedDFrontier(DFrontierType& dF){
       }//if vTarget not in DFrontier
      }//if edge has fault injected
    }//for all edges
+   STATS_DFRONTIER(dF.size());
    dumpDFrontier(dF,_v);
 };
 template<typename G>
 void RunGraph<G>::updateDFrontier(DFrontierType& dF){
-/* If there are no more undriven inputs of the front element, remove it */
-  Debug D("updateDFrontier");
+/* If there are no more undriven inputs of the front element, remove it.
+   The watched inputs of the gate answer without a scan of its inputs.
+*/
+  DEBUG_SCOPE(DEBUG_LEVEL_STEP,"updateDFrontier");
+  MEMSTATS_TAG(MemStats::DFrontier);
   assert(0!=dF.size()); // function should not be called if DFrontier is empty
-  InEdgeIteratorType firstEI,lastEI;
-  set<string> InputSignalSet;
   VertexType vTarget=*(dF.begin());
-  for(tie(firstEI,lastEI)=in_edges(vTarget,_g);firstEI!=lastEI;++firstEI){
-    string& signal=_e[*firstEI]["label"];
-    D.Dbg("1","signal==",signal);
-    if("X"==signal){
-      InputSignalSet.insert(signal);
-    }
-  }//for all edges
-  if(0==InputSignalSet.size()){
-    D.Dbg("1","updateDFrontier: ","removing vertex");
+  unsigned undrivenInputs=_gates.watchedXs(vTarget,_nets);
+  DEBUG_DBG("1","undriven inputs ( 2 for 2 or more )==",undrivenInputs);
+  if(0==undrivenInputs){
+    DEBUG_DBG("1","updateDFrontier: ","removing vertex");
     dF.pop_front();
   }
   dumpDFrontier(dF,_v);
 };
 template<typename G>
+void RunGraph<G>::resetSearchState(){
+/* Gives the D-frontier, the propagation container and the PI decisions
+   fresh capacity from the arena, after rewinding it. Their contents are
+   dropped. Each is sized for its worst case, so a fault normally takes
+   nothing from the heap once the arena has its chunks.
+*/
+  _arena.reset();
+  _df.reserve(_arena,num_vertices(_g));   // vertex-unique
+  _cV.reserve(_arena,num_edges(_g)+1);    // a fanout edge per implication
+  _setVS.reserve(_arena,num_vertices(_g));
+};
+template<typename G>
 void RunGraph<G>::printFinishStats(bool DFrontierEmpty,bool FirstOutputFound, bool FirstNonDPassable, bool FirstInconsistentOutput){
   if(true==FirstNonDPassable||true==FirstInconsistentOutput){
     cout << "Bad run\n";
@@ -709,38 +1010,197 @@ void RunGraph<G>::setDebug(const string& dString){
 };
 template<typename G>
 void RunGraph<G>::initializeGraph(){
-  Debug D("initializeGraph");
-  XEdgeVisitor<G> initV(_g);
-  depth_first_search(_g,visitor(initV));
+  DEBUG_SCOPE(DEBUG_LEVEL_PHASE,"initializeGraph");
+  STATS_PHASE(RunStats::Initialize);
+  if(!_nets.loaded()){ // afterwards the nets hold every signal, nothing is left unset
+    {
+      MEMSTATS_TAG(MemStats::Graph); // X labels added to the edge attribute maps
+      XEdgeVisitor<G> initV(_g);
+      depth_first_search(_g,visitor(initV));
+    }
+    loadSignals();
+  }
   cout << "\n";
+  MEMSTATS_MARK("initialize");
+};
+template<typename G>
+void RunGraph<G>::loadSignals(){
+/* Moves the edge labels into the net store. The stem of each vertex takes
+   the label of its first out edge, any out edge with a different label
+   keeps it as a branch value, so any labelling of the file is kept.
+*/
+  DEBUG_SCOPE(DEBUG_LEVEL_STEP,"loadSignals");
+  MEMSTATS_TAG(MemStats::Propagation);
+  _nets.clear(num_vertices(_g));
+  VertexIteratorType viStart,viEnd;
+  OutEdgeIteratorType startEI,endEI;
+  for(tie(viStart,viEnd)=vertices(_g);viStart!=viEnd;++viStart){
+    _nets.setFanout(*viStart,out_degree(*viStart,_g));
+    DLogic net=DLogic::X;
+    bool bFirst=true;
+    for(tie(startEI,endEI)=out_edges(*viStart,_g);startEI!=endEI;++startEI){
+      const string& label=_e[*startEI]["label"];
+      DLogic signal(label);
+      if(!signal.valid()){
+        cout << "Warning! Edge label " << label << " is not a signal, using X\n";
+        signal=DLogic::X;
+      }
+      if(bFirst){
+        net=signal;
+        _nets.setNet(*viStart,net);
+        bFirst=false;
+      }else if(net!=signal){
+        _nets.setBranch(*viStart,_ei[*startEI],signal);
+      }
+    }
+  }
+  DEBUG_DBG("1","branch values==",_nets.numBranchValues());
+  if(0==_gates.size()){
+    InEdgeIteratorType firstEI,lastEI;
+    for(tie(viStart,viEnd)=vertices(_g);viStart!=viEnd;++viStart){
+      for(tie(firstEI,lastEI)=in_edges(*viStart,_g);firstEI!=lastEI;++firstEI){
+        _gates.addInput(*viStart,source(*firstEI,_g),_ei[*firstEI]);
+      }
+      NodeHelper VertexHelper(_v[*viStart]["label"]);
+      const string& func=VertexHelper.getFunc();
+      const TruthTable* table=CellTable(func,static_cast<unsigned>(in_degree(*viStart,_g)));
+      if(0!=table){
+        _gates.setTable(*viStart,*table);
+      }else{
+        _gates.setFunc(*viStart,GateCounts::funcFromName(func));
+      }
+    }
+  }
+  _gates.clear(num_vertices(_g));
+  EdgeIteratorType firstEI,lastEI;
+  for(tie(firstEI,lastEI)=edges(_g);firstEI!=lastEI;++firstEI){
+    DLogic signal=edgeSignal(*firstEI);
+    if(DLogic::X!=signal) _gates.change(target(*firstEI,_g),DLogic::X,signal);
+  }
+};
+template<typename G>
+void RunGraph<G>::clearSignals(){
+/* Every net and every gate input back to X */
+  _nets.clear(num_vertices(_g));
+  _gates.clear(num_vertices(_g));
+};
+template<typename G>
+void RunGraph<G>::injectFault(const EdgeType& e,DLogic d){
+/* d on the one branch e, the rest of its net keeps its value */
+  _gates.change(target(e,_g),edgeSignal(e),d);
+  _nets.setBranch(source(e,_g),_ei[e],d);
+};
+template<typename G>
+void RunGraph<G>::storeSignals(){
+/* Writes the net signals back into the edge labels, for the dot writers */
+  if(!_nets.loaded()) return;
+  DEBUG_SCOPE(DEBUG_LEVEL_STEP,"storeSignals");
+  EdgeIteratorType firstEI,lastEI;
+  for(tie(firstEI,lastEI)=edges(_g);firstEI!=lastEI;++firstEI){
+    _e[*firstEI]["label"]=edgeSignal(*firstEI).GetLabel();
+  }
+};
+template<typename G>
+DLogic RunGraph<G>::evaluateNet(VertexType v){
+  /* The functionality can be described as follows :
+     RealSignals, R=={ONE,ZERO,D,_D}
+     All branches of the net of v should have the same signal value. This
+     can then be used to set the remaining branches
+     Branches of the net | Evaluated result
+     --------------------|-----------------
+     R,X,X,X             |  R
+     R,R,X,X             |  R
+     R1,R2,X,X           |  error ( R1 != R2 ), X
+     X,X,X,X             |  X
+     Only a branch fault gives a branch a value apart from its stem.
+  */
+  DEBUG_SCOPE(DEBUG_LEVEL_GATE,"EvaluateOutputs");
+  DEBUG_DBG("1","vertex label==",_v[v]["label"]);
+  bool bIncompatible=false;
+  DLogic result=_nets.evaluate(v,bIncompatible);
+  if(bIncompatible){ // more than one incompatible driving signal
+    cout << "Error! More than one incompatible signal found on out_edges of " << _v[v]["label"] << "\n";
+  }
+  DEBUG_DBG("1","sResult==",result.GetString());
+  return result;
+};
+template<typename G>
+void RunGraph<G>::driveNet(VertexType v,DLogic d){
+/* Sets the net of v, the branches already driven keep their value */
+  DEBUG_SCOPE(DEBUG_LEVEL_GATE,"setOutputEdges");
+  OutEdgeIteratorType startEI,endEI;
+  for(tie(startEI,endEI)=out_edges(v,_g);startEI!=endEI;++startEI){ // the X branches take d
+    if(DLogic::X==edgeSignal(*startEI)) _gates.change(target(*startEI,_g),DLogic::X,d);
+  }
+  for(unsigned notX=_nets.drive(v,d);0!=notX;--notX){
+    cout << "Warning! Output edge should be X\n";
+  }
 };
 template<typename G>
 void RunGraph<G>::backtraceVertex(const VertexType& v){
-  Debug D("backtraceGraph");
+  DEBUG_SCOPE(DEBUG_LEVEL_STEP,"backtraceGraph");
+  STATS_PHASE(RunStats::Backtrace);
+  STATS_COUNT(RunStats::Backtraces);
+  MEMSTATS_TAG(MemStats::Backtrace);
   string& vertexLabel=_v[v]["label"];
-  D.Dbg("1","vertex label==",vertexLabel);
-
-  typedef std::vector<default_color_type> ColorMapType;
-  ColorMapType GraphColorMap(num_vertices(_g));
-  BacktraceVisitor<reverse_graph<G> > backtraceVisitor(_g,_e,_setVS);
-  depth_first_visit(*_pRG,v,backtraceVisitor,&GraphColorMap[0]);
+  DEBUG_DBG("1","vertex label==",vertexLabel);
+
+  /* Same visiting order as depth_first_visit(*_pRG,v,backtraceVisitor,color),
+     which builds a new stack on every call; the color map and the stack
+     are members here, so a backtrace allocates nothing.
+  */
+  _colors.assign(num_vertices(_g),white_color);
+  BacktraceVisitor<reverse_graph<G> > backtraceVisitor(_nets,_gates,_setVS);
+  const reverse_graph<G>& rg=*_pRG;
+  ReverseOutEdgeIteratorType ei,eiEnd;
+  VertexType u=v;
+  _colors[u]=gray_color;
+  backtraceVisitor.discover_vertex(u,rg);
+  tie(ei,eiEnd)=out_edges(u,rg);
+  _backtraceStack.clear();
+  _backtraceStack.push_back(BacktraceFrameType(u,make_pair(ei,eiEnd)));
+  while(!_backtraceStack.empty()){
+    u=_backtraceStack.back().first;
+    tie(ei,eiEnd)=_backtraceStack.back().second;
+    _backtraceStack.pop_back();
+    while(ei!=eiEnd){
+      VertexType w=target(*ei,rg);
+      if(white_color==_colors[w]){
+        ++ei;
+        _backtraceStack.push_back(BacktraceFrameType(u,make_pair(ei,eiEnd)));
+        u=w;
+        _colors[u]=gray_color;
+        backtraceVisitor.discover_vertex(u,rg);
+        tie(ei,eiEnd)=out_edges(u,rg);
+      }else{
+        ++ei;
+      }
+    }
+    _colors[u]=black_color;
+  }
 };
 template<typename G>
 tripleBool RunGraph<G>::propagateVertex(VertexType v, DLogic driveSignal){
-    Debug D("propagateVertex");
-    string VertexLabel=_v[v]["label"];
-    D.Dbg("1","vertex label==",VertexLabel);
-    deque<VertexType> cV;
+    DEBUG_SCOPE(DEBUG_LEVEL_STEP,"propagateVertex");
+    STATS_PHASE(RunStats::Propagate);
+    MEMSTATS_TAG(MemStats::Propagation);
+    DEBUG_DBG("1","vertex label==",_v[v]["label"]);
+    PropagateContainerType& cV=_cV;
+    cV.clear();
     cV.push_back(v);
-    setOutputEdges(v,_g,driveSignal);
+    traceStep();
+    driveNet(v,driveSignal);
+    traceChange(v,driveSignal);
     VertexType vOrigin;
     bool bOutputFound=false,bInconsistentOutput=false,bNonDPassable=false;
     while(0!=cV.size()){
-      ostringstream outputString;
-      for(typename deque<VertexType>::iterator it=cV.begin();it!=cV.end();++it){
-        outputString << _v[*it]["label"]+",";
-      }
-      D.Dbg("1","cV==",outputString.str());
+      DEBUG_DBG("1","cV==",[&]{
+        ostringstream outputString;
+        for(typename PropagateContainerType::iterator it=cV.begin();it!=cV.end();++it){
+          outputString << _v[*it]["label"]+",";
+        }
+        return outputString.str();
+      }());
       vOrigin=*cV.begin();
       tie(bOutputFound,bInconsistentOutput,bNonDPassable)=propagateChange(vOrigin,_g,cV);
       cV.pop_front();
@@ -750,25 +1210,28 @@ tripleBool RunGraph<G>::propagateVertex(VertexType v, DLogic driveSignal){
 };
 template<typename G>
 bool RunGraph<G>::processOutput(VertexType v,G& g,PropagateContainerType& cv,DLogic outS,DLogic currentS){
-  Debug D("processOutput");
+  DEBUG_SCOPE(DEBUG_LEVEL_GATE,"processOutput");
   bool bInconsistentOutput=false;
   if(false==OutputConsistent(outS,currentS)){
     bInconsistentOutput=true;
   }else{
     if(DLogic::X!=outS){
-      setOutputEdges(v,g,outS);
+      STATS_COUNT(RunStats::Implications);
+      driveNet(v,outS);
+      traceChange(v,outS);
       putDescendantsInPContainer(v,g,cv);
       if(DLogic::D==outS||DLogic::_D==outS) putDescendantsInDFrontier(v,g,_df);
     }
   }
-  D.Dbg("1","bInconsistentOutput==",bInconsistentOutput);
+  DEBUG_DBG("1","bInconsistentOutput==",bInconsistentOutput);
   return bInconsistentOutput;
 };
 template<typename G>
 tripleBool RunGraph<G>::propagateChange(VertexType v, G& g,PropagateContainerType& cv) {
-    Debug D("propagateChange");
-    string VertexLabel=_v[v]["label"];
-    D.Dbg("1","vertex label==",VertexLabel);
+    DEBUG_SCOPE(DEBUG_LEVEL_GATE,"propagateChange");
+    traceStep();
+    const string& VertexLabel=_v[v]["label"];
+    DEBUG_DBG("1","vertex label==",VertexLabel);
     NodeHelper VertexHelper(VertexLabel);
     const string& VertexFunc=VertexHelper.getFunc();
     DLogic outSignal,currentSignal;
@@ -781,11 +1244,10 @@ tripleBool RunGraph<G>::propagateChange(VertexType v, G& g,PropagateContainerTyp
       if("out"==VertexFunc){
         bOutputFound=true;
       }else if("in"==VertexFunc) {
-        outSignal=EvaluateOutputs(v,g);
-        D.Dbg("1","outSignal==",outSignal.GetString());
+        outSignal=evaluateNet(v);
+        DEBUG_DBG("1","outSignal==",outSignal.GetString());
         processOutput(v,g,cv,outSignal,DLogic::X);
       }else{
-        vector<DLogic> vSignals;
         int totalDegree=degree(v,g); // Bug in in_degree
         int numOutputs=out_degree(v,g);
         int numInputs=totalDegree-numOutputs;
@@ -795,21 +1257,21 @@ tripleBool RunGraph<G>::propagateChange(VertexType v, G& g,PropagateContainerTyp
         case 0 :
           break;
         case 1 : // single input, see Note 1
-          tie(startEI,endEI)=in_edges(v,g);
-          outSignal=EvaluateSingleInput(VertexFunc,_e[*startEI]["label"]);
-          currentSignal=EvaluateOutputs(v,g);
-          bInconsistentOutput=processOutput(v,g,cv,outSignal,currentSignal);
-          break;
-        default : // multi-inputs
-          tie(startEI,endEI)=in_edges(v,g);
-          // see podem.oln Note1 : VC6 error if std:: left out of transform
-          // see podem.oln Note2 : VC6 error if std:: left out of back_inserter
-          std::transform(startEI,endEI,std::back_inserter(vSignals),GetSignalFunctor<G>(_g));
-          outSignal=EvaluateMultipleInputs(VertexFunc,vSignals);
-          currentSignal=EvaluateOutputs(v,g);
-          if(false==DPassable(vSignals,outSignal)){
+          if(GateCounts::Table!=_gates.func(v)){
+            tie(startEI,endEI)=in_edges(v,g);
+            outSignal=EvaluateSingleInput(VertexFunc,edgeSignal(*startEI));
+            currentSignal=evaluateNet(v);
+            bInconsistentOutput=processOutput(v,g,cv,outSignal,currentSignal);
+            break;
+          } // a cell of one input goes through its table
+        default : // multi-inputs, from the input counts or the cell table, see GateCounts
+          STATS_COUNT(RunStats::GateEvals);
+          outSignal=_gates.evaluate(v,_nets);
+          DEBUG_DBG("1","counted outSignal==",outSignal.GetString());
+          currentSignal=evaluateNet(v);
+          if(false==_gates.dPassable(v,outSignal)){
             bNonDPassable=true;
-            D.Dbg("1","multi-inputs : ","bNonDPassable set to true");
+            DEBUG_DBG("1","multi-inputs : ","bNonDPassable set to true");
           }
           bInconsistentOutput=processOutput(v,g,cv,outSignal,currentSignal);
           break;
@@ -824,11 +1286,11 @@ tripleBool RunGraph<G>::propagateChange(VertexType v, G& g,PropagateContainerTyp
               +--> seedDFrontier
               +--> backtraceVertex --+--> BacktraceVisitor
               |                      +--> depth_first_visit
-              +--> propagateVertex --+--> propagateChange --+--> EvaluateOutputs
+              +--> propagateVertex --+--> propagateChange --+--> evaluateNet
               |                                             +--> EvaluateSingleInput
-              |                                             +--> GetSignalFunctor
-              |                                             +--> EvaluateMultipleInputs
+              |                                             +--> GateCounts
               |                                             +--> processOutput
+              +--> recordPattern ------> PatternWriter
               +--> printFinishStats
 
  */
@@ -914,12 +1376,16 @@ different circuits can be studied.
  
  */
 template<typename G>
-void RunGraph<G>::runATPG(){
-  Debug D("runATPG");
+bool RunGraph<G>::runATPG(){
+  DEBUG_SCOPE(DEBUG_LEVEL_PHASE,"runATPG");
 
   bool bFirstOutputFound=false,bFirstNonDPassable=false,bFirstInconsistentOutput=false;
-  bool bStopRun=false; // for testing purpose, set to false or remove later
+  bool bStopRun=false;
   VertexType vObjective;
+  vector<DecisionType>& decisions=_decisions;
+  vector<DecisionType>& lastDecisions=_lastDecisions; // to detect a pass that repeats the previous one
+  lastDecisions.clear();
+  resetSearchState();
   initializeGraph();
   seedDFrontier(_df);
   //  while(!(_df.empty() || bFirstOutputFound || bFirstNonDPassable || bFirstInconsistentOutput || bStopRun)) {
@@ -927,20 +1393,103 @@ void RunGraph<G>::runATPG(){
     vObjective=*(_df.begin());
     backtraceVertex(vObjective);
     dumpSetVS(_setVS,_v);    
+    decisions.clear();
+    decisions.push_back(make_pair(vObjective,DLogic(DLogic::X)));
     for(typename SetVertexSignalPairType::iterator it=_setVS.begin();it!=_setVS.end();++it){
+        decisions.push_back(make_pair(it->getVertex(),it->getSignal()));
+        STATS_COUNT(RunStats::Decisions);
         tie(bFirstOutputFound,bFirstInconsistentOutput,bFirstNonDPassable)=propagateVertex(it->getVertex(),it->getSignal());
+        if(bFirstNonDPassable||bFirstInconsistentOutput){
+          STATS_COUNT(RunStats::Backtracks);
+          Progress::backtrack();
+        }
         if(bFirstOutputFound||bFirstNonDPassable||bFirstInconsistentOutput) break;
     }
     _setVS.clear();
     updateDFrontier(_df); // remove vObjective if no more undriven inputs
-    // writeGraph("debug.dot");
-    bStopRun=false;
+    // writeGraph("debug.dot"); // use -vcd instead, see openValueChangeDump
+    /* Propagation is deterministic, so the same objective with the same
+       decisions as the previous pass leaves the graph as it was, and the
+       loop would never end. Seen on fault lists of generated circuits.
+    */
+    bStopRun=(decisions==lastDecisions);
+    decisions.swap(lastDecisions);
   };//while - done with PODEM
-  printFinishStats(_df.empty(),bFirstOutputFound,bFirstNonDPassable,bFirstInconsistentOutput);
+  if(bFirstOutputFound){
+    recordPattern();
+    Progress::pattern();
+  }
+  MEMSTATS_MARK("atpg");
+  bool bAborted=bStopRun && !bFirstOutputFound && !bFirstNonDPassable && !bFirstInconsistentOutput;
+  RunEnd end={_df.empty(),bFirstOutputFound,bFirstNonDPassable,bFirstInconsistentOutput,bAborted};
+  _lastRun=end;
+  return bFirstOutputFound;
+};
+template<typename G>
+void RunGraph<G>::reportRun(){
+/* Once per run of a single target; runFaultList sums its runs instead */
+  if(_lastRun.bAborted) cout << "Aborted run, a pass repeated the previous one\n";
+  else printFinishStats(_lastRun.bDFrontierEmpty,_lastRun.bFirstOutputFound,_lastRun.bFirstNonDPassable,_lastRun.bFirstInconsistentOutput);
+  writeValueChangeDump(_vcdPath);
+};
+template<typename G>
+void RunGraph<G>::runFaultList(){
+/* Runs runATPG once per checkpoint fault, stuck-at-0 ( D ) and stuck-at-1
+   ( _D ) on every PI output edge and every fanout branch, replacing the
+   seed fault of the input file. Before each fault every net is reset to
+   X, the fault is the one branch value, and the D-frontier is emptied, so
+   the runs are independent. Counts go to Progress as each fault finishes.
+   The finish states of printFinishStats are summed over the list and
+   printed once at the end; runs stopped by a repeated pass are counted as
+   aborted, apart from the good and bad runs. With -vcd each fault gets its own dump, named
+   after the -vcd path with the fault number : run.vcd gives run.1.vcd,
+   run.2.vcd ... in the order of the faults.
+*/
+  DEBUG_SCOPE(DEBUG_LEVEL_PHASE,"runFaultList");
+  vector<EdgeType> sites;
+  EdgeIteratorType firstEI,lastEI;
+  for(tie(firstEI,lastEI)=edges(_g);firstEI!=lastEI;++firstEI){
+    VertexType vSource=source(*firstEI,_g);
+    NodeHelper SourceHelper(_v[vSource]["label"]);
+    if(out_degree(vSource,_g)>1 || "in"==SourceHelper.getFunc()) sites.push_back(*firstEI);
+  }
+  Progress::setTotal(2*sites.size());
+  initializeGraph(); // fanouts of the nets, inputs of the gates
+  unsigned long long detected=0,badRuns=0,aborted=0,dFrontierEmpty=0,nonDPassable=0,inconsistentOutput=0;
+  string vcdStem(_vcdPath);
+  if(vcdStem.size()>4 && ".vcd"==vcdStem.substr(vcdStem.size()-4)) vcdStem.erase(vcdStem.size()-4);
+  unsigned long long fault=0;
+  for(typename vector<EdgeType>::iterator it=sites.begin();it!=sites.end();++it){
+    for(int stuckAt=0;stuckAt<2;++stuckAt){
+      clearSignals();
+      injectFault(*it,(0==stuckAt) ? DLogic::D : DLogic::_D);
+      bool bDetected=runATPG();
+      if(_lastRun.bAborted){
+        Progress::faultAborted();
+        ++aborted;
+      }else{
+        Progress::faultDone(bDetected);
+      }
+      if(bDetected) ++detected;
+      if(_lastRun.bFirstNonDPassable || _lastRun.bFirstInconsistentOutput) ++badRuns;
+      if(_lastRun.bDFrontierEmpty) ++dFrontierEmpty;
+      if(_lastRun.bFirstNonDPassable) ++nonDPassable;
+      if(_lastRun.bFirstInconsistentOutput) ++inconsistentOutput;
+      writeValueChangeDump(vcdStem+"."+boost::lexical_cast<string>(++fault)+".vcd");
+    }
+  }
+  cout << "Fault list : " << detected << " of " << 2*sites.size() << " checkpoint faults reach an output\n";
+  cout << "\tGood runs :\t" << 2*sites.size()-badRuns-aborted << "\n";
+  cout << "\tBad runs :\t" << badRuns << "\n";
+  cout << "\tAborted runs :\t" << aborted << "\n";
+  cout << "\t1) DFrontier empty :\t" << dFrontierEmpty << "\n";
+  cout << "\t2) First output found :\t" << detected << "\n";
+  cout << "\t3) First non D passable found :\t" << nonDPassable << "\n";
+  cout << "\t4) First inconsistent output found :\t" << inconsistentOutput << "\n";
 };
 template<typename G>
 void RunGraph<G>::test(const string& startLabel){
-  Debug D("test - new");
+  DEBUG_SCOPE(DEBUG_LEVEL_PHASE,"test - new");
 };
 // ------------------------------------------------------------
 // Collection of tests - should not be compiled unless we need it
@@ -948,14 +1497,14 @@ void RunGraph<G>::test(const string& startLabel){
 #if 0
 template<typename G>
 void RunGraph<G>::test(const string& startLabel){
-  Debug D("test - hasX");
+  DEBUG_SCOPE(DEBUG_LEVEL_PHASE,"test - hasX");
 
   BacktraceVisitor<G> forwardVisitor(_g,_v,_e,_setVS);
-  D.Dbg("1","depth_first_search: ","forwardVisitor");
+  DEBUG_DBG("1","depth_first_search: ","forwardVisitor");
   depth_first_search(_g,visitor(forwardVisitor));
   cout <<"\n";
   BacktraceVisitor< reverse_graph<G> > reverseVisitor(*_pRG,_v,_e,_setVS);
-  D.Dbg("1","depth_first_search: ","reverseVisitor");
+  DEBUG_DBG("1","depth_first_search: ","reverseVisitor");
   depth_first_search(*_pRG,visitor(reverseVisitor)); // reverse graph takes reverseVisitor of type reverse_graph<G>
   cout <<"\n";
 };
@@ -964,7 +1513,7 @@ void RunGraph<G>::test(const string& startLabel){
 template<typename G>
 void RunGraph<G>::test(const string& startLabel){
   // use zeroinput.dot as input
-  Debug D("test - reverse_graph");
+  DEBUG_SCOPE(DEBUG_LEVEL_PHASE,"test - reverse_graph");
   cout << "No of vertices==" << num_vertices(*_pRG) << "\n";
 #if defined(REVERSE_PROBLEM)
   DfsVisitor<G> forwardVisitor(_g);
@@ -989,7 +1538,7 @@ void RunGraph<G>::test(const string& startLabel){
 #if 0
 template<typename G>
 void RunGraph<G>::test(const string& startLabel){
-  Debug D("test - EvaluateMultipleInputs");
+  DEBUG_SCOPE(DEBUG_LEVEL_PHASE,"test - EvaluateMultipleInputs");
   //  DLogic result=EvaluateSingleInput("not","_D");
   DLogic result;
   vector<DLogic> vA;
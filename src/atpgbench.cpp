@@ -0,0 +1,442 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#if defined(WIN32) && !defined( __COMO__)
+   #pragma warning(disable:4786 4503 4101)
+#endif
+/* Micro-benchmarks of the ATPG hot primitives, run one at a time.
+
+   Every optimization of DLogic, gate evaluation, label parsing, the
+   D-frontier or backtrace should be measured against these numbers
+   before and after the change.
+
+   Usage :
+      atpgbench                  run everything
+      atpgbench -f Evaluate      only benchmarks whose name contains Evaluate
+      atpgbench -n 30 -ms 50     30 repetitions of at least 50 ms each
+      atpgbench -csv bench.csv   also write the results as csv
+      atpgbench -perf            add hardware counters per op, see PerfCounters
+      atpgbench -f ordering -perf  cache misses per gate of each Netlist ordering
+
+   Build with DEBUG_OFF, STATS_OFF and MEMSTATS_OFF as well to see what the
+   Debug scopes, RunStats counters and the MemStats operator new cost in
+   the release configuration.
+ */
+#include <iostream>
+#include <fstream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+using std::cout;
+
+#include "atpg.hpp"
+#include "CmdLine.hpp"
+#include "Bench.hpp"
+#include "BitSim.hpp"
+#include "CompiledSim.hpp"
+#include "CircuitGen.hpp"
+#include "DotStore.hpp"
+
+namespace{
+  typedef RunGraph<GraphvizDigraph> GraphType;
+
+  // deterministic, so that runs are comparable
+  unsigned nextRandom(unsigned& state){
+    state=state*1664525u+1013904223u;
+    return state>>8;
+  }
+  DLogic randomDLogic(unsigned& state){
+    return DLogic(static_cast<int>(nextRandom(state)%5));
+  }
+  void benchDLogic(Bench& b){
+    const unsigned N=1024;
+    unsigned state=1;
+    vector<DLogic> lhs,rhs;
+    for(unsigned i=0;i<N;++i){
+      lhs.push_back(randomDLogic(state));
+      rhs.push_back(randomDLogic(state));
+    }
+    b.run("DLogic and",[&]{
+      for(unsigned i=0;i<N;++i) Bench::keep(lhs[i] && rhs[i]);
+    },N);
+    b.run("DLogic or",[&]{
+      for(unsigned i=0;i<N;++i) Bench::keep(lhs[i] || rhs[i]);
+    },N);
+    b.run("DLogic not",[&]{
+      for(unsigned i=0;i<N;++i) Bench::keep(!lhs[i]);
+    },N);
+    vector<string> names;
+    for(unsigned i=0;i<N;++i) names.push_back(lhs[i].GetString());
+    b.run("DLogic(string)",[&]{
+      for(unsigned i=0;i<N;++i){
+        DLogic d(names[i]);
+        Bench::keep(d);
+      }
+    },N);
+    b.run("DLogic::GetString",[&]{
+      for(unsigned i=0;i<N;++i){
+        string s=lhs[i].GetString();
+        Bench::keep(s);
+      }
+    },N);
+  }
+  void benchEvaluate(Bench& b){
+  /* A pool of random input vectors per arity, cycled so the branch
+     predictor cannot learn the result.
+   */
+    const unsigned Pool=256;
+    const char* Funcs[]={"and","nand","or","nor"};
+    const unsigned Arities[]={2,3,4,8,32};
+    for(size_t a=0;a<sizeof(Arities)/sizeof(Arities[0]);++a){
+      unsigned state=Arities[a];
+      vector<vector<DLogic> > inputs(Pool);
+      for(unsigned i=0;i<Pool;++i){
+        for(unsigned k=0;k<Arities[a];++k) inputs[i].push_back(randomDLogic(state));
+      }
+      for(size_t f=0;f<sizeof(Funcs)/sizeof(Funcs[0]);++f){
+        const string func(Funcs[f]);
+        ostringstream name;
+        name << "EvaluateMultipleInputs " << func << Arities[a];
+        b.run(name.str(),[&]{
+          for(unsigned i=0;i<Pool;++i) Bench::keep(EvaluateMultipleInputs(func,inputs[i]));
+        },Pool);
+        const Netlist::GateType type=Netlist::typeFromFunc(func);
+        const unsigned numIn=Arities[a];
+        ostringstream kernelName;
+        kernelName << "GateKernels " << func << Arities[a];
+        b.run(kernelName.str(),[&]{
+          for(unsigned i=0;i<Pool;++i) Bench::keep(GateKernels::evaluate(type,&inputs[i][0],numIn));
+        },Pool);
+      }
+    }
+    /* One input event on a wide gate : the fold goes over every input
+       again, the counts move one input and read the output off.
+     */
+    const unsigned Wide=32;
+    unsigned eventState=Wide;
+    vector<DLogic> events;
+    for(unsigned i=0;i<Pool;++i) events.push_back(randomDLogic(eventState));
+    vector<DLogic> folded(Wide,DLogic::X);
+    const string wideFunc("nand");
+    ostringstream foldName;
+    foldName << "event fold " << wideFunc << Wide;
+    b.run(foldName.str(),[&]{
+      for(unsigned i=0;i<Pool;++i){
+        folded[i%Wide]=events[i];
+        Bench::keep(EvaluateMultipleInputs(wideFunc,folded));
+      }
+    },Pool);
+    GateCounts gates;
+    for(unsigned k=0;k<Wide;++k) gates.addInput(Wide,k,k); // gate Wide, inputs from vertices 0 to Wide-1
+    gates.setFunc(Wide,GateCounts::funcFromName(wideFunc));
+    gates.clear(Wide+1);
+    vector<DLogic> counted(Wide,DLogic::X);
+    ostringstream countName;
+    countName << "event GateCounts " << wideFunc << Wide;
+    b.run(countName.str(),[&]{
+      for(unsigned i=0;i<Pool;++i){
+        gates.change(Wide,counted[i%Wide],events[i]);
+        counted[i%Wide]=events[i];
+        Bench::keep(gates.evaluate(Wide));
+      }
+    },Pool);
+    unsigned state=1;
+    vector<string> signals;
+    for(unsigned i=0;i<Pool;++i) signals.push_back(randomDLogic(state).GetString());
+    const string inv("inv");
+    b.run("EvaluateSingleInput inv",[&]{
+      for(unsigned i=0;i<Pool;++i) Bench::keep(EvaluateSingleInput(inv,signals[i]));
+    },Pool);
+  }
+  void benchNodeHelper(Bench& b){
+    const unsigned N=256;
+    const char* Funcs[]={"in","out","inv","nand","nor","and","or"};
+    vector<string> labels,plain;
+    for(unsigned i=0;i<N;++i){
+      ostringstream label;
+      label << "U" << i << ":" << Funcs[i%(sizeof(Funcs)/sizeof(Funcs[0]))];
+      labels.push_back(label.str());
+      plain.push_back(label.str().substr(0,label.str().find(':')));
+    }
+    b.run("NodeHelper name:func",[&]{
+      for(unsigned i=0;i<N;++i){
+        NodeHelper h(labels[i]);
+        Bench::keep(h);
+      }
+    },N);
+    b.run("NodeHelper name",[&]{
+      for(unsigned i=0;i<N;++i){
+        NodeHelper h(plain[i]);
+        Bench::keep(h);
+      }
+    },N);
+  }
+  void benchDFrontier(Bench& b){
+  /* The D-frontier is a deque of vertices, kept free of duplicates with
+     std::find before every push_back ( seedDFrontier,
+     putDescendantsInDFrontier ), so insertion is linear in its size.
+   */
+    typedef GraphType::VertexType VertexType;
+    const unsigned Sizes[]={16,256,4096};
+    for(size_t s=0;s<sizeof(Sizes)/sizeof(Sizes[0]);++s){
+      const unsigned N=Sizes[s];
+      unsigned state=N;
+      vector<VertexType> order;
+      for(unsigned i=0;i<N;++i) order.push_back(i);
+      for(unsigned i=N-1;i>0;--i) std::swap(order[i],order[nextRandom(state)%(i+1)]);
+      ostringstream insertName,lookupName;
+      insertName << "DFrontier insert " << N;
+      lookupName << "DFrontier lookup " << N;
+      b.run(insertName.str(),[&]{
+        std::deque<VertexType> dF;
+        for(unsigned i=0;i<N;++i){
+          if(dF.end()==std::find(dF.begin(),dF.end(),order[i])) dF.push_back(order[i]);
+        }
+        Bench::keep(dF);
+      },N);
+      std::deque<VertexType> dF(order.begin(),order.end());
+      b.run(lookupName.str(),[&]{
+        for(unsigned i=0;i<N;++i) Bench::keep(std::find(dF.begin(),dF.end(),order[N-1-i]));
+      },N);
+    }
+  }
+  string scratchPath(){
+    const char* dir=getenv("TMPDIR");
+    string path=string((NULL!=dir) ? dir : "/tmp")+"/atpgbenchXXXXXX";
+    vector<char> name(path.begin(),path.end());
+    name.push_back('\0');
+    int fd=mkstemp(&name[0]);
+    if(fd<0) return "";
+    close(fd);
+    return &name[0];
+  }
+  string writeTree(unsigned depth){
+  /* Balanced nand tree, 2^depth primary inputs and 2^depth-1 gates, with
+     the root driving Z:out, so the whole graph is the backtrace cone of Z.
+   */
+    string path=scratchPath();
+    if(path.empty()) return "";
+    ofstream os(path.c_str());
+    os << "digraph \"tree\" {\n";
+    unsigned leaves=1u<<depth;
+    // vertex i has children 2i+1 and 2i+2, the leaves are primary inputs
+    for(unsigned i=0;i<2*leaves-1;++i){
+      if(i<leaves-1) os << "\"n" << i << "\" [label=\"U" << i << ":nand\"];\n";
+      else os << "\"n" << i << "\" [label=\"I" << i << ":in\"];\n";
+    }
+    os << "\"z\" [label=\"Z:out\"];\n\"n0\" -> \"z\" [label=\"X\"];\n";
+    for(unsigned i=0;i<leaves-1;++i){
+      os << "\"n" << 2*i+1 << "\" -> \"n" << i << "\" [label=\"X\"];\n";
+      os << "\"n" << 2*i+2 << "\" -> \"n" << i << "\" [label=\"X\"];\n";
+    }
+    os << "}\n";
+    return os.good() ? path : "";
+  }
+  void benchBacktrace(Bench& b){
+    const unsigned Depths[]={4,8,12,14};
+    for(size_t d=0;d<sizeof(Depths)/sizeof(Depths[0]);++d){
+      ostringstream name;
+      name << "backtraceVertex cone " << (1u<<Depths[d])-1 << " gates"; // the nands, not the PIs
+      if(!b.selected(name.str())) continue;
+      string path=writeTree(Depths[d]);
+      if(path.empty()){
+        cout << "Error! Cannot write benchmark netlist\n";
+        return;
+      }
+      {
+        GraphType g(path);
+        g.initializeGraph();
+        GraphType::VertexType root=g.findVertexWithLabel("Z:out");
+        b.run(name.str(),[&]{ g.backtraceVertex(root); });
+      }
+      unlink(path.c_str());
+    }
+  }
+  void benchOrdering(Bench& b){
+  /* A generated circuit read back from its dot file, so the gate ids are
+     in node_id order as for any netlist read with -r, then renumbered by
+     each Netlist ordering. One BitSim<64> pass and one fanout cone walk
+     from every 16th PI, per gate, run with -perf for the cache misses.
+   */
+    const size_t Gates=200000;
+    bool bSelected=false;
+    for(unsigned o=0;o<Netlist::NumOrderings;++o){
+      bSelected=bSelected || b.selected(string("BitSim 64 ordering ")+Netlist::orderingName(static_cast<Netlist::Ordering>(o)))
+                          || b.selected(string("fanout cone ordering ")+Netlist::orderingName(static_cast<Netlist::Ordering>(o)));
+    }
+    if(!bSelected) return;
+    string path=scratchPath();
+    Netlist generated;
+    CircuitGen gen(generated,1);
+    gen.generate("random",Gates);
+    if(path.empty() || !generated.levelize() || !CircuitGen::writeDot(generated,path,generated.getInputs()[0])){
+      cout << "Error! Cannot write benchmark netlist\n";
+      return;
+    }
+    DotStore dot;
+    bool bRead=dot.read(path);
+    unlink(path.c_str());
+    if(!bRead){
+      cout << "Error! " << dot.error() << "\n";
+      return;
+    }
+    for(unsigned o=0;o<Netlist::NumOrderings;++o){
+      Netlist n;
+      dot.compile(n);
+      n.reorder(static_cast<Netlist::Ordering>(o));
+      string name=string("BitSim 64 ordering ")+Netlist::orderingName(static_cast<Netlist::Ordering>(o));
+      if(b.selected(name)){
+        BitSim<64> sim(n);
+        unsigned state=1;
+        for(size_t i=0;i<n.getInputs().size();++i){
+          BitSim<64>::Word hi=(static_cast<BitSim<64>::Word>(nextRandom(state))<<32)|nextRandom(state);
+          BitSim<64>::Word lo=~hi;
+          sim.setInput(i,&hi,&lo);
+        }
+        b.run(name,[&]{ sim.simulate(); Bench::keep(sim.getHi(n.getOutputs()[0])[0]); },n.size());
+      }
+      name=string("fanout cone ordering ")+Netlist::orderingName(static_cast<Netlist::Ordering>(o));
+      if(b.selected(name)){
+        vector<unsigned> stamp(n.size(),0);
+        vector<Netlist::GateId> queue;
+        queue.reserve(n.size());
+        unsigned pass=0;
+        auto walk=[&]()->size_t{
+          size_t count=0;
+          for(size_t i=0;i<n.getInputs().size();i+=16){
+            ++pass;
+            queue.assign(1,n.getInputs()[i]);
+            for(size_t head=0;head<queue.size();++head){
+              for(unsigned f=0;f<n.numFanouts(queue[head]);++f){
+                Netlist::GateId g=n.fanouts(queue[head])[f];
+                if(pass!=stamp[g]){ stamp[g]=pass; queue.push_back(g); }
+              }
+            }
+            count+=queue.size();
+          }
+          return count;
+        };
+        size_t visited=walk(); // gates visited per call, so that the time is per gate
+        b.run(name,[&]{ Bench::keep(walk()); },visited);
+      }
+    }
+  }
+  void benchCells(Bench& b){
+  /* Cells from their truth table, DLogic and bit-parallel, next to a
+     nand of the same number of inputs from its kernel.
+   */
+    const unsigned Pool=256;
+    const char* Cells[][2]={{"xor","2"},{"mux","3"},{"aoi21","3"},{"aoi222","6"},{"lut_9669a55a3cc3f00f","6"}};
+    vector<bool> kernelRun(TruthTable::MaxInputs+1,false);
+    for(size_t c=0;c<sizeof(Cells)/sizeof(Cells[0]);++c){
+      const string func(Cells[c][0]);
+      const unsigned numIn=static_cast<unsigned>(atoi(Cells[c][1]));
+      TruthTable t;
+      if(!TruthTable::fromFunc(func,numIn,t)) continue;
+      unsigned state=numIn;
+      vector<DLogic> inputs;
+      for(unsigned i=0;i<Pool*numIn;++i) inputs.push_back(randomDLogic(state));
+      b.run("TruthTable "+func,[&]{
+        for(unsigned i=0;i<Pool;++i) Bench::keep(t.evaluate(&inputs[i*numIn]));
+      },Pool);
+      ostringstream nandName;
+      nandName << "TruthTable nand" << numIn << " kernel";
+      if(!kernelRun[numIn] && b.selected(nandName.str())){
+        kernelRun[numIn]=true;
+        b.run(nandName.str(),[&]{
+          for(unsigned i=0;i<Pool;++i) Bench::keep(GateKernels::evaluate(Netlist::Nand,&inputs[i*numIn],numIn));
+        },Pool);
+      }
+      // one gate over numIn inputs, 64 patterns per evaluation
+      Netlist n;
+      vector<Netlist::GateId> in;
+      for(unsigned i=0;i<numIn;++i) in.push_back(n.addGate(string(1,static_cast<char>('a'+i)),Netlist::In));
+      Netlist::GateId g=n.addGate("z",func);
+      for(unsigned i=0;i<numIn;++i) n.addFanin(g,in[i]);
+      if(!n.levelize()) continue;
+      BitSim<64> sim(n);
+      for(unsigned i=0;i<numIn;++i){
+        BitSim<64>::Word hi=(static_cast<BitSim<64>::Word>(nextRandom(state))<<32)|nextRandom(state);
+        BitSim<64>::Word lo=~hi&((static_cast<BitSim<64>::Word>(nextRandom(state))<<32)|nextRandom(state));
+        sim.setInput(i,&hi,&lo);
+      }
+      b.run("BitSim 64 cell "+func,[&]{ sim.evaluate(g); Bench::keep(sim.getHi(g)[0]); },1);
+    }
+  }
+  template<unsigned Width>
+  void benchCompiledWidth(Bench& b,const Netlist& n,const string& cacheDir){
+    ostringstream interpreted,compiled;
+    interpreted << "BitSim " << Width << " interpreted";
+    compiled << "BitSim " << Width << " compiled";
+    if(!b.selected(interpreted.str()) && !b.selected(compiled.str())) return;
+    typedef typename BitSim<Width>::Word Word;
+    BitSim<Width> sim(n);
+    unsigned state=1;
+    for(size_t i=0;i<n.getInputs().size();++i){
+      Word hi[BitSim<Width>::Words],lo[BitSim<Width>::Words];
+      for(unsigned w=0;w<BitSim<Width>::Words;++w){
+        hi[w]=(static_cast<Word>(nextRandom(state))<<32)|nextRandom(state);
+        lo[w]=~hi[w];
+      }
+      sim.setInput(i,hi,lo);
+    }
+    if(b.selected(interpreted.str())){
+      b.run(interpreted.str(),[&]{ sim.simulate(); Bench::keep(sim.getHi(n.getOutputs()[0])[0]); },n.size());
+    }
+    CompiledSim cs;
+    if(b.selected(compiled.str()) && cs.load(n,BitSim<Width>::Words,cacheDir)){
+      sim.setCompiled(cs.function());
+      b.run(compiled.str(),[&]{ sim.simulate(); Bench::keep(sim.getHi(n.getOutputs()[0])[0]); },n.size());
+    }
+  }
+  void benchCompiled(Bench& b){
+  /* The interpreter against the compiled code of CompiledSim, per gate.
+     The objects are cached in $TMPDIR, the first run compiles them.
+   */
+    Netlist n;
+    CircuitGen gen(n,1);
+    gen.generate("random",10000);
+    if(!n.levelize()) return;
+    const char* dir=getenv("TMPDIR");
+    string cacheDir=(NULL!=dir) ? dir : "/tmp";
+    benchCompiledWidth<64>(b,n,cacheDir);
+    benchCompiledWidth<512>(b,n,cacheDir);
+  }
+}
+void processCmdLine(CmdLine& cL,int argc,char** argv){
+  cL.addStandaloneSwitch("-h","print this help message");
+  cL.addStandaloneSwitch("-perf","count cycles, instructions and misses per op");
+  cL.addParameterSwitch("-f","","run only benchmarks whose name contains this string");
+  cL.addParameterSwitch("-n","15","repetitions per benchmark");
+  cL.addParameterSwitch("-ms","20","minimum milliseconds per repetition");
+  cL.addParameterSwitch("-csv","undefined","write results csv path");
+  cL.process(argc,argv);
+}
+int main(int argc,char** argv){
+  cout << "$Id$\n";
+  CmdLine cLine;
+  processCmdLine(cLine,argc,argv);
+  if("set"==cLine.switchValue("-h")){
+    cLine.printSwitches();
+    return 0;
+  }
+  Bench b(atoi(cLine.switchValue("-n").c_str()),atof(cLine.switchValue("-ms").c_str()));
+  b.setFilter(cLine.switchValue("-f"));
+  if("set"==cLine.switchValue("-perf") && !b.setCounters(true)){
+    cout << "Warning! No hardware counters, " << b.countersError() << "\n";
+  }
+  benchDLogic(b);
+  benchEvaluate(b);
+  benchNodeHelper(b);
+  benchDFrontier(b);
+  benchBacktrace(b);
+  benchOrdering(b);
+  benchCells(b);
+  benchCompiled(b);
+  b.print();
+  const string& csvPath=cLine.switchValue("-csv");
+  if("undefined"!=csvPath && !b.writeCsv(csvPath)) cout << "Error! Cannot write " << csvPath << "\n";
+  return 0;
+}
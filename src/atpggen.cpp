@@ -0,0 +1,85 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#if defined(WIN32) && !defined( __COMO__)
+   #pragma warning(disable:4786 4503 4101)
+#endif
+/* Writes a synthetic circuit, see CircuitGen.hpp.
+
+   Usage :
+      atpggen -c adder -g 1000 -o add.dot
+      atpggen -c random -g 100000 -d 40 -fi 4 -fo 6 -rc 0.5 -o r.dot
+      atpggen -c iscas -g 10000000 -nm big.nl     mapped netlist only, for atpg -rm
+
+   The first PI is the seed fault ( D on its first fanout edge ) unless
+   -fault names another gate.
+ */
+#include <iostream>
+#include <stdlib.h>
+using std::cout;
+
+#include "CmdLine.hpp"
+#include "CircuitGen.hpp"
+#include "MappedNetlist.hpp"
+
+void processCmdLine(CmdLine& cL,int argc,char** argv){
+  cL.addStandaloneSwitch("-h","print this help message");
+  cL.addParameterSwitch("-c","random",std::string("circuit, ")+CircuitGen::circuitNames());
+  cL.addParameterSwitch("-g","1000","approximate number of gates");
+  cL.addParameterSwitch("-d","0","random : depth, 0 picks 2*log2(gates)");
+  cL.addParameterSwitch("-fi","3","random : maximum fanin");
+  cL.addParameterSwitch("-fo","8","random : maximum fanout");
+  cL.addParameterSwitch("-rc","0.3","random : reconvergence probability");
+  cL.addParameterSwitch("-seed","1","random number seed");
+  cL.addParameterSwitch("-fault","undefined","name of the gate whose first fanout edge gets the D");
+  cL.addParameterSwitch("-o","undefined","write dot file path");
+  cL.addParameterSwitch("-nm","undefined","write mapped netlist path");
+  cL.process(argc,argv);
+}
+int main(int argc,char** argv){
+  cout << "$Id$\n";
+  CmdLine cLine;
+  processCmdLine(cLine,argc,argv);
+  if("set"==cLine.switchValue("-h")){
+    cLine.printSwitches();
+    return 0;
+  }
+  const std::string& circuit=cLine.switchValue("-c");
+  if(!CircuitGen::validCircuit(circuit)){
+    cout << "Error! Unknown circuit " << circuit << ", use " << CircuitGen::circuitNames() << "\n";
+    return 1;
+  }
+  Netlist netlist;
+  CircuitGen gen(netlist,static_cast<unsigned>(atoi(cLine.switchValue("-seed").c_str())));
+  gen.generate(circuit,static_cast<std::size_t>(atof(cLine.switchValue("-g").c_str())),
+               static_cast<unsigned>(atoi(cLine.switchValue("-d").c_str())),
+               static_cast<unsigned>(atoi(cLine.switchValue("-fi").c_str())),
+               static_cast<unsigned>(atoi(cLine.switchValue("-fo").c_str())),
+               atof(cLine.switchValue("-rc").c_str()));
+  if(!netlist.levelize()){
+    cout << "Error! Generated netlist has a combinational loop\n";
+    return 1;
+  }
+  cout << circuit << " : " << netlist.size() << " gates, " << netlist.getInputs().size() << " PIs, "
+       << netlist.getOutputs().size() << " POs, depth " << netlist.getDepth() << "\n";
+
+  Netlist::GateId fault=netlist.getInputs().empty() ? static_cast<Netlist::GateId>(netlist.size()) : netlist.getInputs()[0];
+  if("undefined"!=cLine.switchValue("-fault")){
+    fault=netlist.findGate(cLine.switchValue("-fault"));
+    if(fault>=netlist.size()) cout << "Warning! No gate named " << cLine.switchValue("-fault") << ", no fault seeded\n";
+  }
+  int status=0;
+  const std::string& dotPath=cLine.switchValue("-o");
+  if("undefined"!=dotPath && !CircuitGen::writeDot(netlist,dotPath,fault)){
+    cout << "Error! Cannot write " << dotPath << "\n";
+    status=1;
+  }
+  const std::string& mappedPath=cLine.switchValue("-nm");
+  if("undefined"!=mappedPath && !MappedNetlist::write(netlist,mappedPath)){
+    cout << "Error! Cannot write mapped netlist " << mappedPath << "\n";
+    status=1;
+  }
+  return status;
+}
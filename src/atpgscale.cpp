@@ -0,0 +1,229 @@
+/* Copyright (C) Kwee Heong Tan 2002 - 2003
+   Permission is granted to use this code without restriction as
+   long as this copyright notice appears in all source files.
+*/
+// $Id$
+#if defined(WIN32) && !defined( __COMO__)
+   #pragma warning(disable:4786 4503 4101)
+#endif
+/* End to end scaling benchmark over synthetic circuits ( CircuitGen ).
+
+   For every size in -sizes, generates the circuit and times
+      generate    CircuitGen and levelize
+      write       dot file with the seed fault on the first PI
+      parse       RunGraph, read_graphviz into the BGL graph
+      compact     DotStore, the same file into the compact store
+      compile     RunGraph::compileNetlist
+      faultlist   collapsed stuck-at fault list, two faults per checkpoint
+                  ( PIs and fanout branches )
+      atpg        RunGraph::runATPG for the seed fault
+      patterns    random binary pattern file, -patterns patterns
+      sim         PatternSim::simulateFile over that file
+   and appends one row per size to the csv, with the peak resident set
+   size so far. graph_bytes_per_gate is the heap of the BGL graph from
+   MemStats ( empty with MEMSTATS_OFF ), compact_bytes_per_gate the heap of
+   the DotStore, string pool excluded. Sizes above -graphmax skip the dot
+   and BGL stages ( write, parse, compact, compile, atpg ), the fault list
+   and simulation then run on the generated netlist, so 10M gate runs fit
+   in memory.
+
+   Usage :
+      atpgscale -c random -sizes 1000,10000,100000,1000000 -csv random.csv
+      atpgscale -c iscas -sizes 1000000,10000000 -graphmax 0
+ */
+#include <iostream>
+#include <chrono>
+#include <stdlib.h>
+#include <unistd.h>
+using std::cout;
+
+#include "atpg.hpp"
+#include "CmdLine.hpp"
+#include "CircuitGen.hpp"
+#include "PatternSim.hpp"
+#include "RunStats.hpp"
+#include "MemStats.hpp"
+#include "DotStore.hpp"
+
+namespace{
+  class Stopwatch{
+  public:
+    Stopwatch() : _start(std::chrono::steady_clock::now()) {}
+    double seconds() const {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now()-_start).count();
+    }
+  private:
+    std::chrono::steady_clock::time_point _start;
+  };
+  struct Fault{
+    Netlist::GateId gate;    // driver of the faulty net
+    Netlist::GateId branch;  // fanout gate, or gate itself for a stem fault
+    bool stuckAtOne;
+  };
+  void buildFaultList(const Netlist& n,vector<Fault>& faults){
+  /* Checkpoint theorem : tests for the stuck-at faults on PIs and fanout
+     branches detect all single stuck-at faults of the circuit.
+   */
+    faults.clear();
+    for(Netlist::GateId g=0;g<n.size();++g){
+      if(Netlist::In==n.getType(g)){
+        Fault f0={g,g,false},f1={g,g,true};
+        faults.push_back(f0);
+        faults.push_back(f1);
+      }
+      if(n.numFanouts(g)>1){
+        for(unsigned i=0;i<n.numFanouts(g);++i){
+          Fault f0={g,n.fanouts(g)[i],false},f1={g,n.fanouts(g)[i],true};
+          faults.push_back(f0);
+          faults.push_back(f1);
+        }
+      }
+    }
+  }
+  bool writeRandomPatterns(const Netlist& n,const string& path,size_t count,unsigned seed){
+    vector<string> piNames,poNames;
+    for(size_t i=0;i<n.getInputs().size();++i) piNames.push_back(n.getName(n.getInputs()[i]));
+    for(size_t i=0;i<n.getOutputs().size();++i) poNames.push_back(n.getName(n.getOutputs()[i]));
+    PatternWriter w(path,PatternFile::Binary,piNames,poNames);
+    if(!w.good()) return false;
+    vector<DLogic> piValues(piNames.size()),poValues(poNames.size(),DLogic::X); // no known responses
+    unsigned state=seed;
+    for(size_t p=0;p<count;++p){
+      for(size_t i=0;i<piValues.size();++i){
+        state=state*1664525u+1013904223u;
+        piValues[i]=(state&0x10000) ? DLogic::ONE : DLogic::ZERO;
+      }
+      w.addPattern(piValues,poValues);
+    }
+    w.close();
+    return w.good();
+  }
+  string scratchPath(const string& suffix){
+    const char* dir=getenv("TMPDIR");
+    return string((NULL!=dir) ? dir : "/tmp")+"/atpgscale"+boost::lexical_cast<string>(getpid())+suffix;
+  }
+}
+void processCmdLine(CmdLine& cL,int argc,char** argv){
+  cL.addStandaloneSwitch("-h","print this help message");
+  cL.addStandaloneSwitch("-keep","keep the generated dot and pattern files");
+  cL.addParameterSwitch("-c","random",string("circuit, ")+CircuitGen::circuitNames());
+  cL.addParameterSwitch("-sizes","1000,10000,100000,1000000","comma separated gate counts");
+  cL.addParameterSwitch("-graphmax","1000000","largest size run through the dot file and BGL stages");
+  cL.addParameterSwitch("-patterns","256","random patterns to simulate");
+  cL.addParameterSwitch("-sw","256","simulation block width, 64, 256 or 512");
+  cL.addParameterSwitch("-seed","1","random number seed");
+  cL.addParameterSwitch("-csv","scale.csv","write results csv path");
+  cL.process(argc,argv);
+}
+int main(int argc,char** argv){
+  cout << "$Id$\n";
+  CmdLine cLine;
+  processCmdLine(cLine,argc,argv);
+  if("set"==cLine.switchValue("-h")){
+    cLine.printSwitches();
+    return 0;
+  }
+  const string& circuit=cLine.switchValue("-c");
+  if(!CircuitGen::validCircuit(circuit)){
+    cout << "Error! Unknown circuit " << circuit << ", use " << CircuitGen::circuitNames() << "\n";
+    return 1;
+  }
+  vector<size_t> sizes;
+  std::istringstream sizeList(cLine.switchValue("-sizes"));
+  string item;
+  while(std::getline(sizeList,item,',')) if(!item.empty()) sizes.push_back(static_cast<size_t>(atof(item.c_str())));
+  size_t graphMax=static_cast<size_t>(atof(cLine.switchValue("-graphmax").c_str()));
+  size_t numPatterns=static_cast<size_t>(atoi(cLine.switchValue("-patterns").c_str()));
+  unsigned width=static_cast<unsigned>(atoi(cLine.switchValue("-sw").c_str()));
+  unsigned seed=static_cast<unsigned>(atoi(cLine.switchValue("-seed").c_str()));
+  bool bKeep=("set"==cLine.switchValue("-keep"));
+
+  const string& csvPath=cLine.switchValue("-csv");
+  std::ofstream csv(csvPath.c_str());
+  if(!csv.good()){
+    cout << "Error! Cannot write " << csvPath << "\n";
+    return 1;
+  }
+  csv << "circuit,target_gates,gates,inputs,outputs,depth,generate_s,write_s,parse_s,graph_bytes_per_gate,"
+         "compact_s,compact_bytes_per_gate,compile_s,"
+         "faults,faultlist_s,atpg_s,patterns,patterns_s,sim_s,peak_rss_kb\n";
+  for(size_t s=0;s<sizes.size();++s){
+    cout << "\n" << circuit << " " << sizes[s] << " gates\n";
+    std::ostringstream row;
+    row << circuit << "," << sizes[s] << ",";
+
+    Stopwatch generateTime;
+    Netlist generated;
+    CircuitGen gen(generated,seed);
+    gen.generate(circuit,sizes[s]);
+    if(!generated.levelize()){
+      cout << "Error! Generated netlist has a combinational loop\n";
+      return 1;
+    }
+    double generateSeconds=generateTime.seconds();
+    row << generated.size() << "," << generated.getInputs().size() << "," << generated.getOutputs().size() << ","
+        << generated.getDepth() << "," << generateSeconds << ",";
+
+    // the fault list and simulation use the compiled netlist when there is one
+    Netlist compiled;
+    const Netlist* pNetlist=&generated;
+    string dotPath=scratchPath(".dot");
+    if(sizes[s]<=graphMax && !generated.getInputs().empty()){
+      Stopwatch writeTime;
+      if(!CircuitGen::writeDot(generated,dotPath,generated.getInputs()[0])){
+        cout << "Error! Cannot write " << dotPath << "\n";
+        return 1;
+      }
+      row << writeTime.seconds() << ",";
+      MemStats::Counters before[MemStats::NumTags],after[MemStats::NumTags];
+      MemStats::get(before);
+      Stopwatch parseTime;
+      RunGraph<GraphvizDigraph> graph(dotPath);
+      row << parseTime.seconds() << ",";
+      MemStats::get(after);
+#ifndef MEMSTATS_OFF
+      row << (after[MemStats::Graph].inUse-before[MemStats::Graph].inUse)/static_cast<long long>(generated.size()+1);
+#endif
+      row << ",";
+      Stopwatch compactTime;
+      DotStore dot;
+      if(!dot.read(dotPath)) cout << "Error! " << dot.error() << "\n";
+      row << compactTime.seconds() << "," << dot.bytes()/(generated.size()+1) << ",";
+      Stopwatch compileTime;
+      bool bCompiled=graph.compileNetlist(compiled);
+      row << compileTime.seconds() << ",";
+      if(bCompiled) pNetlist=&compiled;
+
+      vector<Fault> faults;
+      Stopwatch faultTime;
+      buildFaultList(*pNetlist,faults);
+      row << faults.size() << "," << faultTime.seconds() << ",";
+      Stopwatch atpgTime;
+      graph.runATPG();
+      row << atpgTime.seconds() << ",";
+    }else{
+      vector<Fault> faults;
+      Stopwatch faultTime;
+      buildFaultList(*pNetlist,faults);
+      row << ",,,,,,," << faults.size() << "," << faultTime.seconds() << ",,";
+    }
+    if(!bKeep) unlink(dotPath.c_str());
+
+    string patternPath=scratchPath(".pat");
+    Stopwatch patternTime;
+    if(!writeRandomPatterns(*pNetlist,patternPath,numPatterns,seed)){
+      cout << "Error! Cannot write " << patternPath << "\n";
+      return 1;
+    }
+    row << numPatterns << "," << patternTime.seconds() << ",";
+    PatternSim::Stats stats;
+    Stopwatch simTime;
+    PatternSim::simulateFile(*pNetlist,patternPath,width,stats);
+    row << simTime.seconds() << "," << RunStats::peakRSSKb();
+    if(!bKeep) unlink(patternPath.c_str());
+
+    csv << row.str() << "\n" << std::flush;
+  }
+  cout << "\nWrote " << csvPath << "\n";
+  return 0;
+}